@@ -0,0 +1,949 @@
+//---------------------------------------------------------------------------
+// benchmarks.cpp
+//
+// Copyright (C) 2026 Lost Empire Entertainment
+//
+// This is free source code, and you are welcome to redistribute it under certain conditions.
+// Read LICENSE.md for more information.
+//
+// Benchmark driver for the hot paths of the headers, results are written as json
+// by BenchmarkSuite from profile_utils.hpp and can be compared against a saved baseline.
+//
+// Covers:
+//   - mat4 multiply and inverse, combine3d and TransformHierarchy::update over large scenes
+//   - convert_colors over color spans, f32 planes and RGBA8 image buffers
+//   - Log::Print single-threaded and contended, synchronous and async
+//   - TokenizeString and FromString
+//   - GetTextFileLineCount and GetRangeByValue on a generated text file (GB-scale by default)
+//   - ImportKMD, ImportKMDMapped, ImportKFD and StreamGlyphs on generated files of configurable size
+//   - lockwait under contention
+//
+// Build from the repository root with CMake:
+//   cmake -S benchmarks -B build-benchmarks -DCMAKE_BUILD_TYPE=Release && cmake --build build-benchmarks --config Release
+//
+// or as a single command:
+//   c++ -std=c++20 -O2 -DNDEBUG -I. benchmarks/benchmarks.cpp -o kala_benchmarks -pthread
+//
+// Log::Print writes to stdout, so run with stdout sent to the null device,
+// progress and the result table go to stderr:
+//   kala_benchmarks --out results.json --baseline previous.json > /dev/null
+//
+// Returns 0 on success, 1 if a result regressed against the baseline and 2 if the run failed
+//---------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <atomic>
+#include <fstream>
+#include <filesystem>
+#include <span>
+
+//profile_utils must come first so the other headers pick up its profiler hooks
+#include "profile_utils.hpp"
+#include "math_utils.hpp"
+#include "color_utils.hpp"
+#include "log_utils.hpp"
+#include "string_utils.hpp"
+#include "thread_utils.hpp"
+#include "file_utils.hpp"
+#include "import_kmd.hpp"
+#include "import_kfd.hpp"
+
+using KalaHeaders::KalaProfile::BenchmarkSuite;
+using KalaHeaders::KalaProfile::BenchmarkSettings;
+using KalaHeaders::KalaProfile::BenchmarkResult;
+using KalaHeaders::KalaProfile::BenchmarkComparison;
+using KalaHeaders::KalaProfile::KeepValue;
+
+namespace KalaMath = KalaHeaders::KalaMath;
+namespace KalaColor = KalaHeaders::KalaColor;
+namespace KalaLog = KalaHeaders::KalaLog;
+namespace KalaString = KalaHeaders::KalaString;
+namespace KalaThread = KalaHeaders::KalaThread;
+namespace KalaFile = KalaHeaders::KalaFile;
+namespace KalaModelData = KalaHeaders::KalaModelData;
+namespace KalaFontData = KalaHeaders::KalaFontData;
+
+using std::string;
+using std::string_view;
+using std::vector;
+using std::atomic;
+using std::ofstream;
+using std::ios;
+using std::span;
+using std::filesystem::path;
+using std::filesystem::exists;
+using std::filesystem::file_size;
+using std::filesystem::create_directories;
+
+using u8 = uint8_t;
+using u16 = uint16_t;
+using u32 = uint32_t;
+using u64 = uint64_t;
+using i16 = int16_t;
+using f32 = float;
+using f64 = double;
+
+struct BenchmarkOptions
+{
+	path outFile = "benchmark_results.json";
+	path baselineFile{};           //compared against the new results if set
+	path dataDir = "benchmark_data"; //generated input files, reused while their size matches
+	f64 tolerance = 0.05;          //allowed median slowdown before a result counts as a regression
+	u64 textFileMb = 1024;         //size of the GetTextFileLineCount and GetRangeByValue file
+	u64 modelFileMb = 64;          //approximate size of the kmd file, clamped below the kmd block limit
+	u32 glyphCount = 4096;         //glyphs in the kfd file, clamped up to the kfd glyph limit
+	u32 glyphSize = 48;            //glyph width and height in pixels, clamped to the kfd glyph height range
+	u32 sceneSize = 100000;        //transforms in the combine3d and hierarchy scenes
+	u32 threadCount = 4;           //threads of the contended benchmarks
+	bool isQuick{};                //fewer and shorter samples for smoke runs
+};
+
+static void PrintUsage()
+{
+	fprintf(stderr,
+		"usage: kala_benchmarks [options] > /dev/null\n"
+		"  --out <file>        json results, default benchmark_results.json\n"
+		"  --baseline <file>   json results of an earlier run to compare against\n"
+		"  --tolerance <x>     allowed median slowdown, default 0.05\n"
+		"  --data-dir <dir>    where generated input files are kept, default benchmark_data\n"
+		"  --text-mb <n>       size of the generated text file, default 1024\n"
+		"  --kmd-mb <n>        approximate size of the generated kmd file, default 64\n"
+		"  --glyphs <n>        glyph count of the generated kfd file, default 4096\n"
+		"  --glyph-size <n>    glyph width and height in pixels, default 48\n"
+		"  --scene <n>         transform count of the scene benchmarks, default 100000\n"
+		"  --threads <n>       threads of the contended benchmarks, default 4\n"
+		"  --quick             fewer and shorter samples\n"
+		"  --help              show this list\n");
+}
+
+//Returns false if an argument is unknown or misses its value
+static bool ParseOptions(
+	int argc,
+	char** argv,
+	BenchmarkOptions& outOptions)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		const string_view arg = argv[i];
+
+		if (arg == "--quick")
+		{
+			outOptions.isQuick = true;
+			continue;
+		}
+
+		if (i + 1 >= argc) return false;
+		const char* value = argv[++i];
+
+		if (arg == "--out") outOptions.outFile = value;
+		else if (arg == "--baseline") outOptions.baselineFile = value;
+		else if (arg == "--data-dir") outOptions.dataDir = value;
+		else if (arg == "--tolerance") outOptions.tolerance = strtod(value, nullptr);
+		else if (arg == "--text-mb") outOptions.textFileMb = strtoull(value, nullptr, 10);
+		else if (arg == "--kmd-mb") outOptions.modelFileMb = strtoull(value, nullptr, 10);
+		else if (arg == "--glyphs") outOptions.glyphCount = scast<u32>(strtoul(value, nullptr, 10));
+		else if (arg == "--glyph-size") outOptions.glyphSize = scast<u32>(strtoul(value, nullptr, 10));
+		else if (arg == "--scene") outOptions.sceneSize = scast<u32>(strtoul(value, nullptr, 10));
+		else if (arg == "--threads") outOptions.threadCount = scast<u32>(strtoul(value, nullptr, 10));
+		else return false;
+	}
+
+	return true;
+}
+
+//
+// GENERATED INPUT FILES
+//
+
+inline constexpr string_view TEXT_NEEDLE = "kala benchmark needle";
+
+//Writes numbered text lines with one needle line per megabyte
+static bool WriteTextFile(
+	const path& target,
+	u64 sizeBytes)
+{
+	if (exists(target)
+		&& file_size(target) == sizeBytes)
+	{
+		return true;
+	}
+
+	ofstream out(target, ios::binary | ios::trunc);
+	if (!out.is_open()) return false;
+
+	const u64 chunkSize = 1048576;
+
+	string chunk{};
+	chunk.reserve(chunkSize);
+
+	u64 written{};
+	u64 line{};
+	while (written < sizeBytes)
+	{
+		chunk.clear();
+
+		const u64 chunkTarget = std::min(chunkSize, sizeBytes - written);
+		while (chunk.size() + 64 < chunkTarget)
+		{
+			chunk += "generated benchmark line ";
+			chunk += std::to_string(line++);
+			chunk += " with some padding text\n";
+		}
+		if (chunk.size() + TEXT_NEEDLE.size() + 1 <= chunkTarget)
+		{
+			chunk += TEXT_NEEDLE;
+			chunk += '\n';
+		}
+		chunk.append(chunkTarget - chunk.size(), '\n');
+
+		out.write(chunk.data(), scast<std::streamsize>(chunk.size()));
+		written += chunk.size();
+	}
+
+	return out.good();
+}
+
+static void Append(
+	vector<u8>& data,
+	const void* value,
+	size_t size)
+{
+	const u8* bytes = scast<const u8*>(value);
+	data.insert(data.end(), bytes, bytes + size);
+}
+
+template <typename T>
+static void Append(
+	vector<u8>& data,
+	T value)
+{
+	Append(data, &value, sizeof(T));
+}
+
+//Writes a version 2 kmd file of uncompressed f32 vertices and u32 triangle list indices,
+//every model is a strip of triangles over a grid of vertices. Returns the written file size, 0 on failure
+static u64 WriteModelFile(
+	const path& target,
+	u64 sizeBytes)
+{
+	using namespace KalaModelData;
+
+	const u32 modelCount = 256;
+	const u64 bytesPerVertex = sizeof(Vertex) + 3 * sizeof(u32);
+	const u64 blockBudget = std::min<u64>(sizeBytes, MAX_MODEL_BLOCK_SIZE - 1048576) / modelCount;
+	const u32 vertexCount = scast<u32>(std::max<u64>(blockBudget / bytesPerVertex, 3));
+	const u32 indexCount = (vertexCount - 2) * 3;
+
+	const u32 blockSize = VERTICE_DATA_OFFSET_V2
+		+ vertexCount * scast<u32>(sizeof(Vertex))
+		+ indexCount * scast<u32>(sizeof(u32));
+	const u32 tablesSize = modelCount * CORRECT_MODEL_TABLE_SIZE;
+	const u64 totalSize = CORRECT_MODEL_HEADER_SIZE + tablesSize + scast<u64>(blockSize) * modelCount;
+
+	if (exists(target)
+		&& file_size(target) == totalSize)
+	{
+		return totalSize;
+	}
+
+	ofstream out(target, ios::binary | ios::trunc);
+	if (!out.is_open()) return 0;
+
+	vector<u8> data{};
+	Append(data, KMD_MAGIC);
+	Append<u8>(data, 2);
+	Append<u8>(data, 1);
+	Append(data, modelCount);
+	Append(data, tablesSize);
+	Append(data, blockSize * modelCount);
+
+	for (u32 m = 0; m < modelCount; ++m)
+	{
+		char name[20]{};
+		snprintf(name, sizeof(name), "model_%u", m);
+		Append(data, name, sizeof(name));
+		Append(data, scast<u32>(CORRECT_MODEL_HEADER_SIZE + tablesSize + blockSize * m));
+		Append(data, blockSize);
+	}
+
+	out.write(rcast<const char*>(data.data()), scast<std::streamsize>(data.size()));
+
+	//every block only differs by name, so the streams are built once
+	vector<u8> streams{};
+	const u32 gridWidth = scast<u32>(std::sqrt(scast<f64>(vertexCount))) + 1;
+	for (u32 v = 0; v < vertexCount; ++v)
+	{
+		Vertex vertex{};
+		vertex.position[0] = scast<f32>(v % gridWidth) * 0.01f;
+		vertex.position[1] = scast<f32>(v / gridWidth) * 0.01f;
+		vertex.normal[2] = 1.0f;
+		vertex.texCoord[0] = scast<f32>(v % gridWidth) / scast<f32>(gridWidth);
+		vertex.texCoord[1] = scast<f32>(v / gridWidth) / scast<f32>(gridWidth);
+		vertex.tangent[0] = 1.0f;
+		vertex.tangent[3] = 1.0f;
+		Append(streams, vertex);
+	}
+	for (u32 t = 0; t + 2 < vertexCount; ++t)
+	{
+		Append(streams, t);
+		Append(streams, t + 1);
+		Append(streams, t + 2);
+	}
+
+	for (u32 m = 0; m < modelCount; ++m)
+	{
+		data.assign(VERTICE_DATA_OFFSET_V2, 0);
+		snprintf(rcast<char*>(data.data()), 20, "model_%u", m);
+		snprintf(rcast<char*>(data.data()) + 20, 20, "mesh_%u", m);
+
+		const f32 position[3]{ 0.0f, 0.0f, 0.0f };
+		const f32 rotation[4]{ 1.0f, 0.0f, 0.0f, 0.0f };
+		const f32 size[3]{ 1.0f, 1.0f, 1.0f };
+		memcpy(data.data() + 92, position, sizeof(position));
+		memcpy(data.data() + 104, rotation, sizeof(rotation));
+		memcpy(data.data() + 120, size, sizeof(size));
+
+		const u32 verticesSize = vertexCount * scast<u32>(sizeof(Vertex));
+		const u32 indicesSize = indexCount * scast<u32>(sizeof(u32));
+		memcpy(data.data() + 132, &vertexCount, sizeof(u32));
+		memcpy(data.data() + 136, &verticesSize, sizeof(u32));
+		memcpy(data.data() + 140, &indexCount, sizeof(u32));
+		memcpy(data.data() + 144, &indicesSize, sizeof(u32));
+		data[148] = 0;
+		data[149] = INDEX_U32;
+		data[150] = COMPRESSION_NONE;
+		data[151] = 0;
+
+		out.write(rcast<const char*>(data.data()), scast<std::streamsize>(data.size()));
+		out.write(rcast<const char*>(streams.data()), scast<std::streamsize>(streams.size()));
+	}
+
+	return out.good() ? totalSize : 0;
+}
+
+//Writes a per-glyph kfd file (type 2) of square glyphs with a gradient as pixels.
+//Returns the written file size, 0 on failure
+static u64 WriteGlyphFile(
+	const path& target,
+	u32 glyphCount,
+	u32 glyphSize)
+{
+	using namespace KalaFontData;
+
+	const u16 size = scast<u16>(std::clamp<u32>(glyphSize, MIN_GLYPH_HEIGHT, MAX_GLYPH_HEIGHT));
+	const u32 count = std::clamp<u32>(glyphCount, 1, MAX_GLYPH_COUNT);
+
+	const u32 blockSize = RAW_PIXEL_DATA_OFFSET + scast<u32>(size) * size;
+	const u32 tableSize = count * CORRECT_GLYPH_TABLE_SIZE;
+	const u64 totalSize = CORRECT_GLYPH_HEADER_SIZE + tableSize + scast<u64>(blockSize) * count;
+
+	if (exists(target)
+		&& file_size(target) == totalSize)
+	{
+		return totalSize;
+	}
+
+	const i16 ascent = scast<i16>(size * 3 / 4);
+	const i16 descent = scast<i16>(-(size / 4));
+	const i16 lineGap = 2;
+
+	vector<u8> data{};
+	data.reserve(scast<size_t>(totalSize));
+
+	Append(data, KFD_MAGIC);
+	Append<u8>(data, KFD_VERSION);
+	Append<u8>(data, 2);
+	Append(data, size);
+	Append(data, ascent);
+	Append(data, descent);
+	Append(data, lineGap);
+	Append(data, scast<i16>(ascent - descent + lineGap));
+	Append(data, count);
+
+	const u8 indices[6]{ 0, 1, 2, 2, 3, 0 };
+	const u8 uvs[8]{ 0, 0, 1, 0, 1, 1, 0, 1 };
+	Append(data, indices, sizeof(indices));
+	Append(data, uvs, sizeof(uvs));
+	Append(data, tableSize);
+	Append(data, blockSize * count);
+
+	for (u32 i = 0; i < count; ++i)
+	{
+		Append(data, 32u + i);
+		Append(data, scast<u32>(CORRECT_GLYPH_HEADER_SIZE + tableSize + blockSize * i));
+		Append(data, blockSize);
+	}
+
+	for (u32 i = 0; i < count; ++i)
+	{
+		Append(data, 32u + i);
+		Append(data, size);
+		Append(data, size);
+		Append<i16>(data, 1);
+		Append(data, scast<i16>(size));
+		Append(data, scast<u16>(size + 1));
+
+		const i16 s = scast<i16>(size);
+		const i16 vertices[8]{ 0, 0, s, 0, s, scast<i16>(-s), 0, scast<i16>(-s) };
+		Append(data, vertices, sizeof(vertices));
+
+		Append(data, scast<u32>(size) * size);
+		for (u32 p = 0; p < scast<u32>(size) * size; ++p)
+		{
+			Append(data, scast<u8>(p + i));
+		}
+	}
+
+	ofstream out(target, ios::binary | ios::trunc);
+	if (!out.is_open()) return 0;
+
+	out.write(rcast<const char*>(data.data()), scast<std::streamsize>(data.size()));
+	return out.good() ? totalSize : 0;
+}
+
+//
+// BENCHMARKS
+//
+
+static void RunMathBenchmarks(
+	BenchmarkSuite& suite,
+	const BenchmarkOptions& options,
+	const BenchmarkSettings& settings)
+{
+	using namespace KalaMath;
+
+	const quat rotation(0.9238795f, 0.0f, 0.3826834f, 0.0f);
+	mat4 a = createumodel(vec3(1.0f, 2.0f, 3.0f), rotation, vec3(1.0f));
+	const mat4 b = createumodel(vec3(0.0f), rotation, vec3(1.0f));
+
+	suite.Run("mat4 multiply", [&]() { a = a * b; KeepValue(a); }, settings);
+	suite.Run("mat4 inverse", [&]() { mat4 i = inverse(a); KeepValue(i); }, settings);
+
+	const u32 sceneSize = std::max(options.sceneSize, 1u);
+
+	//a flat scene of siblings under one moved parent
+	vector<Transform3D> scene(sceneSize);
+	for (u32 i = 0; i < sceneSize; ++i)
+	{
+		scene[i].pos_world = vec3(scast<f32>(i % 1000), scast<f32>(i / 1000), 0.0f);
+		scene[i].pos_local = vec3(0.5f);
+	}
+	Transform3D parent{};
+	parent.pos_combined = vec3(1.0f, 2.0f, 3.0f);
+	parent.rot_combined = rotation;
+	parent.size_combined = vec3(2.0f);
+
+	BenchmarkSettings sceneSettings = settings;
+	sceneSettings.itemsPerIteration = sceneSize;
+
+	suite.Run(
+		"combine3d scene",
+		[&]()
+		{
+			for (auto& t : scene) combine3d(t, parent);
+			KeepValue(scene[0]);
+		},
+		sceneSettings);
+
+	//a hierarchy of chains 8 levels deep, moving the roots dirties every node
+	TransformHierarchy hierarchy{};
+	vector<TransformNode> roots{};
+	for (u32 i = 0; i < sceneSize; i += 8)
+	{
+		TransformNode node = hierarchy.add();
+		roots.push_back(node);
+		for (u32 d = 1; d < 8 && i + d < sceneSize; ++d) node = hierarchy.add(node);
+	}
+
+	f32 offset{};
+	auto updateHierarchy = [&](bool parallel)
+		{
+			offset += 0.001f;
+			for (TransformNode r : roots) hierarchy.setpos(r, PosTarget::POS_WORLD, vec3(offset));
+			hierarchy.update(parallel, options.threadCount);
+			KeepValue(offset);
+		};
+
+	suite.Run("TransformHierarchy update", [&]() { updateHierarchy(false); }, sceneSettings);
+	suite.Run("TransformHierarchy update parallel", [&]() { updateHierarchy(true); }, sceneSettings);
+}
+
+static void RunColorBenchmarks(
+	BenchmarkSuite& suite,
+	const BenchmarkSettings& settings)
+{
+	using namespace KalaColor;
+
+	//one 1080p image
+	const size_t pixelCount = 1920 * 1080;
+
+	vector<color> colorsIn(pixelCount);
+	for (size_t i = 0; i < pixelCount; ++i)
+	{
+		colorsIn[i] = color(
+			scast<f32>(i % 256) / 255.0f,
+			scast<f32>((i / 256) % 256) / 255.0f,
+			0.5f,
+			1.0f);
+	}
+	vector<color> colorsOut(pixelCount);
+
+	BenchmarkSettings colorSettings = settings;
+	colorSettings.bytesPerIteration = pixelCount * sizeof(color);
+	colorSettings.itemsPerIteration = pixelCount;
+
+	auto runColors = [&](string_view name, ColorConvertType type)
+		{
+			suite.Run(
+				name,
+				[&, type]()
+				{
+					KeepValue(convert_colors(type, span<const color>(colorsIn), span<color>(colorsOut)));
+				},
+				colorSettings);
+		};
+
+	runColors("convert_colors srgb to linear", ColorConvertType::COLOR_SRGB_TO_LINEAR);
+	runColors("convert_colors linear to srgb", ColorConvertType::COLOR_LINEAR_TO_SRGB);
+	runColors("convert_colors srgb to hsv", ColorConvertType::COLOR_SRGB_TO_HSV);
+	runColors("convert_colors linear to oklab", ColorConvertType::COLOR_LINEAR_TO_OKLAB);
+
+	vector<f32> planeData(pixelCount * 8, 0.5f);
+	const color_planes planesIn{
+		span<f32>(planeData.data(), pixelCount),
+		span<f32>(planeData.data() + pixelCount, pixelCount),
+		span<f32>(planeData.data() + pixelCount * 2, pixelCount),
+		span<f32>(planeData.data() + pixelCount * 3, pixelCount) };
+	const color_planes planesOut{
+		span<f32>(planeData.data() + pixelCount * 4, pixelCount),
+		span<f32>(planeData.data() + pixelCount * 5, pixelCount),
+		span<f32>(planeData.data() + pixelCount * 6, pixelCount),
+		span<f32>(planeData.data() + pixelCount * 7, pixelCount) };
+
+	BenchmarkSettings planeSettings = settings;
+	planeSettings.bytesPerIteration = pixelCount * 4 * sizeof(f32);
+	planeSettings.itemsPerIteration = pixelCount;
+
+	suite.Run(
+		"convert_colors planes srgb to linear",
+		[&]() { KeepValue(convert_colors(ColorConvertType::COLOR_SRGB_TO_LINEAR, planesIn, planesOut)); },
+		planeSettings);
+
+	vector<u8> rgba8(pixelCount * 4);
+	for (size_t i = 0; i < rgba8.size(); ++i) rgba8[i] = scast<u8>(i * 7);
+
+	BenchmarkSettings rgba8Settings = settings;
+	rgba8Settings.bytesPerIteration = rgba8.size();
+	rgba8Settings.itemsPerIteration = pixelCount;
+
+	suite.Run(
+		"srgb8_to_linear",
+		[&]() { KeepValue(srgb8_to_linear(span<const u8>(rgba8), planesOut)); },
+		rgba8Settings);
+	suite.Run(
+		"linear_to_srgb8",
+		[&]() { KeepValue(linear_to_srgb8(planesIn, span<u8>(rgba8))); },
+		rgba8Settings);
+}
+
+static void RunLogBenchmarks(
+	BenchmarkSuite& suite,
+	const BenchmarkOptions& options,
+	const BenchmarkSettings& settings)
+{
+	using namespace KalaLog;
+
+	const string_view message = "benchmark message with a typical length for a log line";
+
+	BenchmarkSettings logSettings = settings;
+	logSettings.itemsPerIteration = 1;
+
+	auto print = [message]() { Log::Print(message, "BENCHMARK", LogType::LOG_INFO); };
+
+	suite.Run("Log::Print", print, logSettings);
+	suite.RunThreaded("Log::Print contended", options.threadCount, [&](u32) { print(); }, logSettings);
+
+	//blocking overflow so the async numbers include draining the ring instead of dropping messages
+	Log::StartAsync(LogOverflowPolicy::OVERFLOW_BLOCK);
+
+	suite.Run("Log::Print async", print, logSettings);
+	suite.RunThreaded("Log::Print async contended", options.threadCount, [&](u32) { print(); }, logSettings);
+
+	Log::StopAsync();
+}
+
+static void RunStringBenchmarks(
+	BenchmarkSuite& suite,
+	const BenchmarkSettings& settings)
+{
+	using namespace KalaString;
+
+	string line{};
+	for (int i = 0; i < 64; ++i)
+	{
+		line += "word";
+		line += std::to_string(i);
+		line += i % 8 == 0 ? " \"quoted words stay together\" " : " ";
+	}
+
+	BenchmarkSettings lineSettings = settings;
+	lineSettings.bytesPerIteration = line.size();
+
+	suite.Run("TokenizeString", [&]() { KeepValue(TokenizeString(line, '"', " ")); }, lineSettings);
+
+	vector<string_view> views{};
+	suite.Run("TokenizeStringViews", [&]() { KeepValue(TokenizeStringViews(line, '"', " ", views)); }, lineSettings);
+
+	suite.Run("FromString int", [&]() { KeepValue(FromString<int>("-1234567")); }, settings);
+	suite.Run("FromString float", [&]() { KeepValue(FromString<float>("3.1415926")); }, settings);
+
+	string numbers{};
+	for (int i = 0; i < 256; ++i) numbers += std::to_string(i * 37) + ", ";
+
+	BenchmarkSettings numberSettings = settings;
+	numberSettings.bytesPerIteration = numbers.size();
+	numberSettings.itemsPerIteration = 256;
+
+	vector<int> parsed{};
+	suite.Run("ParseNumbers int", [&]() { KeepValue(ParseNumbers(numbers, ",", parsed)); }, numberSettings);
+}
+
+//Returns false if a file operation failed
+static bool RunFileBenchmarks(
+	BenchmarkSuite& suite,
+	const BenchmarkOptions& options,
+	const BenchmarkSettings& settings)
+{
+	using namespace KalaFile;
+
+	const path textFile = options.dataDir / "text.txt";
+	const u64 textSize = std::max<u64>(options.textFileMb, 1) * 1048576;
+
+	fprintf(stderr, "preparing %llu MB text file...\n", scast<unsigned long long>(textSize / 1048576));
+	if (!WriteTextFile(textFile, textSize))
+	{
+		fprintf(stderr, "failed to write '%s'\n", textFile.string().c_str());
+		return false;
+	}
+
+	BenchmarkSettings fileSettings = settings;
+	fileSettings.bytesPerIteration = textSize;
+	fileSettings.sampleCount = std::min(settings.sampleCount, 5u);
+
+	string error{};
+
+	suite.Run(
+		"GetTextFileLineCount",
+		[&]()
+		{
+			size_t count{};
+			string result = GetTextFileLineCount(textFile, count);
+			if (!result.empty()) error = result;
+			KeepValue(count);
+		},
+		fileSettings);
+
+	suite.Run(
+		"GetRangeByValue",
+		[&]()
+		{
+			vector<BinaryRange> ranges{};
+			string result = GetRangeByValue(textFile, TEXT_NEEDLE, ranges);
+			if (!result.empty()) error = result;
+			KeepValue(ranges.size());
+		},
+		fileSettings);
+
+	if (!error.empty())
+	{
+		fprintf(stderr, "%s\n", error.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+//Returns false if a file could not be generated or imported
+static bool RunImportBenchmarks(
+	BenchmarkSuite& suite,
+	const BenchmarkOptions& options,
+	const BenchmarkSettings& settings)
+{
+	BenchmarkSettings importSettings = settings;
+	importSettings.sampleCount = std::min(settings.sampleCount, 7u);
+
+	//models
+	{
+		using namespace KalaModelData;
+
+		const path modelFile = options.dataDir / "models.kmd";
+
+		fprintf(stderr, "preparing %llu MB kmd file...\n", scast<unsigned long long>(options.modelFileMb));
+		const u64 modelSize = WriteModelFile(modelFile, std::max<u64>(options.modelFileMb, 1) * 1048576);
+		if (modelSize == 0)
+		{
+			fprintf(stderr, "failed to write '%s'\n", modelFile.string().c_str());
+			return false;
+		}
+
+		importSettings.bytesPerIteration = modelSize;
+
+		ImportResult result = ImportResult::RESULT_SUCCESS;
+
+		suite.Run(
+			"ImportKMD",
+			[&]()
+			{
+				ModelHeader header{};
+				vector<ModelTable> tables{};
+				vector<ModelBlock> blocks{};
+				ImportResult r = ImportKMD(modelFile, header, tables, blocks);
+				if (r != ImportResult::RESULT_SUCCESS) result = r;
+				KeepValue(blocks.size());
+			},
+			importSettings);
+
+		suite.Run(
+			"ImportKMDMapped",
+			[&]()
+			{
+				MappedModelFile mapping{};
+				ModelHeader header{};
+				vector<ModelTable> tables{};
+				vector<ModelBlockView> views{};
+				ImportResult r = ImportKMDMapped(modelFile, mapping, header, tables, views);
+				if (r != ImportResult::RESULT_SUCCESS) result = r;
+				KeepValue(views.size());
+			},
+			importSettings);
+
+		if (result != ImportResult::RESULT_SUCCESS)
+		{
+			fprintf(stderr, "failed to import '%s': %s\n", modelFile.string().c_str(), ResultToString(result).c_str());
+			return false;
+		}
+	}
+
+	//glyphs
+	{
+		using namespace KalaFontData;
+
+		const path glyphFile = options.dataDir / "glyphs.kfd";
+
+		fprintf(stderr, "preparing kfd file of %u glyphs...\n", options.glyphCount);
+		const u64 glyphSize = WriteGlyphFile(glyphFile, options.glyphCount, options.glyphSize);
+		if (glyphSize == 0)
+		{
+			fprintf(stderr, "failed to write '%s'\n", glyphFile.string().c_str());
+			return false;
+		}
+
+		importSettings.bytesPerIteration = glyphSize;
+
+		ImportResult result = ImportResult::RESULT_SUCCESS;
+
+		GlyphHeader header{};
+		vector<GlyphTable> tables{};
+		vector<GlyphBlock> blocks{};
+
+		suite.Run(
+			"ImportKFD",
+			[&]()
+			{
+				ImportResult r = ImportKFD(glyphFile, header, tables, blocks);
+				if (r != ImportResult::RESULT_SUCCESS) result = r;
+				KeepValue(blocks.size());
+			},
+			importSettings);
+
+		if (result != ImportResult::RESULT_SUCCESS)
+		{
+			fprintf(stderr, "failed to import '%s': %s\n", glyphFile.string().c_str(), ResultToString(result).c_str());
+			return false;
+		}
+
+		//every 16th glyph, the sparse lookups a text renderer streams on demand
+		vector<GlyphTable> requested{};
+		for (size_t i = 0; i < tables.size(); i += 16) requested.push_back(tables[i]);
+
+		BenchmarkSettings streamSettings = importSettings;
+		streamSettings.bytesPerIteration = 0;
+		streamSettings.itemsPerIteration = requested.size();
+
+		suite.Run(
+			"StreamGlyphs sparse",
+			[&]()
+			{
+				vector<GlyphBlock> streamed{};
+				ImportResult r = StreamGlyphs(glyphFile, requested, streamed);
+				if (r != ImportResult::RESULT_SUCCESS) result = r;
+				KeepValue(streamed.size());
+			},
+			streamSettings);
+
+		streamSettings.itemsPerIteration = tables.size();
+
+		suite.Run(
+			"StreamGlyphs all",
+			[&]()
+			{
+				vector<GlyphBlock> streamed{};
+				ImportResult r = StreamGlyphs(glyphFile, tables, streamed);
+				if (r != ImportResult::RESULT_SUCCESS) result = r;
+				KeepValue(streamed.size());
+			},
+			streamSettings);
+
+		if (result != ImportResult::RESULT_SUCCESS)
+		{
+			fprintf(stderr, "failed to stream '%s': %s\n", glyphFile.string().c_str(), ResultToString(result).c_str());
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void RunThreadBenchmarks(
+	BenchmarkSuite& suite,
+	const BenchmarkOptions& options,
+	const BenchmarkSettings& settings)
+{
+	atomic<bool> flag{};
+	u64 counter{};
+
+	auto lockedIncrement = [&](u32)
+		{
+			KalaThread::lockwait(flag);
+			++counter;
+			KalaThread::unlock(flag);
+		};
+
+	suite.Run("lockwait uncontended", [&]() { lockedIncrement(0); }, settings);
+	suite.RunThreaded("lockwait contended", options.threadCount, lockedIncrement, settings);
+
+	//the same contention with a short critical section, closer to a guarded container update
+	vector<u64> shared(64);
+	suite.RunThreaded(
+		"lockwait contended with work",
+		options.threadCount,
+		[&](u32 t)
+		{
+			KalaThread::lockwait(flag);
+			for (auto& v : shared) v += t;
+			KalaThread::unlock(flag);
+		},
+		settings);
+
+	KeepValue(counter);
+	KeepValue(shared[0]);
+}
+
+int main(int argc, char** argv)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		if (string_view(argv[i]) == "--help")
+		{
+			PrintUsage();
+			return 0;
+		}
+	}
+
+	BenchmarkOptions options{};
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 2;
+	}
+
+	std::error_code ec{};
+	create_directories(options.dataDir, ec);
+	if (ec)
+	{
+		fprintf(stderr, "failed to create data directory '%s'\n", options.dataDir.string().c_str());
+		return 2;
+	}
+
+	BenchmarkSettings settings{};
+	if (options.isQuick)
+	{
+		settings.sampleCount = 5;
+		settings.minSampleMs = 1.0;
+		settings.warmupMs = 2.0;
+	}
+
+	BenchmarkSuite suite("kalaheaders");
+
+	fprintf(stderr, "math...\n");
+	RunMathBenchmarks(suite, options, settings);
+	fprintf(stderr, "color...\n");
+	RunColorBenchmarks(suite, settings);
+	fprintf(stderr, "log...\n");
+	RunLogBenchmarks(suite, options, settings);
+	fprintf(stderr, "string...\n");
+	RunStringBenchmarks(suite, settings);
+	fprintf(stderr, "thread...\n");
+	RunThreadBenchmarks(suite, options, settings);
+	fprintf(stderr, "file...\n");
+	if (!RunFileBenchmarks(suite, options, settings)) return 2;
+	fprintf(stderr, "import...\n");
+	if (!RunImportBenchmarks(suite, options, settings)) return 2;
+
+	fprintf(stderr, "\n%-40s %8s %14s %12s %12s %14s\n", "benchmark", "threads", "median ns", "stddev ns", "MB/s", "items/s");
+	for (const BenchmarkResult& r : suite.GetResults())
+	{
+		fprintf(stderr, "%-40s %8u %14.1f %12.1f %12.1f %14.4g\n",
+			r.name.c_str(),
+			r.threadCount,
+			r.medianNs,
+			r.stddevNs,
+			r.mbPerSecond,
+			r.itemsPerSecond);
+	}
+
+	if (!suite.WriteJson(options.outFile))
+	{
+		fprintf(stderr, "failed to write results to '%s'\n", options.outFile.string().c_str());
+		return 2;
+	}
+	fprintf(stderr, "\nresults written to '%s'\n", options.outFile.string().c_str());
+
+	if (options.baselineFile.empty()) return 0;
+
+	vector<BenchmarkResult> baseline{};
+	if (!BenchmarkSuite::LoadJson(options.baselineFile, baseline))
+	{
+		fprintf(stderr, "failed to read baseline '%s'\n", options.baselineFile.string().c_str());
+		return 2;
+	}
+
+	bool hasRegression{};
+	fprintf(stderr, "\n%-40s %8s %14s %14s %8s\n", "compared to baseline", "threads", "baseline ns", "current ns", "ratio");
+	for (const BenchmarkComparison& c : BenchmarkSuite::Compare(baseline, suite.GetResults(), options.tolerance))
+	{
+		if (c.isMissing)
+		{
+			fprintf(stderr, "%-40s %8u %14s %14.1f %8s\n", c.name.c_str(), c.threadCount, "-", c.currentNs, "new");
+			continue;
+		}
+
+		fprintf(stderr, "%-40s %8u %14.1f %14.1f %8.3f%s\n",
+			c.name.c_str(),
+			c.threadCount,
+			c.baselineNs,
+			c.currentNs,
+			c.ratio,
+			c.isRegression ? "  REGRESSION" : "");
+
+		if (c.isRegression) hasRegression = true;
+	}
+
+	return hasRegression ? 1 : 0;
+}
@@ -9,21 +9,46 @@
 // Provides:
 //   - custom color container as a variable for linear RGBA operations
 //   - color conversion, color operators
+//   - batched color conversion over color spans, f32 planes and RGBA8 pixels with sRGB lookup tables and SIMD kernels
 //---------------------------------------------------------------------------
 
 #include <cmath>
 #include <algorithm>
+#include <array>
+#include <span>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define KCOLOR_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	#include <arm_neon.h>
+	#define KCOLOR_NEON
+#endif
 
 namespace KalaHeaders::KalaColor
 {
 #ifndef scast
 	#define scast static_cast
 #endif
+#ifndef rcast
+	#define rcast reinterpret_cast
+#endif
 
 	using std::clamp;
 	using std::min;
 	using std::max;
-	using std::fabsf;
+	using std::fabs;
+	using std::sqrt;
+	using std::sin;
+	using std::cos;
+	using std::atan2;
+	using std::fmod;
+	using std::pow;
+	using std::floor;
+	using std::array;
+	using std::span;
 
 	//8-bit unsigned int
 	//Min: 0
@@ -56,7 +81,7 @@ namespace KalaHeaders::KalaColor
 		f32 origin,
 		f32 divisor)
 	{
-		const f32 safeDivisor = (fabsf(divisor) > epsilon) ? divisor : 1.0f;
+		const f32 safeDivisor = (fabs(divisor) > epsilon) ? divisor : 1.0f;
 		return origin / safeDivisor;
 	}
 	//Used for compound division and prevents division by 0, mutates origin instead of returning result
@@ -64,7 +89,7 @@ namespace KalaHeaders::KalaColor
 		f32& origin,
 		f32 divisor)
 	{
-		const f32 safeDivisor = (fabsf(divisor) > epsilon) ? divisor : 1.0f;
+		const f32 safeDivisor = (fabs(divisor) > epsilon) ? divisor : 1.0f;
 		origin /= safeDivisor;
 	}
 
@@ -191,10 +216,10 @@ namespace KalaHeaders::KalaColor
 		bool operator==(const color& c) const
 		{
 			return
-				fabsf(r - c.r) <= epsilon
-				&& fabsf(g - c.g) <= epsilon
-				&& fabsf(b - c.b) <= epsilon
-				&& fabsf(a - c.a) <= epsilon;
+				fabs(r - c.r) <= epsilon
+				&& fabs(g - c.g) <= epsilon
+				&& fabs(b - c.b) <= epsilon
+				&& fabs(a - c.a) <= epsilon;
 		}
 
 		bool operator!=(const color& c) const { return !(*this == c); }
@@ -317,16 +342,16 @@ namespace KalaHeaders::KalaColor
 	//Returns true if float a is close to float b within epsilon range
 	inline bool isnear(f32 a, f32 b = {})
 	{
-		return fabsf(a - b) <= epsilon;
+		return fabs(a - b) <= epsilon;
 	}
 
 	//Returns true if color a is close to color b within epsilon range
 	inline bool isnear(const color& a, const color& b = {})
 	{
-		return fabsf(a.r - b.r) <= epsilon
-			&& fabsf(a.g - b.g) <= epsilon
-			&& fabsf(a.b - b.b) <= epsilon
-			&& fabsf(a.a - b.a) <= epsilon;
+		return fabs(a.r - b.r) <= epsilon
+			&& fabs(a.g - b.g) <= epsilon
+			&& fabs(a.b - b.b) <= epsilon
+			&& fabs(a.a - b.a) <= epsilon;
 	}
 
 	//================================================================================
@@ -403,13 +428,13 @@ namespace KalaHeaders::KalaColor
 		auto to_linear = [](f32 c) -> f32
 			{
 				if (c <= 0.04045f) return c / 12.92f;
-				return powf((c + 0.055f) / 1.055f, 2.4f);
+				return pow((c + 0.055f) / 1.055f, 2.4f);
 			};
 			
 		auto to_srgb = [](f32 c) -> f32
 			{
 				if (c <= 0.0031308f) return c * 12.92f;
-				return 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+				return 1.055f * pow(c, 1.0f / 2.4f) - 0.055f;
 			};
 		
 		auto SRGB_TO_LINEAR = [&]() -> color
@@ -562,8 +587,8 @@ namespace KalaHeaders::KalaColor
 				
 				if (s <= epsilon) return color(v, v, v, nc.a);
 				
-				h = fmodf(h, 1.0f) * 6.0f;
-				f32 i = floorf(h);
+				h = fmod(h, 1.0f) * 6.0f;
+				f32 i = floor(h);
 				f32 f = h - i;
 				
 				f32 p = v * (1.0f - s);
@@ -760,11 +785,11 @@ namespace KalaHeaders::KalaColor
 				
 				//chroma
 				
-				f32 C = sqrtf(A * A + Bc * Bc);
+				f32 C = sqrt(A * A + Bc * Bc);
 				
 				//hue angle in radians
 				
-				f32 h = atan2f(Bc, A);
+				f32 h = atan2(Bc, A);
 				
 				//normalize hue to 0-1
 				
@@ -785,8 +810,8 @@ namespace KalaHeaders::KalaColor
 				
 				//convert polar to cartesian
 				
-				f32 A = C * cosf(angle);
-				f32 Bc = C * sinf(angle);
+				f32 A = C * cos(angle);
+				f32 Bc = C * sin(angle);
 				
 				return color(L, A, Bc, nc.a);
 			};
@@ -852,8 +877,8 @@ namespace KalaHeaders::KalaColor
 				f32 Bc = oklab.b;
 				f32 A_ = oklab.a;
 				
-				float C = sqrtf(A * A + Bc * Bc);
-				float h = atan2f(Bc, A) / (2.0f * PI);
+				float C = sqrt(A * A + Bc * Bc);
+				float h = atan2(Bc, A) / (2.0f * PI);
 				if (h < 0.0f) h += 1.0f;
 				
 				return color(L, C, h, A_);
@@ -935,8 +960,8 @@ namespace KalaHeaders::KalaColor
 				
 				//convert polar to cartesian
 				
-				f32 A = C * cosf(angle);
-				f32 Bc = C * sinf(angle);
+				f32 A = C * cos(angle);
+				f32 Bc = C * sin(angle);
 				
 				return OKLAB_TO_LINEAR(color(L, A, Bc, A_), false);
 			};
@@ -1029,9 +1054,9 @@ namespace KalaHeaders::KalaColor
 		f32 inv = 1.0f / clamped;
 
 		return color(
-			powf(c.r, inv),
-			powf(c.g, inv),
-			powf(c.b, inv),
+			pow(c.r, inv),
+			pow(c.g, inv),
+			pow(c.b, inv),
 			c.a);
 	}
 	//Darkens shadows and expands highlights.
@@ -1044,9 +1069,9 @@ namespace KalaHeaders::KalaColor
 		f32 clamped = clamp(gammaValue, 0.01f, 10.0f);
 		
 		return color(
-			powf(c.r, clamped),
-			powf(c.g, clamped),
-			powf(c.b, clamped),
+			pow(c.r, clamped),
+			pow(c.g, clamped),
+			pow(c.b, clamped),
 			c.a);
 	}
 	
@@ -1082,7 +1107,7 @@ namespace KalaHeaders::KalaColor
 		//always range-normalize up front
 		f32 nc = normalize_r(colorChannel);
 
-		return normalize_r(floorf(nc * k) / k);
+		return normalize_r(floor(nc * k) / k);
 	}
 
 	//Increases saturation while protecting already-saturated colors.
@@ -1125,7 +1150,7 @@ namespace KalaHeaders::KalaColor
 		//always range-normalize up front
 		color nc = normalize_r(c);
 
-		f32 h = shift - floorf(shift);
+		f32 h = shift - floor(shift);
 
 		//convert to hsv
 
@@ -1219,7 +1244,7 @@ namespace KalaHeaders::KalaColor
 	{
 		f32 clamped = clamp(ev, -10.0f, 10.0f);
 
-		f32 s = powf(2.0f, clamped);
+		f32 s = pow(2.0f, clamped);
 
 		return color(c.r * s, c.g * s, c.b * s, c.a);
 	}
@@ -1521,4 +1546,586 @@ namespace KalaHeaders::KalaColor
 			c.a
 		);
 	}
+	
+	//================================================================================
+	//
+	// BATCH CONVERSION
+	//
+	//================================================================================
+	
+	//Entries of the interpolated float and the quantized 8-bit sRGB tables
+	inline constexpr size_t SRGB_LUT_SIZE = 4096;
+	
+	//Transfer function tables, built once on first use
+	struct srgb_tables
+	{
+		//exact linear value of every 8-bit sRGB value
+		array<f32, 256> srgb8ToLinear{};
+		//nearest 8-bit sRGB value of linear i / (SRGB_LUT_SIZE - 1)
+		array<u8, SRGB_LUT_SIZE> linearToSrgb8{};
+		
+		//curves sampled at i / SRGB_LUT_SIZE for linear interpolation,
+		//the last entry lets x = 1 interpolate without a bounds check
+		array<f32, SRGB_LUT_SIZE + 1> linearToSrgb{};
+		array<f32, SRGB_LUT_SIZE + 1> srgbToLinear{};
+	};
+	
+	inline f32 srgb_to_linear_exact(f32 c)
+	{
+		if (c <= 0.04045f) return c / 12.92f;
+		return pow((c + 0.055f) / 1.055f, 2.4f);
+	}
+	inline f32 linear_to_srgb_exact(f32 c)
+	{
+		if (c <= 0.0031308f) return c * 12.92f;
+		return 1.055f * pow(c, 1.0f / 2.4f) - 0.055f;
+	}
+	
+	inline const srgb_tables& get_srgb_tables()
+	{
+		static const srgb_tables tables = []
+			{
+				srgb_tables t{};
+				
+				for (size_t i = 0; i < 256; ++i)
+				{
+					t.srgb8ToLinear[i] = srgb_to_linear_exact(scast<f32>(i) / 255.0f);
+				}
+				for (size_t i = 0; i < SRGB_LUT_SIZE; ++i)
+				{
+					const f32 s = linear_to_srgb_exact(scast<f32>(i) / scast<f32>(SRGB_LUT_SIZE - 1));
+					t.linearToSrgb8[i] = scast<u8>(clamp(s, 0.0f, 1.0f) * 255.0f + 0.5f);
+				}
+				for (size_t i = 0; i <= SRGB_LUT_SIZE; ++i)
+				{
+					const f32 x = scast<f32>(i) / scast<f32>(SRGB_LUT_SIZE);
+					t.linearToSrgb[i] = linear_to_srgb_exact(x);
+					t.srgbToLinear[i] = srgb_to_linear_exact(x);
+				}
+				
+				return t;
+			}();
+			
+		return tables;
+	}
+	
+	//Interpolated curve lookup, max error is about 2e-5 inside 0-1.
+	//Values outside 0-1 fall back to the exact curve so HDR values survive
+	template <f32(*Exact)(f32)>
+	inline f32 srgb_lut_lerp(
+		const array<f32, SRGB_LUT_SIZE + 1>& table,
+		f32 x)
+	{
+		if (!(x >= 0.0f && x <= 1.0f)) return Exact(x);
+		
+		const f32 f = x * scast<f32>(SRGB_LUT_SIZE);
+		const size_t i = min(scast<size_t>(f), SRGB_LUT_SIZE - 1);
+		const f32 t = f - scast<f32>(i);
+		
+		return table[i] + (table[i + 1] - table[i]) * t;
+	}
+	
+	//Four separate channel arrays, a may be empty in which case alpha is read as 1 and never written.
+	//Input and output planes may be the same arrays for in-place conversion
+	struct color_planes
+	{
+		span<f32> r{};
+		span<f32> g{};
+		span<f32> b{};
+		span<f32> a{};
+		
+		//Count of pixels that every non-empty plane can hold
+		inline size_t size() const
+		{
+			size_t count = min(r.size(), min(g.size(), b.size()));
+			if (!a.empty()) count = min(count, a.size());
+			
+			return count;
+		}
+	};
+	
+#if defined(KCOLOR_SSE2)
+	using color_f4 = __m128;
+	
+	inline color_f4 color_load(const f32* p) { return _mm_loadu_ps(p); }
+	inline void color_store(f32* p, color_f4 v) { _mm_storeu_ps(p, v); }
+	inline color_f4 color_set1(f32 s) { return _mm_set1_ps(s); }
+	inline color_f4 color_add(color_f4 a, color_f4 b) { return _mm_add_ps(a, b); }
+	inline color_f4 color_mul(color_f4 a, color_f4 b) { return _mm_mul_ps(a, b); }
+	inline color_f4 color_div(color_f4 a, color_f4 b) { return _mm_div_ps(a, b); }
+	inline color_f4 color_gt(color_f4 a, color_f4 b) { return _mm_cmpgt_ps(a, b); }
+	//picks a where mask is set, otherwise b
+	inline color_f4 color_select(color_f4 mask, color_f4 a, color_f4 b)
+	{
+		return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+	}
+#elif defined(KCOLOR_NEON)
+	using color_f4 = float32x4_t;
+	
+	inline color_f4 color_load(const f32* p) { return vld1q_f32(p); }
+	inline void color_store(f32* p, color_f4 v) { vst1q_f32(p, v); }
+	inline color_f4 color_set1(f32 s) { return vdupq_n_f32(s); }
+	inline color_f4 color_add(color_f4 a, color_f4 b) { return vaddq_f32(a, b); }
+	inline color_f4 color_mul(color_f4 a, color_f4 b) { return vmulq_f32(a, b); }
+	inline color_f4 color_div(color_f4 a, color_f4 b) { return vdivq_f32(a, b); }
+	inline color_f4 color_gt(color_f4 a, color_f4 b) { return vreinterpretq_f32_u32(vcgtq_f32(a, b)); }
+	//picks a where mask is set, otherwise b
+	inline color_f4 color_select(color_f4 mask, color_f4 a, color_f4 b)
+	{
+		return vbslq_f32(vreinterpretq_u32_f32(mask), a, b);
+	}
+#endif
+	
+	//Row-major 3x3 matrix applied to the RGB planes, alpha is copied
+	inline void convert_planes_mat3(
+		const color_planes& in,
+		const color_planes& out,
+		size_t count,
+		const f32 (&m)[9])
+	{
+		size_t i{};
+		
+#if defined(KCOLOR_SSE2) || defined(KCOLOR_NEON)
+		const color_f4 m0 = color_set1(m[0]), m1 = color_set1(m[1]), m2 = color_set1(m[2]);
+		const color_f4 m3 = color_set1(m[3]), m4 = color_set1(m[4]), m5 = color_set1(m[5]);
+		const color_f4 m6 = color_set1(m[6]), m7 = color_set1(m[7]), m8 = color_set1(m[8]);
+		
+		for (; i + 4 <= count; i += 4)
+		{
+			const color_f4 r = color_load(in.r.data() + i);
+			const color_f4 g = color_load(in.g.data() + i);
+			const color_f4 b = color_load(in.b.data() + i);
+			
+			color_store(out.r.data() + i, color_add(color_add(color_mul(m0, r), color_mul(m1, g)), color_mul(m2, b)));
+			color_store(out.g.data() + i, color_add(color_add(color_mul(m3, r), color_mul(m4, g)), color_mul(m5, b)));
+			color_store(out.b.data() + i, color_add(color_add(color_mul(m6, r), color_mul(m7, g)), color_mul(m8, b)));
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			const f32 r = in.r[i];
+			const f32 g = in.g[i];
+			const f32 b = in.b[i];
+			
+			out.r[i] = m[0] * r + m[1] * g + m[2] * b;
+			out.g[i] = m[3] * r + m[4] * g + m[5] * b;
+			out.b[i] = m[6] * r + m[7] * g + m[8] * b;
+		}
+		
+		if (!out.a.empty())
+		{
+			for (size_t j = 0; j < count; ++j) out.a[j] = in.a.empty() ? 1.0f : in.a[j];
+		}
+	}
+	
+	//Premultiplies or unpremultiplies the RGB planes by alpha, alpha is copied.
+	//Unpremultiplying a fully transparent pixel gives opaque black like convert_color
+	inline void convert_planes_premultiply(
+		const color_planes& in,
+		const color_planes& out,
+		size_t count,
+		bool premultiply)
+	{
+		if (in.a.empty())
+		{
+			//alpha is 1, only the copy remains
+			for (size_t i = 0; i < count; ++i)
+			{
+				out.r[i] = in.r[i];
+				out.g[i] = in.g[i];
+				out.b[i] = in.b[i];
+				if (!out.a.empty()) out.a[i] = 1.0f;
+			}
+			return;
+		}
+		
+		size_t i{};
+		
+#if defined(KCOLOR_SSE2) || defined(KCOLOR_NEON)
+		const color_f4 eps = color_set1(epsilon);
+		const color_f4 zero = color_set1(0.0f);
+		const color_f4 one = color_set1(1.0f);
+		
+		for (; i + 4 <= count; i += 4)
+		{
+			const color_f4 a = color_load(in.a.data() + i);
+			const color_f4 r = color_load(in.r.data() + i);
+			const color_f4 g = color_load(in.g.data() + i);
+			const color_f4 b = color_load(in.b.data() + i);
+			
+			if (premultiply)
+			{
+				color_store(out.r.data() + i, color_mul(r, a));
+				color_store(out.g.data() + i, color_mul(g, a));
+				color_store(out.b.data() + i, color_mul(b, a));
+				if (!out.a.empty()) color_store(out.a.data() + i, a);
+			}
+			else
+			{
+				const color_f4 visible = color_gt(a, eps);
+				const color_f4 safeA = color_select(visible, a, one);
+				
+				color_store(out.r.data() + i, color_select(visible, color_div(r, safeA), zero));
+				color_store(out.g.data() + i, color_select(visible, color_div(g, safeA), zero));
+				color_store(out.b.data() + i, color_select(visible, color_div(b, safeA), zero));
+				if (!out.a.empty()) color_store(out.a.data() + i, safeA);
+			}
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			const color c = convert_color(
+				premultiply
+				? ColorConvertType::COLOR_SRGB_TO_PREMULTIPLIED
+				: ColorConvertType::COLOR_SRGB_FROM_PREMULTIPLIED,
+				color(in.r[i], in.g[i], in.b[i], in.a[i]));
+				
+			out.r[i] = c.r;
+			out.g[i] = c.g;
+			out.b[i] = c.b;
+			if (!out.a.empty()) out.a[i] = c.a;
+		}
+	}
+	
+	//Converts every color with a type known at compile time so the per-color switch folds away
+	template <ColorConvertType T>
+	inline void convert_colors_typed(
+		span<const color> in,
+		span<color> out,
+		size_t count)
+	{
+		for (size_t i = 0; i < count; ++i) out[i] = convert_color(T, in[i]);
+	}
+	
+	//Converts every color from in to out with chosen ColorConvertType,
+	//gives the same results as convert_color but switches on type only once.
+	//In and out may be the same span, returns how many colors were converted
+	inline size_t convert_colors(
+		ColorConvertType type,
+		span<const color> in,
+		span<color> out)
+	{
+		using enum ColorConvertType;
+		
+		const size_t count = min(in.size(), out.size());
+		
+		switch (type)
+		{
+		default:
+		case COLOR_NONE:
+			if (in.data() != out.data())
+			{
+				for (size_t i = 0; i < count; ++i) out[i] = in[i];
+			}
+			break;
+			
+		case COLOR_SRGB_TO_LINEAR: convert_colors_typed<COLOR_SRGB_TO_LINEAR>(in, out, count); break;
+		case COLOR_LINEAR_TO_SRGB: convert_colors_typed<COLOR_LINEAR_TO_SRGB>(in, out, count); break;
+		
+		case COLOR_HSL_TO_HSV: convert_colors_typed<COLOR_HSL_TO_HSV>(in, out, count); break;
+		case COLOR_HSV_TO_HSL: convert_colors_typed<COLOR_HSV_TO_HSL>(in, out, count); break;
+		
+		case COLOR_SRGB_TO_HSV:  convert_colors_typed<COLOR_SRGB_TO_HSV>(in, out, count); break;
+		case COLOR_SRGB_TO_HSL:  convert_colors_typed<COLOR_SRGB_TO_HSL>(in, out, count); break;
+		case COLOR_SRGB_TO_RGB8: convert_colors_typed<COLOR_SRGB_TO_RGB8>(in, out, count); break;
+		case COLOR_SRGB_TO_CMYK: convert_colors_typed<COLOR_SRGB_TO_CMYK>(in, out, count); break;
+		
+		case COLOR_HSV_TO_SRGB:  convert_colors_typed<COLOR_HSV_TO_SRGB>(in, out, count); break;
+		case COLOR_HSL_TO_SRGB:  convert_colors_typed<COLOR_HSL_TO_SRGB>(in, out, count); break;
+		case COLOR_RGB8_TO_SRGB: convert_colors_typed<COLOR_RGB8_TO_SRGB>(in, out, count); break;
+		case COLOR_CMYK_TO_SRGB: convert_colors_typed<COLOR_CMYK_TO_SRGB>(in, out, count); break;
+		
+		case COLOR_SRGB_TO_PREMULTIPLIED:   convert_colors_typed<COLOR_SRGB_TO_PREMULTIPLIED>(in, out, count); break;
+		case COLOR_SRGB_FROM_PREMULTIPLIED: convert_colors_typed<COLOR_SRGB_FROM_PREMULTIPLIED>(in, out, count); break;
+		
+		case COLOR_XYZ_TO_LAB: convert_colors_typed<COLOR_XYZ_TO_LAB>(in, out, count); break;
+		case COLOR_LAB_TO_XYZ: convert_colors_typed<COLOR_LAB_TO_XYZ>(in, out, count); break;
+		
+		case COLOR_OKLAB_TO_OKLCH: convert_colors_typed<COLOR_OKLAB_TO_OKLCH>(in, out, count); break;
+		case COLOR_OKLCH_TO_OKLAB: convert_colors_typed<COLOR_OKLCH_TO_OKLAB>(in, out, count); break;
+		
+		case COLOR_XYZ_TO_LINEAR:   convert_colors_typed<COLOR_XYZ_TO_LINEAR>(in, out, count); break;
+		case COLOR_LAB_TO_LINEAR:   convert_colors_typed<COLOR_LAB_TO_LINEAR>(in, out, count); break;
+		case COLOR_OKLAB_TO_LINEAR: convert_colors_typed<COLOR_OKLAB_TO_LINEAR>(in, out, count); break;
+		case COLOR_OKLCH_TO_LINEAR: convert_colors_typed<COLOR_OKLCH_TO_LINEAR>(in, out, count); break;
+		
+		case COLOR_LINEAR_TO_XYZ:   convert_colors_typed<COLOR_LINEAR_TO_XYZ>(in, out, count); break;
+		case COLOR_LINEAR_TO_LAB:   convert_colors_typed<COLOR_LINEAR_TO_LAB>(in, out, count); break;
+		case COLOR_LINEAR_TO_OKLAB: convert_colors_typed<COLOR_LINEAR_TO_OKLAB>(in, out, count); break;
+		case COLOR_LINEAR_TO_OKLCH: convert_colors_typed<COLOR_LINEAR_TO_OKLCH>(in, out, count); break;
+		}
+		
+		return count;
+	}
+	
+	//Converts planar colors from in to out with chosen ColorConvertType.
+	//sRGB <-> linear use the interpolated tables, linear <-> XYZ and premultiply
+	//use SIMD kernels, every other type goes through convert_colors per pixel.
+	//Returns how many pixels were converted
+	inline size_t convert_colors(
+		ColorConvertType type,
+		const color_planes& in,
+		const color_planes& out)
+	{
+		using enum ColorConvertType;
+		
+		const size_t count = min(in.size(), out.size());
+		
+		switch (type)
+		{
+		case COLOR_SRGB_TO_LINEAR:
+		{
+			const srgb_tables& t = get_srgb_tables();
+			
+			//convert_color range-normalizes srgb input, alpha included
+			for (size_t i = 0; i < count; ++i)
+			{
+				out.r[i] = srgb_lut_lerp<srgb_to_linear_exact>(t.srgbToLinear, normalize_r(in.r[i]));
+				out.g[i] = srgb_lut_lerp<srgb_to_linear_exact>(t.srgbToLinear, normalize_r(in.g[i]));
+				out.b[i] = srgb_lut_lerp<srgb_to_linear_exact>(t.srgbToLinear, normalize_r(in.b[i]));
+				if (!out.a.empty()) out.a[i] = in.a.empty() ? 1.0f : normalize_r(in.a[i]);
+			}
+			return count;
+		}
+		case COLOR_LINEAR_TO_SRGB:
+		{
+			const srgb_tables& t = get_srgb_tables();
+			
+			for (size_t i = 0; i < count; ++i)
+			{
+				out.r[i] = srgb_lut_lerp<linear_to_srgb_exact>(t.linearToSrgb, in.r[i]);
+				out.g[i] = srgb_lut_lerp<linear_to_srgb_exact>(t.linearToSrgb, in.g[i]);
+				out.b[i] = srgb_lut_lerp<linear_to_srgb_exact>(t.linearToSrgb, in.b[i]);
+				if (!out.a.empty()) out.a[i] = in.a.empty() ? 1.0f : in.a[i];
+			}
+			return count;
+		}
+		
+		case COLOR_LINEAR_TO_XYZ:
+			convert_planes_mat3(in, out, count,
+				{
+					0.4124564f, 0.3575761f, 0.1804375f,
+					0.2126729f, 0.7151522f, 0.0721750f,
+					0.0193339f, 0.1191920f, 0.9503041f
+				});
+			return count;
+		case COLOR_XYZ_TO_LINEAR:
+			convert_planes_mat3(in, out, count,
+				{
+					3.2404542f, -1.5371385f, -0.4985314f,
+					-0.9692660f, 1.8760108f, 0.0415560f,
+					0.0556434f, -0.2040259f, 1.0572252f
+				});
+			return count;
+			
+		case COLOR_SRGB_TO_PREMULTIPLIED:
+			convert_planes_premultiply(in, out, count, true);
+			return count;
+		case COLOR_SRGB_FROM_PREMULTIPLIED:
+			convert_planes_premultiply(in, out, count, false);
+			return count;
+			
+		default:
+			break;
+		}
+		
+		//gather a block into colors so the remaining types still switch once per block
+		constexpr size_t BLOCK = 256;
+		color block[BLOCK]{};
+		
+		for (size_t start = 0; start < count; start += BLOCK)
+		{
+			const size_t n = min(BLOCK, count - start);
+			
+			for (size_t i = 0; i < n; ++i)
+			{
+				const size_t j = start + i;
+				block[i] = color(
+					in.r[j],
+					in.g[j],
+					in.b[j],
+					in.a.empty() ? 1.0f : in.a[j]);
+			}
+			
+			convert_colors(
+				type,
+				span<const color>(block, n),
+				span<color>(block, n));
+				
+			for (size_t i = 0; i < n; ++i)
+			{
+				const size_t j = start + i;
+				out.r[j] = block[i].r;
+				out.g[j] = block[i].g;
+				out.b[j] = block[i].b;
+				if (!out.a.empty()) out.a[j] = block[i].a;
+			}
+		}
+		
+		return count;
+	}
+	
+	//Decodes interleaved RGBA8 sRGB pixels into linear planes through the 256-entry table,
+	//alpha is only rescaled to 0-1. Returns how many pixels were converted
+	inline size_t srgb8_to_linear(
+		span<const u8> inRGBA8,
+		const color_planes& out)
+	{
+		const srgb_tables& t = get_srgb_tables();
+		const size_t count = min(inRGBA8.size() / 4, out.size());
+		
+		const u8* src = inRGBA8.data();
+		for (size_t i = 0; i < count; ++i, src += 4)
+		{
+			out.r[i] = t.srgb8ToLinear[src[0]];
+			out.g[i] = t.srgb8ToLinear[src[1]];
+			out.b[i] = t.srgb8ToLinear[src[2]];
+			if (!out.a.empty()) out.a[i] = scast<f32>(src[3]) * (1.0f / 255.0f);
+		}
+		
+		return count;
+	}
+	
+	//Encodes linear planes into interleaved RGBA8 sRGB pixels through the 4096-entry table,
+	//within one 8-bit step of the exact curve. Returns how many pixels were converted
+	inline size_t linear_to_srgb8(
+		const color_planes& in,
+		span<u8> outRGBA8)
+	{
+		const srgb_tables& t = get_srgb_tables();
+		const size_t count = min(in.size(), outRGBA8.size() / 4);
+		
+		constexpr f32 scale = scast<f32>(SRGB_LUT_SIZE - 1);
+		
+		auto encode = [&](f32 x) -> u8
+			{
+				return t.linearToSrgb8[scast<size_t>(clamp(x, 0.0f, 1.0f) * scale + 0.5f)];
+			};
+		
+		u8* dst = outRGBA8.data();
+		for (size_t i = 0; i < count; ++i, dst += 4)
+		{
+			dst[0] = encode(in.r[i]);
+			dst[1] = encode(in.g[i]);
+			dst[2] = encode(in.b[i]);
+			dst[3] = in.a.empty()
+				? 255
+				: scast<u8>(clamp(in.a[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+		}
+		
+		return count;
+	}
+	
+	//Premultiplies interleaved RGBA8 pixels in place with exact rounding of c * a / 255,
+	//alpha is left untouched. Returns how many pixels were converted
+	inline size_t premultiply_rgba8(span<u8> inOutRGBA8)
+	{
+		const size_t count = inOutRGBA8.size() / 4;
+		u8* px = inOutRGBA8.data();
+		
+		size_t i{};
+		
+#if defined(KCOLOR_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i half = _mm_set1_epi16(128);
+		const __m128i alphaMask = _mm_set1_epi32(scast<int>(0xFF000000u));
+		
+		//(t + (t >> 8)) >> 8 with t = c * a + 128 equals c * a / 255 rounded
+		auto mul255 = [&](__m128i c) -> __m128i
+			{
+				__m128i a = _mm_shufflelo_epi16(c, _MM_SHUFFLE(3, 3, 3, 3));
+				a = _mm_shufflehi_epi16(a, _MM_SHUFFLE(3, 3, 3, 3));
+				
+				const __m128i t = _mm_add_epi16(_mm_mullo_epi16(c, a), half);
+				return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+			};
+		
+		for (; i + 4 <= count; i += 4)
+		{
+			u8* p = px + i * 4;
+			const __m128i v = _mm_loadu_si128(rcast<const __m128i*>(p));
+			
+			const __m128i lo = mul255(_mm_unpacklo_epi8(v, zero));
+			const __m128i hi = mul255(_mm_unpackhi_epi8(v, zero));
+			
+			const __m128i rgb = _mm_andnot_si128(alphaMask, _mm_packus_epi16(lo, hi));
+			_mm_storeu_si128(
+				rcast<__m128i*>(p),
+				_mm_or_si128(rgb, _mm_and_si128(v, alphaMask)));
+		}
+#elif defined(KCOLOR_NEON)
+		//(p + ((p + 128) >> 8) + 128) >> 8 equals c * a / 255 rounded
+		auto mul255 = [](uint8x16_t c, uint8x16_t a) -> uint8x16_t
+			{
+				const uint16x8_t lo = vmull_u8(vget_low_u8(c), vget_low_u8(a));
+				const uint16x8_t hi = vmull_u8(vget_high_u8(c), vget_high_u8(a));
+				
+				return vcombine_u8(
+					vrshrn_n_u16(vrsraq_n_u16(lo, lo, 8), 8),
+					vrshrn_n_u16(vrsraq_n_u16(hi, hi, 8), 8));
+			};
+			
+		for (; i + 16 <= count; i += 16)
+		{
+			u8* p = px + i * 4;
+			uint8x16x4_t v = vld4q_u8(p);
+			
+			v.val[0] = mul255(v.val[0], v.val[3]);
+			v.val[1] = mul255(v.val[1], v.val[3]);
+			v.val[2] = mul255(v.val[2], v.val[3]);
+			
+			vst4q_u8(p, v);
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			u8* p = px + i * 4;
+			const u32 a = p[3];
+			
+			for (size_t c = 0; c < 3; ++c)
+			{
+				const u32 t = p[c] * a + 128;
+				p[c] = scast<u8>((t + (t >> 8)) >> 8);
+			}
+		}
+		
+		return count;
+	}
+	
+	//Writes the relative luminance of every linear pixel to out.
+	//Linear only - sRGB is display-referred and scene math should never be done in display space.
+	//Returns how many pixels were converted
+	inline size_t luminance(
+		const color_planes& in,
+		span<f32> out)
+	{
+		const size_t count = min(
+			min(in.r.size(), min(in.g.size(), in.b.size())),
+			out.size());
+			
+		size_t i{};
+		
+#if defined(KCOLOR_SSE2) || defined(KCOLOR_NEON)
+		const color_f4 kr = color_set1(0.2126f);
+		const color_f4 kg = color_set1(0.7152f);
+		const color_f4 kb = color_set1(0.0722f);
+		
+		for (; i + 4 <= count; i += 4)
+		{
+			color_store(out.data() + i, color_add(color_add(
+				color_mul(color_load(in.r.data() + i), kr),
+				color_mul(color_load(in.g.data() + i), kg)),
+				color_mul(color_load(in.b.data() + i), kb)));
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			out[i] =
+				in.r[i] * 0.2126f
+				+ in.g[i] * 0.7152f
+				+ in.b[i] * 0.0722f;
+		}
+		
+		return count;
+	}
 }
\ No newline at end of file
@@ -11,7 +11,11 @@
 //   - file management - create file, create directory, list directory contents, rename, delete, copy, move
 //   - file metadata - file size, directory size, line count, set extension
 //   - text I/O - read/write data for text files with vector of string lines or string blob
+//   - streaming chunked line reader with string_view callbacks and SIMD line counting
 //   - binary I/O - read/write data for binary files with vector of bytes or buffer + size
+//   - streaming binary writer with chunked buffers, header patching, atomic temp+rename and async writes
+//   - memory-mapped multi-pattern binary search with optional multithreaded scanning
+//   - parallel directory scanner with incremental rescans and saved snapshot indexes
 //---------------------------------------------------------------------------
 
 #pragma once
@@ -27,6 +31,35 @@
 #include <concepts>
 #include <type_traits>
 #include <chrono>
+#include <thread>
+#include <bit>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+
+#ifdef _WIN32
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <dirent.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define KFILE_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	#include <arm_neon.h>
+	#define KFILE_NEON
+#endif
 
 //rcast
 #ifndef rcast
@@ -38,6 +71,18 @@
 	#define scast static_cast
 #endif
 
+//
+// PROFILER HOOKS
+//
+
+//Recorded by profile_utils.hpp if it is included first with KPROFILE_ENABLED defined,
+//otherwise every zone and counter below compiles to nothing
+#ifndef KPROFILE_ZONE
+	#define KPROFILE_HOOKS_FALLBACK
+	#define KPROFILE_ZONE(name)
+	#define KPROFILE_COUNTER(name, value) do {} while (0)
+#endif
+
 namespace KalaHeaders::KalaFile
 {	
 	using std::exception;
@@ -54,6 +99,18 @@ namespace KalaHeaders::KalaFile
 	using std::search;
 	using std::distance;
 	using std::min;
+	using std::max;
+	using std::memchr;
+	using std::memmove;
+	using std::memcmp;
+	using std::memcpy;
+	using std::memset;
+	using std::thread;
+	using std::mutex;
+	using std::unique_lock;
+	using std::condition_variable;
+	using std::unordered_map;
+	using std::sort;
 	using std::filesystem::exists;
 	using std::filesystem::path;
 	using std::filesystem::is_regular_file;
@@ -81,6 +138,9 @@ namespace KalaHeaders::KalaFile
 	using std::remove_pointer_t;
 	using std::remove_reference_t;
 	using std::remove_extent_t;
+	using std::invocable;
+	using std::invoke_result_t;
+	using std::is_same_v;
 	using std::filesystem::filesystem_error;
 	using std::filesystem::file_time_type;
 	using std::chrono::system_clock;
@@ -88,6 +148,7 @@ namespace KalaHeaders::KalaFile
 	using u8 = uint8_t;
 	using u16 = uint16_t;
 	using u32 = uint32_t;
+	using u64 = uint64_t;
 	using i8 = int8_t;
 	using i16 = int16_t;
 	using i32 = int32_t;
@@ -218,969 +279,1256 @@ namespace KalaHeaders::KalaFile
 	concept IsConstrutible = constructible_from<X, Y>;
 
 	//
-	// WILDCARDS
+	// DIRECTORY SCAN
 	//
 
-	enum class PathTarget : u8
+	//File or directory found by ScanDirectory. Symlinks report the size and time
+	//of their target, symlinked directories are listed but never descended into
+	struct ScannedEntry
 	{
-		P_ANY = 0,
-		P_FILE_ONLY = 1,
-		P_DIR_ONLY = 2
+		//file name relative to its directory
+		path name{};
+		//0 for directories
+		uintmax_t size{};
+		file_time_type lastModified{};
+		bool isDirectory{};
+		bool isSymlink{};
 	};
 
-	//Resolve any path-like field into a vector of paths (wildcards may return multiple values),
-	//PathTarget let you select both files and dirs, or files only, or dirs only
-	inline string ResolveAnyPath(
-		string_view input,
-		string_view relativeDir,
-		vector<path>& out,
-		PathTarget target = PathTarget::P_ANY)
+	//Direct entries of one directory, sorted by name
+	struct ScannedDirectory
 	{
-		if (input.empty()) return "Failed to resolve empty path!";
-		if (input.ends_with("*.")
-			|| input.ends_with("**."))
+		path dirPath{};
+		file_time_type lastModified{};
+		vector<ScannedEntry> entries{};
+	};
+
+	//Every directory under root including root itself, sorted by path
+	struct DirectorySnapshot
+	{
+		path root{};
+		vector<ScannedDirectory> directories{};
+
+		//Sum of the sizes of every non-directory entry
+		inline uintmax_t GetTotalSize() const
 		{
-			return "Failed to resolve extensionless file path!";
+			uintmax_t total{};
+			for (const auto& d : directories)
+			{
+				for (const auto& e : d.entries)
+				{
+					if (!e.isDirectory) total += e.size;
+				}
+			}
+
+			return total;
 		}
+	};
 
-		vector<path> results{};
+	//Reads the direct entries of dir with sizes and times in the same pass, one fstatat per
+	//entry on POSIX and none on Windows since FindFirstFileEx already returns them.
+	//If previous has the same directory modification time its entries are reused instead,
+	//outReused reports which path was taken
+	inline string ScanSingleDirectory(
+		const path& dir,
+		const ScannedDirectory* previous,
+		ScannedDirectory& outDir,
+		bool& outReused)
+	{
+		ostringstream oss{};
 
-		auto complete = [&out, &results]() -> void
+		outDir.dirPath = dir;
+		outDir.entries.clear();
+		outReused = false;
+
+#ifdef _WIN32
+		auto to_file_time = [](const FILETIME& ft)
 			{
-				out.insert(
-					out.end(),
-					make_move_iterator(results.begin()),
-					make_move_iterator(results.end()));
+				//file_time_type counts 100ns ticks since 1601 just like FILETIME
+				ULARGE_INTEGER ticks{};
+				ticks.LowPart = ft.dwLowDateTime;
+				ticks.HighPart = ft.dwHighDateTime;
+
+				return file_time_type(file_time_type::duration(scast<long long>(ticks.QuadPart)));
 			};
 
-		auto clean_paths = [&results]() -> string
+		WIN32_FILE_ATTRIBUTE_DATA dirData{};
+		if (!GetFileAttributesExW(
+			dir.c_str(),
+			GetFileExInfoStandard,
+			&dirData))
+		{
+			oss << "Failed to scan directory '" << dir
+				<< "'! Reason: (error " << GetLastError() << ")";
+
+			return oss.str();
+		}
+
+		outDir.lastModified = to_file_time(dirData.ftLastWriteTime);
+
+		if (previous != nullptr
+			&& previous->lastModified == outDir.lastModified)
+		{
+			outDir.entries = previous->entries;
+			outReused = true;
+
+			return{};
+		}
+
+		WIN32_FIND_DATAW data{};
+		HANDLE find = FindFirstFileExW(
+			(dir / L"*").c_str(),
+			FindExInfoBasic,
+			&data,
+			FindExSearchNameMatch,
+			nullptr,
+			FIND_FIRST_EX_LARGE_FETCH);
+
+		if (find == INVALID_HANDLE_VALUE)
+		{
+			DWORD err = GetLastError();
+			if (err == ERROR_FILE_NOT_FOUND) return{};
+
+			oss << "Failed to scan directory '" << dir
+				<< "'! Reason: (error " << err << ")";
+
+			return oss.str();
+		}
+
+		do
+		{
+			const wchar_t* name = data.cFileName;
+			if (name[0] == L'.'
+				&& (name[1] == L'\0'
+				|| (name[1] == L'.' && name[2] == L'\0')))
 			{
-				for (path& p : results)
-				{
-					try
-					{
-						p = weakly_canonical(p);
-					}
-					catch (const filesystem_error&)
-					{
-						return "Failed to resolve target path '" + p.string() + "'!";
-					}
-				}
+				continue;
+			}
 
-				return {};
-			};
+			ScannedEntry entry{};
+			entry.name = name;
+			entry.isDirectory = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+			entry.isSymlink = (data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0;
+			entry.lastModified = to_file_time(data.ftLastWriteTime);
+			if (!entry.isDirectory)
+			{
+				entry.size =
+					(scast<uintmax_t>(data.nFileSizeHigh) << 32)
+					| data.nFileSizeLow;
+			}
 
-		auto contains_string = [](string_view origin, string_view target) -> bool
+			outDir.entries.push_back(std::move(entry));
+		} while (FindNextFileW(find, &data));
+
+		FindClose(find);
+#else
+		auto to_file_time = [](const struct stat& st)
 			{
-				//return false if origin or target is empty
-				if (origin.empty()
-					|| target.empty())
-				{
-					return false;
-				}
+				using namespace std::chrono;
 
-				//can't contain something longer than itself
-				if (target.size() > origin.size()) return false;
+#ifdef __APPLE__
+				const timespec& ts = st.st_mtimespec;
+#else
+				const timespec& ts = st.st_mtim;
+#endif
+				const sys_time<nanoseconds> sys(seconds(ts.tv_sec) + nanoseconds(ts.tv_nsec));
 
-				//case-insensitive search
-				auto it = search(
-					origin.begin(), 
-					origin.end(),
-					target.begin(), 
-					target.end(),
-					[](unsigned char char1, unsigned char char2)
-					{
-						return tolower(char1) == tolower(char2);
-					});
+				return time_point_cast<file_time_type::duration>(file_clock::from_sys(sys));
+			};
 
-				return it != origin.end();
+		auto errno_message = [&dir](int err)
+			{
+				char errbuf[256]{};
+				strerror_r(err, errbuf, sizeof(errbuf));
+
+				ostringstream oss{};
+				oss << "Failed to scan directory '" << dir
+					<< "'! Reason: (errno " << err << "): " << errbuf;
+
+				return oss.str();
 			};
 
-		path p = path(input);
+		int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+		if (fd < 0) return errno_message(errno);
 
-		const string pstr = p.string();
+		struct stat dirStat{};
+		if (fstat(fd, &dirStat) != 0)
+		{
+			int err = errno;
+			close(fd);
 
-		//File or directory exists as a real path
-		if (exists(p))
+			return errno_message(err);
+		}
+
+		outDir.lastModified = to_file_time(dirStat);
+
+		if (previous != nullptr
+			&& previous->lastModified == outDir.lastModified)
 		{
-			results.push_back(p);
+			close(fd);
 
-			string cleanupResult = clean_paths();
-			if (!cleanupResult.empty()) return cleanupResult;
+			outDir.entries = previous->entries;
+			outReused = true;
 
-			complete();
+			return{};
+		}
 
-			return {};
+		//the stream takes over the descriptor
+		DIR* stream = fdopendir(fd);
+		if (stream == nullptr)
+		{
+			int err = errno;
+			close(fd);
+
+			return errno_message(err);
 		}
 
-		//check exclusion logic
-		if (pstr.find('!') != string::npos)
+		while (dirent* d = readdir(stream))
 		{
-			if (pstr.find('*') != string::npos)
-			{
-				return "Exclusion does not support wildcards!";
-			}
-			if (!pstr.starts_with('!'))
+			const char* name = d->d_name;
+			if (name[0] == '.'
+				&& (name[1] == '\0'
+				|| (name[1] == '.' && name[2] == '\0')))
 			{
-				return "Exclusion requires the exclamation mark to be in the front!";
+				continue;
 			}
-			if (pstr.find('!', 1) != string::npos)
+
+			ScannedEntry entry{};
+			entry.name = name;
+
+			bool isLink = d->d_type == DT_LNK;
+			struct stat st{};
+
+			if (d->d_type == DT_UNKNOWN)
 			{
-				return "Exclusion allows only one exclamation mark in a path!";
+				//file systems without d_type need an extra lstat for the link check
+				if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) == 0) isLink = S_ISLNK(st.st_mode);
 			}
 
-			results.push_back(p);
+			//broken symlinks and entries that vanished mid-scan are skipped
+			if (fstatat(fd, name, &st, 0) != 0) continue;
 
-			string cleanupResult = clean_paths();
-			if (!cleanupResult.empty()) return cleanupResult;
+			entry.isDirectory = S_ISDIR(st.st_mode);
+			entry.isSymlink = isLink;
+			entry.lastModified = to_file_time(st);
+			if (!entry.isDirectory) entry.size = scast<uintmax_t>(st.st_size);
 
-			complete();
+			outDir.entries.push_back(std::move(entry));
+		}
 
-			return {};
+		closedir(stream);
+#endif
+		sort(
+			outDir.entries.begin(),
+			outDir.entries.end(),
+			[](const ScannedEntry& a, const ScannedEntry& b) { return a.name < b.name; });
+
+		return{};
+	}
+
+	//Scans every directory under target across threadCount worker threads (0 uses all hardware threads).
+	//Directories are handed out one at a time so deep and wide trees both spread across the workers.
+	//If previous is a snapshot of the same root, directories whose modification time is unchanged reuse
+	//their previous entries without being read. A directory time only changes when entries are added,
+	//removed or renamed, so files rewritten in place keep their previous size and time in that case
+	inline string ScanDirectory(
+		const path& target,
+		DirectorySnapshot& outSnapshot,
+		u32 threadCount = 1,
+		const DirectorySnapshot* previous = nullptr)
+	{
+		KPROFILE_ZONE("ScanDirectory");
+
+		ostringstream oss{};
+
+		if (!exists(target))
+		{
+			oss << "Failed to scan target directory '" << target << "' because it does not exist!";
+
+			return oss.str();
 		}
+		if (!is_directory(target))
+		{
+			oss << "Failed to scan target directory '" << target << "' because it is not a directory!";
 
-		if (!contains_string(pstr, "*")) p = relativeDir / p;
+			return oss.str();
+		}
 
-		auto get_all_wildcards = [&pstr, &target](
-			path input,
-			vector<path>& out,
-			bool recursive = false) -> string
+		//read-only lookup shared by all workers
+		unordered_map<path::string_type, const ScannedDirectory*> previousDirs{};
+		if (previous != nullptr
+			&& previous->root == target)
+		{
+			previousDirs.reserve(previous->directories.size());
+			for (const auto& d : previous->directories)
 			{
-				path p{ input };
-
-				if (p.empty()) return "Failed to get paths with wildcard because the directory path is empty!";
+				previousDirs.emplace(d.dirPath.native(), &d);
+			}
+		}
 
-				string fullDirName = recursive
-					? "**"
-					: "*";
+		mutex stateMutex{};
+		condition_variable stateChanged{};
+		vector<path> pending{ target };
+		size_t active{};
+		string firstError{};
+		vector<ScannedDirectory> results{};
 
-				if (p.filename().string() != fullDirName)
+		auto work = [&]()
+			{
+				unique_lock<mutex> lock(stateMutex);
+				while (true)
 				{
-					return
-					"Failed to get paths with wildcard because the directory path "
-					"'" + pstr + "' does not match any known wildcard pattern!";
-				}
+					stateChanged.wait(lock, [&]
+						{
+							return !pending.empty()
+								|| active == 0
+								|| !firstError.empty();
+						});
 
-				vector<path> tempOutTargetPaths{};
+					if (!firstError.empty()
+						|| (pending.empty() && active == 0))
+					{
+						break;
+					}
 
-				path baseDir = p.parent_path().empty()
-					? "."
-					: p.parent_path();
+					path dir = std::move(pending.back());
+					pending.pop_back();
+					++active;
 
-				if (!recursive)
-				{
-					for (const auto& t : directory_iterator(baseDir))
+					lock.unlock();
+
+					const ScannedDirectory* prev{};
+					if (!previousDirs.empty())
 					{
-						if (target == PathTarget::P_ANY
-							|| (target == PathTarget::P_FILE_ONLY
-							&& is_regular_file(t))
-							|| (target == PathTarget::P_DIR_ONLY
-							&& is_directory(t)))
-						{
-							tempOutTargetPaths.push_back(path(t));
-						}
+						auto it = previousDirs.find(dir.native());
+						if (it != previousDirs.end()) prev = it->second;
 					}
-				}
-				else
-				{
-					for (const auto& t : recursive_directory_iterator(baseDir))
+
+					ScannedDirectory scanned{};
+					bool reused{};
+					string result{};
+					vector<path> children{};
+
+					try
 					{
-						if (target == PathTarget::P_ANY
-							|| (target == PathTarget::P_FILE_ONLY
-							&& is_regular_file(t))
-							|| (target == PathTarget::P_DIR_ONLY
-							&& is_directory(t)))
+						result = ScanSingleDirectory(
+							dir,
+							prev,
+							scanned,
+							reused);
+
+						for (const auto& e : scanned.entries)
 						{
-							tempOutTargetPaths.push_back(path(t));
+							if (e.isDirectory && !e.isSymlink) children.push_back(dir / e.name);
 						}
 					}
-				}
+					catch (exception& e)
+					{
+						result = e.what();
+					}
 
-				out.insert(
-					out.end(),
-					make_move_iterator(tempOutTargetPaths.begin()),
-					make_move_iterator(tempOutTargetPaths.end()));
+					lock.lock();
+					--active;
 
-				return{};
+					if (!result.empty())
+					{
+						if (firstError.empty()) firstError = result;
+					}
+					else
+					{
+						results.push_back(std::move(scanned));
+						for (auto& c : children) pending.push_back(std::move(c));
+					}
+
+					stateChanged.notify_all();
+				}
 			};
 
-		auto get_file_wildcards = [](
-			const path& input,
-			vector<path>& out,
-			bool recursive = false) -> string
+		size_t workerCount = threadCount == 0
+			? thread::hardware_concurrency()
+			: threadCount;
+		workerCount = max(workerCount, size_t{ 1 });
+
+		try
+		{
+			//the calling thread scans too, so one less worker is spawned
+			vector<thread> workers{};
+			workers.reserve(workerCount - 1);
+
+			for (size_t i = 1; i < workerCount; ++i)
 			{
-				auto get_extension = [](string_view f) -> string_view
-				{
-					auto pos = f.rfind('.');
+				//if a thread can't be spawned the started workers and the calling thread
+				//still drain every pending directory, unwinding here would destroy joinable threads
+				try { workers.emplace_back(work); }
+				catch (...) { break; }
+			}
 
-					//return empty extension, valid for GNU
-					if (pos == string_view::npos) return{};
-					//returns found extension
-					return f.substr(pos);
-				};
-				
-				path p{ input };
-				
-				string filenamePattern = p.filename().string();
-				
-				bool startsWithWildcard = filenamePattern.starts_with('*');
-				bool endsWithWildcard = filenamePattern.ends_with('*');
-				
-				string pattern = filenamePattern;
-				
-				if (startsWithWildcard) pattern.erase(0, 1);
-				if (endsWithWildcard
-					&& !pattern.empty())
-				{
-					pattern.pop_back();
-				}
-
-				auto get_valid_file = [
-					&startsWithWildcard,
-					&endsWithWildcard,
-					&pattern](
-					const path& file,
-					string_view ext,
-					vector<path>& output)
-				{
-					if (!is_regular_file(file)) return;
-					
-					string name = file.filename().string();
-					
-					bool match{};
-					
-					if (startsWithWildcard
-						&& endsWithWildcard)
-					{
-						match = name.find(pattern) != string::npos;
-					}
-					else if (startsWithWildcard) match = name.ends_with(pattern);
-					else if (endsWithWildcard) match = name.starts_with(pattern);
-					else match = name == pattern;
-					
-					if (!match) return;
-					
-					bool extSpecified = !ext.empty();
-					bool hasValidExtension =
-						extSpecified
-						&& file.extension() == ext;
-						
-					bool allowAnyExtension = !extSpecified;
-
-					if (hasValidExtension
-						|| allowAnyExtension)
-					{
-						output.push_back(file);
-					}
-				};
+			work();
 
-				string filename = p.filename().string();
-				string_view ext = get_extension(filename);
+			for (auto& w : workers) w.join();
+		}
+		catch (exception& e)
+		{
+			oss << "Failed to scan target directory '" << target << "'! Reason: " << e.what();
 
-				if (p.empty()) return "Failed to get files with wildcard because the file path is empty!";
+			return oss.str();
+		}
 
-				vector<path> tempOutFilePaths{};
+		if (!firstError.empty())
+		{
+			oss << "Failed to scan target directory '" << target << "'! Reason: " << firstError;
 
-				path baseDir = p.parent_path().empty()
-					? "."
-					: p.parent_path();
+			return oss.str();
+		}
 
-				if (!recursive)
-				{
-					for (const auto& f : directory_iterator(baseDir))
-					{
-						const path& fpath{ f };
+		KPROFILE_COUNTER("directories scanned", results.size());
 
-						get_valid_file(
-							fpath,
-							ext,
-							tempOutFilePaths);
-					}
-				}
-				else
-				{
-					for (const auto& f : recursive_directory_iterator(baseDir))
-					{
-						const path& fpath{ f };
+		sort(
+			results.begin(),
+			results.end(),
+			[](const ScannedDirectory& a, const ScannedDirectory& b) { return a.dirPath < b.dirPath; });
 
-						get_valid_file(
-							fpath,
-							ext,
-							tempOutFilePaths);
-					}
-				}
+		outSnapshot.root = target;
+		outSnapshot.directories = std::move(results);
 
-				out.insert(
-					out.end(),
-					make_move_iterator(tempOutFilePaths.begin()),
-					make_move_iterator(tempOutFilePaths.end()));
+		return{};
+	}
 
-				return{};
-			};
+	inline constexpr u32 DIRECTORY_SNAPSHOT_MAGIC = 0x4E53444B; //"KDSN"
+	inline constexpr u32 DIRECTORY_SNAPSHOT_VERSION = 1;
 
-		vector<path> foundPaths{};
+	//Saves a snapshot index so a later ScanDirectory can skip unchanged directories.
+	//Times are stored as raw file_time_type ticks, so snapshots only load on the platform that saved them
+	inline string SaveDirectorySnapshot(
+		const path& target,
+		const DirectorySnapshot& snapshot)
+	{
+		ostringstream oss{};
 
-		//Directory or file is recursive
-		if (pstr == "**"
-			|| pstr.ends_with("**"))
+		try
 		{
-			string result = get_all_wildcards(
-				p, 
-				foundPaths,
-				true);
+			ofstream out(
+				target,
+				ios::binary
+				| ios::trunc);
 
-			if (!result.empty())
+			if (!out)
 			{
-				return
-					"Failed to resolve recursive directory or file path '" + string(input) 
-					+ "' because of wildcard error! Reason: " + result;
+				oss << "Failed to save directory snapshot to target '" << target << "' because it couldn't be opened!";
+
+				return oss.str();
 			}
 
-			results.insert(
-				results.end(),
-				make_move_iterator(foundPaths.begin()),
-				make_move_iterator(foundPaths.end()));
+			auto write_u32 = [&out](u32 v) { out.write(rcast<const char*>(&v), sizeof(v)); };
+			auto write_u64 = [&out](u64 v) { out.write(rcast<const char*>(&v), sizeof(v)); };
+			auto write_time = [&](file_time_type t) { write_u64(scast<u64>(t.time_since_epoch().count())); };
+			auto write_path = [&](const path& p)
+				{
+					const auto s = p.generic_u8string();
+					write_u32(scast<u32>(s.size()));
+					out.write(rcast<const char*>(s.data()), scast<streamsize>(s.size()));
+				};
 
-			string cleanupResult = clean_paths();
-			if (!cleanupResult.empty()) return cleanupResult;
+			write_u32(DIRECTORY_SNAPSHOT_MAGIC);
+			write_u32(DIRECTORY_SNAPSHOT_VERSION);
+			write_path(snapshot.root);
+			write_u64(snapshot.directories.size());
 
-			complete();
+			for (const auto& d : snapshot.directories)
+			{
+				write_path(d.dirPath);
+				write_time(d.lastModified);
+				write_u64(d.entries.size());
 
-			return {};
-		}
-		//Directory or file is not recursive
-		else if (input == "*")
-		{
-			string result = get_all_wildcards(
-				p, 
-				foundPaths);
+				for (const auto& e : d.entries)
+				{
+					write_path(e.name);
+					write_u64(e.size);
+					write_time(e.lastModified);
+
+					const u8 flags = scast<u8>(
+						(e.isDirectory ? 1 : 0)
+						| (e.isSymlink ? 2 : 0));
+					out.write(rcast<const char*>(&flags), 1);
+				}
+			}
 
-			if (!result.empty())
+			if (!out)
 			{
-				return
-					"Failed to resolve directory or file path '" + string(input) 
-					+ "' because of wildcard error! Reason: " + result;
+				oss << "Failed to save directory snapshot to target '" << target << "' because writing failed!";
+
+				return oss.str();
 			}
+		}
+		catch (exception& e)
+		{
+			oss << "Failed to save directory snapshot to target '" << target << "'! Reason: " << e.what();
 
-			results.insert(
-				results.end(),
-				make_move_iterator(foundPaths.begin()),
-				make_move_iterator(foundPaths.end()));
+			return oss.str();
+		}
 
-			string cleanupResult = clean_paths();
-			if (!cleanupResult.empty()) return cleanupResult;
+		return{};
+	}
 
-			complete();
+	//Loads a snapshot index saved by SaveDirectorySnapshot
+	inline string LoadDirectorySnapshot(
+		const path& target,
+		DirectorySnapshot& outSnapshot)
+	{
+		ostringstream oss{};
 
-			return {};
-		}
-		//File is recursive
-		else if (contains_string(input, "**."))
+		if (!exists(target))
 		{
-			if (target == PathTarget::P_DIR_ONLY) return {};
+			oss << "Failed to load directory snapshot from target '" << target << "' because it does not exist!";
 
-			string result = get_file_wildcards(
-				p, 
-				foundPaths, 
-				true);
+			return oss.str();
+		}
 
-			if (!result.empty())
+		try
+		{
+			ifstream in(
+				target,
+				ios::binary);
+
+			if (!in)
 			{
-				return 
-					"Failed to resolve recursive file path '" + string(input) 
-					+ "' because of wildcard error! Reason: " + result;
+				oss << "Failed to load directory snapshot from target '" << target << "' because it couldn't be opened!";
+
+				return oss.str();
 			}
 
-			results.insert(
-				results.end(),
-				make_move_iterator(foundPaths.begin()),
-				make_move_iterator(foundPaths.end()));
+			auto read_u32 = [&in]() { u32 v{}; in.read(rcast<char*>(&v), sizeof(v)); return v; };
+			auto read_u64 = [&in]() { u64 v{}; in.read(rcast<char*>(&v), sizeof(v)); return v; };
+			auto read_time = [&]()
+				{
+					return file_time_type(file_time_type::duration(
+						scast<file_time_type::rep>(read_u64())));
+				};
+			const u64 snapshotSize = file_size(target);
+			auto read_path = [&]()
+				{
+					//a corrupt length must not allocate more than the file could still hold
+					const u32 length = read_u32();
+					const auto position = in.tellg();
+					if (!in
+						|| position < 0
+						|| length > snapshotSize - scast<u64>(position))
+					{
+						in.setstate(ios::failbit);
+						return path{};
+					}
 
-			string cleanupResult = clean_paths();
-			if (!cleanupResult.empty()) return cleanupResult;
+					std::u8string s(length, u8'\0');
+					in.read(rcast<char*>(s.data()), scast<streamsize>(s.size()));
+					return path(s);
+				};
 
-			complete();
+			if (read_u32() != DIRECTORY_SNAPSHOT_MAGIC
+				|| read_u32() != DIRECTORY_SNAPSHOT_VERSION)
+			{
+				oss << "Failed to load directory snapshot from target '" << target << "' because it is not a supported snapshot!";
 
-			return {};
-		}
-		//File is not recursive
-		else if (contains_string(input, "*."))
-		{
-			if (target == PathTarget::P_DIR_ONLY) return {};
+				return oss.str();
+			}
 
-			string result = get_file_wildcards(
-				p, 
-				foundPaths);
+			DirectorySnapshot snapshot{};
+			snapshot.root = read_path();
 
-			if (!result.empty())
+			const u64 dirCount = read_u64();
+			for (u64 i = 0; i < dirCount && in; ++i)
 			{
-				return 
-					"Failed to resolve file path '" + string(input) 
-					+ "' because of wildcard error! Reason: " + result;
-			}
+				ScannedDirectory d{};
+				d.dirPath = read_path();
+				d.lastModified = read_time();
 
-			results.insert(
-				results.end(),
-				make_move_iterator(foundPaths.begin()),
-				make_move_iterator(foundPaths.end()));
-
-			string cleanupResult = clean_paths();
-			if (!cleanupResult.empty()) return cleanupResult;
+				const uint64_t entryCount = read_u64();
+				for (uint64_t j = 0; j < entryCount && in; ++j)
+				{
+					ScannedEntry e{};
+					e.name = read_path();
+					e.size = read_u64();
+					e.lastModified = read_time();
 
-			complete();
+					u8 flags{};
+					in.read(rcast<char*>(&flags), 1);
+					e.isDirectory = (flags & 1) != 0;
+					e.isSymlink = (flags & 2) != 0;
 
-			return {};
-		}
-		//Prefix, suffix, contains wildcard
-		else if (contains_string(input, "*"))
-		{
-			string result = get_file_wildcards(
-				p, 
-				foundPaths);
+					d.entries.push_back(std::move(e));
+				}
 
-			if (!result.empty())
-			{
-				return 
-					"Failed to resolve file path '" + string(input) 
-					+ "' because of wildcard error! Reason: " + result;
+				snapshot.directories.push_back(std::move(d));
 			}
 
-			results.insert(
-				results.end(),
-				make_move_iterator(foundPaths.begin()),
-				make_move_iterator(foundPaths.end()));
+			if (!in)
+			{
+				oss << "Failed to load directory snapshot from target '" << target << "' because it is truncated!";
 
-			string cleanupResult = clean_paths();
-			if (!cleanupResult.empty()) return cleanupResult;
+				return oss.str();
+			}
 
-			complete();
+			outSnapshot = std::move(snapshot);
+		}
+		catch (exception& e)
+		{
+			oss << "Failed to load directory snapshot from target '" << target << "'! Reason: " << e.what();
 
-			return {};
+			return oss.str();
 		}
 
-		return "Failed to resolve path '" + string(input) + "' because it had no matching wildcard pattern, or its relative or full path was not found!";
+		return{};
 	}
 
 	//
-	// CONVERT CONTAINER
+	// WILDCARDS
 	//
 
-	//Convert a path vector to a string vector
-	inline string ToStringVector(
-		const vector<path>& in, 
-		vector<string>& out)
+	enum class PathTarget : u8
 	{
-		if (in.empty()) return "Failed to convert path vector because it was empty!";
-
-		out.clear();
-		out.reserve(in.size());
-
-		for (const path& p : in) out.push_back(p.string());
-
-		return {};
-	}
+		P_ANY = 0,
+		P_FILE_ONLY = 1,
+		P_DIR_ONLY = 2
+	};
 
-	//Convert a string vector to a path vector
-	inline string ToPathVector(
-		const vector<string>& in, 
-		vector<path>& out)
+	//Resolve any path-like field into a vector of paths (wildcards may return multiple values),
+	//PathTarget let you select both files and dirs, or files only, or dirs only
+	inline string ResolveAnyPath(
+		string_view input,
+		string_view relativeDir,
+		vector<path>& out,
+		PathTarget target = PathTarget::P_ANY)
 	{
-		if (in.empty()) return "Failed to convert string vector because it was empty!";
+		if (input.empty()) return "Failed to resolve empty path!";
+		if (input.ends_with("*.")
+			|| input.ends_with("**."))
+		{
+			return "Failed to resolve extensionless file path!";
+		}
 
-		out.clear();
-		out.reserve(in.size());
+		vector<path> results{};
 
-		for (const string& s : in) out.push_back(path(s));
+		auto complete = [&out, &results]() -> void
+			{
+				out.insert(
+					out.end(),
+					make_move_iterator(results.begin()),
+					make_move_iterator(results.end()));
+			};
 
-		return {};
-	}
+		auto clean_paths = [&results]() -> string
+			{
+				for (path& p : results)
+				{
+					try
+					{
+						p = weakly_canonical(p);
+					}
+					catch (const filesystem_error&)
+					{
+						return "Failed to resolve target path '" + p.string() + "'!";
+					}
+				}
 
-	//
-	// FILE MANAGEMENT
-	//
+				return {};
+			};
 
-	//Forward declarations for write* functions
+		auto contains_string = [](string_view origin, string_view target) -> bool
+			{
+				//return false if origin or target is empty
+				if (origin.empty()
+					|| target.empty())
+				{
+					return false;
+				}
 
-	inline string WriteTextToFile(
-		const path& target,
-		string_view inText,
-		bool append = false,
-		bool overwrite = false);
+				//can't contain something longer than itself
+				if (target.size() > origin.size()) return false;
 
-	inline string WriteLinesToFile(
-		const path& target,
-		const vector<string>& inLines,
-		bool append = false,
-		bool overwrite = false);
+				//case-insensitive search
+				auto it = search(
+					origin.begin(), 
+					origin.end(),
+					target.begin(), 
+					target.end(),
+					[](unsigned char char1, unsigned char char2)
+					{
+						return tolower(char1) == tolower(char2);
+					});
 
-	inline string WriteBinaryDataToFile(
-		const path& target,
-		const vector<uint8_t>& inData,
-		bool append = false,
-		bool overwrite = false);
+				return it != origin.end();
+			};
 
-	//Create regular or binary file at target path. If you also want data written
-	//to the new file after its been created then pass a fileData struct
-	//with one of the fields filled in, only the first found field data is used
-	inline string CreateNewFile(
-		const path& target,
-		FileType targetFileType = FileType::FILE_BINARY,
-		const FileData& fileData = FileData{})
-	{
-		ostringstream oss{};
+		path p = path(input);
 
-		if (target.empty())
-		{
-			oss << "Failed to create new file because no target path was passed!";
+		const string pstr = p.string();
 
-			return oss.str();
-		}
-		if (exists(target))
+		//File or directory exists as a real path
+		if (exists(p))
 		{
-			oss << "Failed to create new file at path '" << target
-				<< "' because it already exists!";
+			results.push_back(p);
 
-			return oss.str();
-		}
+			string cleanupResult = clean_paths();
+			if (!cleanupResult.empty()) return cleanupResult;
 
-		path baseDir = target.parent_path().empty()
-			? "."
-			: target.parent_path();
-		
-		auto fileStatus = status(baseDir);
-		auto filePerms = fileStatus.permissions();
-		
-		bool canWrite = (filePerms & (
-			perms::owner_write
-			| perms::group_write
-			| perms::others_write))  
-			!= perms::none;
-		
-		if (!canWrite)
-		{
-			oss << "Failed to create target '" << target << "' because of insufficient write permissions!";
+			complete();
 
-			return oss.str();
+			return {};
 		}
 
-		switch (targetFileType)
-		{
-		case FileType::FILE_TEXT:
+		//check exclusion logic
+		if (pstr.find('!') != string::npos)
 		{
-			if (!fileData.inData.empty())
+			if (pstr.find('*') != string::npos)
 			{
-				oss << "Failed to create new file at path '" << target
-					<< "' because its type was set to 'FILE_TEXT' and binary data was passed to it!";
-
-				return oss.str();
+				return "Exclusion does not support wildcards!";
+			}
+			if (!pstr.starts_with('!'))
+			{
+				return "Exclusion requires the exclamation mark to be in the front!";
+			}
+			if (pstr.find('!', 1) != string::npos)
+			{
+				return "Exclusion allows only one exclamation mark in a path!";
 			}
 
-			ofstream file(
-				target,
-				ios::out
-				| ios::trunc);
+			results.push_back(p);
 
-			file.close();
+			string cleanupResult = clean_paths();
+			if (!cleanupResult.empty()) return cleanupResult;
 
-			if (!fileData.inLines.empty()
-				|| !fileData.inText.empty())
-			{
-				string result{};
+			complete();
 
-				if (!fileData.inText.empty())
-				{
-					result = WriteTextToFile(
-						target,
-						fileData.inText);
-				}
-				else if (!fileData.inLines.empty())
-				{
-					result = WriteLinesToFile(
-						target,
-						fileData.inLines);
-				}
+			return {};
+		}
 
-				if (!result.empty())
-				{
-					oss << "Failed to create new text file '"
-						<< target << "'! Reason: " << result;
+		if (!contains_string(pstr, "*")) p = relativeDir / p;
 
-					return oss.str();
-				}
-			}
-			break;
-		}
-		case FileType::FILE_BINARY:
-		{
-			if (!fileData.inLines.empty()
-				|| !fileData.inText.empty())
+		auto get_all_wildcards = [&pstr, &target](
+			path input,
+			vector<path>& out,
+			bool recursive = false) -> string
 			{
-				oss << "Failed to create new file at path '" << target
-					<< "' because its type was set to 'FILE_BINARY' and string data was passed to it!";
+				path p{ input };
 
-				return oss.str();
-			}
+				if (p.empty()) return "Failed to get paths with wildcard because the directory path is empty!";
 
-			ofstream file(
-				target,
-				ios::out
-				| ios::binary
-				| ios::trunc);
+				string fullDirName = recursive
+					? "**"
+					: "*";
 
-			file.close();
+				if (p.filename().string() != fullDirName)
+				{
+					return
+					"Failed to get paths with wildcard because the directory path "
+					"'" + pstr + "' does not match any known wildcard pattern!";
+				}
 
-			if (!fileData.inData.empty())
-			{
-				string result{};
+				vector<path> tempOutTargetPaths{};
 
-				result = WriteBinaryDataToFile(
-					target,
-					fileData.inData);
+				path baseDir = p.parent_path().empty()
+					? "."
+					: p.parent_path();
 
-				if (!result.empty())
+				if (!recursive)
 				{
-					oss << "Failed to create new binary file '"
-						<< target << "'! Reason: " << result;
-
-					return oss.str();
-				}
-			}
-			break;
-		}
-		}
-
-		return{};
-	}
+					for (const auto& t : directory_iterator(baseDir))
+					{
+						if (target == PathTarget::P_ANY
+							|| (target == PathTarget::P_FILE_ONLY
+							&& is_regular_file(t))
+							|| (target == PathTarget::P_DIR_ONLY
+							&& is_directory(t)))
+						{
+							tempOutTargetPaths.push_back(path(t));
+						}
+					}
+				}
+				else
+				{
+					for (const auto& t : recursive_directory_iterator(baseDir))
+					{
+						if (target == PathTarget::P_ANY
+							|| (target == PathTarget::P_FILE_ONLY
+							&& is_regular_file(t))
+							|| (target == PathTarget::P_DIR_ONLY
+							&& is_directory(t)))
+						{
+							tempOutTargetPaths.push_back(path(t));
+						}
+					}
+				}
 
-	//Create a directory at target path, this also creates all
-	//parent folders up to it that don't exist yet
-	inline string CreateNewDirectory(const path& target)
-	{
-		ostringstream oss{};
+				out.insert(
+					out.end(),
+					make_move_iterator(tempOutTargetPaths.begin()),
+					make_move_iterator(tempOutTargetPaths.end()));
 
-		if (exists(target))
-		{
-			oss << "Failed to create target '" << target << "' because it already exists!";
+				return{};
+			};
 
-			return oss.str();
-		}
-		if (target.has_extension())
-		{
-			oss << "Failed to create target '" << target << "' because it has an extension!";
+		auto get_file_wildcards = [](
+			const path& input,
+			vector<path>& out,
+			bool recursive = false) -> string
+			{
+				auto get_extension = [](string_view f) -> string_view
+				{
+					auto pos = f.rfind('.');
 
-			return oss.str();
-		}
-		
-		path baseDir = target.parent_path().empty()
-			? "."
-			: target.parent_path();
+					//return empty extension, valid for GNU
+					if (pos == string_view::npos) return{};
+					//returns found extension
+					return f.substr(pos);
+				};
+				
+				path p{ input };
+				
+				string filenamePattern = p.filename().string();
+				
+				bool startsWithWildcard = filenamePattern.starts_with('*');
+				bool endsWithWildcard = filenamePattern.ends_with('*');
+				
+				string pattern = filenamePattern;
+				
+				if (startsWithWildcard) pattern.erase(0, 1);
+				if (endsWithWildcard
+					&& !pattern.empty())
+				{
+					pattern.pop_back();
+				}
 
-		auto fileStatus = status(baseDir);
-		auto filePerms = fileStatus.permissions();
-		
-		bool canWrite = (filePerms & (
-			perms::owner_write
-			| perms::group_write
-			| perms::others_write))  
-			!= perms::none;
-		
-		if (!canWrite)
-		{
-			oss << "Failed to create directory '" << target << "' because of insufficient write permissions!";
+				auto get_valid_file = [
+					&startsWithWildcard,
+					&endsWithWildcard,
+					&pattern](
+					const path& file,
+					string_view ext,
+					vector<path>& output)
+				{
+					if (!is_regular_file(file)) return;
+					
+					string name = file.filename().string();
+					
+					bool match{};
+					
+					if (startsWithWildcard
+						&& endsWithWildcard)
+					{
+						match = name.find(pattern) != string::npos;
+					}
+					else if (startsWithWildcard) match = name.ends_with(pattern);
+					else if (endsWithWildcard) match = name.starts_with(pattern);
+					else match = name == pattern;
+					
+					if (!match) return;
+					
+					bool extSpecified = !ext.empty();
+					bool hasValidExtension =
+						extSpecified
+						&& file.extension() == ext;
+						
+					bool allowAnyExtension = !extSpecified;
 
-			return oss.str();
-		}
+					if (hasValidExtension
+						|| allowAnyExtension)
+					{
+						output.push_back(file);
+					}
+				};
 
-		try
-		{
-			create_directories(target);
-		}
-		catch (exception& e)
-		{
-			oss << "Failed to create target '" << target << "'! Reason: " << e.what();
+				string filename = p.filename().string();
+				string_view ext = get_extension(filename);
 
-			return oss.str();
-		}
+				if (p.empty()) return "Failed to get files with wildcard because the file path is empty!";
 
-		return{};
-	}
+				vector<path> tempOutFilePaths{};
 
-	//Returns all files that match the extension or string
-	//depending on the side opposite to the asterisk (*.example or example.*),
-	//will not return any directories,
-	//can search recursively if recursive is true
-	inline string GetRelativeFiles(
-		const path& dir,
-		string_view extensionOrName,
-		vector<path>& outPaths,
-		bool recursive = false)
-	{
-		auto is_valid_star_pattern = [&dir](
-			string_view extensionOrName,
-			string& outExtension,
-			string& outName,
-			string& outErrorResult) -> bool
-			{
-				ostringstream oss{};
+				path baseDir = p.parent_path().empty()
+					? "."
+					: p.parent_path();
 
-				if (!exists(dir))
+				if (!recursive)
 				{
-					oss << "Failed to get files relative to path '" << dir
-						<< "' because it does not exist!";
+					for (const auto& f : directory_iterator(baseDir))
+					{
+						const path& fpath{ f };
 
-					outErrorResult = oss.str();
-					return false;
+						get_valid_file(
+							fpath,
+							ext,
+							tempOutFilePaths);
+					}
 				}
-				if (!is_directory(dir))
+				else
 				{
-					oss << "Failed to get files relative to path '" << dir
-						<< "' because it is not a directory!";
+					for (const auto& f : recursive_directory_iterator(baseDir))
+					{
+						const path& fpath{ f };
 
-					outErrorResult = oss.str();
-					return false;
+						get_valid_file(
+							fpath,
+							ext,
+							tempOutFilePaths);
+					}
 				}
 
-				if (extensionOrName.empty())
-				{
-					oss << "Failed to get files relative to path '" << dir
-						<< "' because no extension or name value was passed!";
+				out.insert(
+					out.end(),
+					make_move_iterator(tempOutFilePaths.begin()),
+					make_move_iterator(tempOutFilePaths.end()));
 
-					outErrorResult = oss.str();
-					return false;
-				}
+				return{};
+			};
 
-				if (extensionOrName == ".")
-				{
-					oss << "Failed to get files relative to path '" << dir
-						<< "' because the extension or name value '" << extensionOrName << "' has no value on both sides of the dot!";
+		vector<path> foundPaths{};
 
-					outErrorResult = oss.str();
-					return false;
-				}
+		//Directory or file is recursive
+		if (pstr == "**"
+			|| pstr.ends_with("**"))
+		{
+			string result = get_all_wildcards(
+				p, 
+				foundPaths,
+				true);
 
-				auto splitstring = [](
-					string_view origin,
-					string_view splitter) -> vector<string>
-					{
-						vector<string> splitResult{};
-						size_t start{};
-						size_t pos{};
+			if (!result.empty())
+			{
+				return
+					"Failed to resolve recursive directory or file path '" + string(input) 
+					+ "' because of wildcard error! Reason: " + result;
+			}
 
-						while ((pos = origin.find(splitter, start)) != string::npos)
-						{
-							splitResult.emplace_back(origin.substr(start, pos - start));
-							start = pos + splitter.length();
-						}
+			results.insert(
+				results.end(),
+				make_move_iterator(foundPaths.begin()),
+				make_move_iterator(foundPaths.end()));
 
-						//push the remainder (or whole string if no delimiter was found)
-						splitResult.emplace_back(origin.substr(start));
+			string cleanupResult = clean_paths();
+			if (!cleanupResult.empty()) return cleanupResult;
 
-						return splitResult;
-					};
-
-				vector<string> splitpath = splitstring(
-					extensionOrName,
-					".");
-
-				if (splitpath.size() > 2)
-				{
-					oss << "Failed to get files relative to path '" << dir
-						<< "' because the extension or name value '" << extensionOrName << "' has more than one dot!";
+			complete();
 
-					outErrorResult = oss.str();
-					return false;
-				}
+			return {};
+		}
+		//Directory or file is not recursive
+		else if (input == "*")
+		{
+			string result = get_all_wildcards(
+				p, 
+				foundPaths);
 
-				string_view name = splitpath[0];
-				string_view extension = splitpath[1];
+			if (!result.empty())
+			{
+				return
+					"Failed to resolve directory or file path '" + string(input) 
+					+ "' because of wildcard error! Reason: " + result;
+			}
 
-				if (name != "*"
-					&& extension != "*")
-				{
-					oss << "Failed to get files relative to path '" << dir
-						<< "' because neither the extension or name value '" << extensionOrName << "' was an asterisk!";
+			results.insert(
+				results.end(),
+				make_move_iterator(foundPaths.begin()),
+				make_move_iterator(foundPaths.end()));
 
-					outErrorResult = oss.str();
-					return false;
-				}
+			string cleanupResult = clean_paths();
+			if (!cleanupResult.empty()) return cleanupResult;
 
-				outExtension = extension;
-				outName = name;
+			complete();
 
-				return true;
-			};
+			return {};
+		}
+		//File is recursive
+		else if (contains_string(input, "**."))
+		{
+			if (target == PathTarget::P_DIR_ONLY) return {};
 
-		string extension{};
-		string name{};
-		string errorResult{};
+			string result = get_file_wildcards(
+				p, 
+				foundPaths, 
+				true);
 
-		if (!is_valid_star_pattern(
-			extensionOrName,
-			extension,
-			name,
-			errorResult))
-		{
-			return errorResult;
-		}
+			if (!result.empty())
+			{
+				return 
+					"Failed to resolve recursive file path '" + string(input) 
+					+ "' because of wildcard error! Reason: " + result;
+			}
 
-		auto fileStatus = status(dir);
-		auto filePerms = fileStatus.permissions();
+			results.insert(
+				results.end(),
+				make_move_iterator(foundPaths.begin()),
+				make_move_iterator(foundPaths.end()));
 
-		bool canRead = (filePerms & (
-			perms::owner_read
-			| perms::group_read
-			| perms::others_read))
-			!= perms::none;
+			string cleanupResult = clean_paths();
+			if (!cleanupResult.empty()) return cleanupResult;
 
-		ostringstream oss{};
+			complete();
 
-		if (!canRead)
+			return {};
+		}
+		//File is not recursive
+		else if (contains_string(input, "*."))
 		{
-			oss << "Failed to get files relative to path '" << dir << "' because of insufficient read permissions!";
+			if (target == PathTarget::P_DIR_ONLY) return {};
 
-			return oss.str();
-		}
+			string result = get_file_wildcards(
+				p, 
+				foundPaths);
 
-		auto is_valid_name = [&name, &extension](const path& target)
-			{
-				return extension == "*"
-					&& !is_directory(target)
-					&& path(target).has_extension()
-					&& path(target).stem() == name;
-			};
-		auto is_valid_extension = [&name, &extension](const path& target)
+			if (!result.empty())
 			{
-				return name == "*"
-					&& !is_directory(target)
-					&& path(target).has_filename()
-					&& path(target).extension() == "." + string(extension);
-			};
+				return 
+					"Failed to resolve file path '" + string(input) 
+					+ "' because of wildcard error! Reason: " + result;
+			}
 
-		try
+			results.insert(
+				results.end(),
+				make_move_iterator(foundPaths.begin()),
+				make_move_iterator(foundPaths.end()));
+
+			string cleanupResult = clean_paths();
+			if (!cleanupResult.empty()) return cleanupResult;
+
+			complete();
+
+			return {};
+		}
+		//Prefix, suffix, contains wildcard
+		else if (contains_string(input, "*"))
 		{
-			if (recursive)
-			{
-				for (auto& entry : recursive_directory_iterator(dir))
-				{
-					if (is_valid_name(entry))           outPaths.push_back(entry.path());
-					else if (is_valid_extension(entry)) outPaths.push_back(entry.path());
-				}
-			}
-			else
+			string result = get_file_wildcards(
+				p, 
+				foundPaths);
+
+			if (!result.empty())
 			{
-				for (auto& entry : directory_iterator(dir))
-				{
-					if (is_valid_name(entry))           outPaths.push_back(entry.path());
-					else if (is_valid_extension(entry)) outPaths.push_back(entry.path());
-				}
+				return 
+					"Failed to resolve file path '" + string(input) 
+					+ "' because of wildcard error! Reason: " + result;
 			}
-		}
-		catch (exception& e)
-		{
-			oss << "Failed to get files relative to path '" << dir << "'! Reason: " << e.what();
 
-			return oss.str();
+			results.insert(
+				results.end(),
+				make_move_iterator(foundPaths.begin()),
+				make_move_iterator(foundPaths.end()));
+
+			string cleanupResult = clean_paths();
+			if (!cleanupResult.empty()) return cleanupResult;
+
+			complete();
+
+			return {};
 		}
 
-		return{};
+		return "Failed to resolve path '" + string(input) + "' because it had no matching wildcard pattern, or its relative or full path was not found!";
 	}
 
-	//List all the contents of a folder,
-	//can search recursively if recursive is true
-	inline string ListDirectoryContents(
+	//
+	// CONVERT CONTAINER
+	//
+
+	//Convert a path vector to a string vector
+	inline string ToStringVector(
+		const vector<path>& in, 
+		vector<string>& out)
+	{
+		if (in.empty()) return "Failed to convert path vector because it was empty!";
+
+		out.clear();
+		out.reserve(in.size());
+
+		for (const path& p : in) out.push_back(p.string());
+
+		return {};
+	}
+
+	//Convert a string vector to a path vector
+	inline string ToPathVector(
+		const vector<string>& in, 
+		vector<path>& out)
+	{
+		if (in.empty()) return "Failed to convert string vector because it was empty!";
+
+		out.clear();
+		out.reserve(in.size());
+
+		for (const string& s : in) out.push_back(path(s));
+
+		return {};
+	}
+
+	//
+	// FILE MANAGEMENT
+	//
+
+	//Forward declarations for write* functions
+
+	inline string WriteTextToFile(
 		const path& target,
-		vector<path>& outEntries,
-		bool recursive = false)
+		string_view inText,
+		bool append = false,
+		bool overwrite = false);
+
+	inline string WriteLinesToFile(
+		const path& target,
+		const vector<string>& inLines,
+		bool append = false,
+		bool overwrite = false);
+
+	inline string WriteBinaryDataToFile(
+		const path& target,
+		const vector<uint8_t>& inData,
+		bool append = false,
+		bool overwrite = false);
+
+	//Create regular or binary file at target path. If you also want data written
+	//to the new file after its been created then pass a fileData struct
+	//with one of the fields filled in, only the first found field data is used
+	inline string CreateNewFile(
+		const path& target,
+		FileType targetFileType = FileType::FILE_BINARY,
+		const FileData& fileData = FileData{})
 	{
 		ostringstream oss{};
 
-		if (!exists(target))
+		if (target.empty())
 		{
-			oss << "Failed to list paths from target '" << target << "' because it does not exist!";
+			oss << "Failed to create new file because no target path was passed!";
 
 			return oss.str();
 		}
-		if (!is_directory(target))
+		if (exists(target))
 		{
-			oss << "Failed to list paths from target '" << target << "' because it is not a directory!";
+			oss << "Failed to create new file at path '" << target
+				<< "' because it already exists!";
 
 			return oss.str();
 		}
-		
+
 		path baseDir = target.parent_path().empty()
 			? "."
 			: target.parent_path();
-
+		
 		auto fileStatus = status(baseDir);
 		auto filePerms = fileStatus.permissions();
 		
-		bool canRead = (filePerms & (
-			perms::owner_read
-			| perms::group_read
-			| perms::others_read))  
+		bool canWrite = (filePerms & (
+			perms::owner_write
+			| perms::group_write
+			| perms::others_write))  
 			!= perms::none;
 		
-		if (!canRead)
+		if (!canWrite)
 		{
-			oss << "Failed to list directory contents from target '" << target << "' because of insufficient read permissions!";
+			oss << "Failed to create target '" << target << "' because of insufficient write permissions!";
 
 			return oss.str();
 		}
 
-		try
+		switch (targetFileType)
 		{
-			if (recursive)
+		case FileType::FILE_TEXT:
+		{
+			if (!fileData.inData.empty())
 			{
-				for (auto& entry : recursive_directory_iterator(target))
-				{
-					outEntries.push_back(entry.path());
-				}
+				oss << "Failed to create new file at path '" << target
+					<< "' because its type was set to 'FILE_TEXT' and binary data was passed to it!";
+
+				return oss.str();
 			}
-			else
+
+			ofstream file(
+				target,
+				ios::out
+				| ios::trunc);
+
+			file.close();
+
+			if (!fileData.inLines.empty()
+				|| !fileData.inText.empty())
 			{
-				for (auto& entry : directory_iterator(target))
+				string result{};
+
+				if (!fileData.inText.empty())
 				{
-					outEntries.push_back(entry.path());
+					result = WriteTextToFile(
+						target,
+						fileData.inText);
+				}
+				else if (!fileData.inLines.empty())
+				{
+					result = WriteLinesToFile(
+						target,
+						fileData.inLines);
+				}
+
+				if (!result.empty())
+				{
+					oss << "Failed to create new text file '"
+						<< target << "'! Reason: " << result;
+
+					return oss.str();
 				}
 			}
+			break;
 		}
-		catch (exception& e)
+		case FileType::FILE_BINARY:
 		{
-			oss << "Failed to list paths from target '" << target << "'! Reason: " << e.what();
+			if (!fileData.inLines.empty()
+				|| !fileData.inText.empty())
+			{
+				oss << "Failed to create new file at path '" << target
+					<< "' because its type was set to 'FILE_BINARY' and string data was passed to it!";
 
-			return oss.str();
+				return oss.str();
+			}
+
+			ofstream file(
+				target,
+				ios::out
+				| ios::binary
+				| ios::trunc);
+
+			file.close();
+
+			if (!fileData.inData.empty())
+			{
+				string result{};
+
+				result = WriteBinaryDataToFile(
+					target,
+					fileData.inData);
+
+				if (!result.empty())
+				{
+					oss << "Failed to create new binary file '"
+						<< target << "'! Reason: " << result;
+
+					return oss.str();
+				}
+			}
+			break;
+		}
 		}
 
 		return{};
 	}
 
-	//Rename file or folder in its current directory
-	inline string RenamePath(
-		const path& target,
-		string_view newName)
+	//Create a directory at target path, this also creates all
+	//parent folders up to it that don't exist yet
+	inline string CreateNewDirectory(const path& target)
 	{
 		ostringstream oss{};
 
-		if (!exists(target))
-		{
-			oss << "Failed to rename target '" << target << "' to '"
-				<< newName << "' because it does not exist!";
-
-			return oss.str();
-		}
-		if (is_directory(target)
-			&& path(newName).has_extension())
+		if (exists(target))
 		{
-			oss << "Failed to rename target '" << target << "' to '"
-				<< newName << "' because target is a directory but new name has an extension!";
+			oss << "Failed to create target '" << target << "' because it already exists!";
 
 			return oss.str();
 		}
-		if (is_regular_file(target)
-			&& newName.empty())
+		if (target.has_extension())
 		{
-			oss << "Failed to rename target '" << target << "' to '"
-				<< newName << "' because target is a file but new name is empty!";
+			oss << "Failed to create target '" << target << "' because it has an extension!";
 
 			return oss.str();
 		}
@@ -1197,24 +1545,21 @@ namespace KalaHeaders::KalaFile
 			| perms::group_write
 			| perms::others_write))  
 			!= perms::none;
-
+		
 		if (!canWrite)
 		{
-			oss << "Failed to rename target '" << target << "' because of insufficient write permissions!";
+			oss << "Failed to create directory '" << target << "' because of insufficient write permissions!";
 
 			return oss.str();
 		}
 
 		try
 		{
-			path newTarget = target.parent_path() / newName;
-			rename(target, newTarget);
+			create_directories(target);
 		}
 		catch (exception& e)
 		{
-			oss << "Failed to rename '"
-				<< target << "' to '"
-				<< newName << "'! Reason: " << e.what();
+			oss << "Failed to create target '" << target << "'! Reason: " << e.what();
 
 			return oss.str();
 		}
@@ -1222,263 +1567,209 @@ namespace KalaHeaders::KalaFile
 		return{};
 	}
 
-	//Delete file or folder in target path (recursive for directories)
-	inline string DeletePath(const path& target)
+	//Returns all files that match the extension or string
+	//depending on the side opposite to the asterisk (*.example or example.*),
+	//will not return any directories,
+	//can search recursively if recursive is true across threadCount threads (0 uses all hardware threads)
+	inline string GetRelativeFiles(
+		const path& dir,
+		string_view extensionOrName,
+		vector<path>& outPaths,
+		bool recursive = false,
+		u32 threadCount = 1)
 	{
-		ostringstream oss{};
+		auto is_valid_star_pattern = [&dir](
+			string_view extensionOrName,
+			string& outExtension,
+			string& outName,
+			string& outErrorResult) -> bool
+			{
+				ostringstream oss{};
 
-		if (!exists(target))
-		{
-			oss << "Failed to delete target '"
-				<< target << "' because it does not exist!";
+				if (!exists(dir))
+				{
+					oss << "Failed to get files relative to path '" << dir
+						<< "' because it does not exist!";
 
-			return oss.str();
-		}
-		
-		path baseDir = target.parent_path().empty()
-			? "."
-			: target.parent_path();
+					outErrorResult = oss.str();
+					return false;
+				}
+				if (!is_directory(dir))
+				{
+					oss << "Failed to get files relative to path '" << dir
+						<< "' because it is not a directory!";
 
-		auto fileStatus = status(baseDir);
-		auto filePerms = fileStatus.permissions();
-		
-		bool canWrite = (filePerms & (
-			perms::owner_write
-			| perms::group_write
-			| perms::others_write))  
-			!= perms::none;
+					outErrorResult = oss.str();
+					return false;
+				}
 
-		if (!canWrite)
-		{
-			oss << "Failed to delete target '" << target << "' because of insufficient write permissions!";
+				if (extensionOrName.empty())
+				{
+					oss << "Failed to get files relative to path '" << dir
+						<< "' because no extension or name value was passed!";
 
-			return oss.str();
-		}
+					outErrorResult = oss.str();
+					return false;
+				}
 
-		try
-		{
-			if (is_regular_file(target)) remove(target);
-			else if (is_directory(target)) remove_all(target);
-		}
-		catch (exception& e)
-		{
-			oss << "Failed to delete '"
-				<< target << "'! Reason: " << e.what();
+				if (extensionOrName == ".")
+				{
+					oss << "Failed to get files relative to path '" << dir
+						<< "' because the extension or name value '" << extensionOrName << "' has no value on both sides of the dot!";
 
-			return oss.str();
-		}
+					outErrorResult = oss.str();
+					return false;
+				}
 
-		return{};
-	}
+				auto splitstring = [](
+					string_view origin,
+					string_view splitter) -> vector<string>
+					{
+						vector<string> splitResult{};
+						size_t start{};
+						size_t pos{};
 
-	//Copy file or folder from origin to target, with optional overwrite flag
-	inline string CopyPath(
-		const path& origin,
-		const path& target,
-		bool overwrite = false)
-	{
-		ostringstream oss{};
+						while ((pos = origin.find(splitter, start)) != string::npos)
+						{
+							splitResult.emplace_back(origin.substr(start, pos - start));
+							start = pos + splitter.length();
+						}
 
-		if (!exists(origin))
-		{
-			oss << "Failed to copy origin to target because origin '"
-				<< origin << "' does not exist!";
+						//push the remainder (or whole string if no delimiter was found)
+						splitResult.emplace_back(origin.substr(start));
 
-			return oss.str();
-		}
-		if (exists(target)
-			&& overwrite)
-		{
-			string result = DeletePath(target);
-			if (!result.empty())
-			{
-				oss << "Failed to copy origin '"
-					<< origin << "' to target '"
-					<< target << "' because overwrite was enabled and target couldn't be deleted! Reason: " << result;
+						return splitResult;
+					};
 
-				return oss.str();
-			}
-		}
-		if (is_directory(origin)
-			&& target.has_extension())
-		{
-			oss << "Failed to copy origin '" << origin << "' to '"
-				<< target << "' because origin is a directory but target has an extension!";
+				vector<string> splitpath = splitstring(
+					extensionOrName,
+					".");
 
-			return oss.str();
-		}
-		if (is_regular_file(origin)
-			&& target.empty())
-		{
-			oss << "Failed to copy origin '" << origin << "' to '"
-				<< target << "' because origin is a file but target is empty!";
+				if (splitpath.size() > 2)
+				{
+					oss << "Failed to get files relative to path '" << dir
+						<< "' because the extension or name value '" << extensionOrName << "' has more than one dot!";
 
-			return oss.str();
-		}
-		
-		path baseDirOrigin = origin.parent_path().empty()
-			? "."
-			: origin.parent_path();
+					outErrorResult = oss.str();
+					return false;
+				}
 
-		auto fileStatusOrigin = status(baseDirOrigin);
-		auto filePermsOrigin = fileStatusOrigin.permissions();
-		
-		bool canWriteOrigin = (filePermsOrigin & (
-			perms::owner_write
-			| perms::group_write
-			| perms::others_write))  
-			!= perms::none;
+				string_view name = splitpath[0];
+				string_view extension = splitpath[1];
 
-		if (!canWriteOrigin)
-		{
-			oss << "Failed to copy origin '" << origin << "' to target '" << target << "' because of insufficient write permissions for origin!";
+				if (name != "*"
+					&& extension != "*")
+				{
+					oss << "Failed to get files relative to path '" << dir
+						<< "' because neither the extension or name value '" << extensionOrName << "' was an asterisk!";
 
-			return oss.str();
-		}
-		
-		path baseDirTarget = target.parent_path().empty()
-			? "."
-			: target.parent_path();
+					outErrorResult = oss.str();
+					return false;
+				}
 
-		auto fileStatusTarget = status(baseDirTarget);
-		auto filePermsTarget = fileStatusTarget.permissions();
-		
-		bool canWriteTarget = (filePermsTarget & (
-			perms::owner_write
-			| perms::group_write
-			| perms::others_write))  
-			!= perms::none;
+				outExtension = extension;
+				outName = name;
 
-		if (!canWriteTarget)
-		{
-			oss << "Failed to copy origin '" << origin << "' to target '" << target << "' because of insufficient write permissions for target!";
+				return true;
+			};
 
-			return oss.str();
-		}
+		string extension{};
+		string name{};
+		string errorResult{};
 
-		try
+		if (!is_valid_star_pattern(
+			extensionOrName,
+			extension,
+			name,
+			errorResult))
 		{
-			if (is_regular_file(origin))
-			{
-				copy_file(
-					origin,
-					target,
-					overwrite
-					? copy_options::overwrite_existing
-					: copy_options::skip_existing);
-			}
-			else if (is_directory(origin))
-			{
-				copy(
-					origin,
-					target,
-					overwrite
-					? copy_options::overwrite_existing
-					| copy_options::recursive
-					: copy_options::skip_existing
-					| copy_options::recursive);
-			}
+			return errorResult;
 		}
-		catch (exception& e)
-		{
-			oss << "Failed to copy '"
-				<< origin << "' to target '"
-				<< target << "'! Reason: " << e.what();
 
-			return oss.str();
-		}
+		auto fileStatus = status(dir);
+		auto filePerms = fileStatus.permissions();
 
-		return{};
-	}
+		bool canRead = (filePerms & (
+			perms::owner_read
+			| perms::group_read
+			| perms::others_read))
+			!= perms::none;
 
-	//Move file or folder from origin to target, target is always overwritten if it already exists
-	inline string MovePath(
-		const path& origin,
-		const path& target)
-	{
 		ostringstream oss{};
 
-		if (!exists(origin))
+		if (!canRead)
 		{
-			oss << "Failed to move origin to target because origin '"
-				<< origin << "' does not exist!";
+			oss << "Failed to get files relative to path '" << dir << "' because of insufficient read permissions!";
 
 			return oss.str();
 		}
-		if (exists(target))
-		{
-			string result = DeletePath(target);
-			if (!result.empty())
-			{
-				oss << "Failed to move origin '"
-					<< origin << "' to target '"
-					<< target << "' because it existed and it couldn't be deleted! Reason: " << result;
 
-				return oss.str();
-			}
-		}
-		if (is_directory(origin)
-			&& target.has_extension())
-		{
-			oss << "Failed to move origin '" << origin << "' to '"
-				<< target << "' because origin is a directory but target has an extension!";
+		//directories are filtered by the callers so the scanned
+		//entries don't need another status call per file
+		auto is_valid_name = [&name, &extension](const path& target)
+			{
+				return extension == "*"
+					&& target.has_extension()
+					&& target.stem() == name;
+			};
+		auto is_valid_extension = [&name, &extension](const path& target)
+			{
+				return name == "*"
+					&& target.has_filename()
+					&& target.extension() == "." + string(extension);
+			};
 
-			return oss.str();
-		}
-		if (is_regular_file(origin)
-			&& target.empty())
+		try
 		{
-			oss << "Failed to move origin '" << origin << "' to '"
-				<< target << "' because origin is a file but target is empty!";
-
-			return oss.str();
-		}
-		
-		auto fileStatusOrigin = status(origin.parent_path());
-		auto filePermsOrigin = fileStatusOrigin.permissions();
-		
-		bool canWriteOrigin = (filePermsOrigin & (
-			perms::owner_write
-			| perms::group_write
-			| perms::others_write))  
-			!= perms::none;
+			if (recursive)
+			{
+				DirectorySnapshot snapshot{};
+				string result = ScanDirectory(
+					dir,
+					snapshot,
+					threadCount);
 
-		if (!canWriteOrigin)
-		{
-			oss << "Failed to move origin '" << origin << "' to target '" << target << "' because of insufficient write permissions for origin!";
+				if (!result.empty()) return result;
 
-			return oss.str();
-		}
+				const size_t firstNew = outPaths.size();
 
-		path baseDirTarget = target.parent_path().empty()
-			? "."
-			: target.parent_path();
-		
-		auto fileStatusTarget = status(baseDirTarget);
-		auto filePermsTarget = fileStatusTarget.permissions();
-		
-		bool canWriteTarget = (filePermsTarget & (
-			perms::owner_write
-			| perms::group_write
-			| perms::others_write))  
-			!= perms::none;
+				for (const auto& scanned : snapshot.directories)
+				{
+					for (const auto& entry : scanned.entries)
+					{
+						if (entry.isDirectory) continue;
 
-		if (!canWriteTarget)
-		{
-			oss << "Failed to move origin '" << origin << "' to target '" << target << "' because of insufficient write permissions for target!";
+						if (is_valid_name(entry.name)
+							|| is_valid_extension(entry.name))
+						{
+							outPaths.push_back(scanned.dirPath / entry.name);
+						}
+					}
+				}
 
-			return oss.str();
-		}
+				//directories are sorted but a file can sort after a subdirectory
+				//of its own directory, so the full paths are sorted once more
+				sort(
+					outPaths.begin() + scast<ptrdiff_t>(firstNew),
+					outPaths.end());
+			}
+			else
+			{
+				for (auto& entry : directory_iterator(dir))
+				{
+					if (entry.is_directory()) continue;
 
-		try
-		{
-			rename(origin, target);
+					if (is_valid_name(entry.path())
+						|| is_valid_extension(entry.path()))
+					{
+						outPaths.push_back(entry.path());
+					}
+				}
+			}
 		}
 		catch (exception& e)
 		{
-			oss << "Failed to move '"
-				<< origin << "' to target '"
-				<< target << "'! Reason: " << e.what();
+			oss << "Failed to get files relative to path '" << dir << "'! Reason: " << e.what();
 
 			return oss.str();
 		}
@@ -1486,26 +1777,24 @@ namespace KalaHeaders::KalaFile
 		return{};
 	}
 
-	//
-	// FILE METADATA
-	//
-
-	//Get the size of the target file in bytes
-	inline string GetFileSize(
+	//List all the contents of a folder,
+	//can search recursively if recursive is true
+	inline string ListDirectoryContents(
 		const path& target,
-		uintmax_t& outSize)
+		vector<path>& outEntries,
+		bool recursive = false)
 	{
 		ostringstream oss{};
 
 		if (!exists(target))
 		{
-			oss << "Failed to get target file '" << target << "' size because it does not exist!";
+			oss << "Failed to list paths from target '" << target << "' because it does not exist!";
 
 			return oss.str();
 		}
-		if (!is_regular_file(target))
+		if (!is_directory(target))
 		{
-			oss << "Failed to get target file '" << target << "' size because it is not a regular file!";
+			oss << "Failed to list paths from target '" << target << "' because it is not a directory!";
 
 			return oss.str();
 		}
@@ -1525,18 +1814,31 @@ namespace KalaHeaders::KalaFile
 		
 		if (!canRead)
 		{
-			oss << "Failed to get file size from target '" << target << "' because of insufficient read permissions!";
+			oss << "Failed to list directory contents from target '" << target << "' because of insufficient read permissions!";
 
 			return oss.str();
 		}
 
 		try
 		{
-			outSize = file_size(target);
+			if (recursive)
+			{
+				for (auto& entry : recursive_directory_iterator(target))
+				{
+					outEntries.push_back(entry.path());
+				}
+			}
+			else
+			{
+				for (auto& entry : directory_iterator(target))
+				{
+					outEntries.push_back(entry.path());
+				}
+			}
 		}
 		catch (exception& e)
 		{
-			oss << "Failed to get target file '" << target << "' size! Reason: " << e.what();
+			oss << "Failed to list paths from target '" << target << "'! Reason: " << e.what();
 
 			return oss.str();
 		}
@@ -1544,23 +1846,33 @@ namespace KalaHeaders::KalaFile
 		return{};
 	}
 
-	//Get the size of the target directory in bytes
-	inline string GetDirectorySize(
+	//Rename file or folder in its current directory
+	inline string RenamePath(
 		const path& target,
-		uintmax_t& outSize)
+		string_view newName)
 	{
 		ostringstream oss{};
-		uintmax_t totalSize{};
 
 		if (!exists(target))
 		{
-			oss << "Failed to get target directory '" << target << "' size because it does not exist!";
+			oss << "Failed to rename target '" << target << "' to '"
+				<< newName << "' because it does not exist!";
 
 			return oss.str();
 		}
-		if (!is_directory(target))
+		if (is_directory(target)
+			&& path(newName).has_extension())
 		{
-			oss << "Failed to get target directory '" << target << "' size because it is not a directory!";
+			oss << "Failed to rename target '" << target << "' to '"
+				<< newName << "' because target is a directory but new name has an extension!";
+
+			return oss.str();
+		}
+		if (is_regular_file(target)
+			&& newName.empty())
+		{
+			oss << "Failed to rename target '" << target << "' to '"
+				<< newName << "' because target is a file but new name is empty!";
 
 			return oss.str();
 		}
@@ -1572,44 +1884,29 @@ namespace KalaHeaders::KalaFile
 		auto fileStatus = status(baseDir);
 		auto filePerms = fileStatus.permissions();
 		
-		bool canRead = (filePerms & (
-			perms::owner_read
-			| perms::group_read
-			| perms::others_read))  
+		bool canWrite = (filePerms & (
+			perms::owner_write
+			| perms::group_write
+			| perms::others_write))  
 			!= perms::none;
-		
-		if (!canRead)
+
+		if (!canWrite)
 		{
-			oss << "Failed to get directory size from target '" << target << "' because of insufficient read permissions!";
+			oss << "Failed to rename target '" << target << "' because of insufficient write permissions!";
 
 			return oss.str();
 		}
 
 		try
 		{
-			for (const auto& file : recursive_directory_iterator(target))
-			{
-				//skip directories
-				if (is_directory(file)) continue;
-
-				uintmax_t fileSize{};
-				string result = GetFileSize(file, fileSize);
-
-				if (!result.empty())
-				{
-					oss << "Failed to get target directory '"
-						<< target << "' size because one of its file sizes couldn't be read! Reason: '" << result;
-
-					return oss.str();
-				}
-
-				totalSize += fileSize;
-			}
-			outSize = totalSize;
+			path newTarget = target.parent_path() / newName;
+			rename(target, newTarget);
 		}
 		catch (exception& e)
 		{
-			oss << "Failed to get target directory '" << target << "' size! Reason: " << e.what();
+			oss << "Failed to rename '"
+				<< target << "' to '"
+				<< newName << "'! Reason: " << e.what();
 
 			return oss.str();
 		}
@@ -1617,23 +1914,15 @@ namespace KalaHeaders::KalaFile
 		return{};
 	}
 
-	//Get the count of lines in a text file
-	inline string GetTextFileLineCount(
-		const path& target,
-		size_t& outCount)
+	//Delete file or folder in target path (recursive for directories)
+	inline string DeletePath(const path& target)
 	{
 		ostringstream oss{};
-		size_t totalCount{};
 
 		if (!exists(target))
 		{
-			oss << "Failed to get target '" << target << "' line count because it does not exist!";
-
-			return oss.str();
-		}
-		if (!is_regular_file(target))
-		{
-			oss << "Failed to get target '" << target << "' line count because it is not a regular file!";
+			oss << "Failed to delete target '"
+				<< target << "' because it does not exist!";
 
 			return oss.str();
 		}
@@ -1645,61 +1934,28 @@ namespace KalaHeaders::KalaFile
 		auto fileStatus = status(baseDir);
 		auto filePerms = fileStatus.permissions();
 		
-		bool canRead = (filePerms & (
-			perms::owner_read
-			| perms::group_read
-			| perms::others_read))  
+		bool canWrite = (filePerms & (
+			perms::owner_write
+			| perms::group_write
+			| perms::others_write))  
 			!= perms::none;
-		
-		if (!canRead)
+
+		if (!canWrite)
 		{
-			oss << "Failed to get text file line count from target '" << target << "' because of insufficient read permissions!";
+			oss << "Failed to delete target '" << target << "' because of insufficient write permissions!";
 
 			return oss.str();
 		}
 
 		try
 		{
-			ifstream in(
-				target, 
-				ios::in);
-
-			if (in.fail()
-				&& errno != 0)
-			{
-				int err = errno;
-
-				char errbuf[256]{};
-#ifdef _WIN32
-				strerror_s(errbuf, sizeof(errbuf), err);
-#else
-				strerror_r(err, errbuf, sizeof(errbuf));
-#endif
-
-				oss << "Failed to get target '" << target
-					<< "' line count because it couldn't be opened! "
-					<< "Reason: (errno " << err << "): " << errbuf;
-
-				return oss.str();
-			}
-
-			string tmp{};
-			while (getline(in, tmp)) ++totalCount;
-
-			if (totalCount == 0)
-			{
-				oss << "Failed to get target '" << target << "' line count because it had no lines!";
-
-				return oss.str();
-			}
-
-			outCount = totalCount;
-
-			in.close();
+			if (is_regular_file(target)) remove(target);
+			else if (is_directory(target)) remove_all(target);
 		}
 		catch (exception& e)
 		{
-			oss << "Failed to get target '" << target << "' line count! Reason: " << e.what();
+			oss << "Failed to delete '"
+				<< target << "'! Reason: " << e.what();
 
 			return oss.str();
 		}
@@ -1707,72 +1963,119 @@ namespace KalaHeaders::KalaFile
 		return{};
 	}
 
-	//Set the extension of the target
-	inline string SetPathExtension(
+	//Copy file or folder from origin to target, with optional overwrite flag
+	inline string CopyPath(
+		const path& origin,
 		const path& target,
-		string_view newExtension,
-		string& outResult)
+		bool overwrite = false)
 	{
 		ostringstream oss{};
 
-		if (!exists(target))
+		if (!exists(origin))
 		{
-			oss << "Failed to set target '"
-				<< target << "' extension because it does not exist!";
+			oss << "Failed to copy origin to target because origin '"
+				<< origin << "' does not exist!";
 
 			return oss.str();
 		}
-		if (!is_regular_file(target))
+		if (exists(target)
+			&& overwrite)
 		{
-			oss << "Failed to set extension for target '"
-				<< target << "' because it is not a regular file!";
+			string result = DeletePath(target);
+			if (!result.empty())
+			{
+				oss << "Failed to copy origin '"
+					<< origin << "' to target '"
+					<< target << "' because overwrite was enabled and target couldn't be deleted! Reason: " << result;
+
+				return oss.str();
+			}
+		}
+		if (is_directory(origin)
+			&& target.has_extension())
+		{
+			oss << "Failed to copy origin '" << origin << "' to '"
+				<< target << "' because origin is a directory but target has an extension!";
+
+			return oss.str();
+		}
+		if (is_regular_file(origin)
+			&& target.empty())
+		{
+			oss << "Failed to copy origin '" << origin << "' to '"
+				<< target << "' because origin is a file but target is empty!";
 
 			return oss.str();
 		}
 		
-		path baseDir = target.parent_path().empty()
+		path baseDirOrigin = origin.parent_path().empty()
 			? "."
-			: target.parent_path();
+			: origin.parent_path();
 
-		auto fileStatus = status(baseDir);
-		auto filePerms = fileStatus.permissions();
+		auto fileStatusOrigin = status(baseDirOrigin);
+		auto filePermsOrigin = fileStatusOrigin.permissions();
 		
-		bool canWrite = (filePerms & (
+		bool canWriteOrigin = (filePermsOrigin & (
 			perms::owner_write
 			| perms::group_write
 			| perms::others_write))  
 			!= perms::none;
-		
-		if (!canWrite)
+
+		if (!canWriteOrigin)
 		{
-			oss << "Failed to set path extension for target '" << target << "' because of insufficient write permissions!";
+			oss << "Failed to copy origin '" << origin << "' to target '" << target << "' because of insufficient write permissions for origin!";
 
 			return oss.str();
 		}
+		
+		path baseDirTarget = target.parent_path().empty()
+			? "."
+			: target.parent_path();
 
-		try
+		auto fileStatusTarget = status(baseDirTarget);
+		auto filePermsTarget = fileStatusTarget.permissions();
+		
+		bool canWriteTarget = (filePermsTarget & (
+			perms::owner_write
+			| perms::group_write
+			| perms::others_write))  
+			!= perms::none;
+
+		if (!canWriteTarget)
 		{
-			path newTarget = target;
-			newTarget.replace_extension(newExtension);
+			oss << "Failed to copy origin '" << origin << "' to target '" << target << "' because of insufficient write permissions for target!";
 
-			string result = RenamePath(
-				target,
-				newTarget.filename().string());
+			return oss.str();
+		}
 
-			if (!result.empty())
+		try
+		{
+			if (is_regular_file(origin))
 			{
-				oss << "Failed to set target extension to '"
-					<< newExtension << "' because RenameTarget failed! Reason: " << result;
-
-				return oss.str();
+				copy_file(
+					origin,
+					target,
+					overwrite
+					? copy_options::overwrite_existing
+					: copy_options::skip_existing);
+			}
+			else if (is_directory(origin))
+			{
+				copy(
+					origin,
+					target,
+					overwrite
+					? copy_options::overwrite_existing
+					| copy_options::recursive
+					: copy_options::skip_existing
+					| copy_options::recursive);
 			}
-
-			outResult = newTarget.string();
 		}
 		catch (exception& e)
 		{
-			oss << "Failed to set extension for target '"
-				<< target << "' to '" + string(newExtension) + "'! Reason: " << e.what();
+			oss << "Failed to copy '"
+				<< origin << "' to target '"
+				<< target << "'! Reason: " << e.what();
 
 			return oss.str();
 		}
@@ -1780,136 +2083,121 @@ namespace KalaHeaders::KalaFile
 		return{};
 	}
 
-	//
-	// TEXT I/O
-	//
-
-	//Write all text from a string to a text file, with optional append and overwrite flags.
-	//A new file is created at target path if it doesn't already exist
-	inline string WriteTextToFile(
-		const path& target,
-		string_view inText,
-		bool append,
-		bool overwrite)
+	//Move file or folder from origin to target, target is always overwritten if it already exists
+	inline string MovePath(
+		const path& origin,
+		const path& target)
 	{
 		ostringstream oss{};
 
-		if (exists(target)
-			&& !is_regular_file(target))
+		if (!exists(origin))
 		{
-			oss << "Failed to write text to target '" << target << "' because it is not a regular file!";
+			oss << "Failed to move origin to target because origin '"
+				<< origin << "' does not exist!";
 
 			return oss.str();
 		}
-		if (inText.empty())
+		if (exists(target))
 		{
-			oss << "Failed to write text to target '" << target << "' because inText string is empty!";
+			string result = DeletePath(target);
+			if (!result.empty())
+			{
+				oss << "Failed to move origin '"
+					<< origin << "' to target '"
+					<< target << "' because it existed and it couldn't be deleted! Reason: " << result;
+
+				return oss.str();
+			}
+		}
+		if (is_directory(origin)
+			&& target.has_extension())
+		{
+			oss << "Failed to move origin '" << origin << "' to '"
+				<< target << "' because origin is a directory but target has an extension!";
 
 			return oss.str();
 		}
-		
-		path baseDir = target.parent_path().empty()
-			? "."
-			: target.parent_path();
+		if (is_regular_file(origin)
+			&& target.empty())
+		{
+			oss << "Failed to move origin '" << origin << "' to '"
+				<< target << "' because origin is a file but target is empty!";
 
-		auto fileStatus = status(baseDir);
-		auto filePerms = fileStatus.permissions();
+			return oss.str();
+		}
 		
-		bool canWrite = (filePerms & (
+		auto fileStatusOrigin = status(origin.parent_path());
+		auto filePermsOrigin = fileStatusOrigin.permissions();
+		
+		bool canWriteOrigin = (filePermsOrigin & (
 			perms::owner_write
 			| perms::group_write
 			| perms::others_write))  
 			!= perms::none;
-		
-		if (!canWrite)
+
+		if (!canWriteOrigin)
 		{
-			oss << "Failed to write text to target '" << target << "' because of insufficient write permissions!";
+			oss << "Failed to move origin '" << origin << "' to target '" << target << "' because of insufficient write permissions for origin!";
 
 			return oss.str();
 		}
 
-		if (overwrite
-			&& exists(target))
-		{
-			string deleteResult = DeletePath(target);
+		path baseDirTarget = target.parent_path().empty()
+			? "."
+			: target.parent_path();
+		
+		auto fileStatusTarget = status(baseDirTarget);
+		auto filePermsTarget = fileStatusTarget.permissions();
+		
+		bool canWriteTarget = (filePermsTarget & (
+			perms::owner_write
+			| perms::group_write
+			| perms::others_write))  
+			!= perms::none;
 
-			if (!deleteResult.empty())
-			{
-				oss << "Failed to delete existing file before writing text to target '" << target << "'! Reason: " + deleteResult;
+		if (!canWriteTarget)
+		{
+			oss << "Failed to move origin '" << origin << "' to target '" << target << "' because of insufficient write permissions for target!";
 
-				return oss.str();	
-			}
+			return oss.str();
 		}
 
 		try
 		{
-			ofstream out;
-
-			if (append)
-			{
-				out.open(
-					target,
-					ios::out
-					| ios::app);
-			}
-			else
-			{
-				out.open(
-					target,
-					ios::out
-					| ios::trunc);
-			}
-
-			if (out.fail()
-				&& errno != 0)
-			{
-				int err = errno;
-
-				char errbuf[256]{};
-
-#ifdef _WIN32
-				strerror_s(errbuf, sizeof(errbuf), err);
-#else
-				strerror_r(err, errbuf, sizeof(errbuf));
-#endif
-
-				oss << "Failed to write text to target '" << target
-					<< "' because it couldn't be opened! "
-					<< "Reason: (errno " << err << "): " << errbuf;
-
-				return oss.str();
-			}
-
-			out << inText;
-
-			out.close();
+			rename(origin, target);
 		}
 		catch (exception& e)
 		{
-			oss << "Failed to write text to target '" << target << "'! Reason: " << e.what();
+			oss << "Failed to move '"
+				<< origin << "' to target '"
+				<< target << "'! Reason: " << e.what();
 
 			return oss.str();
 		}
 
 		return{};
 	}
-	//Read all text from a file into a string
-	inline string ReadTextFromFile(
-		const path& target, 
-		string& outText)
+
+	//
+	// FILE METADATA
+	//
+
+	//Get the size of the target file in bytes
+	inline string GetFileSize(
+		const path& target,
+		uintmax_t& outSize)
 	{
 		ostringstream oss{};
-		string allText{};
 
 		if (!exists(target))
 		{
-			oss << "Failed to read text from target '" << target << "' because it does not exist!";
+			oss << "Failed to get target file '" << target << "' size because it does not exist!";
 
 			return oss.str();
 		}
 		if (!is_regular_file(target))
 		{
-			oss << "Failed to read text from target '" << target << "' because it is not a regular file!";
+			oss << "Failed to get target file '" << target << "' size because it is not a regular file!";
 
 			return oss.str();
 		}
@@ -1929,57 +2217,18 @@ namespace KalaHeaders::KalaFile
 		
 		if (!canRead)
 		{
-			oss << "Failed to get text from target '" << target << "' because of insufficient read permissions!";
+			oss << "Failed to get file size from target '" << target << "' because of insufficient read permissions!";
 
 			return oss.str();
 		}
 
 		try
 		{
-			ifstream in(
-				target,
-				ios::in);
-
-			if (in.fail()
-				&& errno != 0)
-			{
-				int err = errno;
-
-				char errbuf[256]{};
-
-#ifdef _WIN32
-				strerror_s(errbuf, sizeof(errbuf), err);
-#else
-				strerror_r(err, errbuf, sizeof(errbuf));
-#endif
-
-				oss << "Failed to read text from target '" << target
-					<< "' because it couldn't be opened! "
-					<< "Reason: (errno " << err << "): " << errbuf;
-
-				return oss.str();
-			}
-
-			ostringstream buffer{};
-
-			buffer << in.rdbuf();
-			allText = buffer.str();
-
-			in.close();
-
-			if (allText.empty())
-			{
-				oss << "Failed to read text from target '" << target << "' because it was empty!";
-
-				return oss.str();
-			}
-
-			//successfully got data
-			outText = allText;
+			outSize = file_size(target);
 		}
 		catch (exception& e)
 		{
-			oss << "Failed to read text from target '" << target << "'! Reason: " << e.what();
+			oss << "Failed to get target file '" << target << "' size! Reason: " << e.what();
 
 			return oss.str();
 		}
@@ -1987,26 +2236,27 @@ namespace KalaHeaders::KalaFile
 		return{};
 	}
 
-	//Write all lines from a vector to a text file, with optional append and overwrite flags.
-	//A new file is created at target path if it doesn't already exist
-	inline string WriteLinesToFile(
+	//Get the size of the target directory in bytes,
+	//scans across threadCount threads (0 uses all hardware threads)
+	inline string GetDirectorySize(
 		const path& target,
-		const vector<string>& inLines,
-		bool append,
-		bool overwrite)
+		uintmax_t& outSize,
+		u32 threadCount = 1)
 	{
+		KPROFILE_ZONE("GetDirectorySize");
+
 		ostringstream oss{};
+		uintmax_t totalSize{};
 
-		if (exists(target)
-			&& !is_regular_file(target))
+		if (!exists(target))
 		{
-			oss << "Failed to write lines to target '" << target << "' because it is not a regular file!";
+			oss << "Failed to get target directory '" << target << "' size because it does not exist!";
 
 			return oss.str();
 		}
-		if (inLines.empty())
+		if (!is_directory(target))
 		{
-			oss << "Failed to write lines to target '" << target << "' because inLines vector is empty!";
+			oss << "Failed to get target directory '" << target << "' size because it is not a directory!";
 
 			return oss.str();
 		}
@@ -2018,108 +2268,118 @@ namespace KalaHeaders::KalaFile
 		auto fileStatus = status(baseDir);
 		auto filePerms = fileStatus.permissions();
 		
-		bool canWrite = (filePerms & (
-			perms::owner_write
-			| perms::group_write
-			| perms::others_write))  
+		bool canRead = (filePerms & (
+			perms::owner_read
+			| perms::group_read
+			| perms::others_read))  
 			!= perms::none;
 		
-		if (!canWrite)
+		if (!canRead)
 		{
-			oss << "Failed to write lines to target '" << target << "' because of insufficient write permissions!";
+			oss << "Failed to get directory size from target '" << target << "' because of insufficient read permissions!";
 
 			return oss.str();
 		}
 
-		if (overwrite
-			&& exists(target))
-		{
-			string deleteResult = DeletePath(target);
-
-			if (!deleteResult.empty())
-			{
-				oss << "Failed to delete existing file before writing lines to target '" << target << "'! Reason: " + deleteResult;
-
-				return oss.str();	
-			}
-		}
-
 		try
 		{
-			ofstream out;
-
-			if (append)
-			{
-				out.open(
-					target,
-					ios::out
-					| ios::app);
-			}
-			else
-			{
-				out.open(
-					target,
-					ios::out
-					| ios::trunc);
-			}
+			//sizes come from the scan itself instead of a status call per file
+			DirectorySnapshot snapshot{};
+			string result = ScanDirectory(
+				target,
+				snapshot,
+				threadCount);
 
-			if (out.fail()
-				&& errno != 0)
+			if (!result.empty())
 			{
-				int err = errno;
-
-				char errbuf[256]{};
-
-#ifdef _WIN32
-				strerror_s(errbuf, sizeof(errbuf), err);
-#else
-				strerror_r(err, errbuf, sizeof(errbuf));
-#endif
-
-				oss << "Failed to write lines to target '" << target
-					<< "' because it couldn't be opened! "
-					<< "Reason: (errno " << err << "): " << errbuf;
+				oss << "Failed to get target directory '"
+					<< target << "' size because it couldn't be scanned! Reason: '" << result;
 
 				return oss.str();
 			}
 
-			for (size_t i = 0; i < inLines.size(); ++i)
-			{
-				out << inLines[i] << "\n";
-			}
-
-			out.close();
+			totalSize = snapshot.GetTotalSize();
+			outSize = totalSize;
 		}
 		catch (exception& e)
 		{
-			oss << "Failed to write lines to target '" << target << "'! Reason: " << e.what();
+			oss << "Failed to get target directory '" << target << "' size! Reason: " << e.what();
 
 			return oss.str();
 		}
 
 		return{};
 	}
-	//Read all lines from a file into a vector of strings with optional 
-	//lineStart and lineEnd values to avoid placing all lines to memory.
-	//If lineEnd is 0 and lineStart isnt, then this function defaults end to EOF
-	inline string ReadLinesFromFile(
-		const path& target,
-		vector<string>& outLines,
-		size_t lineStart = 0,
-		size_t lineEnd = 0)
+
+	//Returns how many '\n' bytes there are in data, whole 16-byte blocks are counted with SIMD
+	inline size_t CountNewlines(
+		const char* data,
+		size_t size)
+	{
+		const u8* bytes = rcast<const u8*>(data);
+		
+		size_t count{};
+		size_t pos{};
+		
+#if defined(KFILE_SSE2)
+		const __m128i newline = _mm_set1_epi8('\n');
+		while (pos + 16 <= size)
+		{
+			//per-byte counters can take 255 blocks before they overflow
+			const size_t blocks = min((size - pos) / 16, size_t{ 255 });
+			
+			__m128i counters = _mm_setzero_si128();
+			for (size_t b = 0; b < blocks; ++b, pos += 16)
+			{
+				const __m128i v = _mm_loadu_si128(rcast<const __m128i*>(bytes + pos));
+				counters = _mm_sub_epi8(counters, _mm_cmpeq_epi8(v, newline));
+			}
+			
+			const __m128i sums = _mm_sad_epu8(counters, _mm_setzero_si128());
+			count += 
+				scast<size_t>(_mm_cvtsi128_si32(sums))
+				+ scast<size_t>(_mm_extract_epi16(sums, 4));
+		}
+#elif defined(KFILE_NEON)
+		const uint8x16_t newline = vdupq_n_u8('\n');
+		while (pos + 16 <= size)
+		{
+			//per-byte counters can take 255 blocks before they overflow
+			const size_t blocks = min((size - pos) / 16, size_t{ 255 });
+			
+			uint8x16_t counters = vdupq_n_u8(0);
+			for (size_t b = 0; b < blocks; ++b, pos += 16)
+			{
+				counters = vsubq_u8(counters, vceqq_u8(vld1q_u8(bytes + pos), newline));
+			}
+			
+			count += vaddlvq_u8(counters);
+		}
+#endif
+		for (; pos < size; ++pos) count += bytes[pos] == '\n';
+		
+		return count;
+	}
+
+	//Get the count of lines in a text file
+	inline string GetTextFileLineCount(
+		const path& target,
+		size_t& outCount)
 	{
+		KPROFILE_ZONE("GetTextFileLineCount");
+
 		ostringstream oss{};
-		vector<string> allLines{};
+		size_t totalCount{};
 
 		if (!exists(target))
 		{
-			oss << "Failed to read lines from target '" << target << "' because it does not exist!";
+			oss << "Failed to get target '" << target << "' line count because it does not exist!";
 
 			return oss.str();
 		}
 		if (!is_regular_file(target))
 		{
-			oss << "Failed to read lines from target '" << target << "' because it is not a regular file!";
+			oss << "Failed to get target '" << target << "' line count because it is not a regular file!";
 
 			return oss.str();
 		}
@@ -2139,7 +2399,7 @@ namespace KalaHeaders::KalaFile
 		
 		if (!canRead)
 		{
-			oss << "Failed to read lines from target '" << target << "' because of insufficient read permissions!";
+			oss << "Failed to get text file line count from target '" << target << "' because of insufficient read permissions!";
 
 			return oss.str();
 		}
@@ -2147,8 +2407,9 @@ namespace KalaHeaders::KalaFile
 		try
 		{
 			ifstream in(
-				target,
-				ios::in);
+				target, 
+				ios::in
+				| ios::binary);
 
 			if (in.fail()
 				&& errno != 0)
@@ -2156,97 +2417,52 @@ namespace KalaHeaders::KalaFile
 				int err = errno;
 
 				char errbuf[256]{};
-
 #ifdef _WIN32
 				strerror_s(errbuf, sizeof(errbuf), err);
 #else
 				strerror_r(err, errbuf, sizeof(errbuf));
 #endif
 
-				oss << "Failed to read lines from target '" << target
-					<< "' because it couldn't be opened! "
+				oss << "Failed to get target '" << target
+					<< "' line count because it couldn't be opened! "
 					<< "Reason: (errno " << err << "): " << errbuf;
 
 				return oss.str();
 			}
 
-			size_t totalLines{};
-			string result = GetTextFileLineCount(target, totalLines);
-
-			if (!result.empty())
-			{
-				oss << "Failed to read lines from target '"
-					<< target << "'! Reason: '" << result;
-
-				return oss.str();
-			}
-
-			if (lineEnd == 0) lineEnd = totalLines;
-
-			if (lineEnd <= lineStart)
-			{
-				oss << "Failed to read lines from target '"
-					<< target << "' because lineEnd '"
-					<< lineEnd << "' is lower or equal to lineStart '" << lineStart << "'!";
-
-				return oss.str();
-			}
-			if (lineStart >= lineEnd)
+			//count newlines chunk by chunk, a last line without a newline counts too
+			vector<char> buffer(CHUNK_1MB);
+			char lastChar = '\n';
+			
+			while (in)
 			{
-				oss << "Failed to read lines from target '"
-					<< target << "' because lineStart '"
-					<< lineStart << "' is higher or equal to lineEnd '" << lineEnd << "'!";
+				in.read(buffer.data(), scast<streamsize>(buffer.size()));
+				
+				size_t readSize = scast<size_t>(in.gcount());
+				if (readSize == 0) break;
+				
+				totalCount += CountNewlines(buffer.data(), readSize);
+				lastChar = buffer[readSize - 1];
 
-				return oss.str();
+				KPROFILE_COUNTER("file bytes read", readSize);
 			}
-			if (lineStart >= totalLines)
-			{
-				oss << "Failed to read lines from target '"
-					<< target << "' because lineStart '"
-					<< lineStart << "' is higher or equal to totalLines '" << totalLines << "'!";
+			
+			if (lastChar != '\n') ++totalCount;
 
-				return oss.str();
-			}
-			if (lineEnd > totalLines)
+			if (totalCount == 0)
 			{
-				oss << "Failed to read lines from target '"
-					<< target << "' because lineEnd '"
-					<< lineEnd << "' is higher than totalLines '" << totalLines << "'!";
+				oss << "Failed to get target '" << target << "' line count because it had no lines!";
 
 				return oss.str();
 			}
 
-			string line{};
-			size_t currentLine{};
-			while (getline(in, line))
-			{
-				if (currentLine >= lineStart
-					&& currentLine < lineEnd)
-				{
-					allLines.push_back(line);
-				}
-				++currentLine;
-
-				if (currentLine >= lineEnd) break;
-			}
+			outCount = totalCount;
 
 			in.close();
-
-			size_t expected = lineEnd - lineStart;
-			if (allLines.size() != expected)
-			{
-				oss << "Failed to read lines from target '" << target << "'!"
-					<< " Expected size was '" << expected << "' lines but result was '" << allLines.size() << "' lines.";
-
-				return oss.str();
-			}
-
-			//successfully got data
-			outLines = std::move(allLines);
 		}
 		catch (exception& e)
 		{
-			oss << "Failed to read lines from target '" << target << "'! Reason: " << e.what();
+			oss << "Failed to get target '" << target << "' line count! Reason: " << e.what();
 
 			return oss.str();
 		}
@@ -2254,46 +2470,25 @@ namespace KalaHeaders::KalaFile
 		return{};
 	}
 
-	//
-	// BINARY I/O
-	//
-
-	//Simple helper to get binary chunk stream size for efficient binary reading
-	inline constexpr size_t GetBinaryChunkStreamSize(size_t fileSize)
-	{
-		//empty file
-		if (fileSize == 0) return 0;
-
-		//whole file is under 10MB, use as single chunk
-		if (fileSize < TEN_MB) return fileSize;
-
-		//whole file is 10MB to 1GB - return 64KB chunk size
-		if (fileSize < ONE_GB) return CHUNK_64KB;
-
-		//whole file size is over 1GB - return 1MB chunk size
-		return CHUNK_1MB;
-	}
-
-	//Write all binary data from a vector<uint8_t> to a file, with optional append and overwrite flags.
-	//A new file is created at target path if it doesn't already exist
-	inline string WriteBinaryDataToFile(
+	//Set the extension of the target
+	inline string SetPathExtension(
 		const path& target,
-		const vector<uint8_t>& inData,
-		bool append,
-		bool overwrite)
+		string_view newExtension,
+		string& outResult)
 	{
 		ostringstream oss{};
 
-		if (exists(target)
-			&& !is_regular_file(target))
+		if (!exists(target))
 		{
-			oss << "Failed to write binary to target '" << target << "' because it is not a regular file!";
+			oss << "Failed to set target '"
+				<< target << "' extension because it does not exist!";
 
 			return oss.str();
 		}
-		if (inData.empty())
+		if (!is_regular_file(target))
 		{
-			oss << "Failed to write binary to target '" << target << "' because inData vector is empty!";
+			oss << "Failed to set extension for target '"
+				<< target << "' because it is not a regular file!";
 
 			return oss.str();
 		}
@@ -2313,121 +2508,71 @@ namespace KalaHeaders::KalaFile
 		
 		if (!canWrite)
 		{
-			oss << "Failed to write binary data to target '" << target << "' because of insufficient write permissions!";
+			oss << "Failed to set path extension for target '" << target << "' because of insufficient write permissions!";
 
 			return oss.str();
 		}
 
-		if (overwrite
-			&& exists(target))
-		{
-			string deleteResult = DeletePath(target);
-
-			if (!deleteResult.empty())
-			{
-				oss << "Failed to delete existing file before writing binary data to target '" << target << "'! Reason: " + deleteResult;
-
-				return oss.str();	
-			}
-		}
-
 		try
 		{
-			ofstream out;
-
-			if (append)
-			{
-				out.open(
-					target,
-					ios::out
-					| ios::binary
-					| ios::app);
-			}
-			else
-			{
-				out.open(
-					target,
-					ios::out
-					| ios::binary
-					| ios::trunc);
-			}
-
-			if (out.fail()
-				&& errno != 0)
-			{
-				int err = errno;
-
-				char errbuf[256]{};
-
-#ifdef _WIN32
-				strerror_s(errbuf, sizeof(errbuf), err);
-#else
-				strerror_r(err, errbuf, sizeof(errbuf));
-#endif
-
-				oss << "Failed to write binary data to target '" << target
-					<< "' because it couldn't be opened! "
-					<< "Reason: (errno " << err << "): " << errbuf;
-
-				return oss.str();
-			}
+			path newTarget = target;
+			newTarget.replace_extension(newExtension);
 
-			out.write(
-				rcast<const char*>(inData.data()),
-				scast<streamsize>(inData.size()));
+			string result = RenamePath(
+				target,
+				newTarget.filename().string());
 
-			if (out.fail()
-				&& errno != 0)
+			if (!result.empty())
 			{
-				int err = errno;
-
-				char errbuf[256]{};
-
-#ifdef _WIN32
-				strerror_s(errbuf, sizeof(errbuf), err);
-#else
-				strerror_r(err, errbuf, sizeof(errbuf));
-#endif
-
-				oss << "Failed to write binary data to target '" << target
-					<< "' because it couldn't be opened! "
-					<< "Reason: (errno " << err << "): " << errbuf;
+				oss << "Failed to set target extension to '"
+					<< newExtension << "' because RenameTarget failed! Reason: " << result;
 
 				return oss.str();
 			}
 
-			out.close();
+			outResult = newTarget.string();
 		}
 		catch (exception& e)
 		{
-			oss << "Failed to write binary data to target '" << target << "'! Reason: " << e.what();
+			oss << "Failed to set extension for target '"
+				<< target << "' to '" + string(newExtension) + "'! Reason: " << e.what();
 
 			return oss.str();
 		}
 
 		return{};
 	}
-	//Read all binary data from a file into a vector<uint8_t> with optional 
-	//rangeStart and rangeEnd values to avoid placing whole binary file to memory.
-	//If rangeEnd is 0 and rangeStart isnt, then this function defaults end to EOF
-	inline string ReadBinaryDataFromFile(
+
+	//
+	// TEXT I/O
+	//
+
+	//Streams target in chunks of chunkSize bytes and calls onLine with a view of each line without its '\n',
+	//lines that cross chunk boundaries are joined in the same buffer so nothing is copied per line.
+	//The view is only valid during the call, onLine can return false to stop reading early.
+	//The buffer only grows past chunkSize for lines that are longer than it,
+	//if stripCarriageReturn is true then a '\r' before '\n' is also removed
+	template<typename F>
+		requires (invocable<F&, string_view>)
+	inline string ReadLinesChunked(
 		const path& target,
-		vector<uint8_t>& outData,
-		size_t rangeStart = 0,
-		size_t rangeEnd = 0)
+		F&& onLine,
+		size_t chunkSize = CHUNK_1MB,
+		bool stripCarriageReturn = true)
 	{
+		KPROFILE_ZONE("ReadLinesChunked");
+
 		ostringstream oss{};
-		vector<uint8_t> allData{};
 
 		if (!exists(target))
 		{
-			oss << "Failed to read binary from target '" << target << "' because it does not exist!";
+			oss << "Failed to read lines from target '" << target << "' because it does not exist!";
 
 			return oss.str();
 		}
 		if (!is_regular_file(target))
 		{
-			oss << "Failed to read binary from target '" << target << "' because it is not a regular file!";
+			oss << "Failed to read lines from target '" << target << "' because it is not a regular file!";
 
 			return oss.str();
 		}
@@ -2447,7 +2592,7 @@ namespace KalaHeaders::KalaFile
 		
 		if (!canRead)
 		{
-			oss << "Failed to read binary data from target '" << target << "' because of insufficient read permissions!";
+			oss << "Failed to read lines from target '" << target << "' because of insufficient read permissions!";
 
 			return oss.str();
 		}
@@ -2472,71 +2617,250 @@ namespace KalaHeaders::KalaFile
 				strerror_r(err, errbuf, sizeof(errbuf));
 #endif
 
-				oss << "Failed to read binary data from target '" << target
+				oss << "Failed to read lines from target '" << target
 					<< "' because it couldn't be opened! "
 					<< "Reason: (errno " << err << "): " << errbuf;
 
 				return oss.str();
 			}
+			
+			auto emit = [&onLine, stripCarriageReturn](
+				const char* begin,
+				const char* end) -> bool
+				{
+					if (stripCarriageReturn
+						&& end > begin
+						&& *(end - 1) == '\r')
+					{
+						--end;
+					}
+					
+					string_view line(begin, scast<size_t>(end - begin));
+					
+					if constexpr (is_same_v<invoke_result_t<F&, string_view>, bool>)
+					{
+						return onLine(line);
+					}
+					else
+					{
+						onLine(line);
+						return true;
+					}
+				};
+			
+			vector<char> buffer(max(chunkSize, size_t{ 1 }));
+			size_t filled{};
+			size_t scanFrom{};
+			
+			while (true)
+			{
+				in.read(
+					buffer.data() + filled,
+					scast<streamsize>(buffer.size() - filled));
+					
+				size_t readSize = scast<size_t>(in.gcount());
+				filled += readSize;
+				
+				KPROFILE_COUNTER("file bytes read", readSize);
+				
+				const char* data = buffer.data();
+				size_t lineStart{};
+				
+				//memchr is vectorized by the C library
+				while (const void* hit = memchr(data + scanFrom, '\n', filled - scanFrom))
+				{
+					size_t newline = scast<size_t>(scast<const char*>(hit) - data);
+					
+					if (!emit(data + lineStart, data + newline)) return{};
+					
+					lineStart = newline + 1;
+					scanFrom = lineStart;
+				}
+				
+				if (readSize == 0)
+				{
+					//last line without a trailing newline
+					if (lineStart < filled) emit(data + lineStart, data + filled);
+					break;
+				}
+				
+				//move the unfinished line to the front, it has no newline so it is not scanned again
+				size_t tail = filled - lineStart;
+				if (lineStart > 0) memmove(buffer.data(), data + lineStart, tail);
+				
+				filled = tail;
+				scanFrom = tail;
+				
+				if (filled == buffer.size()) buffer.resize(buffer.size() * 2);
+			}
 
-			in.seekg(0, ios::end);
-			size_t fileSize = scast<size_t>(in.tellg());
+			in.close();
+		}
+		catch (exception& e)
+		{
+			oss << "Failed to read lines from target '" << target << "'! Reason: " << e.what();
 
-			if (fileSize == 0)
-			{
-				in.close();
+			return oss.str();
+		}
 
-				oss << "Failed to read binary data from target '" << target << "' because it had no data!";
+		return{};
+	}
 
-				return oss.str();
-			}
+	//Write all text from a string to a text file, with optional append and overwrite flags.
+	//A new file is created at target path if it doesn't already exist
+	inline string WriteTextToFile(
+		const path& target,
+		string_view inText,
+		bool append,
+		bool overwrite)
+	{
+		ostringstream oss{};
 
-			if (rangeEnd == 0) rangeEnd = fileSize;
+		if (exists(target)
+			&& !is_regular_file(target))
+		{
+			oss << "Failed to write text to target '" << target << "' because it is not a regular file!";
 
-			if (rangeEnd <= rangeStart)
-			{
-				in.close();
+			return oss.str();
+		}
+		if (inText.empty())
+		{
+			oss << "Failed to write text to target '" << target << "' because inText string is empty!";
 
-				oss << "Failed to read binary data from target '" << target << "' because rangeEnd '"
-					<< rangeEnd << "' is lower or equal to rangeStart '" << rangeStart << "'!";
+			return oss.str();
+		}
+		
+		path baseDir = target.parent_path().empty()
+			? "."
+			: target.parent_path();
 
-				return oss.str();
-			}
-			if (rangeStart >= rangeEnd)
-			{
-				in.close();
+		auto fileStatus = status(baseDir);
+		auto filePerms = fileStatus.permissions();
+		
+		bool canWrite = (filePerms & (
+			perms::owner_write
+			| perms::group_write
+			| perms::others_write))  
+			!= perms::none;
+		
+		if (!canWrite)
+		{
+			oss << "Failed to write text to target '" << target << "' because of insufficient write permissions!";
 
-				oss << "Failed to read binary data from target '" << target << "' because rangeStart '"
-					<< rangeStart << "' is higher or equal to rangeEnd '" << rangeEnd << "'!";
+			return oss.str();
+		}
 
-				return oss.str();
-			}
-			if (rangeStart >= fileSize)
+		if (overwrite
+			&& exists(target))
+		{
+			string deleteResult = DeletePath(target);
+
+			if (!deleteResult.empty())
 			{
-				in.close();
+				oss << "Failed to delete existing file before writing text to target '" << target << "'! Reason: " + deleteResult;
 
-				oss << "Failed to read binary data from target '" << target << "' because rangeStart '"
-					<< rangeStart << "' is higher or equal to file size '" << fileSize << "'!";
+				return oss.str();	
+			}
+		}
 
-				return oss.str();
+		try
+		{
+			ofstream out;
+
+			if (append)
+			{
+				out.open(
+					target,
+					ios::out
+					| ios::app);
 			}
-			if (rangeEnd > fileSize)
+			else
 			{
-				in.close();
+				out.open(
+					target,
+					ios::out
+					| ios::trunc);
+			}
 
-				oss << "Failed to read binary data from target '" << target << "' because rangeEnd '"
-					<< rangeEnd << "' is higher than file size '" << fileSize << "'!";
+			if (out.fail()
+				&& errno != 0)
+			{
+				int err = errno;
+
+				char errbuf[256]{};
+
+#ifdef _WIN32
+				strerror_s(errbuf, sizeof(errbuf), err);
+#else
+				strerror_r(err, errbuf, sizeof(errbuf));
+#endif
+
+				oss << "Failed to write text to target '" << target
+					<< "' because it couldn't be opened! "
+					<< "Reason: (errno " << err << "): " << errbuf;
 
 				return oss.str();
 			}
 
-			size_t readSize = rangeEnd - rangeStart;
-			allData.resize(readSize);
+			out << inText;
 
-			in.seekg(scast<streamoff>(rangeStart), ios::beg);
-			in.read(
-				rcast<char*>(allData.data()),
-				scast<streamsize>(readSize));
+			out.close();
+		}
+		catch (exception& e)
+		{
+			oss << "Failed to write text to target '" << target << "'! Reason: " << e.what();
+
+			return oss.str();
+		}
+
+		return{};
+	}
+	//Read all text from a file into a string
+	inline string ReadTextFromFile(
+		const path& target, 
+		string& outText)
+	{
+		ostringstream oss{};
+		string allText{};
+
+		if (!exists(target))
+		{
+			oss << "Failed to read text from target '" << target << "' because it does not exist!";
+
+			return oss.str();
+		}
+		if (!is_regular_file(target))
+		{
+			oss << "Failed to read text from target '" << target << "' because it is not a regular file!";
+
+			return oss.str();
+		}
+		
+		path baseDir = target.parent_path().empty()
+			? "."
+			: target.parent_path();
+
+		auto fileStatus = status(baseDir);
+		auto filePerms = fileStatus.permissions();
+		
+		bool canRead = (filePerms & (
+			perms::owner_read
+			| perms::group_read
+			| perms::others_read))  
+			!= perms::none;
+		
+		if (!canRead)
+		{
+			oss << "Failed to get text from target '" << target << "' because of insufficient read permissions!";
+
+			return oss.str();
+		}
+
+		try
+		{
+			ifstream in(
+				target,
+				ios::in);
 
 			if (in.fail()
 				&& errno != 0)
@@ -2551,287 +2875,1686 @@ namespace KalaHeaders::KalaFile
 				strerror_r(err, errbuf, sizeof(errbuf));
 #endif
 
-				oss << "Failed to read binary data from target '" << target
+				oss << "Failed to read text from target '" << target
 					<< "' because it couldn't be opened! "
 					<< "Reason: (errno " << err << "): " << errbuf;
 
 				return oss.str();
 			}
 
-			size_t bytesRead = scast<size_t>(in.gcount());
+			ostringstream buffer{};
+
+			buffer << in.rdbuf();
+			allText = buffer.str();
 
 			in.close();
 
-			if (bytesRead != readSize)
+			if (allText.empty())
 			{
-				oss << "Failed to read binary data from target '" << target << "'!"
-					<< " Expected size was '" << readSize << "' bytes but result was '" << bytesRead << "' bytes.";
+				oss << "Failed to read text from target '" << target << "' because it was empty!";
 
 				return oss.str();
 			}
 
 			//successfully got data
-			outData = std::move(allData);
+			outText = allText;
 		}
 		catch (exception& e)
 		{
-			oss << "Failed to read binary from target '" << target << "'! Reason: " << e.what();
+			oss << "Failed to read text from target '" << target << "'! Reason: " << e.what();
 
 			return oss.str();
 		}
 
 		return{};
 	}
-	
-	inline void WriteFixedString(
-		vector<u8>& data,
-		size_t offset,
-		const char* str,
-		size_t length)
+
+	//Write all lines from a vector to a text file, with optional append and overwrite flags.
+	//A new file is created at target path if it doesn't already exist
+	inline string WriteLinesToFile(
+		const path& target,
+		const vector<string>& inLines,
+		bool append,
+		bool overwrite)
 	{
-		//determine how many characters to actually write
-		const size_t safeLen = min(strlen(str), length);
-		
-		//append data to the end of the file
-		if (offset == scast<size_t>(-1))
+		ostringstream oss{};
+
+		if (exists(target)
+			&& !is_regular_file(target))
 		{
-			for (size_t i = 0; i < length; i++)
-			{
-				if (i < safeLen)
-				{
-					data.push_back(scast<u8>(str[i]));
-				}
-				else data.push_back(0); //null-pad remaining bytes
-			}
-			return;
+			oss << "Failed to write lines to target '" << target << "' because it is not a regular file!";
+
+			return oss.str();
+		}
+		if (inLines.empty())
+		{
+			oss << "Failed to write lines to target '" << target << "' because inLines vector is empty!";
+
+			return oss.str();
 		}
 		
-		//write at target offset, rewrite if needed
-		if (offset + length > data.size())
+		path baseDir = target.parent_path().empty()
+			? "."
+			: target.parent_path();
+
+		auto fileStatus = status(baseDir);
+		auto filePerms = fileStatus.permissions();
+		
+		bool canWrite = (filePerms & (
+			perms::owner_write
+			| perms::group_write
+			| perms::others_write))  
+			!= perms::none;
+		
+		if (!canWrite)
 		{
-			data.resize(offset + length);
+			oss << "Failed to write lines to target '" << target << "' because of insufficient write permissions!";
+
+			return oss.str();
 		}
-			
-		for (size_t i = 0; i < length; i++)
+
+		if (overwrite
+			&& exists(target))
 		{
-			if (i < safeLen)
+			string deleteResult = DeletePath(target);
+
+			if (!deleteResult.empty())
 			{
-				data[offset + i] = scast<u8>(str[i]);
+				oss << "Failed to delete existing file before writing lines to target '" << target << "'! Reason: " + deleteResult;
+
+				return oss.str();	
 			}
-			else data[offset + i] = 0; //null-pad remaining bytes
 		}
-	}
-	inline constexpr string ReadFixedString(
-		const vector<u8>& data,
-		size_t offset,
-		size_t length)
-	{
-		//return empty string if trying to read out of bounds
-		if (offset + length > data.size()) return "";
-		
-		string result{};
-		result.reserve(length);
-		
-		for (size_t i = 0; i < length; i++)
+
+		try
 		{
-			char c = scast<char>(data[offset + i]);
-			if (c == '\0') break; //break at first null byte
-			result.push_back(c);
+			ofstream out;
+
+			if (append)
+			{
+				out.open(
+					target,
+					ios::out
+					| ios::app);
+			}
+			else
+			{
+				out.open(
+					target,
+					ios::out
+					| ios::trunc);
+			}
+
+			if (out.fail()
+				&& errno != 0)
+			{
+				int err = errno;
+
+				char errbuf[256]{};
+
+#ifdef _WIN32
+				strerror_s(errbuf, sizeof(errbuf), err);
+#else
+				strerror_r(err, errbuf, sizeof(errbuf));
+#endif
+
+				oss << "Failed to write lines to target '" << target
+					<< "' because it couldn't be opened! "
+					<< "Reason: (errno " << err << "): " << errbuf;
+
+				return oss.str();
+			}
+
+			for (size_t i = 0; i < inLines.size(); ++i)
+			{
+				out << inLines[i] << "\n";
+			}
+
+			out.close();
 		}
-		
-		return result;
-	}
-	
-	inline constexpr void WriteU8(
-		vector<u8>& data,
-		size_t offset,
-		u8 value)
-	{
-		//append data to the end of the file
-		if (offset == scast<size_t>(-1))
+		catch (exception& e)
 		{
-			data.push_back(value);
-			return;
+			oss << "Failed to write lines to target '" << target << "'! Reason: " << e.what();
+
+			return oss.str();
 		}
-		
-		//write at target offset, auto-resize if needed
-		if (offset >= data.size()) data.resize(offset + 1);
-		
-		data[offset] = value;
+
+		return{};
 	}
-	inline constexpr void WriteU16(
-		vector<u8>& data,
-		size_t offset,
-		u16 value)
+	//Read all lines from a file into a vector of strings with optional 
+	//lineStart and lineEnd values to avoid placing all lines to memory.
+	//If lineEnd is 0 and lineStart isnt, then this function defaults end to EOF
+	inline string ReadLinesFromFile(
+		const path& target,
+		vector<string>& outLines,
+		size_t lineStart = 0,
+		size_t lineEnd = 0)
 	{
-		//append data to the end of the file
-		if (offset == scast<size_t>(-1))
+		ostringstream oss{};
+		vector<string> allLines{};
+
+		if (!exists(target))
 		{
-			data.push_back(scast<u8>(value & 0xFF));
-			data.push_back(scast<u8>((value >> 8) & 0xFF));
-			return;
+			oss << "Failed to read lines from target '" << target << "' because it does not exist!";
+
+			return oss.str();
 		}
-		
-		//write at target offset, auto-resize if needed
-		if (offset + 1 >= data.size()) data.resize(offset + 2);
-		
-		data[offset]     = scast<u8>(value & 0xFF);
-		data[offset + 1] = scast<u8>((value >> 8) & 0xFF);
-	}
-	inline constexpr void WriteU32(
-		vector<u8>& data,
-		size_t offset,
-		u32 value)
-	{
-		//append data to the end of the file
-		if (offset == scast<size_t>(-1))
+		if (!is_regular_file(target))
 		{
-			data.push_back(scast<u8>(value & 0xFF));
-			data.push_back(scast<u8>((value >> 8) & 0xFF));
-			data.push_back(scast<u8>((value >> 16) & 0xFF));
-			data.push_back(scast<u8>((value >> 24) & 0xFF));
-			return;
+			oss << "Failed to read lines from target '" << target << "' because it is not a regular file!";
+
+			return oss.str();
 		}
 		
-		//write at target offset, auto-resize if needed
-		if (offset + 3 >= data.size()) data.resize(offset + 4);
-		
-		data[offset]     = scast<u8>(value & 0xFF);
-		data[offset + 1] = scast<u8>((value >> 8) & 0xFF);
-		data[offset + 2] = scast<u8>((value >> 16) & 0xFF);
-		data[offset + 3] = scast<u8>((value >> 24) & 0xFF);
-	}
-	
-	inline constexpr u8 ReadU8(
-		const vector<u8>& data,
-		size_t offset)
-	{
-		return (offset >= data.size())
-			? 0x00
-			: scast<u8>(data[offset]);
-	}
-	inline constexpr u16 ReadU16(
-		const vector<u8>& data,
-		size_t offset)
-	{
-		return (offset + 1 >= data.size())
-			? 0x0000
-			: scast<u16>(data[offset])
-			| scast<u16>(data[offset + 1]) << 8;
-	}
-	inline constexpr u32 ReadU32(
-		const vector<u8>& data,
-		size_t offset)
-	{
-		return (offset + 3 >= data.size())
-			? 0x00000000
-			: scast<u32>(data[offset])
-			| scast<u32>(data[offset + 1]) << 8
-			| scast<u32>(data[offset + 2]) << 16
-			| scast<u32>(data[offset + 3]) << 24;
-	}
-	
-	inline constexpr void WriteI8(
-		vector<u8>& data,
-		size_t offset,
-		i8 value)
-	{
-		//append data to the end of the file
-		if (offset == scast<size_t>(-1))
-		{
-			data.push_back(scast<u8>(value));
-			return;
-		}
+		path baseDir = target.parent_path().empty()
+			? "."
+			: target.parent_path();
+
+		auto fileStatus = status(baseDir);
+		auto filePerms = fileStatus.permissions();
 		
-		//writes at target offset, auto-resizes if needed
-		if (offset >= data.size()) data.resize(offset + 1);
+		bool canRead = (filePerms & (
+			perms::owner_read
+			| perms::group_read
+			| perms::others_read))  
+			!= perms::none;
 		
-		data[offset] = value;
-	}
-	inline constexpr void WriteI16(
-		vector<u8>& data,
-		size_t offset,
-		i16 value)
-	{
-		//append data to the end of the file
-		if (offset == scast<size_t>(-1))
+		if (!canRead)
 		{
-			data.push_back(scast<u8>(value & 0xFF));
-			data.push_back(scast<u8>((value >> 8) & 0xFF));
-			return;
+			oss << "Failed to read lines from target '" << target << "' because of insufficient read permissions!";
+
+			return oss.str();
 		}
-		
-		//writes at target offset, auto-resizes if needed
-		if (offset + 1 >= data.size()) data.resize(offset + 2);
-		
-		data[offset]     = scast<u8>(value & 0xFF);
-		data[offset + 1] = scast<u8>((value >> 8) & 0xFF);
-	}
-	inline constexpr void WriteI32(
-		vector<u8>& data,
-		size_t offset,
-		i32 value)
-	{
-		//append data to the end of the file
-		if (offset == scast<size_t>(-1))
+
+		try
 		{
-			data.push_back(scast<u8>(value & 0xFF));
-			data.push_back(scast<u8>((value >> 8) & 0xFF));
-			data.push_back(scast<u8>((value >> 16) & 0xFF));
-			data.push_back(scast<u8>((value >> 24) & 0xFF));
-			return;
+			ifstream in(
+				target,
+				ios::in);
+
+			if (in.fail()
+				&& errno != 0)
+			{
+				int err = errno;
+
+				char errbuf[256]{};
+
+#ifdef _WIN32
+				strerror_s(errbuf, sizeof(errbuf), err);
+#else
+				strerror_r(err, errbuf, sizeof(errbuf));
+#endif
+
+				oss << "Failed to read lines from target '" << target
+					<< "' because it couldn't be opened! "
+					<< "Reason: (errno " << err << "): " << errbuf;
+
+				return oss.str();
+			}
+
+			size_t totalLines{};
+			string result = GetTextFileLineCount(target, totalLines);
+
+			if (!result.empty())
+			{
+				oss << "Failed to read lines from target '"
+					<< target << "'! Reason: '" << result;
+
+				return oss.str();
+			}
+
+			if (lineEnd == 0) lineEnd = totalLines;
+
+			if (lineEnd <= lineStart)
+			{
+				oss << "Failed to read lines from target '"
+					<< target << "' because lineEnd '"
+					<< lineEnd << "' is lower or equal to lineStart '" << lineStart << "'!";
+
+				return oss.str();
+			}
+			if (lineStart >= lineEnd)
+			{
+				oss << "Failed to read lines from target '"
+					<< target << "' because lineStart '"
+					<< lineStart << "' is higher or equal to lineEnd '" << lineEnd << "'!";
+
+				return oss.str();
+			}
+			if (lineStart >= totalLines)
+			{
+				oss << "Failed to read lines from target '"
+					<< target << "' because lineStart '"
+					<< lineStart << "' is higher or equal to totalLines '" << totalLines << "'!";
+
+				return oss.str();
+			}
+			if (lineEnd > totalLines)
+			{
+				oss << "Failed to read lines from target '"
+					<< target << "' because lineEnd '"
+					<< lineEnd << "' is higher than totalLines '" << totalLines << "'!";
+
+				return oss.str();
+			}
+
+			in.close();
+			
+			//text mode getline only drops '\r' on windows, keep that behavior
+#ifdef _WIN32
+			constexpr bool stripCarriageReturn = true;
+#else
+			constexpr bool stripCarriageReturn = false;
+#endif
+			
+			allLines.reserve(lineEnd - lineStart);
+			
+			size_t currentLine{};
+			string readResult = ReadLinesChunked(
+				target,
+				[&](string_view line)
+				{
+					if (currentLine >= lineStart) allLines.emplace_back(line);
+					
+					return ++currentLine < lineEnd;
+				},
+				CHUNK_1MB,
+				stripCarriageReturn);
+				
+			if (!readResult.empty())
+			{
+				oss << "Failed to read lines from target '"
+					<< target << "'! Reason: '" << readResult;
+
+				return oss.str();
+			}
+
+			size_t expected = lineEnd - lineStart;
+			if (allLines.size() != expected)
+			{
+				oss << "Failed to read lines from target '" << target << "'!"
+					<< " Expected size was '" << expected << "' lines but result was '" << allLines.size() << "' lines.";
+
+				return oss.str();
+			}
+
+			//successfully got data
+			outLines = std::move(allLines);
 		}
-		
-		//writes at target offset, auto-resizes if needed
-		if (offset + 3 >= data.size()) data.resize(offset + 4);
-		
-		data[offset]     = scast<u8>(value & 0xFF);
-		data[offset + 1] = scast<u8>((value >> 8) & 0xFF);
-		data[offset + 2] = scast<u8>((value >> 16) & 0xFF);
-		data[offset + 3] = scast<u8>((value >> 24) & 0xFF);
+		catch (exception& e)
+		{
+			oss << "Failed to read lines from target '" << target << "'! Reason: " << e.what();
+
+			return oss.str();
+		}
+
+		return{};
 	}
-	
-	inline constexpr i8 ReadI8(
-		const vector<u8>& data,
-		size_t offset)
+
+	//
+	// BINARY I/O
+	//
+
+	//Simple helper to get binary chunk stream size for efficient binary reading
+	inline constexpr size_t GetBinaryChunkStreamSize(size_t fileSize)
 	{
-		return (offset >= data.size())
-			? 0
-			: scast<i8>(data[offset]);
+		//empty file
+		if (fileSize == 0) return 0;
+
+		//whole file is under 10MB, use as single chunk
+		if (fileSize < TEN_MB) return fileSize;
+
+		//whole file is 10MB to 1GB - return 64KB chunk size
+		if (fileSize < ONE_GB) return CHUNK_64KB;
+
+		//whole file size is over 1GB - return 1MB chunk size
+		return CHUNK_1MB;
 	}
-	inline constexpr i16 ReadI16(
-		const vector<u8>& data,
-		size_t offset)
+
+	//Write all binary data from a vector<uint8_t> to a file, with optional append and overwrite flags.
+	//A new file is created at target path if it doesn't already exist
+	inline string WriteBinaryDataToFile(
+		const path& target,
+		const vector<uint8_t>& inData,
+		bool append,
+		bool overwrite)
 	{
-		if (offset + 1 >= data.size()) return 0;
+		ostringstream oss{};
+
+		if (exists(target)
+			&& !is_regular_file(target))
+		{
+			oss << "Failed to write binary to target '" << target << "' because it is not a regular file!";
+
+			return oss.str();
+		}
+		if (inData.empty())
+		{
+			oss << "Failed to write binary to target '" << target << "' because inData vector is empty!";
+
+			return oss.str();
+		}
 		
-		u16 value =
-			scast<u16>(data[offset])
-			| scast<u16>(data[offset + 1]) << 8;
-			
-		return scast<i16>(value);
-	}
-	inline constexpr i32 ReadI32(
-		const vector<u8>& data,
-		size_t offset)
-	{
-		if (offset + 3 >= data.size()) return 0;
+		path baseDir = target.parent_path().empty()
+			? "."
+			: target.parent_path();
+
+		auto fileStatus = status(baseDir);
+		auto filePerms = fileStatus.permissions();
 		
-		u32 value =
-			scast<u32>(data[offset])
-			| scast<u32>(data[offset + 1]) << 8
-			| scast<u32>(data[offset + 2]) << 16
-			| scast<u32>(data[offset + 3]) << 24;
-			
-		return scast<i32>(value);
+		bool canWrite = (filePerms & (
+			perms::owner_write
+			| perms::group_write
+			| perms::others_write))  
+			!= perms::none;
+		
+		if (!canWrite)
+		{
+			oss << "Failed to write binary data to target '" << target << "' because of insufficient write permissions!";
+
+			return oss.str();
+		}
+
+		if (overwrite
+			&& exists(target))
+		{
+			string deleteResult = DeletePath(target);
+
+			if (!deleteResult.empty())
+			{
+				oss << "Failed to delete existing file before writing binary data to target '" << target << "'! Reason: " + deleteResult;
+
+				return oss.str();	
+			}
+		}
+
+		try
+		{
+			ofstream out;
+
+			if (append)
+			{
+				out.open(
+					target,
+					ios::out
+					| ios::binary
+					| ios::app);
+			}
+			else
+			{
+				out.open(
+					target,
+					ios::out
+					| ios::binary
+					| ios::trunc);
+			}
+
+			if (out.fail()
+				&& errno != 0)
+			{
+				int err = errno;
+
+				char errbuf[256]{};
+
+#ifdef _WIN32
+				strerror_s(errbuf, sizeof(errbuf), err);
+#else
+				strerror_r(err, errbuf, sizeof(errbuf));
+#endif
+
+				oss << "Failed to write binary data to target '" << target
+					<< "' because it couldn't be opened! "
+					<< "Reason: (errno " << err << "): " << errbuf;
+
+				return oss.str();
+			}
+
+			out.write(
+				rcast<const char*>(inData.data()),
+				scast<streamsize>(inData.size()));
+
+			if (out.fail()
+				&& errno != 0)
+			{
+				int err = errno;
+
+				char errbuf[256]{};
+
+#ifdef _WIN32
+				strerror_s(errbuf, sizeof(errbuf), err);
+#else
+				strerror_r(err, errbuf, sizeof(errbuf));
+#endif
+
+				oss << "Failed to write binary data to target '" << target
+					<< "' because it couldn't be opened! "
+					<< "Reason: (errno " << err << "): " << errbuf;
+
+				return oss.str();
+			}
+
+			out.close();
+		}
+		catch (exception& e)
+		{
+			oss << "Failed to write binary data to target '" << target << "'! Reason: " << e.what();
+
+			return oss.str();
+		}
+
+		return{};
+	}
+	//Read all binary data from a file into a vector<uint8_t> with optional 
+	//rangeStart and rangeEnd values to avoid placing whole binary file to memory.
+	//If rangeEnd is 0 and rangeStart isnt, then this function defaults end to EOF
+	inline string ReadBinaryDataFromFile(
+		const path& target,
+		vector<uint8_t>& outData,
+		size_t rangeStart = 0,
+		size_t rangeEnd = 0)
+	{
+		ostringstream oss{};
+		vector<uint8_t> allData{};
+
+		if (!exists(target))
+		{
+			oss << "Failed to read binary from target '" << target << "' because it does not exist!";
+
+			return oss.str();
+		}
+		if (!is_regular_file(target))
+		{
+			oss << "Failed to read binary from target '" << target << "' because it is not a regular file!";
+
+			return oss.str();
+		}
+		
+		path baseDir = target.parent_path().empty()
+			? "."
+			: target.parent_path();
+
+		auto fileStatus = status(baseDir);
+		auto filePerms = fileStatus.permissions();
+		
+		bool canRead = (filePerms & (
+			perms::owner_read
+			| perms::group_read
+			| perms::others_read))  
+			!= perms::none;
+		
+		if (!canRead)
+		{
+			oss << "Failed to read binary data from target '" << target << "' because of insufficient read permissions!";
+
+			return oss.str();
+		}
+
+		try
+		{
+			ifstream in(
+				target,
+				ios::in
+				| ios::binary);
+
+			if (in.fail()
+				&& errno != 0)
+			{
+				int err = errno;
+
+				char errbuf[256]{};
+
+#ifdef _WIN32
+				strerror_s(errbuf, sizeof(errbuf), err);
+#else
+				strerror_r(err, errbuf, sizeof(errbuf));
+#endif
+
+				oss << "Failed to read binary data from target '" << target
+					<< "' because it couldn't be opened! "
+					<< "Reason: (errno " << err << "): " << errbuf;
+
+				return oss.str();
+			}
+
+			in.seekg(0, ios::end);
+			size_t fileSize = scast<size_t>(in.tellg());
+
+			if (fileSize == 0)
+			{
+				in.close();
+
+				oss << "Failed to read binary data from target '" << target << "' because it had no data!";
+
+				return oss.str();
+			}
+
+			if (rangeEnd == 0) rangeEnd = fileSize;
+
+			if (rangeEnd <= rangeStart)
+			{
+				in.close();
+
+				oss << "Failed to read binary data from target '" << target << "' because rangeEnd '"
+					<< rangeEnd << "' is lower or equal to rangeStart '" << rangeStart << "'!";
+
+				return oss.str();
+			}
+			if (rangeStart >= rangeEnd)
+			{
+				in.close();
+
+				oss << "Failed to read binary data from target '" << target << "' because rangeStart '"
+					<< rangeStart << "' is higher or equal to rangeEnd '" << rangeEnd << "'!";
+
+				return oss.str();
+			}
+			if (rangeStart >= fileSize)
+			{
+				in.close();
+
+				oss << "Failed to read binary data from target '" << target << "' because rangeStart '"
+					<< rangeStart << "' is higher or equal to file size '" << fileSize << "'!";
+
+				return oss.str();
+			}
+			if (rangeEnd > fileSize)
+			{
+				in.close();
+
+				oss << "Failed to read binary data from target '" << target << "' because rangeEnd '"
+					<< rangeEnd << "' is higher than file size '" << fileSize << "'!";
+
+				return oss.str();
+			}
+
+			size_t readSize = rangeEnd - rangeStart;
+			allData.resize(readSize);
+
+			in.seekg(scast<streamoff>(rangeStart), ios::beg);
+			in.read(
+				rcast<char*>(allData.data()),
+				scast<streamsize>(readSize));
+
+			if (in.fail()
+				&& errno != 0)
+			{
+				int err = errno;
+
+				char errbuf[256]{};
+
+#ifdef _WIN32
+				strerror_s(errbuf, sizeof(errbuf), err);
+#else
+				strerror_r(err, errbuf, sizeof(errbuf));
+#endif
+
+				oss << "Failed to read binary data from target '" << target
+					<< "' because it couldn't be opened! "
+					<< "Reason: (errno " << err << "): " << errbuf;
+
+				return oss.str();
+			}
+
+			size_t bytesRead = scast<size_t>(in.gcount());
+
+			in.close();
+
+			if (bytesRead != readSize)
+			{
+				oss << "Failed to read binary data from target '" << target << "'!"
+					<< " Expected size was '" << readSize << "' bytes but result was '" << bytesRead << "' bytes.";
+
+				return oss.str();
+			}
+
+			//successfully got data
+			outData = std::move(allData);
+		}
+		catch (exception& e)
+		{
+			oss << "Failed to read binary from target '" << target << "'! Reason: " << e.what();
+
+			return oss.str();
+		}
+
+		return{};
+	}
+	
+	inline void WriteFixedString(
+		vector<u8>& data,
+		size_t offset,
+		const char* str,
+		size_t length)
+	{
+		//determine how many characters to actually write
+		const size_t safeLen = min(strlen(str), length);
+		if (length == 0) return;
+		
+		//append data to the end of the file
+		if (offset == scast<size_t>(-1)) offset = data.size();
+		
+		//write at target offset, rewrite if needed
+		if (offset + length > data.size())
+		{
+			data.resize(offset + length);
+		}
+			
+		memcpy(data.data() + offset, str, safeLen);
+		
+		//null-pad remaining bytes
+		memset(data.data() + offset + safeLen, 0, length - safeLen);
+	}
+	inline constexpr string ReadFixedString(
+		const vector<u8>& data,
+		size_t offset,
+		size_t length)
+	{
+		//return empty string if trying to read out of bounds
+		if (offset + length > data.size()) return "";
+		
+		string result{};
+		result.reserve(length);
+		
+		for (size_t i = 0; i < length; i++)
+		{
+			char c = scast<char>(data[offset + i]);
+			if (c == '\0') break; //break at first null byte
+			result.push_back(c);
+		}
+		
+		return result;
+	}
+	
+	inline constexpr void WriteU8(
+		vector<u8>& data,
+		size_t offset,
+		u8 value)
+	{
+		//append data to the end of the file
+		if (offset == scast<size_t>(-1))
+		{
+			data.push_back(value);
+			return;
+		}
+		
+		//write at target offset, auto-resize if needed
+		if (offset >= data.size()) data.resize(offset + 1);
+		
+		data[offset] = value;
+	}
+	inline constexpr void WriteU16(
+		vector<u8>& data,
+		size_t offset,
+		u16 value)
+	{
+		//append data to the end of the file
+		if (offset == scast<size_t>(-1))
+		{
+			data.push_back(scast<u8>(value & 0xFF));
+			data.push_back(scast<u8>((value >> 8) & 0xFF));
+			return;
+		}
+		
+		//write at target offset, auto-resize if needed
+		if (offset + 1 >= data.size()) data.resize(offset + 2);
+		
+		data[offset]     = scast<u8>(value & 0xFF);
+		data[offset + 1] = scast<u8>((value >> 8) & 0xFF);
+	}
+	inline constexpr void WriteU32(
+		vector<u8>& data,
+		size_t offset,
+		u32 value)
+	{
+		//append data to the end of the file
+		if (offset == scast<size_t>(-1))
+		{
+			data.push_back(scast<u8>(value & 0xFF));
+			data.push_back(scast<u8>((value >> 8) & 0xFF));
+			data.push_back(scast<u8>((value >> 16) & 0xFF));
+			data.push_back(scast<u8>((value >> 24) & 0xFF));
+			return;
+		}
+		
+		//write at target offset, auto-resize if needed
+		if (offset + 3 >= data.size()) data.resize(offset + 4);
+		
+		data[offset]     = scast<u8>(value & 0xFF);
+		data[offset + 1] = scast<u8>((value >> 8) & 0xFF);
+		data[offset + 2] = scast<u8>((value >> 16) & 0xFF);
+		data[offset + 3] = scast<u8>((value >> 24) & 0xFF);
+	}
+	
+	inline constexpr u8 ReadU8(
+		const vector<u8>& data,
+		size_t offset)
+	{
+		return (offset >= data.size())
+			? 0x00
+			: scast<u8>(data[offset]);
+	}
+	inline constexpr u16 ReadU16(
+		const vector<u8>& data,
+		size_t offset)
+	{
+		return (offset + 1 >= data.size())
+			? 0x0000
+			: scast<u16>(data[offset])
+			| scast<u16>(data[offset + 1]) << 8;
+	}
+	inline constexpr u32 ReadU32(
+		const vector<u8>& data,
+		size_t offset)
+	{
+		return (offset + 3 >= data.size())
+			? 0x00000000
+			: scast<u32>(data[offset])
+			| scast<u32>(data[offset + 1]) << 8
+			| scast<u32>(data[offset + 2]) << 16
+			| scast<u32>(data[offset + 3]) << 24;
+	}
+	
+	inline constexpr void WriteI8(
+		vector<u8>& data,
+		size_t offset,
+		i8 value)
+	{
+		//append data to the end of the file
+		if (offset == scast<size_t>(-1))
+		{
+			data.push_back(scast<u8>(value));
+			return;
+		}
+		
+		//writes at target offset, auto-resizes if needed
+		if (offset >= data.size()) data.resize(offset + 1);
+		
+		data[offset] = value;
+	}
+	inline constexpr void WriteI16(
+		vector<u8>& data,
+		size_t offset,
+		i16 value)
+	{
+		//append data to the end of the file
+		if (offset == scast<size_t>(-1))
+		{
+			data.push_back(scast<u8>(value & 0xFF));
+			data.push_back(scast<u8>((value >> 8) & 0xFF));
+			return;
+		}
+		
+		//writes at target offset, auto-resizes if needed
+		if (offset + 1 >= data.size()) data.resize(offset + 2);
+		
+		data[offset]     = scast<u8>(value & 0xFF);
+		data[offset + 1] = scast<u8>((value >> 8) & 0xFF);
+	}
+	inline constexpr void WriteI32(
+		vector<u8>& data,
+		size_t offset,
+		i32 value)
+	{
+		//append data to the end of the file
+		if (offset == scast<size_t>(-1))
+		{
+			data.push_back(scast<u8>(value & 0xFF));
+			data.push_back(scast<u8>((value >> 8) & 0xFF));
+			data.push_back(scast<u8>((value >> 16) & 0xFF));
+			data.push_back(scast<u8>((value >> 24) & 0xFF));
+			return;
+		}
+		
+		//writes at target offset, auto-resizes if needed
+		if (offset + 3 >= data.size()) data.resize(offset + 4);
+		
+		data[offset]     = scast<u8>(value & 0xFF);
+		data[offset + 1] = scast<u8>((value >> 8) & 0xFF);
+		data[offset + 2] = scast<u8>((value >> 16) & 0xFF);
+		data[offset + 3] = scast<u8>((value >> 24) & 0xFF);
+	}
+	
+	inline constexpr i8 ReadI8(
+		const vector<u8>& data,
+		size_t offset)
+	{
+		return (offset >= data.size())
+			? 0
+			: scast<i8>(data[offset]);
+	}
+	inline constexpr i16 ReadI16(
+		const vector<u8>& data,
+		size_t offset)
+	{
+		if (offset + 1 >= data.size()) return 0;
+		
+		u16 value =
+			scast<u16>(data[offset])
+			| scast<u16>(data[offset + 1]) << 8;
+			
+		return scast<i16>(value);
+	}
+	inline constexpr i32 ReadI32(
+		const vector<u8>& data,
+		size_t offset)
+	{
+		if (offset + 3 >= data.size()) return 0;
+		
+		u32 value =
+			scast<u32>(data[offset])
+			| scast<u32>(data[offset + 1]) << 8
+			| scast<u32>(data[offset + 2]) << 16
+			| scast<u32>(data[offset + 3]) << 24;
+			
+		return scast<i32>(value);
+	}
+	
+	//Streaming binary writer that fills fixed-size chunks and hands each
+	//full chunk to the disk, so a large export never holds the whole file in memory.
+	//Everything is written into '<target>.tmp' and renamed over target on Commit,
+	//so readers either see the previous file or the complete new one.
+	//With async enabled a dedicated writer thread writes the chunks
+	//while the caller keeps serializing into the next chunk.
+	//Write calls never fail individually, the first error is kept and returned by Commit
+	class BinaryWriter
+	{
+	public:
+		BinaryWriter() = default;
+		~BinaryWriter() { Discard(); }
+
+		BinaryWriter(const BinaryWriter&) = delete;
+		BinaryWriter& operator=(const BinaryWriter&) = delete;
+		BinaryWriter(BinaryWriter&&) = delete;
+		BinaryWriter& operator=(BinaryWriter&&) = delete;
+
+		//Creates the temporary file next to target, discards any previous unfinished write first.
+		//maxChunksInFlight limits how many full chunks may wait for the writer thread before Write blocks
+		inline string Open(
+			const path& target,
+			bool overwrite = true,
+			bool async = false,
+			size_t chunkSize = CHUNK_1MB,
+			size_t maxChunksInFlight = 4)
+		{
+			Discard();
+
+			ostringstream oss{};
+
+			if (exists(target))
+			{
+				if (!is_regular_file(target))
+				{
+					oss << "Failed to open binary writer for target '" << target << "' because it is not a regular file!";
+
+					return oss.str();
+				}
+				if (!overwrite)
+				{
+					oss << "Failed to open binary writer for target '" << target << "' because it already exists!";
+
+					return oss.str();
+				}
+			}
+			if (chunkSize == 0)
+			{
+				oss << "Failed to open binary writer for target '" << target << "' because chunk size was 0!";
+
+				return oss.str();
+			}
+
+			path baseDir = target.parent_path().empty()
+				? "."
+				: target.parent_path();
+
+			auto fileStatus = status(baseDir);
+			auto filePerms = fileStatus.permissions();
+
+			bool canWrite = (filePerms & (
+				perms::owner_write
+				| perms::group_write
+				| perms::others_write))
+				!= perms::none;
+
+			if (!canWrite)
+			{
+				oss << "Failed to open binary writer for target '" << target << "' because of insufficient write permissions!";
+
+				return oss.str();
+			}
+
+			path tempPath = target;
+			tempPath += ".tmp";
+
+#ifdef _WIN32
+			HANDLE file = CreateFileW(
+				tempPath.c_str(),
+				GENERIC_WRITE,
+				0,
+				nullptr,
+				CREATE_ALWAYS,
+				FILE_ATTRIBUTE_NORMAL
+				| FILE_FLAG_SEQUENTIAL_SCAN,
+				nullptr);
+
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				oss << "Failed to open binary writer for target '" << target
+					<< "' because its temporary file couldn't be created! "
+					<< "Reason: (error " << GetLastError() << ")";
+
+				return oss.str();
+			}
+
+			fileHandle = file;
+#else
+			int fd = open(
+				tempPath.c_str(),
+				O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+				0644);
+
+			if (fd < 0)
+			{
+				int err = errno;
+
+				char errbuf[256]{};
+				strerror_r(err, errbuf, sizeof(errbuf));
+
+				oss << "Failed to open binary writer for target '" << target
+					<< "' because its temporary file couldn't be created! "
+					<< "Reason: (errno " << err << "): " << errbuf;
+
+				return oss.str();
+			}
+
+			fileDescriptor = fd;
+#endif
+			targetPath = target;
+			temporaryPath = std::move(tempPath);
+			chunkCapacity = chunkSize;
+			maxInFlight = max(maxChunksInFlight, size_t{ 1 });
+			current.reserve(chunkCapacity);
+			isOpen = true;
+
+			if (async)
+			{
+				try
+				{
+					writerThread = thread([this] { WriterLoop(); });
+				}
+				catch (exception& e)
+				{
+					Discard();
+
+					oss << "Failed to open binary writer for target '" << target
+						<< "' because its writer thread couldn't be started! Reason: " << e.what();
+
+					return oss.str();
+				}
+			}
+
+			return{};
+		}
+
+		inline bool IsOpen() const { return isOpen; }
+
+		//Total bytes written so far, the offset the next Write starts at
+		inline size_t GetPosition() const { return currentOffset + current.size(); }
+
+		inline void Write(
+			const void* data,
+			size_t size)
+		{
+			if (!isOpen) return;
+
+			const u8* bytes = scast<const u8*>(data);
+			while (size > 0)
+			{
+				const size_t step = min(size, chunkCapacity - current.size());
+
+				current.insert(
+					current.end(),
+					bytes,
+					bytes + step);
+
+				bytes += step;
+				size -= step;
+
+				if (current.size() == chunkCapacity) FlushChunk();
+			}
+		}
+
+		inline void WriteU8(u8 value) { Write(&value, 1); }
+		inline void WriteU16(u16 value)
+		{
+			const u8 bytes[2]
+			{
+				scast<u8>(value & 0xFF),
+				scast<u8>((value >> 8) & 0xFF)
+			};
+			Write(bytes, sizeof(bytes));
+		}
+		inline void WriteU32(u32 value)
+		{
+			const u8 bytes[4]
+			{
+				scast<u8>(value & 0xFF),
+				scast<u8>((value >> 8) & 0xFF),
+				scast<u8>((value >> 16) & 0xFF),
+				scast<u8>((value >> 24) & 0xFF)
+			};
+			Write(bytes, sizeof(bytes));
+		}
+		inline void WriteI8(i8 value) { WriteU8(scast<u8>(value)); }
+		inline void WriteI16(i16 value) { WriteU16(scast<u16>(value)); }
+		inline void WriteI32(i32 value) { WriteU32(scast<u32>(value)); }
+
+		//Writes up to length characters of str and null-pads the rest
+		inline void WriteFixedString(
+			const char* str,
+			size_t length)
+		{
+			const size_t safeLen = min(strlen(str), length);
+
+			Write(str, safeLen);
+
+			static constexpr u8 zeros[64]{};
+			for (size_t left = length - safeLen; left > 0;)
+			{
+				const size_t step = min(left, sizeof(zeros));
+				Write(zeros, step);
+				left -= step;
+			}
+		}
+
+		//Writes size zero bytes and returns their offset so a header field
+		//like a table offset or size can be filled in with Patch once it is known
+		inline size_t Reserve(size_t size)
+		{
+			const size_t offset = GetPosition();
+
+			static constexpr u8 zeros[64]{};
+			for (size_t left = size; left > 0;)
+			{
+				const size_t step = min(left, sizeof(zeros));
+				Write(zeros, step);
+				left -= step;
+			}
+
+			return offset;
+		}
+
+		//Overwrites already written bytes. Bytes still in the current chunk are patched
+		//in memory, bytes already handed to the disk are patched on Commit
+		inline void Patch(
+			size_t offset,
+			const void* data,
+			size_t size)
+		{
+			if (!isOpen) return;
+
+			if (size > GetPosition()
+				|| offset > GetPosition() - size)
+			{
+				ostringstream oss{};
+				oss << "Failed to patch binary writer target '" << targetPath << "' because patch range '"
+					<< offset << "-" << offset + size << "' is past the written size '" << GetPosition() << "'!";
+
+				SetError(oss.str());
+
+				return;
+			}
+
+			const u8* bytes = scast<const u8*>(data);
+			if (offset >= currentOffset)
+			{
+				memcpy(current.data() + (offset - currentOffset), bytes, size);
+
+				return;
+			}
+
+			pendingPatches.push_back({ offset, vector<u8>(bytes, bytes + size) });
+		}
+		inline void PatchU32(
+			size_t offset,
+			u32 value)
+		{
+			const u8 bytes[4]
+			{
+				scast<u8>(value & 0xFF),
+				scast<u8>((value >> 8) & 0xFF),
+				scast<u8>((value >> 16) & 0xFF),
+				scast<u8>((value >> 24) & 0xFF)
+			};
+			Patch(offset, bytes, sizeof(bytes));
+		}
+
+		//Writes the last chunk and pending patches, syncs the temporary file
+		//and renames it over target. The writer is closed afterwards either way
+		inline string Commit()
+		{
+			KPROFILE_ZONE("BinaryWriter::Commit");
+
+			if (!isOpen) return "Failed to commit binary writer because it was not open!";
+
+			if (!current.empty()) FlushChunk();
+			StopWriter();
+
+			for (const auto& patch : pendingPatches)
+			{
+				if (!GetError().empty()) break;
+
+				WriteAt(
+					patch.offset,
+					patch.bytes.data(),
+					patch.bytes.size());
+			}
+			pendingPatches.clear();
+
+			string result = GetError();
+
+			if (result.empty())
+			{
+#ifdef _WIN32
+				if (!FlushFileBuffers(fileHandle))
+				{
+					ostringstream oss{};
+					oss << "Failed to commit binary writer target '" << targetPath
+						<< "' because its temporary file couldn't be flushed! "
+						<< "Reason: (error " << GetLastError() << ")";
+
+					result = oss.str();
+				}
+#else
+				if (fsync(fileDescriptor) != 0) result = ErrnoMessage("because its temporary file couldn't be flushed!");
+#endif
+			}
+
+			CloseFile();
+
+			if (result.empty())
+			{
+#ifdef _WIN32
+				if (!MoveFileExW(
+					temporaryPath.c_str(),
+					targetPath.c_str(),
+					MOVEFILE_REPLACE_EXISTING
+					| MOVEFILE_WRITE_THROUGH))
+				{
+					ostringstream oss{};
+					oss << "Failed to commit binary writer target '" << targetPath
+						<< "' because its temporary file couldn't be renamed! "
+						<< "Reason: (error " << GetLastError() << ")";
+
+					result = oss.str();
+				}
+#else
+				if (::rename(temporaryPath.c_str(), targetPath.c_str()) != 0)
+				{
+					result = ErrnoMessage("because its temporary file couldn't be renamed!");
+				}
+#endif
+			}
+
+			if (!result.empty())
+			{
+				std::error_code ec{};
+				remove(temporaryPath, ec);
+			}
+
+			Reset();
+
+			return result;
+		}
+
+		//Stops writing and deletes the temporary file, target is left untouched
+		inline void Discard()
+		{
+			if (!isOpen) return;
+
+			StopWriter();
+			CloseFile();
+
+			std::error_code ec{};
+			remove(temporaryPath, ec);
+
+			Reset();
+		}
+
+	private:
+		struct PendingPatch
+		{
+			size_t offset{};
+			vector<u8> bytes{};
+		};
+
+		inline void SetError(const string& message)
+		{
+			unique_lock<mutex> lock(queueMutex);
+			if (firstError.empty()) firstError = message;
+		}
+		inline string GetError()
+		{
+			unique_lock<mutex> lock(queueMutex);
+			return firstError;
+		}
+
+		inline string ErrnoMessage(const char* what) const
+		{
+			int err = errno;
+
+			char errbuf[256]{};
+#ifdef _WIN32
+			strerror_s(errbuf, sizeof(errbuf), err);
+#else
+			strerror_r(err, errbuf, sizeof(errbuf));
+#endif
+
+			ostringstream oss{};
+			oss << "Failed to write binary writer target '" << targetPath << "' " << what << " "
+				<< "Reason: (errno " << err << "): " << errbuf;
+
+			return oss.str();
+		}
+
+		//Positional write of the whole range, loops over short writes
+		inline void WriteAt(
+			size_t offset,
+			const u8* data,
+			size_t size)
+		{
+			while (size > 0)
+			{
+#ifdef _WIN32
+				OVERLAPPED position{};
+				position.Offset = scast<DWORD>(offset & 0xFFFFFFFF);
+				position.OffsetHigh = scast<DWORD>(scast<u64>(offset) >> 32);
+
+				DWORD written{};
+				const DWORD step = scast<DWORD>(min(size, scast<size_t>(0x40000000)));
+
+				if (!WriteFile(
+					fileHandle,
+					data,
+					step,
+					&written,
+					&position))
+				{
+					ostringstream oss{};
+					oss << "Failed to write binary writer target '" << targetPath
+						<< "'! Reason: (error " << GetLastError() << ")";
+
+					SetError(oss.str());
+
+					return;
+				}
+#else
+				const ssize_t written = pwrite(
+					fileDescriptor,
+					data,
+					size,
+					scast<off_t>(offset));
+
+				if (written < 0)
+				{
+					if (errno == EINTR) continue;
+
+					SetError(ErrnoMessage("because writing failed!"));
+
+					return;
+				}
+#endif
+				if (written == 0)
+				{
+					SetError(ErrnoMessage("because nothing could be written!"));
+
+					return;
+				}
+
+				data += written;
+				offset += scast<size_t>(written);
+				size -= scast<size_t>(written);
+			}
+		}
+
+		//Hands the current chunk to the writer thread, or writes it directly without one
+		inline void FlushChunk()
+		{
+			const size_t offset = currentOffset;
+			currentOffset += current.size();
+
+			if (!writerThread.joinable())
+			{
+				if (GetError().empty()) WriteAt(offset, current.data(), current.size());
+				current.clear();
+
+				return;
+			}
+
+			unique_lock<mutex> lock(queueMutex);
+			queueChanged.wait(lock, [this] { return queuedChunks.size() < maxInFlight; });
+
+			queuedChunks.push_back({ offset, std::move(current) });
+
+			//reuse a chunk the writer thread already finished with
+			if (!freeChunks.empty())
+			{
+				current = std::move(freeChunks.back());
+				freeChunks.pop_back();
+			}
+			else current = vector<u8>{};
+
+			current.clear();
+			current.reserve(chunkCapacity);
+
+			queueChanged.notify_all();
+		}
+
+		inline void WriterLoop()
+		{
+			unique_lock<mutex> lock(queueMutex);
+			while (true)
+			{
+				queueChanged.wait(lock, [this] { return !queuedChunks.empty() || stopWriter; });
+
+				if (queuedChunks.empty()) break;
+
+				PendingPatch chunk = std::move(queuedChunks.front());
+				queuedChunks.erase(queuedChunks.begin());
+
+				const bool failed = !firstError.empty();
+				lock.unlock();
+
+				//after a failure the remaining chunks are only drained
+				if (!failed)
+				{
+					WriteAt(
+						chunk.offset,
+						chunk.bytes.data(),
+						chunk.bytes.size());
+				}
+
+				lock.lock();
+				freeChunks.push_back(std::move(chunk.bytes));
+				queueChanged.notify_all();
+			}
+		}
+
+		//Waits for every queued chunk to be written and joins the writer thread
+		inline void StopWriter()
+		{
+			if (!writerThread.joinable()) return;
+
+			{
+				unique_lock<mutex> lock(queueMutex);
+				stopWriter = true;
+			}
+			queueChanged.notify_all();
+
+			writerThread.join();
+		}
+
+		inline void CloseFile()
+		{
+#ifdef _WIN32
+			if (fileHandle != INVALID_HANDLE_VALUE)
+			{
+				CloseHandle(fileHandle);
+				fileHandle = INVALID_HANDLE_VALUE;
+			}
+#else
+			if (fileDescriptor >= 0)
+			{
+				close(fileDescriptor);
+				fileDescriptor = -1;
+			}
+#endif
+		}
+
+		inline void Reset()
+		{
+			targetPath.clear();
+			temporaryPath.clear();
+			current = vector<u8>{};
+			currentOffset = 0;
+			pendingPatches.clear();
+			queuedChunks.clear();
+			freeChunks.clear();
+			firstError.clear();
+			stopWriter = false;
+			isOpen = false;
+		}
+
+		path targetPath{};
+		path temporaryPath{};
+#ifdef _WIN32
+		HANDLE fileHandle = INVALID_HANDLE_VALUE;
+#else
+		int fileDescriptor = -1;
+#endif
+		bool isOpen{};
+
+		size_t chunkCapacity = CHUNK_1MB;
+		size_t maxInFlight = 4;
+
+		//chunk being filled by the caller and its file offset
+		vector<u8> current{};
+		size_t currentOffset{};
+
+		//patches for bytes that already left the current chunk
+		vector<PendingPatch> pendingPatches{};
+
+		//guards everything below, shared with the writer thread
+		mutex queueMutex{};
+		condition_variable queueChanged{};
+		vector<PendingPatch> queuedChunks{};
+		vector<vector<u8>> freeChunks{};
+		string firstError{};
+		bool stopWriter{};
+		thread writerThread{};
+	};
+
+	//Return all start and end of defined string in a binary
+	inline string GetRangeByValue(
+		const path& target,
+		string_view inData,
+		vector<BinaryRange>& outData)
+	{
+		KPROFILE_ZONE("GetRangeByValue");
+
+		ostringstream oss{};
+
+		if (!exists(target))
+		{
+			oss << "Failed to get binary data range from target '" << target << "' because it does not exist!";
+
+			return oss.str();
+		}
+		if (!is_regular_file(target))
+		{
+			oss << "Failed to get binary data range from target '" << target << "' because it is not a regular file!";
+
+			return oss.str();
+		}
+		
+		if (inData.empty())
+		{
+			oss << "Failed to get binary data range from target '" << target << "' because input string was empty!";
+
+			return oss.str();
+		}
+		
+		path baseDir = target.parent_path().empty()
+			? "."
+			: target.parent_path();
+
+		auto fileStatus = status(baseDir);
+		auto filePerms = fileStatus.permissions();
+		
+		bool canRead = (filePerms & (
+			perms::owner_read
+			| perms::group_read
+			| perms::others_read))  
+			!= perms::none;
+		
+		if (!canRead)
+		{
+			oss << "Failed to get range by value from target '" << target << "' because of insufficient read permissions!";
+
+			return oss.str();
+		}
+
+		try
+		{
+			ifstream in(
+				target,
+				ios::binary);
+
+			if (in.fail()
+				&& errno != 0)
+			{
+				int err = errno;
+
+				char errbuf[256]{};
+
+#ifdef _WIN32
+				strerror_s(errbuf, sizeof(errbuf), err);
+#else
+				strerror_r(err, errbuf, sizeof(errbuf));
+#endif
+
+				oss << "Failed to get ragge by value from target '" << target
+					<< "' because it couldn't be opened! "
+					<< "Reason: (errno " << err << "): " << errbuf;
+
+				return oss.str();
+			}
+
+			size_t fileSize{};
+			string result = GetFileSize(
+				target,
+				fileSize);
+
+			if (!result.empty())
+			{
+				ostringstream oss{};
+				oss << "Failed to get range by value for target '" << target
+					<< "'! Reason: " << result;
+
+				return oss.str();
+			}
+
+			if (fileSize == 0)
+			{
+				ostringstream oss{};
+				oss << "Failed to get range by value for target '" << target
+					<< "' because target file is empty!";
+
+				return oss.str();
+			}
+
+			KPROFILE_COUNTER("file bytes searched", fileSize);
+
+			size_t patternSize = inData.size();
+			if (patternSize == 0)
+			{
+				ostringstream oss{};
+				oss << "Failed to get range by value for target '" << target
+					<< "' because input pattern is empty!";
+
+				return oss.str();
+			}
+
+			size_t chunkSize = GetBinaryChunkStreamSize(fileSize);
+
+			vector<uint8_t> buffer(chunkSize + patternSize - 1);
+			size_t offset{};
+			bool firstRead = true;
+
+			while (in)
+			{
+				size_t preserve{};
+
+				if (!firstRead)
+				{
+					preserve = patternSize > 1 ? patternSize - 1 : 0;
+					memmove(
+						buffer.data(),
+						buffer.data() + chunkSize,
+						preserve);
+					offset -= preserve;
+				}
+
+				in.read(rcast<char*>(buffer.data() + preserve), chunkSize);
+
+				//a short last chunk sets failbit too, errno may still be left over from an earlier call
+				if (in.fail()
+					&& !in.eof()
+					&& errno != 0)
+				{
+					int err = errno;
+
+					char errbuf[256]{};
+
+#ifdef _WIN32
+					strerror_s(errbuf, sizeof(errbuf), err);
+#else
+					strerror_r(err, errbuf, sizeof(errbuf));
+#endif
+
+					oss << "Failed to get range by value from target '" << target
+						<< "' because it couldn't be opened! "
+						<< "Reason: (errno " << err << "): " << errbuf;
+
+					return oss.str();
+				}
+
+				size_t bytesRead = scast<size_t>(in.gcount());
+
+				if (bytesRead == 0) break;
+
+				size_t totalBytes = bytesRead + preserve;
+
+				auto first = buffer.begin();
+				while (true)
+				{
+					auto it = search(
+						first,
+						buffer.begin() + totalBytes,
+						inData.begin(),
+						inData.end());
+
+					if (it == buffer.begin() + totalBytes) break;
+
+					size_t start = offset + scast<size_t>(distance(buffer.begin(), it));
+					size_t end = start + inData.size();
+
+					outData.push_back({ start, end });
+
+					first = it + inData.size();
+				}
+
+				offset += bytesRead;
+				firstRead = false;
+			}
+		}
+		catch (exception& e)
+		{
+			oss << "Failed to get binary data range from target '" << target << "'! Reason: " << e.what();
+
+			return oss.str();
+		}
+
+		return{};
 	}
-	
-	//Return all start and end of defined string in a binary
+
+	//Return all start and end of defined bytes in a binary
 	inline string GetRangeByValue(
 		const path& target,
-		string_view inData,
+		const vector<uint8_t>& inData,
 		vector<BinaryRange>& outData)
 	{
+		KPROFILE_ZONE("GetRangeByValue");
+
 		ostringstream oss{};
 
 		if (!exists(target))
@@ -2849,7 +4572,7 @@ namespace KalaHeaders::KalaFile
 		
 		if (inData.empty())
 		{
-			oss << "Failed to get binary data range from target '" << target << "' because input string was empty!";
+			oss << "Failed to get binary data range from target '" << target << "' because input vector was empty!";
 
 			return oss.str();
 		}
@@ -2893,7 +4616,7 @@ namespace KalaHeaders::KalaFile
 				strerror_r(err, errbuf, sizeof(errbuf));
 #endif
 
-				oss << "Failed to get ragge by value from target '" << target
+				oss << "Failed to get range by value from target '" << target
 					<< "' because it couldn't be opened! "
 					<< "Reason: (errno " << err << "): " << errbuf;
 
@@ -2902,7 +4625,7 @@ namespace KalaHeaders::KalaFile
 
 			size_t fileSize{};
 			string result = GetFileSize(
-				target,
+				target, 
 				fileSize);
 
 			if (!result.empty())
@@ -2914,291 +4637,791 @@ namespace KalaHeaders::KalaFile
 				return oss.str();
 			}
 
-			if (fileSize == 0)
+			if (fileSize == 0)
+			{
+				ostringstream oss{};
+				oss << "Failed to get range by value for target '" << target
+					<< "' because target file is empty!";
+
+				return oss.str();
+			}
+
+			KPROFILE_COUNTER("file bytes searched", fileSize);
+
+			size_t patternSize = inData.size();
+			if (patternSize == 0)
+			{
+				ostringstream oss{};
+				oss << "Failed to get range by value for target '" << target
+					<< "' because input pattern is empty!";
+
+				return oss.str();
+			}
+
+			size_t chunkSize = GetBinaryChunkStreamSize(fileSize);
+
+			vector<uint8_t> buffer(chunkSize + patternSize - 1);
+			size_t offset{};
+			bool firstRead = true;
+
+			while (in)
+			{
+				size_t preserve{};
+
+				if (!firstRead)
+				{
+					preserve = patternSize > 1 ? patternSize - 1 : 0;
+					memmove(
+						buffer.data(),
+						buffer.data() + chunkSize,
+						preserve);
+					offset -= preserve;
+				}
+
+				in.read(rcast<char*>(buffer.data() + preserve), chunkSize);
+
+				//a short last chunk sets failbit too, errno may still be left over from an earlier call
+				if (in.fail()
+					&& !in.eof()
+					&& errno != 0)
+				{
+					int err = errno;
+
+					char errbuf[256]{};
+
+#ifdef _WIN32
+					strerror_s(errbuf, sizeof(errbuf), err);
+#else
+					strerror_r(err, errbuf, sizeof(errbuf));
+#endif
+
+					oss << "Failed to get range by value from target '" << target
+						<< "' because it couldn't be opened! "
+						<< "Reason: (errno " << err << "): " << errbuf;
+
+					return oss.str();
+				}
+
+				size_t bytesRead = scast<size_t>(in.gcount());
+
+				if (bytesRead == 0) break;
+
+				size_t totalBytes = bytesRead + preserve;
+
+				auto first = buffer.begin();
+				while (true)
+				{
+					auto it = search(
+						first,
+						buffer.begin() + totalBytes,
+						inData.begin(),
+						inData.end());
+
+					if (it == buffer.begin() + totalBytes) break;
+
+					size_t start = offset + scast<size_t>(distance(buffer.begin(), it));
+					size_t end = start + inData.size();
+
+					outData.push_back({ start, end });
+
+					first = it + inData.size();
+				}
+
+				offset += bytesRead;
+				firstRead = false;
+			}
+		}
+		catch (exception& e)
+		{
+			oss << "Failed to get binary data range from target '" << target << "'! Reason: " << e.what();
+
+			return oss.str();
+		}
+
+		return{};
+	}
+	//Read-only memory mapping of a whole file, the mapped bytes
+	//stay valid until Unmap is called or the mapping is destroyed
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile() { Unmap(); }
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		MappedFile(MappedFile&& other) noexcept
+		{
+			*this = std::move(other);
+		}
+		MappedFile& operator=(MappedFile&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Unmap();
+
+				data = other.data;
+				size = other.size;
+#ifdef _WIN32
+				mappingHandle = other.mappingHandle;
+				other.mappingHandle = nullptr;
+#endif
+				other.data = nullptr;
+				other.size = 0;
+			}
+
+			return *this;
+		}
+
+		//Maps the whole file as read-only, unmaps any previous mapping first
+		inline string Map(const path& target)
+		{
+			Unmap();
+
+			ostringstream oss{};
+
+#ifdef _WIN32
+			HANDLE file = CreateFileW(
+				target.c_str(),
+				GENERIC_READ,
+				FILE_SHARE_READ,
+				nullptr,
+				OPEN_EXISTING,
+				FILE_ATTRIBUTE_NORMAL
+				| FILE_FLAG_SEQUENTIAL_SCAN,
+				nullptr);
+
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				oss << "Failed to map target '" << target
+					<< "' because it couldn't be opened! "
+					<< "Reason: (error " << GetLastError() << ")";
+
+				return oss.str();
+			}
+
+			LARGE_INTEGER fileSize{};
+			if (!GetFileSizeEx(file, &fileSize))
+			{
+				DWORD err = GetLastError();
+				CloseHandle(file);
+
+				oss << "Failed to map target '" << target
+					<< "' because its size couldn't be read! "
+					<< "Reason: (error " << err << ")";
+
+				return oss.str();
+			}
+			if (fileSize.QuadPart == 0)
+			{
+				CloseHandle(file);
+
+				oss << "Failed to map target '" << target << "' because target file is empty!";
+
+				return oss.str();
+			}
+
+			HANDLE mapping = CreateFileMappingW(
+				file,
+				nullptr,
+				PAGE_READONLY,
+				0,
+				0,
+				nullptr);
+
+			//the mapping keeps its own reference to the file
+			CloseHandle(file);
+
+			if (mapping == nullptr)
+			{
+				oss << "Failed to map target '" << target
+					<< "'! Reason: (error " << GetLastError() << ")";
+
+				return oss.str();
+			}
+
+			void* view = MapViewOfFile(
+				mapping,
+				FILE_MAP_READ,
+				0,
+				0,
+				0);
+
+			if (view == nullptr)
+			{
+				DWORD err = GetLastError();
+				CloseHandle(mapping);
+
+				oss << "Failed to map target '" << target
+					<< "'! Reason: (error " << err << ")";
+
+				return oss.str();
+			}
+
+			mappingHandle = mapping;
+			data = scast<const u8*>(view);
+			size = scast<size_t>(fileSize.QuadPart);
+#else
+			int fd = open(target.c_str(), O_RDONLY);
+			if (fd < 0)
+			{
+				int err = errno;
+
+				char errbuf[256]{};
+				strerror_r(err, errbuf, sizeof(errbuf));
+
+				oss << "Failed to map target '" << target
+					<< "' because it couldn't be opened! "
+					<< "Reason: (errno " << err << "): " << errbuf;
+
+				return oss.str();
+			}
+
+			struct stat fileStat{};
+			if (fstat(fd, &fileStat) != 0)
+			{
+				int err = errno;
+				close(fd);
+
+				char errbuf[256]{};
+				strerror_r(err, errbuf, sizeof(errbuf));
+
+				oss << "Failed to map target '" << target
+					<< "' because its size couldn't be read! "
+					<< "Reason: (errno " << err << "): " << errbuf;
+
+				return oss.str();
+			}
+			if (fileStat.st_size == 0)
+			{
+				close(fd);
+
+				oss << "Failed to map target '" << target << "' because target file is empty!";
+
+				return oss.str();
+			}
+
+			void* view = mmap(
+				nullptr,
+				scast<size_t>(fileStat.st_size),
+				PROT_READ,
+				MAP_PRIVATE,
+				fd,
+				0);
+
+			//the mapping keeps its own reference to the file
+			close(fd);
+
+			if (view == MAP_FAILED)
+			{
+				int err = errno;
+
+				char errbuf[256]{};
+				strerror_r(err, errbuf, sizeof(errbuf));
+
+				oss << "Failed to map target '" << target
+					<< "'! Reason: (errno " << err << "): " << errbuf;
+
+				return oss.str();
+			}
+
+			//every byte is visited once from front to back
+			madvise(view, scast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+
+			data = scast<const u8*>(view);
+			size = scast<size_t>(fileStat.st_size);
+#endif
+			return{};
+		}
+
+		//Releases the mapping, all pointers borrowed from it become invalid
+		inline void Unmap()
+		{
+			if (data != nullptr)
+			{
+#ifdef _WIN32
+				UnmapViewOfFile(data);
+				if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+				mappingHandle = nullptr;
+#else
+				munmap(const_cast<u8*>(data), size);
+#endif
+			}
+
+			data = nullptr;
+			size = 0;
+		}
+
+		inline const u8* GetData() const { return data; }
+		inline size_t GetSize() const { return size; }
+		inline bool IsMapped() const { return data != nullptr; }
+	private:
+		const u8* data{};
+		size_t size{};
+#ifdef _WIN32
+		HANDLE mappingHandle{};
+#endif
+	};
+
+	//Aho-Corasick automaton over a set of byte patterns, finds every
+	//occurrence of every pattern in a single pass over the scanned bytes
+	class PatternMatcher
+	{
+	public:
+		static constexpr u32 NO_PATTERN = UINT32_MAX;
+
+		//Patterns must not be empty, identical patterns share one state
+		inline void Build(const vector<vector<u8>>& inPatterns)
+		{
+			next.assign(256, NO_PATTERN);
+			outLink.assign(1, 0);
+			firstPattern.assign(1, NO_PATTERN);
+			nextSame.assign(inPatterns.size(), NO_PATTERN);
+			lengths.assign(inPatterns.size(), 0);
+			maxLength = 0;
+
+			//trie of all patterns, missing edges are NO_PATTERN until the links are resolved
+			for (size_t p = 0; p < inPatterns.size(); ++p)
+			{
+				u32 state{};
+				for (u8 c : inPatterns[p])
+				{
+					//index instead of reference, adding a state reallocates the table
+					const size_t edge = scast<size_t>(state) * 256 + c;
+					if (next[edge] == NO_PATTERN)
+					{
+						next[edge] = scast<u32>(firstPattern.size());
+
+						next.insert(next.end(), 256, NO_PATTERN);
+						outLink.push_back(0);
+						firstPattern.push_back(NO_PATTERN);
+					}
+					state = next[edge];
+				}
+
+				nextSame[p] = firstPattern[state];
+				firstPattern[state] = scast<u32>(p);
+				lengths[p] = inPatterns[p].size();
+				maxLength = max(maxLength, lengths[p]);
+			}
+
+			//breadth-first so every failure state is complete before it is borrowed from
+			vector<u32> fail(firstPattern.size(), 0);
+			vector<u32> queue{};
+			queue.reserve(firstPattern.size());
+
+			for (size_t c = 0; c < 256; ++c)
 			{
-				ostringstream oss{};
-				oss << "Failed to get range by value for target '" << target
-					<< "' because target file is empty!";
-
-				return oss.str();
+				u32& edge = next[c];
+				if (edge == NO_PATTERN) edge = 0;
+				else queue.push_back(edge);
 			}
 
-			size_t patternSize = inData.size();
-			if (patternSize == 0)
+			for (size_t head = 0; head < queue.size(); ++head)
 			{
-				ostringstream oss{};
-				oss << "Failed to get range by value for target '" << target
-					<< "' because input pattern is empty!";
+				const u32 state = queue[head];
+				const size_t row = scast<size_t>(state) * 256;
+				const size_t failRow = scast<size_t>(fail[state]) * 256;
 
-				return oss.str();
-			}
+				for (size_t c = 0; c < 256; ++c)
+				{
+					u32& edge = next[row + c];
+					if (edge == NO_PATTERN)
+					{
+						edge = next[failRow + c];
+						continue;
+					}
 
-			size_t chunkSize = GetBinaryChunkStreamSize(fileSize);
+					const u32 target = next[failRow + c];
+					fail[edge] = target;
+					outLink[edge] = firstPattern[target] != NO_PATTERN
+						? target
+						: outLink[target];
 
-			vector<uint8_t> buffer(chunkSize + patternSize - 1);
-			size_t offset{};
-			bool firstRead = true;
+					queue.push_back(edge);
+				}
+			}
+		}
 
-			while (in)
+		//Scans bytes [scanStart, scanEnd) and appends every match that starts before ownEnd
+		//to outData[pattern] unless it overlaps the last match appended for that pattern,
+		//matches of one pattern are appended in ascending start order
+		inline void Scan(
+			const u8* data,
+			size_t scanStart,
+			size_t scanEnd,
+			size_t ownEnd,
+			vector<vector<BinaryRange>>& outData) const
+		{
+			u32 state{};
+			for (size_t i = scanStart; i < scanEnd; ++i)
 			{
-				size_t preserve{};
+				state = next[scast<size_t>(state) * 256 + data[i]];
 
-				if (!firstRead)
+				u32 match = firstPattern[state] != NO_PATTERN
+					? state
+					: outLink[state];
+
+				for (; match != 0; match = outLink[match])
 				{
-					preserve = patternSize > 1 ? patternSize - 1 : 0;
-					memmove(
-						buffer.data(),
-						buffer.data() + chunkSize,
-						preserve);
-					offset -= preserve;
+					for (u32 p = firstPattern[match]; p != NO_PATTERN; p = nextSame[p])
+					{
+						const size_t start = i + 1 - lengths[p];
+						auto& found = outData[p];
+						if (start < ownEnd
+							&& (found.empty()
+							|| start >= found.back().end))
+						{
+							found.push_back({ start, i + 1 });
+						}
+					}
 				}
+			}
+		}
 
-				in.read(rcast<char*>(buffer.data() + preserve), chunkSize);
-
-				if (in.fail()
-					&& errno != 0)
-				{
-					int err = errno;
+		inline size_t GetMaxLength() const { return maxLength; }
+	private:
+		vector<u32> next{};         //dense goto table, 256 edges per state
+		vector<u32> outLink{};      //nearest proper suffix state that ends a pattern, 0 if none
+		vector<u32> firstPattern{}; //pattern that ends at this state
+		vector<u32> nextSame{};     //next identical pattern ending at the same state
+		vector<size_t> lengths{};
+		size_t maxLength{};
+	};
 
-					char errbuf[256]{};
+	//Appends every occurrence of pattern that starts in [scanStart, ownEnd) to outData
+	//unless it overlaps the last appended range,
+	//candidates are filtered by their first and last byte before the middle is compared
+	inline void FindPatternInRange(
+		const u8* data,
+		size_t scanStart,
+		size_t scanEnd,
+		size_t ownEnd,
+		const vector<u8>& pattern,
+		vector<BinaryRange>& outData)
+	{
+		const size_t length = pattern.size();
+		if (scanEnd < scanStart + length) return;
 
-#ifdef _WIN32
-					strerror_s(errbuf, sizeof(errbuf), err);
-#else
-					strerror_r(err, errbuf, sizeof(errbuf));
-#endif
+		//last position a whole pattern fits at, capped to the owned range
+		const size_t limit = min(scanEnd - length + 1, ownEnd);
 
-					oss << "Failed to get range by value from target '" << target
-						<< "' because it couldn't be opened! "
-						<< "Reason: (errno " << err << "): " << errbuf;
+		const u8* bytes = pattern.data();
+		const u8 firstByte = bytes[0];
+		const u8 lastByte = bytes[length - 1];
 
-					return oss.str();
+		auto check = [&](size_t pos)
+			{
+				if (!outData.empty()
+					&& pos < outData.back().end)
+				{
+					return;
 				}
 
-				size_t bytesRead = scast<size_t>(in.gcount());
+				if (length <= 2
+					|| memcmp(data + pos + 1, bytes + 1, length - 2) == 0)
+				{
+					outData.push_back({ pos, pos + length });
+				}
+			};
 
-				if (bytesRead == 0) break;
+		size_t pos = scanStart;
 
-				size_t totalBytes = bytesRead + preserve;
+#if defined(KFILE_SSE2)
+		const __m128i first = _mm_set1_epi8(scast<char>(firstByte));
+		const __m128i last = _mm_set1_epi8(scast<char>(lastByte));
 
-				auto first = buffer.begin();
-				while (true)
-				{
-					auto it = search(
-						first,
-						buffer.begin() + totalBytes,
-						inData.begin(),
-						inData.end());
+		for (; pos + 16 <= limit; pos += 16)
+		{
+			const __m128i a = _mm_loadu_si128(rcast<const __m128i*>(data + pos));
+			const __m128i b = _mm_loadu_si128(rcast<const __m128i*>(data + pos + length - 1));
 
-					if (it == buffer.begin() + totalBytes) break;
+			u32 mask = scast<u32>(_mm_movemask_epi8(_mm_and_si128(
+				_mm_cmpeq_epi8(a, first),
+				_mm_cmpeq_epi8(b, last))));
 
-					size_t start = offset + scast<size_t>(distance(buffer.begin(), it));
-					size_t end = start + inData.size();
+			while (mask != 0)
+			{
+				check(pos + scast<size_t>(std::countr_zero(mask)));
+				mask &= mask - 1;
+			}
+		}
+#elif defined(KFILE_NEON)
+		const uint8x16_t first = vdupq_n_u8(firstByte);
+		const uint8x16_t last = vdupq_n_u8(lastByte);
 
-					outData.push_back({ start, end });
+		for (; pos + 16 <= limit; pos += 16)
+		{
+			const uint8x16_t eq = vandq_u8(
+				vceqq_u8(vld1q_u8(data + pos), first),
+				vceqq_u8(vld1q_u8(data + pos + length - 1), last));
 
-					first = it + inData.size();
-				}
+			//narrow to 4 bits per byte so the whole block fits in one 64-bit mask
+			u64 mask = vget_lane_u64(vreinterpret_u64_u8(
+				vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
 
-				offset += bytesRead;
-				firstRead = false;
+			while (mask != 0)
+			{
+				check(pos + scast<size_t>(std::countr_zero(mask) >> 2));
+				mask &= ~(u64{ 0xF } << (std::countr_zero(mask) & ~3));
 			}
 		}
-		catch (exception& e)
+#endif
+		while (pos < limit)
 		{
-			oss << "Failed to get binary data range from target '" << target << "'! Reason: " << e.what();
+			const void* found = memchr(data + pos, firstByte, limit - pos);
+			if (found == nullptr) break;
 
-			return oss.str();
+			pos = scast<size_t>(scast<const u8*>(found) - data);
+			if (data[pos + length - 1] == lastByte) check(pos);
+			++pos;
 		}
-
-		return{};
 	}
 
-	//Return all start and end of defined bytes in a binary
-	inline string GetRangeByValue(
+	//Return all start and end ranges of every pattern in a binary in one pass over a memory mapping.
+	//outData is resized to one result vector per pattern, matches of one pattern never overlap
+	//and are sorted by start like GetRangeByValue, matches of different patterns may overlap.
+	//threadCount of 0 uses all hardware threads, files are never split into segments under 1MB
+	inline string GetRangesByValues(
 		const path& target,
-		const vector<uint8_t>& inData,
-		vector<BinaryRange>& outData)
+		const vector<vector<uint8_t>>& inPatterns,
+		vector<vector<BinaryRange>>& outData,
+		u32 threadCount = 1)
 	{
+		KPROFILE_ZONE("GetRangesByValues");
+
 		ostringstream oss{};
 
 		if (!exists(target))
 		{
-			oss << "Failed to get binary data range from target '" << target << "' because it does not exist!";
+			oss << "Failed to get binary data ranges from target '" << target << "' because it does not exist!";
 
 			return oss.str();
 		}
 		if (!is_regular_file(target))
 		{
-			oss << "Failed to get binary data range from target '" << target << "' because it is not a regular file!";
-
-			return oss.str();
-		}
-		
-		if (inData.empty())
-		{
-			oss << "Failed to get binary data range from target '" << target << "' because input vector was empty!";
+			oss << "Failed to get binary data ranges from target '" << target << "' because it is not a regular file!";
 
 			return oss.str();
 		}
-		
-		path baseDir = target.parent_path().empty()
-			? "."
-			: target.parent_path();
 
-		auto fileStatus = status(baseDir);
-		auto filePerms = fileStatus.permissions();
-		
-		bool canRead = (filePerms & (
-			perms::owner_read
-			| perms::group_read
-			| perms::others_read))  
-			!= perms::none;
-		
-		if (!canRead)
+		if (inPatterns.empty())
 		{
-			oss << "Failed to get range by value from target '" << target << "' because of insufficient read permissions!";
+			oss << "Failed to get binary data ranges from target '" << target << "' because no patterns were passed!";
 
 			return oss.str();
 		}
-
-		try
+		for (const auto& p : inPatterns)
 		{
-			ifstream in(
-				target,
-				ios::binary);
-
-			if (in.fail()
-				&& errno != 0)
+			if (p.empty())
 			{
-				int err = errno;
-
-				char errbuf[256]{};
-
-#ifdef _WIN32
-				strerror_s(errbuf, sizeof(errbuf), err);
-#else
-				strerror_r(err, errbuf, sizeof(errbuf));
-#endif
-
-				oss << "Failed to get range by value from target '" << target
-					<< "' because it couldn't be opened! "
-					<< "Reason: (errno " << err << "): " << errbuf;
+				oss << "Failed to get binary data ranges from target '" << target << "' because an input pattern was empty!";
 
 				return oss.str();
 			}
+		}
 
-			size_t fileSize{};
-			string result = GetFileSize(
-				target, 
-				fileSize);
+		outData.assign(inPatterns.size(), {});
 
+		try
+		{
+			//the mapping is the only read, its size replaces a separate GetFileSize call
+			MappedFile file{};
+			string result = file.Map(target);
 			if (!result.empty())
 			{
-				ostringstream oss{};
-				oss << "Failed to get range by value for target '" << target
+				oss << "Failed to get binary data ranges from target '" << target
 					<< "'! Reason: " << result;
 
 				return oss.str();
 			}
 
-			if (fileSize == 0)
-			{
-				ostringstream oss{};
-				oss << "Failed to get range by value for target '" << target
-					<< "' because target file is empty!";
+			const u8* data = file.GetData();
+			const size_t fileSize = file.GetSize();
 
-				return oss.str();
-			}
+			KPROFILE_COUNTER("file bytes searched", fileSize);
 
-			size_t patternSize = inData.size();
-			if (patternSize == 0)
+			PatternMatcher matcher{};
+			size_t maxLength{};
+			if (inPatterns.size() > 1)
 			{
-				ostringstream oss{};
-				oss << "Failed to get range by value for target '" << target
-					<< "' because input pattern is empty!";
-
-				return oss.str();
+				matcher.Build(inPatterns);
+				maxLength = matcher.GetMaxLength();
 			}
+			else maxLength = inPatterns[0].size();
 
-			size_t chunkSize = GetBinaryChunkStreamSize(fileSize);
+			size_t workerCount = threadCount == 0
+				? thread::hardware_concurrency()
+				: threadCount;
+			workerCount = max(min(workerCount, (fileSize + CHUNK_1MB - 1) / CHUNK_1MB), size_t{ 1 });
 
-			vector<uint8_t> buffer(chunkSize + patternSize - 1);
-			size_t offset{};
-			bool firstRead = true;
+			const size_t segmentSize = (fileSize + workerCount - 1) / workerCount;
 
-			while (in)
-			{
-				size_t preserve{};
+			//every segment owns the matches that start inside it and reads up to
+			//maxLength - 1 bytes past its end so matches crossing the boundary are found once,
+			//overlapping matches are dropped while scanning so only the kept ones are stored
+			vector<vector<vector<BinaryRange>>> segmentResults(workerCount);
+			vector<string> segmentErrors(workerCount);
 
-				if (!firstRead)
+			auto work = [&](size_t segment)
 				{
-					preserve = patternSize > 1 ? patternSize - 1 : 0;
-					memmove(
-						buffer.data(),
-						buffer.data() + chunkSize,
-						preserve);
-					offset -= preserve;
-				}
+					try
+					{
+						const size_t start = segment * segmentSize;
+						const size_t end = min(start + segmentSize, fileSize);
+						const size_t scanEnd = min(end + maxLength - 1, fileSize);
 
-				in.read(rcast<char*>(buffer.data() + preserve), chunkSize);
+						auto& found = segmentResults[segment];
+						found.resize(inPatterns.size());
 
-				if (in.fail()
-					&& errno != 0)
-				{
-					int err = errno;
+						if (start >= end) return;
 
-					char errbuf[256]{};
+						if (inPatterns.size() > 1)
+						{
+							matcher.Scan(
+								data,
+								start,
+								scanEnd,
+								end,
+								found);
+						}
+						else
+						{
+							FindPatternInRange(
+								data,
+								start,
+								scanEnd,
+								end,
+								inPatterns[0],
+								found[0]);
+						}
+					}
+					catch (exception& e)
+					{
+						segmentErrors[segment] = e.what();
+					}
+				};
 
-#ifdef _WIN32
-					strerror_s(errbuf, sizeof(errbuf), err);
-#else
-					strerror_r(err, errbuf, sizeof(errbuf));
-#endif
+			//the calling thread scans the first segment, so one less worker is spawned
+			vector<thread> workers{};
+			workers.reserve(workerCount - 1);
 
-					oss << "Failed to get range by value from target '" << target
-						<< "' because it couldn't be opened! "
-						<< "Reason: (errno " << err << "): " << errbuf;
+			size_t spawned = 1;
+			for (; spawned < workerCount; ++spawned)
+			{
+				//if a thread can't be spawned the calling thread scans the remaining
+				//segments itself, unwinding here would destroy joinable threads
+				try { workers.emplace_back(work, spawned); }
+				catch (...) { break; }
+			}
+
+			work(0);
+			for (size_t i = spawned; i < workerCount; ++i) work(i);
+
+			for (auto& w : workers) w.join();
+
+			for (const auto& e : segmentErrors)
+			{
+				if (!e.empty())
+				{
+					oss << "Failed to get binary data ranges from target '" << target << "'! Reason: " << e;
 
 					return oss.str();
 				}
+			}
 
-				size_t bytesRead = scast<size_t>(in.gcount());
-
-				if (bytesRead == 0) break;
+			//a segment's kept matches are what a sequential search gives once it reaches the segment
+			//start, unless the previous segment's last match runs into it. Then the chain is rebuilt
+			//from that match's end: a dropped match only hides inside the span of a kept one,
+			//so only the bytes between the rebuilt end and the end of the kept match before
+			//the next candidate are checked, until the chain lands back on the kept matches
+			for (size_t p = 0; p < inPatterns.size(); ++p)
+			{
+				auto& out = outData[p];
+				const vector<u8>& pattern = inPatterns[p];
+				const size_t length = pattern.size();
 
-				size_t totalBytes = bytesRead + preserve;
+				size_t total{};
+				for (const auto& s : segmentResults) total += s[p].size();
+				out.reserve(total);
 
-				auto first = buffer.begin();
-				while (true)
+				size_t lastEnd{};
+				for (size_t segment = 0; segment < workerCount; ++segment)
 				{
-					auto it = search(
-						first,
-						buffer.begin() + totalBytes,
-						inData.begin(),
-						inData.end());
+					const auto& kept = segmentResults[segment][p];
+					const size_t segmentEnd = min((segment + 1) * segmentSize, fileSize);
 
-					if (it == buffer.begin() + totalBytes) break;
+					size_t k{};
+					while (true)
+					{
+						while (k < kept.size()
+							&& kept[k].start < lastEnd)
+						{
+							++k;
+						}
 
-					size_t start = offset + scast<size_t>(distance(buffer.begin(), it));
-					size_t end = start + inData.size();
+						size_t windowEnd{};
+						if (k > 0)
+						{
+							windowEnd = min(
+								kept[k - 1].end,
+								k < kept.size() ? kept[k].start : segmentEnd);
+						}
 
-					outData.push_back({ start, end });
+						size_t pos = lastEnd;
+						for (; pos < windowEnd; ++pos)
+						{
+							if (pos + length <= fileSize
+								&& memcmp(data + pos, pattern.data(), length) == 0)
+							{
+								break;
+							}
+						}
 
-					first = it + inData.size();
-				}
+						if (pos >= windowEnd) break;
 
-				offset += bytesRead;
-				firstRead = false;
+						out.push_back({ pos, pos + length });
+						lastEnd = pos + length;
+					}
+
+					if (k < kept.size())
+					{
+						out.insert(out.end(), kept.begin() + scast<ptrdiff_t>(k), kept.end());
+						lastEnd = kept.back().end;
+					}
+				}
 			}
 		}
 		catch (exception& e)
 		{
-			oss << "Failed to get binary data range from target '" << target << "'! Reason: " << e.what();
+			oss << "Failed to get binary data ranges from target '" << target << "'! Reason: " << e.what();
 
 			return oss.str();
 		}
 
 		return{};
 	}
+
+	//Return all start and end ranges of every string in a binary in one pass over a memory mapping
+	inline string GetRangesByValues(
+		const path& target,
+		const vector<string_view>& inPatterns,
+		vector<vector<BinaryRange>>& outData,
+		u32 threadCount = 1)
+	{
+		vector<vector<uint8_t>> patterns{};
+		patterns.reserve(inPatterns.size());
+
+		for (string_view p : inPatterns)
+		{
+			patterns.emplace_back(p.begin(), p.end());
+		}
+
+		return GetRangesByValues(
+			target,
+			patterns,
+			outData,
+			threadCount);
+	}
 }
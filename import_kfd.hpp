@@ -8,6 +8,9 @@
 //
 // Provides:
 //   - Helpers for streaming individual font glyphs or loading the full kalafontdata binary into memory
+//   - Asynchronous import that decodes glyph blocks in parallel with a per-block callback
+//   - Glyph cache with O(1) char code lookup, resident metrics and lazily streamed LRU pixel payloads
+//   - Shelf-packed texture atlas builder for per-glyph kfd files with a kfa cache file
 // 
 // Does not currently support:
 //   - OpenType (GSUB/GPOS)
@@ -85,6 +88,28 @@ Offset | Size | Field
 #include <string>
 #include <fstream>
 #include <filesystem>
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <span>
+#include <unordered_map>
+#include <cmath>
+#include <bit>
+
+//
+// PROFILER HOOKS
+//
+
+//Recorded by profile_utils.hpp if it is included first with KPROFILE_ENABLED defined,
+//otherwise every zone and counter below compiles to nothing
+#ifndef KPROFILE_ZONE
+	#define KPROFILE_HOOKS_FALLBACK
+	#define KPROFILE_ZONE(name)
+	#define KPROFILE_COUNTER(name, value) do {} while (0)
+#endif
 
 namespace KalaHeaders::KalaFontData
 {	
@@ -99,6 +124,7 @@ namespace KalaHeaders::KalaFontData
 	using std::array;
 	using std::string;
 	using std::ifstream;
+	using std::ofstream;
 	using std::filesystem::path;
 	using std::filesystem::current_path;
 	using std::filesystem::weakly_canonical;
@@ -106,17 +132,40 @@ namespace KalaHeaders::KalaFontData
 	using std::filesystem::is_regular_file;
 	using std::filesystem::perms;
 	using std::filesystem::status;
+	using std::filesystem::file_size;
+	using std::filesystem::last_write_time;
+	using std::error_code;
 	using std::streamoff;
 	using std::streamsize;
 	using std::ios;
 	using std::move;
 	using std::memcpy;
+	using std::sort;
+	using std::iota;
+	using std::max;
+	using std::min;
+	using std::clamp;
+	using std::thread;
+	using std::atomic;
+	using std::function;
+	using std::shared_ptr;
+	using std::make_shared;
+	using std::memory_order_relaxed;
+	using std::memory_order_acquire;
+	using std::memory_order_release;
+	using std::memory_order_acq_rel;
+	using std::span;
+	using std::unordered_map;
+	using std::sqrt;
+	using std::bit_ceil;
 	
 	using u8 = uint8_t;
 	using u16 = uint16_t;
 	using u32 = uint32_t;
 	using i8 = int8_t;
 	using i16 = int16_t;
+	using u64 = uint64_t;
+	using f32 = float;
 	
 	//The magic that must exist in all kfd files at the first four bytes
 	inline constexpr u32 KFD_MAGIC = 0x0044464B;
@@ -144,6 +193,12 @@ namespace KalaHeaders::KalaFontData
 	//Max total glyph block size: 40064  * 4096 = 156.5 MB
 	inline constexpr u32 MAX_GLYPH_BLOCK_SIZE = 164102144u;
 	
+	//Streamed blocks separated by at most this many bytes are read with a single call (4 KB)
+	inline constexpr u32 STREAM_MERGE_GAP = 4096u;
+	
+	//Streamed ranges are not merged past this size in bytes (16 MB), larger blocks are read alone
+	inline constexpr u32 MAX_STREAM_RANGE_SIZE = 16777216u;
+	
 	inline constexpr u32 MIN_TOTAL_SIZE =
 		CORRECT_GLYPH_HEADER_SIZE
 		+ CORRECT_GLYPH_TABLE_SIZE
@@ -160,6 +215,21 @@ namespace KalaHeaders::KalaFontData
 	//Max allowed glyph height
 	inline constexpr u8 MAX_GLYPH_HEIGHT = 100;
 	
+	//The magic that must exist in all kfa (kalafontatlas) cache files at the first four bytes
+	inline constexpr u32 KFA_MAGIC = 0x0041464B;
+	
+	//The version that must exist in all kfa cache files as the fifth byte
+	inline constexpr u8 KFA_VERSION = 1;
+	
+	//The true kfa top header size that is always required
+	inline constexpr u8 CORRECT_ATLAS_HEADER_SIZE = 24u;
+	
+	//The true per-glyph kfa rect size that is always required
+	inline constexpr u8 CORRECT_ATLAS_RECT_SIZE = 12u;
+	
+	//Max allowed atlas width or height in pixels
+	inline constexpr u32 MAX_ATLAS_SIZE = 8192u;
+	
 	//The main header at the top of each kfd file
 	struct GlyphHeader
 	{
@@ -236,7 +306,15 @@ namespace KalaHeaders::KalaFontData
 		RESULT_INVALID_GLYPH_TABLE_SIZE    = 13, //found a glyph table that wasnt the correct size
 		RESULT_INVALID_GLYPH_BLOCK_SIZE    = 14, //found a glyph block that was less or more than the allowed size
 		RESULT_INVALID_GLYPH_COUNT         = 15, //total glyph count was above allowed max glyph count
-		RESULT_UNEXPECTED_EOF              = 16  //file reached end sooner than expected
+		RESULT_UNEXPECTED_EOF              = 16, //file reached end sooner than expected
+		
+		//
+		// ATLAS ERRORS
+		//
+		
+		RESULT_ATLAS_OVERFLOW              = 17, //glyphs did not fit into the max atlas size
+		RESULT_ATLAS_STALE                 = 18, //atlas cache file was built from a different kfd file
+		RESULT_ATLAS_WRITE_FAILED          = 19  //atlas cache file could not be written
 	};
 	
 	inline constexpr string ResultToString(ImportResult result)
@@ -280,6 +358,13 @@ namespace KalaHeaders::KalaFontData
 			return "RESULT_INVALID_GLYPH_COUNT";
 		case ImportResult::RESULT_UNEXPECTED_EOF:
 			return "RESULT_UNEXPECTED_EOF";
+			
+		case ImportResult::RESULT_ATLAS_OVERFLOW:
+			return "RESULT_ATLAS_OVERFLOW";
+		case ImportResult::RESULT_ATLAS_STALE:
+			return "RESULT_ATLAS_STALE";
+		case ImportResult::RESULT_ATLAS_WRITE_FAILED:
+			return "RESULT_ATLAS_WRITE_FAILED";
 		}
 		
 		return "RESULT_UNKNOWN";
@@ -506,13 +591,39 @@ namespace KalaHeaders::KalaFontData
 		}
 	}
 	
-	//Returns glyph blocks for the inserted tables, set skipChecks to true if the file has already been checked
+	//Decodes the fixed-layout part of a glyph block (everything before RAW_PIXEL_DATA_OFFSET)
+	//into a GlyphBlock, src must have atleast RAW_PIXEL_DATA_OFFSET readable bytes
+	inline void DecodeBlockHeader(
+		const u8* src,
+		GlyphBlock& b)
+	{
+		memcpy(&b.charCode, src + 0, sizeof(u32));
+		memcpy(&b.width,    src + 4, sizeof(u16));
+		memcpy(&b.height,   src + 6, sizeof(u16));
+		memcpy(&b.bearingX, src + 8, sizeof(i16));
+		memcpy(&b.bearingY, src + 10, sizeof(i16));
+		memcpy(&b.advance,  src + 12, sizeof(u16));
+		
+		//vertices
+		memcpy(&b.vertices, src + 14, sizeof(b.vertices));
+		
+		//raw pixel size
+		memcpy(&b.rawPixelSize, src + 30, sizeof(u32));
+	}
+	
+	//Returns glyph blocks for the inserted tables, set skipChecks to true if the file has already been checked.
+	//Tables are read in file order and nearby blocks are merged into a single read,
+	//outBlocks is returned in the same order as inTables.
+	//Set includePixels to false to only read the fixed-layout glyph info and leave rawPixels empty
 	inline ImportResult StreamGlyphs(
 		const path& inFile,
 		const vector<GlyphTable>& inTables,
 		vector<GlyphBlock>& outBlocks,
-		bool skipChecks = false)
+		bool skipChecks = false,
+		bool includePixels = true)
 	{
+		KPROFILE_ZONE("StreamGlyphs");
+
 		if (!skipChecks)
 		{
 			ImportResult preReadResult = PreReadCheck(inFile);
@@ -529,49 +640,117 @@ namespace KalaHeaders::KalaFontData
 			in.seekg(0, ios::end);
 			size_t fileSize = scast<size_t>(in.tellg());
 			
-			//glyph block data
-			
-			vector<GlyphBlock> blocks{};
-			blocks.reserve(inTables.size());
+			//verify that no block is OOB before reading anything
 			
 			for (const auto& t : inTables)
 			{
-				GlyphBlock b{};
-				
-				size_t offset = t.blockOffset;
-				
-				//verify that block size is not OOB
-				if (offset + t.blockSize > fileSize)
+				if (scast<size_t>(t.blockOffset) + t.blockSize > fileSize)
 				{
 					return ImportResult::RESULT_UNEXPECTED_EOF;
 				}
+			}
+			
+			//sort requested tables by their position in the file
+			
+			vector<size_t> order(inTables.size());
+			iota(order.begin(), order.end(), 0);
+			sort(order.begin(), order.end(),
+				[&inTables](size_t a, size_t b)
+				{
+					return inTables[a].blockOffset < inTables[b].blockOffset;
+				});
+			
+			//glyph block data
+			
+			vector<GlyphBlock> blocks(inTables.size());
+			vector<u8> rangeData{};
+			
+			size_t first = 0;
+			while (first < order.size())
+			{
+				//merge all following blocks that are close enough into one range
+				
+				auto readEnd = [includePixels](const GlyphTable& t)
+					{
+						return scast<size_t>(t.blockOffset) 
+							+ (includePixels
+							? t.blockSize
+							: min(t.blockSize, scast<u32>(RAW_PIXEL_DATA_OFFSET)));
+					};
 				
-				in.seekg(offset);
+				size_t rangeStart = inTables[order[first]].blockOffset;
+				size_t rangeEnd = readEnd(inTables[order[first]]);
 				
-				in.read(rcast<char*>(&b.charCode), sizeof(u32));
-				in.read(rcast<char*>(&b.width),    sizeof(u16));
-				in.read(rcast<char*>(&b.height),   sizeof(u16));
-				in.read(rcast<char*>(&b.bearingX), sizeof(i16));
-				in.read(rcast<char*>(&b.bearingY), sizeof(i16));
-				in.read(rcast<char*>(&b.advance),  sizeof(u16));
+				size_t last = first + 1;
+				while (last < order.size())
+				{
+					const GlyphTable& next = inTables[order[last]];
+					size_t nextEnd = readEnd(next);
+					
+					if (next.blockOffset > rangeEnd + STREAM_MERGE_GAP
+						|| max(rangeEnd, nextEnd) - rangeStart > MAX_STREAM_RANGE_SIZE)
+					{
+						break;
+					}
+					
+					rangeEnd = max(rangeEnd, nextEnd);
+					++last;
+				}
 				
-				//vertices
-				in.read(rcast<char*>(&b.vertices), sizeof(b.vertices));
+				//read the whole range with one call
 				
-				//raw pixel size
-				in.read(rcast<char*>(&b.rawPixelSize), sizeof(u32));
+				size_t rangeSize = rangeEnd - rangeStart;
+				rangeData.resize(rangeSize);
 				
-				//verify that pixel data is not OOB
-				if (offset + RAW_PIXEL_DATA_OFFSET + b.rawPixelSize > fileSize)
+				in.seekg(scast<streamoff>(rangeStart));
+				in.read(
+					rcast<char*>(rangeData.data()),
+					scast<streamsize>(rangeSize));
+					
+				if (scast<size_t>(in.gcount()) != rangeSize)
 				{
 					return ImportResult::RESULT_UNEXPECTED_EOF;
 				}
 				
-				//raw pixel data
-				b.rawPixels.resize(b.rawPixelSize);
-				in.read(rcast<char*>(b.rawPixels.data()), b.rawPixelSize);
+				KPROFILE_COUNTER("kfd bytes read", rangeSize);
 				
-				blocks.push_back(std::move(b));
+				//decode each block in the range
+				
+				for (size_t i = first; i < last; ++i)
+				{
+					const GlyphTable& t = inTables[order[i]];
+					GlyphBlock& b = blocks[order[i]];
+					
+					size_t relativeOffset = t.blockOffset - rangeStart;
+					size_t blockEnd = relativeOffset + t.blockSize;
+					
+					//verify that the fixed-layout block header is not OOB
+					if (relativeOffset + RAW_PIXEL_DATA_OFFSET > blockEnd)
+					{
+						return ImportResult::RESULT_UNEXPECTED_EOF;
+					}
+					
+					DecodeBlockHeader(
+						rangeData.data() + relativeOffset,
+						b);
+					
+					//verify that pixel data is not OOB
+					if (relativeOffset + RAW_PIXEL_DATA_OFFSET + b.rawPixelSize > blockEnd)
+					{
+						return ImportResult::RESULT_UNEXPECTED_EOF;
+					}
+					
+					if (!includePixels) continue;
+					
+					//raw pixel data
+					b.rawPixels.resize(b.rawPixelSize);
+					memcpy(
+						b.rawPixels.data(),
+						rangeData.data() + relativeOffset + RAW_PIXEL_DATA_OFFSET,
+						b.rawPixelSize);
+				}
+				
+				first = last;
 			}
 			
 			in.close();
@@ -586,12 +765,56 @@ namespace KalaHeaders::KalaFontData
 		}
 	}
 	
-	//Returns the entire kfd file binary content in structs
-	inline ImportResult ImportKFD(
+	//Decodes and validates one glyph block from the block region of a kfd file,
+	//blockData must start at blockRegionStart in the file
+	inline ImportResult DecodeGlyphBlock(
+		const vector<u8>& blockData,
+		size_t blockRegionStart,
+		const GlyphTable& t,
+		GlyphBlock& b)
+	{
+		//verify that the block doesn't start before the block region
+		if (t.blockOffset < blockRegionStart) return ImportResult::RESULT_UNEXPECTED_EOF;
+		
+		size_t relativeOffset = t.blockOffset - blockRegionStart;
+		
+		//verify that block size is not OOB
+		if (relativeOffset > blockData.size()
+			|| t.blockSize > blockData.size() - relativeOffset)
+		{
+			return ImportResult::RESULT_UNEXPECTED_EOF;
+		}
+		
+		//verify that the fixed-layout block header is not OOB
+		if (RAW_PIXEL_DATA_OFFSET > blockData.size() - relativeOffset)
+		{
+			return ImportResult::RESULT_UNEXPECTED_EOF;
+		}
+		
+		DecodeBlockHeader(
+			blockData.data() + relativeOffset,
+			b);
+		
+		//verify that pixel data is not OOB
+		if (relativeOffset + scast<u32>(RAW_PIXEL_DATA_OFFSET) + b.rawPixelSize > blockData.size())
+		{
+			return ImportResult::RESULT_UNEXPECTED_EOF;
+		}
+		
+		//raw pixel data
+		b.rawPixels.resize(b.rawPixelSize);
+		memcpy(b.rawPixels.data(), blockData.data() + relativeOffset + RAW_PIXEL_DATA_OFFSET, b.rawPixelSize);
+		
+		return ImportResult::RESULT_SUCCESS;
+	}
+	
+	//Reads and validates the header and tables of the kfd file
+	//and the whole block region into outBlockData
+	inline ImportResult ReadBlockRegion(
 		const path& inFile,
 		GlyphHeader& outHeader,
 		vector<GlyphTable>& outTables,
-		vector<GlyphBlock>& outBlocks)
+		vector<u8>& outBlockData)
 	{
 		ImportResult preReadResult = PreReadCheck(inFile);
 		if (preReadResult != ImportResult::RESULT_SUCCESS) return preReadResult;
@@ -606,7 +829,7 @@ namespace KalaHeaders::KalaFontData
 		ImportResult headerResult = GetHeaderData(
 			inFile,
 			header,
-			false);
+			true);
 			
 		if (headerResult != ImportResult::RESULT_SUCCESS) return headerResult;
 			
@@ -633,13 +856,52 @@ namespace KalaHeaders::KalaFontData
 			size_t blockRegionStart = CORRECT_GLYPH_HEADER_SIZE + header.glyphTableSize;
 			in.seekg(blockRegionStart);
 			
-			//read in the size of all models
+			//read in the size of all glyphs
 			in.read(
 				rcast<char*>(blockData.data()),
 				scast<streamsize>(header.glyphBlockSize));
 				
 			in.close();
 			
+			KPROFILE_COUNTER("kfd bytes read", header.glyphBlockSize);
+			
+			outHeader = header;
+			outTables = std::move(tables);
+			outBlockData = std::move(blockData);
+			
+			return ImportResult::RESULT_SUCCESS;
+		}
+		catch (...)
+		{
+			return ImportResult::RESULT_UNKNOWN_READ_ERROR;
+		}
+	}
+
+	//Returns the entire kfd file binary content in structs
+	inline ImportResult ImportKFD(
+		const path& inFile,
+		GlyphHeader& outHeader,
+		vector<GlyphTable>& outTables,
+		vector<GlyphBlock>& outBlocks)
+	{
+		KPROFILE_ZONE("ImportKFD");
+
+		GlyphHeader header{};
+		vector<GlyphTable> tables{};
+		vector<u8> blockData{};
+		
+		ImportResult regionResult = ReadBlockRegion(
+			inFile,
+			header,
+			tables,
+			blockData);
+			
+		if (regionResult != ImportResult::RESULT_SUCCESS) return regionResult;
+				
+		try
+		{
+			size_t blockRegionStart = CORRECT_GLYPH_HEADER_SIZE + header.glyphTableSize;
+			
 			//glyph block data
 			
 			vector<GlyphBlock> blocks{};
@@ -648,43 +910,988 @@ namespace KalaHeaders::KalaFontData
 			for (const auto& t : tables)
 			{
 				GlyphBlock b{};
-				size_t relativeOffset = t.blockOffset - blockRegionStart;
 				
-				//verify that block size is not OOB
-				if (relativeOffset + t.blockSize > blockData.size())
+				ImportResult blockResult = DecodeGlyphBlock(
+					blockData,
+					blockRegionStart,
+					t,
+					b);
+					
+				if (blockResult != ImportResult::RESULT_SUCCESS) return blockResult;
+				
+				blocks.push_back(std::move(b));
+			}
+			
+			outHeader = header;
+			outTables = std::move(tables);
+			outBlocks = std::move(blocks);
+			
+			return ImportResult::RESULT_SUCCESS;
+		}
+		catch (...)
+		{
+			return ImportResult::RESULT_UNKNOWN_READ_ERROR;
+		}
+	}
+	
+	//Called from an import worker as soon as a glyph block has been decoded,
+	//index is the position of the block in the glyph tables.
+	//Runs concurrently on all workers so it must be thread-safe
+	using GlyphReadyCallback = function<void(size_t index, const GlyphBlock& block)>;
+	
+	//Shared state between an AsyncGlyphImport handle and its workers
+	struct AsyncGlyphImportState
+	{
+		GlyphHeader header{};
+		vector<GlyphTable> tables{};
+		vector<GlyphBlock> blocks{};
+		vector<u8> blockData{};
+		
+		GlyphReadyCallback onReady{};
+		
+		atomic<ImportResult> result{ ImportResult::RESULT_SUCCESS };
+		atomic<size_t> nextBlock{};
+		atomic<size_t> readyCount{};
+		atomic<bool> isReady{};
+	};
+	
+	//Future-like handle returned by ImportKFDAsync, waits for the import to finish when destroyed
+	class AsyncGlyphImport
+	{
+	public:
+		AsyncGlyphImport() = default;
+		AsyncGlyphImport(
+			shared_ptr<AsyncGlyphImportState> inState,
+			thread&& inCoordinator)
+			: state(std::move(inState)),
+			coordinator(std::move(inCoordinator)) {}
+		
+		~AsyncGlyphImport() { Wait(); }
+		
+		AsyncGlyphImport(const AsyncGlyphImport&) = delete;
+		AsyncGlyphImport& operator=(const AsyncGlyphImport&) = delete;
+		
+		AsyncGlyphImport(AsyncGlyphImport&&) noexcept = default;
+		AsyncGlyphImport& operator=(AsyncGlyphImport&& other) noexcept
+		{
+			if (this == &other) return *this;
+			
+			Wait();
+			
+			state = std::move(other.state);
+			coordinator = std::move(other.coordinator);
+			
+			return *this;
+		}
+		
+		//Returns true once every block has been decoded or the import has failed
+		inline bool IsReady() const
+		{
+			return state
+				&& state->isReady.load(memory_order_acquire);
+		}
+		
+		//Returns how many blocks have been decoded so far
+		inline size_t GetReadyCount() const
+		{
+			return state
+				? state->readyCount.load(memory_order_acquire)
+				: 0;
+		}
+		
+		//Blocks until the import has finished and returns its result
+		inline ImportResult Wait()
+		{
+			if (coordinator.joinable()) coordinator.join();
+			
+			return state
+				? state->result.load(memory_order_acquire)
+				: ImportResult::RESULT_UNKNOWN_READ_ERROR;
+		}
+		
+		//Header, tables and blocks are only valid after Wait has returned RESULT_SUCCESS
+		inline GlyphHeader& GetHeader() { return state->header; }
+		inline vector<GlyphTable>& GetTables() { return state->tables; }
+		inline vector<GlyphBlock>& GetBlocks() { return state->blocks; }
+	private:
+		shared_ptr<AsyncGlyphImportState> state{};
+		thread coordinator{};
+	};
+	
+	//Imports the entire kfd file in the background and decodes its glyph blocks in parallel.
+	//onReady is called for each block as soon as it is decoded, before the rest of the blocks are done.
+	//threadCount of 0 uses all hardware threads, never more threads than there are glyphs
+	inline AsyncGlyphImport ImportKFDAsync(
+		const path& inFile,
+		GlyphReadyCallback onReady = {},
+		u32 threadCount = 0)
+	{
+		auto state = make_shared<AsyncGlyphImportState>();
+		state->onReady = std::move(onReady);
+		
+		auto fail = [](AsyncGlyphImportState& s, ImportResult r)
+			{
+				ImportResult expected = ImportResult::RESULT_SUCCESS;
+				s.result.compare_exchange_strong(
+					expected,
+					r,
+					memory_order_acq_rel);
+			};
+		
+		auto work = [fail](AsyncGlyphImportState& s)
+			{
+				size_t blockRegionStart = CORRECT_GLYPH_HEADER_SIZE + s.header.glyphTableSize;
+				
+				while (s.result.load(memory_order_relaxed) == ImportResult::RESULT_SUCCESS)
 				{
-					return ImportResult::RESULT_UNEXPECTED_EOF;
+					size_t i = s.nextBlock.fetch_add(1, memory_order_relaxed);
+					if (i >= s.tables.size()) break;
+					
+					try
+					{
+						ImportResult blockResult = DecodeGlyphBlock(
+							s.blockData,
+							blockRegionStart,
+							s.tables[i],
+							s.blocks[i]);
+							
+						if (blockResult != ImportResult::RESULT_SUCCESS)
+						{
+							fail(s, blockResult);
+							break;
+						}
+						
+						if (s.onReady) s.onReady(i, s.blocks[i]);
+					}
+					catch (...)
+					{
+						fail(s, ImportResult::RESULT_UNKNOWN_READ_ERROR);
+						break;
+					}
+					
+					s.readyCount.fetch_add(1, memory_order_release);
 				}
+			};
+		
+		auto run = [state, inFile, threadCount, fail, work]()
+			{
+				AsyncGlyphImportState& s = *state;
 				
-				memcpy(&b.charCode, blockData.data() + relativeOffset + 0, sizeof(u32));
-				memcpy(&b.width,    blockData.data() + relativeOffset + 4, sizeof(u16));
-				memcpy(&b.height,   blockData.data() + relativeOffset + 6, sizeof(u16));
-				memcpy(&b.bearingX, blockData.data() + relativeOffset + 8, sizeof(i16));
-				memcpy(&b.bearingY, blockData.data() + relativeOffset + 10, sizeof(i16));
-				memcpy(&b.advance,  blockData.data() + relativeOffset + 12, sizeof(u16));
+				ImportResult regionResult = ReadBlockRegion(
+					inFile,
+					s.header,
+					s.tables,
+					s.blockData);
+					
+				if (regionResult != ImportResult::RESULT_SUCCESS)
+				{
+					fail(s, regionResult);
+				}
+				else
+				{
+					try
+					{
+						s.blocks.resize(s.tables.size());
+						
+						size_t workerCount = threadCount == 0
+							? thread::hardware_concurrency()
+							: threadCount;
+						workerCount = clamp(workerCount, size_t{ 1 }, max(s.tables.size(), size_t{ 1 }));
+						
+						//the coordinator decodes too, so one less worker is spawned
+						vector<thread> workers{};
+						workers.reserve(workerCount - 1);
+						
+						for (size_t i = 1; i < workerCount; ++i)
+						{
+							//if a thread can't be spawned the already started workers
+							//and the coordinator still claim and decode every block,
+							//unwinding here would destroy joinable threads
+							try { workers.emplace_back(work, std::ref(s)); }
+							catch (...) { break; }
+						}
+						
+						work(s);
+						
+						for (auto& w : workers) w.join();
+					}
+					catch (...)
+					{
+						fail(s, ImportResult::RESULT_UNKNOWN_READ_ERROR);
+					}
+				}
+				
+				//the raw block region is no longer needed once everything is decoded
+				vector<u8>().swap(s.blockData);
+				
+				s.isReady.store(true, memory_order_release);
+			};
+			
+		//a coordinator that can't be spawned is reported like any other failed import
+		thread coordinator{};
+		try { coordinator = thread(std::move(run)); }
+		catch (...)
+		{
+			fail(*state, ImportResult::RESULT_UNKNOWN_READ_ERROR);
+			state->isReady.store(true, memory_order_release);
+		}
+			
+		return AsyncGlyphImport(
+			std::move(state),
+			std::move(coordinator));
+	}
+	//Sentinel index returned by GlyphCache for char codes that are not in the font
+	inline constexpr u32 INVALID_GLYPH = 0xFFFFFFFFu;
+	
+	//Char codes below this are looked up from the dense direct-indexed table (Basic Multilingual Plane)
+	inline constexpr u32 GLYPH_CACHE_DENSE_RANGE = 0x10000u;
+	
+	//Default byte budget for resident glyph pixel payloads in GlyphCache (16 MB)
+	inline constexpr size_t DEFAULT_GLYPH_PIXEL_BUDGET = 16777216u;
+	
+	//Resident per-glyph metrics stored as structure-of-arrays, indexed by glyph index
+	struct GlyphMetrics
+	{
+		vector<u32> charCodes{};
+		vector<u16> widths{};
+		vector<u16> heights{};
+		vector<i16> bearingX{};
+		vector<i16> bearingY{};
+		vector<u16> advances{};
+		vector<array<array<i16, 2>, 4>> vertices{};
+		vector<u32> rawPixelSizes{};
+	};
+	
+	//O(1) char code lookup over a kfd file with resident metrics
+	//and lazily streamed pixel payloads that are evicted least-recently-used first.
+	//Not thread-safe, use one cache per thread or guard it externally
+	class GlyphCache
+	{
+	public:
+		//Reads the header, tables and fixed-layout glyph info of the kfd file and builds the lookup tables.
+		//Pixel payloads are streamed on first use and kept under maxPixelBytes
+		inline ImportResult Load(
+			const path& inFile,
+			size_t maxPixelBytes = DEFAULT_GLYPH_PIXEL_BUDGET)
+		{
+			Clear();
+			
+			ImportResult preReadResult = PreReadCheck(inFile);
+			if (preReadResult != ImportResult::RESULT_SUCCESS) return preReadResult;
+			
+			ImportResult tryOpenResult = TryOpenCheck(inFile);
+			if (tryOpenResult != ImportResult::RESULT_SUCCESS) return tryOpenResult;
+			
+			GlyphHeader newHeader{};
+			ImportResult headerResult = GetHeaderData(inFile, newHeader, true);
+			if (headerResult != ImportResult::RESULT_SUCCESS) return headerResult;
+			
+			vector<GlyphTable> newTables{};
+			ImportResult tableResult = GetTableData(inFile, newTables, true);
+			if (tableResult != ImportResult::RESULT_SUCCESS) return tableResult;
+			
+			if (newTables.size() > MAX_GLYPH_COUNT) return ImportResult::RESULT_INVALID_GLYPH_COUNT;
+			
+			//glyph info without pixels
+			
+			vector<GlyphBlock> infos{};
+			ImportResult infoResult = StreamGlyphs(
+				inFile,
+				newTables,
+				infos,
+				true,
+				false);
 				
-				//vertices
-				memcpy(&b.vertices, blockData.data() + relativeOffset + 14, sizeof(b.vertices));
+			if (infoResult != ImportResult::RESULT_SUCCESS) return infoResult;
+			
+			try
+			{
+				size_t count = newTables.size();
 				
-				//raw pixel size
-				memcpy(&b.rawPixelSize, blockData.data() + relativeOffset + 30, sizeof(u32));
+				metrics.charCodes.reserve(count);
+				metrics.widths.reserve(count);
+				metrics.heights.reserve(count);
+				metrics.bearingX.reserve(count);
+				metrics.bearingY.reserve(count);
+				metrics.advances.reserve(count);
+				metrics.vertices.reserve(count);
+				metrics.rawPixelSizes.reserve(count);
 				
-				//verify that pixel data is not OOB
-				if (relativeOffset + scast<u32>(RAW_PIXEL_DATA_OFFSET) + b.rawPixelSize > blockData.size())
+				denseIndex.assign(GLYPH_CACHE_DENSE_RANGE, DENSE_EMPTY);
+				
+				for (size_t i = 0; i < count; ++i)
 				{
-					return ImportResult::RESULT_UNEXPECTED_EOF;
+					const GlyphBlock& b = infos[i];
+					
+					//the table char code is the lookup key
+					u32 charCode = newTables[i].charCode;
+					
+					metrics.charCodes.push_back(charCode);
+					metrics.widths.push_back(b.width);
+					metrics.heights.push_back(b.height);
+					metrics.bearingX.push_back(b.bearingX);
+					metrics.bearingY.push_back(b.bearingY);
+					metrics.advances.push_back(b.advance);
+					metrics.vertices.push_back(b.vertices);
+					metrics.rawPixelSizes.push_back(b.rawPixelSize);
+					
+					if (charCode < GLYPH_CACHE_DENSE_RANGE)
+					{
+						//first table entry wins for duplicate char codes
+						if (denseIndex[charCode] == DENSE_EMPTY) denseIndex[charCode] = scast<u16>(i);
+					}
+					else sparseIndex.try_emplace(charCode, scast<u32>(i));
 				}
 				
-				//raw pixel data
-				b.rawPixels.resize(b.rawPixelSize);
-				memcpy(b.rawPixels.data(), blockData.data() + relativeOffset + RAW_PIXEL_DATA_OFFSET, b.rawPixelSize);
+				pixels.resize(count);
+				lruPrev.assign(count, INVALID_GLYPH);
+				lruNext.assign(count, INVALID_GLYPH);
+				resident.assign(count, 0);
 				
-				blocks.push_back(std::move(b));
+				filePath = inFile;
+				header = newHeader;
+				tables = std::move(newTables);
+				pixelBudget = maxPixelBytes;
+				
+				return ImportResult::RESULT_SUCCESS;
+			}
+			catch (...)
+			{
+				Clear();
+				return ImportResult::RESULT_UNKNOWN_READ_ERROR;
+			}
+		}
+		
+		//Releases all tables, metrics and pixel payloads
+		inline void Clear()
+		{
+			filePath.clear();
+			header = {};
+			tables.clear();
+			metrics = {};
+			denseIndex.clear();
+			sparseIndex.clear();
+			pixels.clear();
+			lruPrev.clear();
+			lruNext.clear();
+			resident.clear();
+			lruHead = INVALID_GLYPH;
+			lruTail = INVALID_GLYPH;
+			residentCount = 0;
+			residentBytes = 0;
+		}
+		
+		//Returns the glyph index of the char code or INVALID_GLYPH if the font does not have it
+		inline u32 Find(u32 charCode) const
+		{
+			if (charCode < GLYPH_CACHE_DENSE_RANGE)
+			{
+				if (denseIndex.empty()) return INVALID_GLYPH;
+				
+				u16 index = denseIndex[charCode];
+				return index == DENSE_EMPTY ? INVALID_GLYPH : index;
 			}
 			
-			outHeader = header;
-			outTables = std::move(tables);
-			outBlocks = std::move(blocks);
+			auto it = sparseIndex.find(charCode);
+			return it == sparseIndex.end() ? INVALID_GLYPH : it->second;
+		}
+		
+		inline bool Contains(u32 charCode) const { return Find(charCode) != INVALID_GLYPH; }
+		
+		//Returns the pixels of the glyph at index, streams them from the file if they are not resident.
+		//outPixels stays valid until the next call that loads pixels or Clear
+		inline ImportResult GetPixels(
+			u32 index,
+			span<const u8>& outPixels)
+		{
+			if (index >= tables.size()) return ImportResult::RESULT_INVALID_GLYPH_COUNT;
+			
+			if (!IsResident(index))
+			{
+				ImportResult loadResult = LoadPixels(&index, 1);
+				if (loadResult != ImportResult::RESULT_SUCCESS) return loadResult;
+			}
+			else Touch(index);
+			
+			outPixels = pixels[index];
+			return ImportResult::RESULT_SUCCESS;
+		}
+		
+		//Streams all missing pixel payloads of the char codes with one batched read,
+		//char codes the font does not have are skipped
+		inline ImportResult Prefetch(span<const u32> charCodes)
+		{
+			vector<u32> missing{};
+			missing.reserve(charCodes.size());
+			
+			for (u32 c : charCodes)
+			{
+				u32 index = Find(c);
+				if (index == INVALID_GLYPH) continue;
+				
+				if (IsResident(index)) Touch(index);
+				else missing.push_back(index);
+			}
+			
+			if (missing.empty()) return ImportResult::RESULT_SUCCESS;
+			
+			return LoadPixels(missing.data(), missing.size());
+		}
+		
+		//Drops the pixel payload of the glyph at index, its metrics stay resident
+		inline void Evict(u32 index)
+		{
+			if (index >= tables.size()
+				|| !IsResident(index))
+			{
+				return;
+			}
+			
+			residentBytes -= pixels[index].size();
+			vector<u8>().swap(pixels[index]);
+			
+			Unlink(index);
+			resident[index] = 0;
+			--residentCount;
+		}
+		
+		inline bool IsResident(u32 index) const
+		{
+			return index < resident.size()
+				&& resident[index] != 0;
+		}
+		
+		inline const GlyphHeader& GetHeader() const { return header; }
+		inline const vector<GlyphTable>& GetTables() const { return tables; }
+		inline const GlyphMetrics& GetMetrics() const { return metrics; }
+		inline size_t GetGlyphCount() const { return tables.size(); }
+		inline size_t GetResidentBytes() const { return residentBytes; }
+		inline size_t GetPixelBudget() const { return pixelBudget; }
+	private:
+		//Dense table value for char codes that are not in the font
+		static constexpr u16 DENSE_EMPTY = 0xFFFFu;
+		
+		//Removes the glyph at index from the recently used order
+		inline void Unlink(u32 index)
+		{
+			u32 prev = lruPrev[index];
+			u32 next = lruNext[index];
+			
+			if (prev != INVALID_GLYPH) lruNext[prev] = next;
+			else lruHead = next;
+			
+			if (next != INVALID_GLYPH) lruPrev[next] = prev;
+			else lruTail = prev;
+			
+			lruPrev[index] = INVALID_GLYPH;
+			lruNext[index] = INVALID_GLYPH;
+		}
+		
+		//Places the glyph at index as the most recently used one
+		inline void PushFront(u32 index)
+		{
+			lruPrev[index] = INVALID_GLYPH;
+			lruNext[index] = lruHead;
+			
+			if (lruHead != INVALID_GLYPH) lruPrev[lruHead] = index;
+			lruHead = index;
+			
+			if (lruTail == INVALID_GLYPH) lruTail = index;
+		}
+		
+		//Marks the resident glyph at index as the most recently used one
+		inline void Touch(u32 index)
+		{
+			if (lruHead == index) return;
+			
+			Unlink(index);
+			PushFront(index);
+		}
+		
+		inline ImportResult LoadPixels(
+			const u32* indices,
+			size_t count)
+		{
+			//a glyph can be requested more than once in one batch,
+			//it is streamed once and counted once by the eviction guard
+			vector<u32> batch(indices, indices + count);
+			sort(batch.begin(), batch.end());
+			batch.erase(
+				std::unique(batch.begin(), batch.end()),
+				batch.end());
+			
+			vector<GlyphTable> requested{};
+			requested.reserve(batch.size());
+			for (u32 index : batch) requested.push_back(tables[index]);
+			
+			vector<GlyphBlock> loaded{};
+			ImportResult streamResult = StreamGlyphs(
+				filePath,
+				requested,
+				loaded,
+				true);
+				
+			if (streamResult != ImportResult::RESULT_SUCCESS) return streamResult;
+			
+			for (size_t i = 0; i < batch.size(); ++i)
+			{
+				u32 index = batch[i];
+				
+				if (IsResident(index))
+				{
+					Touch(index);
+					continue;
+				}
+				
+				residentBytes += loaded[i].rawPixels.size();
+				pixels[index] = std::move(loaded[i].rawPixels);
+				
+				PushFront(index);
+				resident[index] = 1;
+				++residentCount;
+			}
+			
+			//evict least recently used payloads but never the ones that were just requested
+			while (residentBytes > pixelBudget
+				&& residentCount > batch.size())
+			{
+				Evict(lruTail);
+			}
+			
+			return ImportResult::RESULT_SUCCESS;
+		}
+		
+		path filePath{};
+		GlyphHeader header{};
+		vector<GlyphTable> tables{};
+		GlyphMetrics metrics{};
+		
+		vector<u16> denseIndex{};
+		unordered_map<u32, u32> sparseIndex{};
+		
+		//pixel payloads and their least-recently-used order as index links
+		vector<vector<u8>> pixels{};
+		vector<u32> lruPrev{};
+		vector<u32> lruNext{};
+		vector<u8> resident{};
+		u32 lruHead = INVALID_GLYPH;
+		u32 lruTail = INVALID_GLYPH;
+		size_t residentCount{};
+		size_t residentBytes{};
+		size_t pixelBudget = DEFAULT_GLYPH_PIXEL_BUDGET;
+	};
+	//Where a glyph was packed inside a GlyphAtlas, uvs are normalized with 0,0 at the top-left
+	struct GlyphAtlasRect
+	{
+		u32 charCode{}; //glyph character code in unicode
+		u16 x{};        //left edge in pixels
+		u16 y{};        //top edge in pixels
+		u16 width{};    //glyph width in pixels
+		u16 height{};   //glyph height in pixels
+		f32 u0{};       //left uv
+		f32 v0{};       //top uv
+		f32 u1{};       //right uv
+		f32 v1{};       //bottom uv
+	};
+	
+	//One contiguous texture buffer holding every glyph of a per-glyph kfd file
+	struct GlyphAtlas
+	{
+		u32 width{};             //atlas width in pixels, always a power of two
+		u32 height{};            //atlas height in pixels, always a power of two
+		u8 channels{};           //bytes per pixel, same as the glyph raw pixels
+		vector<u8> pixels{};     //width * height * channels bytes, rows top to bottom
+		vector<GlyphAtlasRect> rects{}; //same order as the glyph blocks the atlas was built from
+	};
+	
+	//Returns a fingerprint of the size and last write time of a kfd file,
+	//used for detecting kfa cache files that no longer match their kfd file without importing it.
+	//Returns 0 if the file could not be read, LoadGlyphAtlas treats 0 as always stale
+	inline u64 GetAtlasSourceHash(const path& kfdFile)
+	{
+		error_code ec{};
+		
+		const u64 size = scast<u64>(file_size(kfdFile, ec));
+		if (ec) return 0;
+		
+		const u64 writeTime = scast<u64>(last_write_time(kfdFile, ec).time_since_epoch().count());
+		if (ec) return 0;
+		
+		//FNV-1a
+		u64 hash = 14695981039346656037ull;
+		auto mix = [&hash](u64 value)
+			{
+				for (int i = 0; i < 8; ++i)
+				{
+					hash ^= (value >> (i * 8)) & 0xFF;
+					hash *= 1099511628211ull;
+				}
+			};
+			
+		mix(size);
+		mix(writeTime);
+		
+		return hash == 0 ? 1 : hash;
+	}
+	
+	//Packs the glyphs of a per-glyph kfd file (type 2) into one atlas with a shelf packer.
+	//Glyphs are placed tallest first with padding pixels of empty space around each of them,
+	//the atlas grows in powers of two up to maxAtlasSize in both axis
+	inline ImportResult BuildGlyphAtlas(
+		const GlyphHeader& header,
+		const vector<GlyphBlock>& blocks,
+		GlyphAtlas& outAtlas,
+		u16 padding = 1,
+		u32 maxAtlasSize = 4096u)
+	{
+		if (header.type != 2) return ImportResult::RESULT_INVALID_TYPE;
+		if (blocks.empty()) return ImportResult::RESULT_INVALID_GLYPH_COUNT;
+		
+		maxAtlasSize = min(maxAtlasSize, MAX_ATLAS_SIZE);
+		
+		//every glyph must use the same amount of bytes per pixel
+		
+		u8 channels{};
+		size_t totalArea{};
+		
+		for (const auto& b : blocks)
+		{
+			size_t area = scast<size_t>(b.width) * b.height;
+			if (area == 0) continue;
+			
+			if (b.rawPixels.size() % area != 0) return ImportResult::RESULT_INVALID_GLYPH_BLOCK_SIZE;
+			
+			size_t glyphChannels = b.rawPixels.size() / area;
+			if (glyphChannels == 0
+				|| glyphChannels > 4
+				|| (channels != 0 && glyphChannels != channels))
+			{
+				return ImportResult::RESULT_INVALID_GLYPH_BLOCK_SIZE;
+			}
+			
+			channels = scast<u8>(glyphChannels);
+			totalArea += (scast<size_t>(b.width) + padding) * (scast<size_t>(b.height) + padding);
+		}
+		
+		if (channels == 0) channels = 1;
+		
+		//tallest glyphs first keeps shelves tight
+		
+		vector<size_t> order(blocks.size());
+		iota(order.begin(), order.end(), 0);
+		sort(order.begin(), order.end(),
+			[&blocks](size_t a, size_t b)
+			{
+				if (blocks[a].height != blocks[b].height) return blocks[a].height > blocks[b].height;
+				return blocks[a].width > blocks[b].width;
+			});
+			
+		vector<GlyphAtlasRect> rects(blocks.size());
+		
+		//returns the packed height or 0 if the glyphs did not fit into width
+		auto pack = [&](u32 width) -> u32
+			{
+				size_t x = padding;
+				size_t y = padding;
+				size_t shelfHeight{};
+				
+				for (size_t i : order)
+				{
+					const GlyphBlock& b = blocks[i];
+					GlyphAtlasRect& r = rects[i];
+					
+					r = {};
+					r.charCode = b.charCode;
+					
+					if (b.width == 0 || b.height == 0) continue;
+					if (b.width + 2u * padding > width) return 0;
+					
+					//start a new shelf
+					if (x + b.width + padding > width)
+					{
+						x = padding;
+						y += shelfHeight + padding;
+						shelfHeight = 0;
+					}
+					
+					if (y + b.height + padding > maxAtlasSize) return 0;
+					
+					r.x = scast<u16>(x);
+					r.y = scast<u16>(y);
+					r.width = b.width;
+					r.height = b.height;
+					
+					x += b.width + padding;
+					shelfHeight = max(shelfHeight, scast<size_t>(b.height));
+				}
+				
+				return scast<u32>(y + shelfHeight + padding);
+			};
+			
+		u32 width = bit_ceil(max(
+			scast<u32>(sqrt(scast<double>(totalArea))),
+			16u));
+		u32 usedHeight{};
+		
+		while (width <= maxAtlasSize)
+		{
+			usedHeight = pack(width);
+			if (usedHeight != 0) break;
+			
+			width *= 2;
+		}
+		
+		if (width > maxAtlasSize
+			|| usedHeight == 0)
+		{
+			return ImportResult::RESULT_ATLAS_OVERFLOW;
+		}
+		
+		u32 height = bit_ceil(usedHeight);
+		if (height > maxAtlasSize) return ImportResult::RESULT_ATLAS_OVERFLOW;
+		
+		try
+		{
+			GlyphAtlas atlas{};
+			atlas.width = width;
+			atlas.height = height;
+			atlas.channels = channels;
+			atlas.pixels.assign(scast<size_t>(width) * height * channels, 0);
+			
+			const size_t atlasPitch = scast<size_t>(width) * channels;
+			
+			for (size_t i = 0; i < blocks.size(); ++i)
+			{
+				const GlyphBlock& b = blocks[i];
+				GlyphAtlasRect& r = rects[i];
+				
+				if (r.width == 0) continue;
+				
+				const size_t glyphPitch = scast<size_t>(r.width) * channels;
+				
+				for (size_t row = 0; row < r.height; ++row)
+				{
+					memcpy(
+						atlas.pixels.data() + (r.y + row) * atlasPitch + scast<size_t>(r.x) * channels,
+						b.rawPixels.data() + row * glyphPitch,
+						glyphPitch);
+				}
+				
+				r.u0 = scast<f32>(r.x) / width;
+				r.v0 = scast<f32>(r.y) / height;
+				r.u1 = scast<f32>(r.x + r.width) / width;
+				r.v1 = scast<f32>(r.y + r.height) / height;
+			}
+			
+			atlas.rects = std::move(rects);
+			outAtlas = std::move(atlas);
+			
+			return ImportResult::RESULT_SUCCESS;
+		}
+		catch (...)
+		{
+			return ImportResult::RESULT_UNKNOWN_READ_ERROR;
+		}
+	}
+	
+	/*---------------------------------------------------------------------------------------------
+	
+	# KFA binary top header
+	
+	Offset | Size | Field
+	-------|------|--------------------------------------------
+	0      | 4    | KFA magic word, always 'K', 'F', 'A', '\0'
+	4      | 1    | kfa binary version
+	5      | 1    | channels - bytes per pixel
+	6      | 2    | unused, always '0'
+	8      | 8    | source hash - GetAtlasSourceHash of the kfd file the atlas was built from
+	16     | 2    | atlas width (stored as width - 1)
+	18     | 2    | atlas height (stored as height - 1)
+	20     | 4    | glyph rect count
+	
+	# KFA binary glyph rect
+	
+	Offset | Size | Field
+	-------|------|--------------------------------------------
+	??     | 4    | character code in unicode
+	??+4   | 2    | left edge in pixels
+	??+6   | 2    | top edge in pixels
+	??+8   | 2    | width
+	??+10  | 2    | height
+	
+	Followed by width * height * channels atlas pixels, uvs are rebuilt on load.
+	
+	---------------------------------------------------------------------------------------------*/
+	
+	//Saves the packed atlas to a kfa cache file so later launches can skip packing,
+	//sourceHash should come from GetAtlasSourceHash of the kfd file the atlas was built from
+	inline ImportResult SaveGlyphAtlas(
+		const path& outFile,
+		const GlyphAtlas& atlas,
+		u64 sourceHash)
+	{
+		if (atlas.width == 0
+			|| atlas.height == 0
+			|| atlas.width > MAX_ATLAS_SIZE
+			|| atlas.height > MAX_ATLAS_SIZE
+			|| atlas.pixels.size() != scast<size_t>(atlas.width) * atlas.height * atlas.channels)
+		{
+			return ImportResult::RESULT_ATLAS_OVERFLOW;
+		}
+		
+		try
+		{
+			vector<u8> data(CORRECT_ATLAS_HEADER_SIZE + atlas.rects.size() * CORRECT_ATLAS_RECT_SIZE);
+			
+			u16 storedWidth = scast<u16>(atlas.width - 1);
+			u16 storedHeight = scast<u16>(atlas.height - 1);
+			u32 rectCount = scast<u32>(atlas.rects.size());
+			
+			memcpy(data.data() + 0,  &KFA_MAGIC,      sizeof(u32));
+			memcpy(data.data() + 4,  &KFA_VERSION,    sizeof(u8));
+			memcpy(data.data() + 5,  &atlas.channels, sizeof(u8));
+			memcpy(data.data() + 8,  &sourceHash,     sizeof(u64));
+			memcpy(data.data() + 16, &storedWidth,    sizeof(u16));
+			memcpy(data.data() + 18, &storedHeight,   sizeof(u16));
+			memcpy(data.data() + 20, &rectCount,      sizeof(u32));
+			
+			u8* p = data.data() + CORRECT_ATLAS_HEADER_SIZE;
+			for (const auto& r : atlas.rects)
+			{
+				memcpy(p + 0,  &r.charCode, sizeof(u32));
+				memcpy(p + 4,  &r.x,        sizeof(u16));
+				memcpy(p + 6,  &r.y,        sizeof(u16));
+				memcpy(p + 8,  &r.width,    sizeof(u16));
+				memcpy(p + 10, &r.height,   sizeof(u16));
+				p += CORRECT_ATLAS_RECT_SIZE;
+			}
+			
+			ofstream out(outFile, ios::out | ios::binary | ios::trunc);
+			if (out.fail()) return ImportResult::RESULT_ATLAS_WRITE_FAILED;
+			
+			out.write(rcast<const char*>(data.data()), scast<streamsize>(data.size()));
+			out.write(rcast<const char*>(atlas.pixels.data()), scast<streamsize>(atlas.pixels.size()));
+			
+			if (out.fail()) return ImportResult::RESULT_ATLAS_WRITE_FAILED;
+			
+			out.close();
+			
+			return ImportResult::RESULT_SUCCESS;
+		}
+		catch (...)
+		{
+			return ImportResult::RESULT_ATLAS_WRITE_FAILED;
+		}
+	}
+	
+	//Loads a packed atlas from a kfa cache file,
+	//returns RESULT_ATLAS_STALE if it was not built from the kfd file that expectedSourceHash belongs to
+	inline ImportResult LoadGlyphAtlas(
+		const path& inFile,
+		u64 expectedSourceHash,
+		GlyphAtlas& outAtlas)
+	{
+		if (expectedSourceHash == 0) return ImportResult::RESULT_ATLAS_STALE;
+		if (!exists(inFile)) return ImportResult::RESULT_FILE_NOT_FOUND;
+		if (!is_regular_file(inFile)) return ImportResult::RESULT_INVALID_EXTENSION;
+		
+		try
+		{
+			ifstream in(inFile, ios::in | ios::binary);
+			if (in.fail()) return ImportResult::RESULT_UNKNOWN_READ_ERROR;
+			
+			in.seekg(0, ios::end);
+			size_t fileSize = scast<size_t>(in.tellg());
+			in.seekg(0, ios::beg);
+			
+			if (fileSize == 0) return ImportResult::RESULT_FILE_EMPTY;
+			if (fileSize < CORRECT_ATLAS_HEADER_SIZE) return ImportResult::RESULT_FILE_TOO_SMALL;
+			
+			u8 headerData[CORRECT_ATLAS_HEADER_SIZE]{};
+			in.read(rcast<char*>(headerData), CORRECT_ATLAS_HEADER_SIZE);
+			
+			u32 magic{};
+			u8 version{};
+			u8 channels{};
+			u64 sourceHash{};
+			u16 storedWidth{};
+			u16 storedHeight{};
+			u32 rectCount{};
+			
+			memcpy(&magic,        headerData + 0,  sizeof(u32));
+			memcpy(&version,      headerData + 4,  sizeof(u8));
+			memcpy(&channels,     headerData + 5,  sizeof(u8));
+			memcpy(&sourceHash,   headerData + 8,  sizeof(u64));
+			memcpy(&storedWidth,  headerData + 16, sizeof(u16));
+			memcpy(&storedHeight, headerData + 18, sizeof(u16));
+			memcpy(&rectCount,    headerData + 20, sizeof(u32));
+			
+			if (magic != KFA_MAGIC) return ImportResult::RESULT_INVALID_MAGIC;
+			if (version != KFA_VERSION) return ImportResult::RESULT_INVALID_VERSION;
+			if (sourceHash != expectedSourceHash) return ImportResult::RESULT_ATLAS_STALE;
+			if (rectCount > MAX_GLYPH_COUNT) return ImportResult::RESULT_INVALID_GLYPH_COUNT;
+			
+			u32 width = scast<u32>(storedWidth) + 1;
+			u32 height = scast<u32>(storedHeight) + 1;
+			
+			if (channels == 0
+				|| channels > 4
+				|| width > MAX_ATLAS_SIZE
+				|| height > MAX_ATLAS_SIZE)
+			{
+				return ImportResult::RESULT_INVALID_GLYPH_BLOCK_SIZE;
+			}
+			
+			size_t rectsSize = scast<size_t>(rectCount) * CORRECT_ATLAS_RECT_SIZE;
+			size_t pixelsSize = scast<size_t>(width) * height * channels;
+			
+			if (fileSize != CORRECT_ATLAS_HEADER_SIZE + rectsSize + pixelsSize)
+			{
+				return ImportResult::RESULT_UNEXPECTED_EOF;
+			}
+			
+			vector<u8> rectData(rectsSize);
+			in.read(rcast<char*>(rectData.data()), scast<streamsize>(rectsSize));
+			
+			GlyphAtlas atlas{};
+			atlas.width = width;
+			atlas.height = height;
+			atlas.channels = channels;
+			atlas.rects.resize(rectCount);
+			
+			for (size_t i = 0; i < rectCount; ++i)
+			{
+				const u8* p = rectData.data() + i * CORRECT_ATLAS_RECT_SIZE;
+				GlyphAtlasRect& r = atlas.rects[i];
+				
+				memcpy(&r.charCode, p + 0,  sizeof(u32));
+				memcpy(&r.x,        p + 4,  sizeof(u16));
+				memcpy(&r.y,        p + 6,  sizeof(u16));
+				memcpy(&r.width,    p + 8,  sizeof(u16));
+				memcpy(&r.height,   p + 10, sizeof(u16));
+				
+				if (scast<u32>(r.x) + r.width > width
+					|| scast<u32>(r.y) + r.height > height)
+				{
+					return ImportResult::RESULT_INVALID_GLYPH_BLOCK_SIZE;
+				}
+				
+				if (r.width == 0) continue;
+				
+				r.u0 = scast<f32>(r.x) / width;
+				r.v0 = scast<f32>(r.y) / height;
+				r.u1 = scast<f32>(r.x + r.width) / width;
+				r.v1 = scast<f32>(r.y + r.height) / height;
+			}
+			
+			atlas.pixels.resize(pixelsSize);
+			in.read(rcast<char*>(atlas.pixels.data()), scast<streamsize>(pixelsSize));
+			
+			if (scast<size_t>(in.gcount()) != pixelsSize) return ImportResult::RESULT_UNEXPECTED_EOF;
+			
+			in.close();
+			
+			outAtlas = std::move(atlas);
 			
 			return ImportResult::RESULT_SUCCESS;
 		}
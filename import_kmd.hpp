@@ -8,6 +8,11 @@
 //
 // Provides:
 //   - Helpers for streaming individual models or loading the full kalamodeldata binary into memory
+//   - Memory-mapped import mode that returns borrowed vertex and index views without copying
+//   - Asynchronous import that decodes model blocks in parallel with a per-block callback
+//   - Model-space AABB and bounding sphere per model block, computed once at import
+//   - Version 2 blocks with quantized vertex attributes, 16-bit indices and chunked LZ4 compression
+//   - Mesh post-processing: vertex cache, overdraw and vertex fetch order, LOD index buffer chains
 //---------------------------------------------------------------------------
 
 /*---------------------------------------------------------------------------------------------
@@ -76,6 +81,51 @@ Render type:
 	2 - masked (assigned if material is enabled, material has transparent texture or color but alpha/transparency is 100% or 0%)
 	3-255 - unused, defaults to 0
 
+# KMD version 2 model block
+
+Same as version 1 up to and including the model size, version 1 files keep loading as before.
+
+Offset | Size | Field
+-------|------|--------------------------------------------
+??+132 | 4    | vertex count
+??+136 | 4    | vertex stream size as stored in the file
+??+140 | 4    | index count
+??+144 | 4    | index stream size as stored in the file
+??+148 | 1    | vertex encoding (bit flags)
+??+149 | 1    | index encoding (0-1)
+??+150 | 1    | stream compression (0-1)
+??+151 | 1    | LOD count (0-8)
+??+152 | ???  | vertex stream
+??+??  | ???  | index stream
+??+??  | 12   | per LOD: index count, index stream size as stored, f32 simplification error
+??+??  | ???  | per LOD: index stream, same index encoding and compression as the main index stream
+
+Vertex encoding, each encoded vertex is position, normal, texCoord, tangent in that order:
+	0 - normal as octahedral snorm16 x2 instead of f32 x3
+	1 - tangent as octahedral snorm16 x2 instead of f32 x4, lowest bit of the second value is set if tw is negative
+	2 - texCoord as half float x2 instead of f32 x2
+	3 - texCoord as unorm16 x2 in the 0-1 range instead of f32 x2
+	4-7 - unused, bits 2 and 3 can't both be set
+
+Index encoding:
+	0 - u32
+	1 - u16 (vertex count must be 65536 or less)
+	2-255 - unused
+
+LOD count:
+	0 - no LODs
+	1-8 - index buffers of progressively simplified versions of the mesh, all indexing the same vertex stream.
+	      The simplification error is relative to the largest extent of the model-space AABB
+	9-255 - unused
+
+Stream compression:
+	0 - none, the stream is the encoded vertices or indices as-is
+	1 - chunked LZ4, the stream is a sequence of chunks of
+	    u32 raw size, u32 stored size and the stored bytes in the LZ4 block format,
+	    chunks whose stored size equals their raw size are stored uncompressed.
+	    Raw chunk sizes are at most 64 KB and always a multiple of the encoded vertex or index size
+	2-255 - unused
+
 ---------------------------------------------------------------------------------------------*/
 
 #pragma once
@@ -86,6 +136,42 @@ Render type:
 #include <string>
 #include <fstream>
 #include <filesystem>
+#include <span>
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <cstddef>
+#include <cmath>
+
+#ifdef _WIN32
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+//
+// PROFILER HOOKS
+//
+
+//Recorded by profile_utils.hpp if it is included first with KPROFILE_ENABLED defined,
+//otherwise every zone and counter below compiles to nothing
+#ifndef KPROFILE_ZONE
+	#define KPROFILE_HOOKS_FALLBACK
+	#define KPROFILE_ZONE(name)
+	#define KPROFILE_COUNTER(name, value) do {} while (0)
+#endif
 
 namespace KalaHeaders::KalaModelData
 {	
@@ -112,17 +198,39 @@ namespace KalaHeaders::KalaModelData
 	using std::ios;
 	using std::move;
 	using std::memcpy;
+	using std::span;
+	using std::sort;
+	using std::fill;
+	using std::iota;
+	using std::min;
+	using std::max;
+	using std::clamp;
+	using std::sqrt;
+	using std::fabs;
+	using std::thread;
+	using std::atomic;
+	using std::function;
+	using std::shared_ptr;
+	using std::make_shared;
+	using std::memory_order_relaxed;
+	using std::memory_order_acquire;
+	using std::memory_order_release;
+	using std::memory_order_acq_rel;
 	
 	using u8 = uint8_t;
 	using u16 = uint16_t;
 	using u32 = uint32_t;
+	using i16 = int16_t;
 	using f32 = float;
 	
 	//The magic that must exist in all kmd files at the first four bytes
 	inline constexpr u32 KMD_MAGIC = 0x00444D4B;
 	
-	//The version that must exist in all kmd files as the fifth byte
-	inline constexpr u8 KMD_VERSION = 1;
+	//The newest version that may exist in kmd files as the fifth byte
+	inline constexpr u8 KMD_VERSION = 2;
+	
+	//The oldest version that is still imported
+	inline constexpr u8 KMD_MIN_VERSION = 1;
 	
 	//The true top header size that is always required
 	inline constexpr u8 CORRECT_MODEL_HEADER_SIZE = 18u;
@@ -133,6 +241,32 @@ namespace KalaHeaders::KalaModelData
 	//The offset where vertice data must always start relative to each model block
 	inline constexpr u8 VERTICE_DATA_OFFSET = 148u;
 	
+	//The offset where the vertex stream starts relative to each version 2 model block
+	inline constexpr u8 VERTICE_DATA_OFFSET_V2 = 152u;
+	
+	//Version 2 vertex encoding flags
+	inline constexpr u8 VERTEX_OCTAHEDRAL_NORMAL = 1u << 0;
+	inline constexpr u8 VERTEX_OCTAHEDRAL_TANGENT = 1u << 1;
+	inline constexpr u8 VERTEX_HALF_TEXCOORD = 1u << 2;
+	inline constexpr u8 VERTEX_UNORM_TEXCOORD = 1u << 3;
+	
+	//Version 2 index encodings
+	inline constexpr u8 INDEX_U32 = 0u;
+	inline constexpr u8 INDEX_U16 = 1u;
+	
+	//Version 2 stream compression types
+	inline constexpr u8 COMPRESSION_NONE = 0u;
+	inline constexpr u8 COMPRESSION_LZ4 = 1u;
+	
+	//Max raw size in bytes of a single compressed stream chunk (64 KB)
+	inline constexpr u32 MAX_STREAM_CHUNK_SIZE = 65536u;
+	
+	//Max LOD index buffers per version 2 model block
+	inline constexpr u8 MAX_LOD_COUNT = 8u;
+	
+	//Size of each LOD entry in a version 2 model block
+	inline constexpr u8 LOD_TABLE_ENTRY_SIZE = 12u;
+	
 	//Max allowed models
 	inline constexpr u16 MAX_MODEL_COUNT = 1024u;
 	
@@ -142,6 +276,12 @@ namespace KalaHeaders::KalaModelData
 	//Max allowed total model blocks size in bytes (1 GB)
 	inline constexpr u32 MAX_MODEL_BLOCK_SIZE = 1073741824u;
 	
+	//Streamed blocks separated by at most this many bytes are read with a single call (4 KB)
+	inline constexpr u32 STREAM_MERGE_GAP = 4096u;
+	
+	//Streamed ranges are not merged past this size in bytes (64 MB), larger blocks are read alone
+	inline constexpr u32 MAX_STREAM_RANGE_SIZE = 67108864u;
+	
 	//Not allowed to be less than this position in X, Y or Z axis
 	inline constexpr f32 MIN_POS = -10000.0f;
 	//Not allowed to be more than this position in X, Y or Z axis
@@ -195,6 +335,30 @@ namespace KalaHeaders::KalaModelData
 		f32 texCoord[2]{}; //u, v
 		f32 tangent[4]{};  //tx, ty, tz, tw
 	};
+	
+	//Simplified index buffer of a model block, indexes the same vertices as the full-detail indices
+	struct ModelLod
+	{
+		vector<u32> indices{};
+		f32 error{}; //simplification error relative to the largest aabb extent
+	};
+	
+	//Simplified index buffer of a model block view
+	struct ModelLodView
+	{
+		span<const u32> indices{};
+		f32 error{}; //simplification error relative to the largest aabb extent
+	};
+	
+	//Model-space bounds of the vertex positions of a model block,
+	//all zero if the block has no vertices
+	struct ModelBounds
+	{
+		f32 aabbMin[3]{}; //x, y, z (vector3)
+		f32 aabbMax[3]{}; //x, y, z (vector3)
+		f32 center[3]{};  //bounding sphere center, same as the aabb center
+		f32 radius{};     //bounding sphere radius
+	};
 		
 	//The block containing data of each model
 	struct ModelBlock
@@ -209,13 +373,77 @@ namespace KalaHeaders::KalaModelData
 		f32 rotation[4]{}; //w, x, y, z (quaternion)
 		f32 size[3]{};     //x, y, z (vector3)
 		
+		//version 2 blocks store the offsets and sizes of the encoded streams
 		u32 verticesOffset{};
 		u32 verticesSize{};
 		u32 indicesOffset{};
 		u32 indicesSize{};
 		
+		u32 vertexCount{};
+		u32 indexCount{};
+		
+		//how the vertices and indices were stored in the file, always 0 for version 1
+		u8 vertexEncoding{};
+		u8 indexEncoding{};
+		u8 compression{};
+		u8 lodCount{};
+		
 		vector<Vertex> vertices{};
 		vector<u32> indices{};
+		
+		//progressively simplified index buffers, only stored by version 2 blocks
+		vector<ModelLod> lods{};
+		
+		ModelBounds bounds{}; //computed from vertices at import
+	};
+	
+	//The block containing data of each model,
+	//vertices and indices are borrowed from the MappedModelFile they were imported from.
+	//vertexBytes and indexBytes point straight into the mapping and can be uploaded as-is,
+	//vertices and indices point into the mapping only if the block data is aligned inside the file.
+	//Quantized or compressed version 2 blocks are decoded once into the storage of the MappedModelFile
+	struct ModelBlockView
+	{
+		char nodeName[20]{}; //19 chars + null terminator
+		char meshName[20]{}; //19 chars + null terminator
+		char nodePath[50]{}; //49 chars + null terminator
+		u8 dataTypeFlags{};  //defines what kind of data was stored to this model data block
+		u8 renderType{};     //defines if this model is opaque, transparent or masked
+		
+		f32 position[3]{}; //x, y, z (vector3)
+		f32 rotation[4]{}; //w, x, y, z (quaternion)
+		f32 size[3]{};     //x, y, z (vector3)
+		
+		//version 2 blocks store the offsets and sizes of the encoded streams
+		u32 verticesOffset{};
+		u32 verticesSize{};
+		u32 indicesOffset{};
+		u32 indicesSize{};
+		
+		u32 vertexCount{};
+		u32 indexCount{};
+		
+		//how the vertices and indices were stored in the file, always 0 for version 1
+		u8 vertexEncoding{};
+		u8 indexEncoding{};
+		u8 compression{};
+		u8 lodCount{};
+		
+		span<const u8> vertexBytes{};
+		span<const u8> indexBytes{};
+		
+		span<const Vertex> vertices{};
+		span<const u32> indices{};
+		
+		//progressively simplified index buffers, only stored by version 2 blocks
+		vector<ModelLodView> lods{};
+		
+		ModelBounds bounds{}; //computed from vertexBytes at import
+		
+		//false if the block data was not aligned for Vertex or u32 and was either
+		//copied into the storage of its MappedModelFile or left empty,
+		//or if it was decoded from a quantized or compressed version 2 block
+		bool isBorrowed{};
 	};
 	
 	enum class ImportResult : u8
@@ -249,7 +477,10 @@ namespace KalaHeaders::KalaModelData
 		RESULT_INVALID_MODEL_SIZE          = 15, //model size must be within range
 		RESULT_INVALID_MODEL_TABLE_SIZE    = 16, //found a model table that wasnt the correct size
 		RESULT_INVALID_MODEL_BLOCK_SIZE    = 17, //found a model block that was less or more than the allowed size
-		RESULT_UNEXPECTED_EOF              = 18  //file reached end sooner than expected
+		RESULT_UNEXPECTED_EOF              = 18, //file reached end sooner than expected
+		RESULT_MAP_FAILED                  = 19, //failed to memory-map the file
+		RESULT_INVALID_ENCODING            = 20, //version 2 vertex, index or compression type must be within range
+		RESULT_DECOMPRESSION_FAILED        = 21  //version 2 stream chunks were corrupt or didn't match the counts
 	};
 	
 	inline constexpr string ResultToString(ImportResult result)
@@ -299,6 +530,12 @@ namespace KalaHeaders::KalaModelData
 			return "RESULT_INVALID_MODEL_BLOCK_SIZE";
 		case ImportResult::RESULT_UNEXPECTED_EOF:
 			return "RESULT_UNEXPECTED_EOF";
+		case ImportResult::RESULT_MAP_FAILED:
+			return "RESULT_MAP_FAILED";
+		case ImportResult::RESULT_INVALID_ENCODING:
+			return "RESULT_INVALID_ENCODING";
+		case ImportResult::RESULT_DECOMPRESSION_FAILED:
+			return "RESULT_DECOMPRESSION_FAILED";
 		}
 		
 		return "RESULT_UNKNOWN";
@@ -403,7 +640,11 @@ namespace KalaHeaders::KalaModelData
 			if (header.magic != KMD_MAGIC) return ImportResult::RESULT_INVALID_MAGIC;
 			
 			memcpy(&header.version, headerData.data() + 4, sizeof(u8));
-			if (header.version != KMD_VERSION) return ImportResult::RESULT_INVALID_VERSION;
+			if (header.version < KMD_MIN_VERSION
+				|| header.version > KMD_VERSION)
+			{
+				return ImportResult::RESULT_INVALID_VERSION;
+			}
 			
 			memcpy(&header.scaleFactor, headerData.data() + 5,  sizeof(u8));
 			//clamp to 0 for out of range values
@@ -503,333 +744,1038 @@ namespace KalaHeaders::KalaModelData
 		}
 	}
 	
-	//Returns model blocks for the inserted tables, set skipChecks to true if the file has already been checked
-	inline ImportResult StreamModels(
-		const path& inFile,
-		const vector<ModelTable>& inTables,
-		vector<ModelBlock>& outBlocks,
-		bool skipChecks = false)
+	//Returns the fixed-layout block header size of a kmd version, vertex data starts right after it
+	inline constexpr size_t GetVertexDataOffset(u8 version)
 	{
-		if (!skipChecks)
+		return version >= 2
+			? VERTICE_DATA_OFFSET_V2
+			: VERTICE_DATA_OFFSET;
+	}
+	
+	//Returns the size in bytes of one vertex stored with the version 2 vertex encoding flags
+	inline constexpr size_t GetEncodedVertexSize(u8 vertexEncoding)
+	{
+		return sizeof(f32) * 3
+			+ ((vertexEncoding & VERTEX_OCTAHEDRAL_NORMAL) ? 4 : 12)
+			+ ((vertexEncoding & (VERTEX_HALF_TEXCOORD | VERTEX_UNORM_TEXCOORD)) ? 4 : 8)
+			+ ((vertexEncoding & VERTEX_OCTAHEDRAL_TANGENT) ? 4 : 16);
+	}
+	
+	//Returns the size in bytes of one index stored with the version 2 index encoding
+	inline constexpr size_t GetEncodedIndexSize(u8 indexEncoding)
+	{
+		return indexEncoding == INDEX_U16
+			? sizeof(u16)
+			: sizeof(u32);
+	}
+	
+	//Returns the most raw bytes a version 2 stream of storedSize bytes can decode to.
+	//One stored LZ4 byte never expands past 255 raw bytes
+	inline constexpr size_t GetMaxStreamRawSize(
+		size_t storedSize,
+		u8 compression)
+	{
+		return compression == COMPRESSION_NONE
+			? storedSize
+			: storedSize * 255;
+	}
+	
+	//Decodes the fixed-layout part of a model block (everything before GetVertexDataOffset)
+	//into a ModelBlock or ModelBlockView, src must have atleast GetVertexDataOffset readable bytes
+	template<typename T>
+	inline ImportResult DecodeBlockHeader(
+		const u8* src,
+		T& b,
+		u8 version = KMD_MIN_VERSION)
+	{
+		memcpy(b.nodeName, src + 0, 20);
+		memcpy(b.meshName, src + 20, 20);
+		memcpy(b.nodePath, src + 40, 50);
+		
+		//data flags go from 0 to 4
+		memcpy(&b.dataTypeFlags, src + 90, sizeof(u8));
+		if (b.dataTypeFlags & ~0b00011111) return ImportResult::RESULT_INVALID_DATA_FLAGS;
+		
+		//render type goes from 0 to 2
+		memcpy(&b.renderType, src + 91, sizeof(u8));
+		if (b.renderType > 2) return ImportResult::RESULT_INVALID_RENDER_TYPE;
+		
+		f32 newPos[3]{};
+		memcpy(newPos, src + 92, sizeof(newPos));
+		
+		if (newPos[0] < MIN_POS
+			|| newPos[0] > MAX_POS
+			|| newPos[1] < MIN_POS
+			|| newPos[1] > MAX_POS
+			|| newPos[2] < MIN_POS
+			|| newPos[2] > MAX_POS)
 		{
-			ImportResult preReadResult = PreReadCheck(inFile);
-			if (preReadResult != ImportResult::RESULT_SUCCESS) return preReadResult;
-			
-			ImportResult tryOpenResult = TryOpenCheck(inFile);
-			if (tryOpenResult != ImportResult::RESULT_SUCCESS) return tryOpenResult;
+			return ImportResult::RESULT_INVALID_MODEL_POSITION;
 		}
 		
-		try
+		memcpy(b.position, newPos, sizeof(b.position));
+		
+		f32 newRot[4]{};
+		memcpy(newRot, src + 104, sizeof(newRot));
+		
+		if (newRot[0] < MIN_ROT
+			|| newRot[0] > MAX_ROT
+			|| newRot[1] < MIN_ROT
+			|| newRot[1] > MAX_ROT
+			|| newRot[2] < MIN_ROT
+			|| newRot[2] > MAX_ROT
+			|| newRot[3] < MIN_ROT
+			|| newRot[3] > MAX_ROT)
 		{
-			ifstream in(inFile, ios::in | ios::binary);
+			return ImportResult::RESULT_INVALID_MODEL_ROTATION;
+		}
+		
+		memcpy(b.rotation, newRot, sizeof(b.rotation));
+		
+		f32 newSize[3]{};
+		memcpy(newSize, src + 120, sizeof(newSize));
+		
+		if (newSize[0] < MIN_SIZE
+			|| newSize[0] > MAX_SIZE
+			|| newSize[1] < MIN_SIZE
+			|| newSize[1] > MAX_SIZE
+			|| newSize[2] < MIN_SIZE
+			|| newSize[2] > MAX_SIZE)
+		{
+			return ImportResult::RESULT_INVALID_MODEL_SIZE;
+		}
+		
+		memcpy(b.size, newSize, sizeof(b.size));
+		
+		if (version < 2)
+		{
+			memcpy(&b.verticesOffset, src + 132, sizeof(u32));
+			memcpy(&b.verticesSize,   src + 136, sizeof(u32));
+			memcpy(&b.indicesOffset,  src + 140, sizeof(u32));
+			memcpy(&b.indicesSize,    src + 144, sizeof(u32));
 			
-			in.seekg(0, ios::end);
-			size_t fileSize = scast<size_t>(in.tellg());
+			b.vertexCount = scast<u32>(b.verticesSize / sizeof(Vertex));
+			b.indexCount = scast<u32>(b.indicesSize / sizeof(u32));
+			
+			return ImportResult::RESULT_SUCCESS;
+		}
+		
+		memcpy(&b.vertexCount,    src + 132, sizeof(u32));
+		memcpy(&b.verticesSize,   src + 136, sizeof(u32));
+		memcpy(&b.indexCount,     src + 140, sizeof(u32));
+		memcpy(&b.indicesSize,    src + 144, sizeof(u32));
+		memcpy(&b.vertexEncoding, src + 148, sizeof(u8));
+		memcpy(&b.indexEncoding,  src + 149, sizeof(u8));
+		memcpy(&b.compression,    src + 150, sizeof(u8));
+		memcpy(&b.lodCount,       src + 151, sizeof(u8));
+		
+		b.verticesOffset = VERTICE_DATA_OFFSET_V2;
+		b.indicesOffset = VERTICE_DATA_OFFSET_V2 + b.verticesSize;
+		
+		//vertex encoding flags go from 0 to 3, half and unorm texcoords are exclusive
+		if (b.vertexEncoding & ~0b00001111
+			|| ((b.vertexEncoding & VERTEX_HALF_TEXCOORD)
+			&& (b.vertexEncoding & VERTEX_UNORM_TEXCOORD)))
+		{
+			return ImportResult::RESULT_INVALID_ENCODING;
+		}
+		if (b.indexEncoding > INDEX_U16
+			|| (b.indexEncoding == INDEX_U16 && b.vertexCount > 65536u)
+			|| b.compression > COMPRESSION_LZ4
+			|| b.lodCount > MAX_LOD_COUNT)
+		{
+			return ImportResult::RESULT_INVALID_ENCODING;
+		}
+		
+		//decoded data can't be larger than the whole block region is allowed to be
+		if (scast<size_t>(b.vertexCount) * sizeof(Vertex) > MAX_MODEL_BLOCK_SIZE
+			|| scast<size_t>(b.indexCount) * sizeof(u32) > MAX_MODEL_BLOCK_SIZE)
+		{
+			return ImportResult::RESULT_INVALID_MODEL_BLOCK_SIZE;
+		}
+		
+		//counts must fit their stored streams, so a small corrupt block can't force huge allocations
+		if (scast<size_t>(b.vertexCount) * GetEncodedVertexSize(b.vertexEncoding)
+				> GetMaxStreamRawSize(b.verticesSize, b.compression)
+			|| scast<size_t>(b.indexCount) * GetEncodedIndexSize(b.indexEncoding)
+				> GetMaxStreamRawSize(b.indicesSize, b.compression))
+		{
+			return ImportResult::RESULT_DECOMPRESSION_FAILED;
+		}
+		
+		return ImportResult::RESULT_SUCCESS;
+	}
+	
+	//Computes model-space bounds from vertexCount tightly packed vertices,
+	//positions are copied out one by one so vertexData does not need to be aligned
+	inline ModelBounds ComputeModelBounds(
+		const u8* vertexData,
+		size_t vertexCount)
+	{
+		ModelBounds b{};
+		if (vertexData == nullptr
+			|| vertexCount == 0)
+		{
+			return b;
+		}
+		
+		auto getPosition = [vertexData](size_t i, f32 (&outPos)[3])
+			{
+				memcpy(
+					outPos,
+					vertexData + i * sizeof(Vertex) + offsetof(Vertex, position),
+					sizeof(outPos));
+			};
+		
+		f32 pos[3]{};
+		getPosition(0, pos);
+		
+		memcpy(b.aabbMin, pos, sizeof(pos));
+		memcpy(b.aabbMax, pos, sizeof(pos));
+		
+		for (size_t i = 1; i < vertexCount; ++i)
+		{
+			getPosition(i, pos);
 			
-			//glyph block data
+			for (int a = 0; a < 3; ++a)
+			{
+				b.aabbMin[a] = min(b.aabbMin[a], pos[a]);
+				b.aabbMax[a] = max(b.aabbMax[a], pos[a]);
+			}
+		}
+		
+		for (int a = 0; a < 3; ++a)
+		{
+			b.center[a] = (b.aabbMin[a] + b.aabbMax[a]) * 0.5f;
+		}
+		
+		//second pass gives a tighter sphere than the half-diagonal of the aabb
+		f32 maxDist2{};
+		for (size_t i = 0; i < vertexCount; ++i)
+		{
+			getPosition(i, pos);
 			
-			vector<ModelBlock> blocks{};
-			blocks.reserve(inTables.size());
+			f32 dx = pos[0] - b.center[0];
+			f32 dy = pos[1] - b.center[1];
+			f32 dz = pos[2] - b.center[2];
 			
-			for (const auto& t : inTables)
+			maxDist2 = max(maxDist2, dx * dx + dy * dy + dz * dz);
+		}
+		
+		b.radius = sqrt(maxDist2);
+		
+		return b;
+	}
+	//Computes model-space bounds from the vertices of a model block
+	inline ModelBounds ComputeModelBounds(const ModelBlock& b)
+	{
+		return ComputeModelBounds(
+			rcast<const u8*>(b.vertices.data()),
+			b.vertices.size());
+	}
+	//Computes model-space bounds from the vertex bytes of a model block view,
+	//works for unaligned blocks whose vertices were left empty
+	inline ModelBounds ComputeModelBounds(const ModelBlockView& b)
+	{
+		return ComputeModelBounds(
+			b.vertexBytes.data(),
+			b.vertexBytes.size() / sizeof(Vertex));
+	}
+	
+	//Decodes an IEEE 754 half float
+	inline f32 HalfToFloat(u16 h)
+	{
+		const u32 sign = scast<u32>(h & 0x8000u) << 16;
+		u32 exponent = (h >> 10) & 0x1Fu;
+		u32 mantissa = h & 0x3FFu;
+		u32 bits{};
+		
+		if (exponent == 0)
+		{
+			if (mantissa == 0) bits = sign;
+			else
 			{
-				ModelBlock b{};
-				
-				size_t offset = t.blockOffset;
-				
-				//verify that block size is not OOB
-				if (offset + t.blockSize > fileSize)
-				{
-					return ImportResult::RESULT_UNEXPECTED_EOF;
-				}
-				
-				in.seekg(offset);
-				
-				in.read(rcast<char*>(b.nodeName),       20);
-				in.read(rcast<char*>(b.meshName),       20);
-				in.read(rcast<char*>(b.nodePath),       50);
-				
-				//data flags go from 0 to 4
-				in.read(rcast<char*>(&b.dataTypeFlags), sizeof(u8));
-				if (b.dataTypeFlags & ~0b00011111) return ImportResult::RESULT_INVALID_DATA_FLAGS;
-				
-				//render type goes from 0 to 2
-				in.read(rcast<char*>(&b.renderType),    sizeof(u8));
-				if (b.renderType > 2) return ImportResult::RESULT_INVALID_RENDER_TYPE;
-				
-				f32 newPos[3]{};
-				in.read(rcast<char*>(&newPos[0]), sizeof(f32));
-				in.read(rcast<char*>(&newPos[1]), sizeof(f32));
-				in.read(rcast<char*>(&newPos[2]), sizeof(f32));
-				
-				if (newPos[0] < MIN_POS
-					|| newPos[0] > MAX_POS
-					|| newPos[1] < MIN_POS
-					|| newPos[1] > MAX_POS
-					|| newPos[2] < MIN_POS
-					|| newPos[2] > MAX_POS)
-				{
-					return ImportResult::RESULT_INVALID_MODEL_POSITION;
-				}
-				
-				memcpy(b.position, newPos, sizeof(b.position));
-				
-				f32 newRot[4]{};
-				in.read(rcast<char*>(&newRot[0]), sizeof(f32));
-				in.read(rcast<char*>(&newRot[1]), sizeof(f32));
-				in.read(rcast<char*>(&newRot[2]), sizeof(f32));
-				in.read(rcast<char*>(&newRot[3]), sizeof(f32));
-				
-				if (newRot[0] < MIN_ROT
-					|| newRot[0] > MAX_ROT
-					|| newRot[1] < MIN_ROT
-					|| newRot[1] > MAX_ROT
-					|| newRot[2] < MIN_ROT
-					|| newRot[2] > MAX_ROT
-					|| newRot[3] < MIN_ROT
-					|| newRot[3] > MAX_ROT)
-				{
-					return ImportResult::RESULT_INVALID_MODEL_ROTATION;
-				}
-				
-				memcpy(b.rotation, newRot, sizeof(b.rotation));
-				
-				f32 newSize[3]{};
-				in.read(rcast<char*>(&newSize[0]), sizeof(f32));
-				in.read(rcast<char*>(&newSize[1]), sizeof(f32));
-				in.read(rcast<char*>(&newSize[2]), sizeof(f32));
-				
-				if (newSize[0] < MIN_SIZE
-					|| newSize[0] > MAX_SIZE
-					|| newSize[1] < MIN_SIZE
-					|| newSize[1] > MAX_SIZE
-					|| newSize[2] < MIN_SIZE
-					|| newSize[2] > MAX_SIZE)
-				{
-					return ImportResult::RESULT_INVALID_MODEL_SIZE;
-				}
-				
-				memcpy(b.size, newSize, sizeof(b.size));
-				
-				in.read(rcast<char*>(&b.verticesOffset), sizeof(u32));
-				in.read(rcast<char*>(&b.verticesSize),   sizeof(u32));
-				in.read(rcast<char*>(&b.indicesOffset),  sizeof(u32));
-				in.read(rcast<char*>(&b.indicesSize),    sizeof(u32));
-				
-				//verify that vertices are not OOB
-				if (offset + VERTICE_DATA_OFFSET + b.verticesSize > fileSize)
-				{
-					return ImportResult::RESULT_UNEXPECTED_EOF;
-				}
-				
-				//vertices
-				
-				size_t vertexCount = b.verticesSize / sizeof(Vertex);
-				
-				b.vertices.resize(vertexCount);
-				in.read(rcast<char*>(b.vertices.data()), b.verticesSize);
-				
-				//verify that indices are not OOB
-				if (offset + VERTICE_DATA_OFFSET + b.verticesSize + b.indicesSize > fileSize)
+				//subnormal half, renormalize into a normal float
+				exponent = 127 - 15 + 1;
+				while ((mantissa & 0x400u) == 0)
 				{
-					return ImportResult::RESULT_UNEXPECTED_EOF;
+					mantissa <<= 1;
+					--exponent;
 				}
+				mantissa &= 0x3FFu;
 				
-				//indices
-				
-				size_t indexCount = b.indicesSize / sizeof(u32);
-				
-				b.indices.resize(indexCount);
-				in.read(rcast<char*>(b.indices.data()), b.indicesSize);
-				
-				blocks.push_back(std::move(b));
+				bits = sign | (exponent << 23) | (mantissa << 13);
 			}
-			
-			in.close();
-			
-			outBlocks = std::move(blocks);
-			
-			return ImportResult::RESULT_SUCCESS;
 		}
-		catch(...)
+		else if (exponent == 31) bits = sign | 0x7F800000u | (mantissa << 13);
+		else bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+		
+		f32 result{};
+		memcpy(&result, &bits, sizeof(result));
+		
+		return result;
+	}
+	
+	//Decodes a unit vector from two octahedral snorm16 values
+	inline void DecodeOctahedral(
+		i16 qx,
+		i16 qy,
+		f32* outDir)
+	{
+		f32 x = max(scast<f32>(qx) / 32767.0f, -1.0f);
+		f32 y = max(scast<f32>(qy) / 32767.0f, -1.0f);
+		const f32 z = 1.0f - fabs(x) - fabs(y);
+		
+		//lower hemisphere is folded over the diagonals
+		if (z < 0.0f)
 		{
-			return ImportResult::RESULT_UNEXPECTED_EOF;
+			const f32 ox = x;
+			x = (1.0f - fabs(y)) * (ox >= 0.0f ? 1.0f : -1.0f);
+			y = (1.0f - fabs(ox)) * (y >= 0.0f ? 1.0f : -1.0f);
 		}
+		
+		const f32 length = sqrt(x * x + y * y + z * z);
+		const f32 scale = length > 0.0f ? 1.0f / length : 0.0f;
+		
+		outDir[0] = x * scale;
+		outDir[1] = y * scale;
+		outDir[2] = z * scale;
 	}
 	
-	//Returns the entire kmd file binary content in structs
-	inline ImportResult ImportKMD(
-		const path& inFile,
-		ModelHeader& outHeader,
-		vector<ModelTable>& outTables,
-		vector<ModelBlock>& outBlocks)
+	//Decompresses one LZ4 block, fails on malformed input or if
+	//the output doesn't fill exactly dstSize bytes
+	inline bool DecompressLZ4Block(
+		const u8* src,
+		size_t srcSize,
+		u8* dst,
+		size_t dstSize)
 	{
-		ImportResult preReadResult = PreReadCheck(inFile);
-		if (preReadResult != ImportResult::RESULT_SUCCESS) return preReadResult;
+		const u8* ip = src;
+		const u8* const ipEnd = src + srcSize;
+		u8* op = dst;
+		u8* const opEnd = dst + dstSize;
 		
-		ImportResult tryOpenResult = TryOpenCheck(inFile);
-		if (tryOpenResult != ImportResult::RESULT_SUCCESS) return tryOpenResult;
+		//15 in a token nibble means the length continues in the following bytes
+		auto readLength = [&ip, ipEnd](size_t& length)
+			{
+				if (length != 15) return true;
+				
+				u8 next{};
+				do
+				{
+					if (ip >= ipEnd) return false;
+					next = *ip++;
+					length += next;
+				} while (next == 255);
+				
+				return true;
+			};
 		
-		//header data
+		while (ip < ipEnd)
+		{
+			const u8 token = *ip++;
 			
-		ModelHeader header{};
+			size_t literalLength = token >> 4;
+			if (!readLength(literalLength)
+				|| literalLength > scast<size_t>(ipEnd - ip)
+				|| literalLength > scast<size_t>(opEnd - op))
+			{
+				return false;
+			}
 			
-		ImportResult headerResult = GetHeaderData(
-			inFile,
-			header,
-			false);
+			memcpy(op, ip, literalLength);
+			op += literalLength;
+			ip += literalLength;
 			
-		if (headerResult != ImportResult::RESULT_SUCCESS) return headerResult;
+			//the last sequence only has literals
+			if (ip == ipEnd) break;
 			
-		//model table data
+			if (ipEnd - ip < 2) return false;
+			const size_t offset = scast<size_t>(ip[0]) | (scast<size_t>(ip[1]) << 8);
+			ip += 2;
 			
-		vector<ModelTable> tables{};
-		tables.reserve(header.modelCount);
+			if (offset == 0
+				|| offset > scast<size_t>(op - dst))
+			{
+				return false;
+			}
 			
-		ImportResult tableResult = GetTableData(
-			inFile,
-			tables,
-			true);
+			size_t matchLength = token & 0x0Fu;
+			if (!readLength(matchLength)) return false;
+			matchLength += 4;
 			
-		if (tableResult != ImportResult::RESULT_SUCCESS) return tableResult;
-		
-		try
-		{
-			ifstream in(inFile, ios::in | ios::binary);
+			if (matchLength > scast<size_t>(opEnd - op)) return false;
 			
-			vector<u8> blockData(header.modelBlocksSize);
+			const u8* match = op - offset;
+			if (offset >= matchLength) memcpy(op, match, matchLength);
+			else
+			{
+				//overlapping match repeats the last offset bytes
+				for (size_t i = 0; i < matchLength; ++i) op[i] = match[i];
+			}
+			op += matchLength;
+		}
+		
+		return op == opEnd;
+	}
+	
+	//Walks a version 2 vertex or index stream of elementCount elements of elementSize bytes.
+	//If directOut is set every chunk is decompressed straight into directOut at its raw offset,
+	//otherwise chunks are decompressed into scratch one at a time and passed to
+	//onChunk(const u8* raw, size_t firstElement, size_t chunkElementCount) to be expanded
+	template<typename F>
+	inline ImportResult ReadStreamChunks(
+		const u8* src,
+		size_t storedSize,
+		u8 compression,
+		size_t elementSize,
+		size_t elementCount,
+		u8* directOut,
+		vector<u8>& scratch,
+		F&& onChunk)
+	{
+		const size_t rawSize = elementSize * elementCount;
+		
+		if (compression == COMPRESSION_NONE)
+		{
+			if (storedSize != rawSize) return ImportResult::RESULT_DECOMPRESSION_FAILED;
 			
-			//start at the end of the tables
+			if (directOut != nullptr) memcpy(directOut, src, rawSize);
+			else if (elementCount > 0) onChunk(src, 0, elementCount);
 			
-			size_t blockRegionStart = CORRECT_MODEL_HEADER_SIZE + header.modelTablesSize;
-			in.seekg(blockRegionStart);
+			return ImportResult::RESULT_SUCCESS;
+		}
+		
+		size_t storedOffset{};
+		size_t rawOffset{};
+		
+		while (rawOffset < rawSize)
+		{
+			if (storedSize - storedOffset < 8) return ImportResult::RESULT_DECOMPRESSION_FAILED;
 			
-			//read in the size of all models
-			in.read(
-				rcast<char*>(blockData.data()),
-				scast<streamsize>(header.modelBlocksSize));
-				
-			in.close();
+			u32 chunkRawSize{};
+			u32 chunkStoredSize{};
+			memcpy(&chunkRawSize,    src + storedOffset,     sizeof(u32));
+			memcpy(&chunkStoredSize, src + storedOffset + 4, sizeof(u32));
+			storedOffset += 8;
 			
-			//model block data
+			if (chunkRawSize == 0
+				|| chunkRawSize > MAX_STREAM_CHUNK_SIZE
+				|| chunkRawSize % elementSize != 0
+				|| chunkRawSize > rawSize - rawOffset
+				|| chunkStoredSize > chunkRawSize
+				|| chunkStoredSize > storedSize - storedOffset)
+			{
+				return ImportResult::RESULT_DECOMPRESSION_FAILED;
+			}
 			
-			vector<ModelBlock> blocks{};
-			blocks.reserve(header.modelCount);
+			const u8* stored = src + storedOffset;
+			const u8* raw = stored;
 			
-			for (const auto& t : tables)
+			if (chunkStoredSize != chunkRawSize)
 			{
-				ModelBlock b{};
-				size_t relativeOffset = t.blockOffset - blockRegionStart;
-				
-				//verify that block size is not OOB
-				if (relativeOffset + t.blockSize > blockData.size())
+				u8* target = directOut;
+				if (target != nullptr) target += rawOffset;
+				else
 				{
-					return ImportResult::RESULT_UNEXPECTED_EOF;
+					scratch.resize(chunkRawSize);
+					target = scratch.data();
 				}
 				
-				memcpy(b.nodeName, blockData.data() + relativeOffset + 0, 20);
-				memcpy(b.meshName, blockData.data() + relativeOffset + 20, 20);
-				memcpy(b.nodePath, blockData.data() + relativeOffset + 40, 50);
-				
-				//data flags go from 0 to 4
-				memcpy(&b.dataTypeFlags, blockData.data() + relativeOffset + 90, sizeof(u8));
-				if (b.dataTypeFlags & ~0b00011111) return ImportResult::RESULT_INVALID_DATA_FLAGS;
-				
-				//render type goes from 0 to 2
-				memcpy(&b.renderType, blockData.data() + relativeOffset + 91, sizeof(u8));
-				if (b.renderType > 2) return ImportResult::RESULT_INVALID_RENDER_TYPE;
-				
-				f32 newPos[3]{};
-				memcpy(&newPos[0], blockData.data() + relativeOffset + 92, sizeof(f32));
-				memcpy(&newPos[1], blockData.data() + relativeOffset + 96, sizeof(f32));
-				memcpy(&newPos[2], blockData.data() + relativeOffset + 100, sizeof(f32));
-				
-				if (newPos[0] < MIN_POS
-					|| newPos[0] > MAX_POS
-					|| newPos[1] < MIN_POS
-					|| newPos[1] > MAX_POS
-					|| newPos[2] < MIN_POS
-					|| newPos[2] > MAX_POS)
+				if (!DecompressLZ4Block(
+					stored,
+					chunkStoredSize,
+					target,
+					chunkRawSize))
 				{
-					return ImportResult::RESULT_INVALID_MODEL_POSITION;
+					return ImportResult::RESULT_DECOMPRESSION_FAILED;
 				}
 				
-				memcpy(b.position, newPos, sizeof(b.position));
-				
-				f32 newRot[4]{};
-				memcpy(&newRot[0], blockData.data() + relativeOffset + 104, sizeof(f32));
-				memcpy(&newRot[1], blockData.data() + relativeOffset + 108, sizeof(f32));
-				memcpy(&newRot[2], blockData.data() + relativeOffset + 112, sizeof(f32));
-				memcpy(&newRot[3], blockData.data() + relativeOffset + 116, sizeof(f32));
-				
-				if (newRot[0] < MIN_ROT
-					|| newRot[0] > MAX_ROT
-					|| newRot[1] < MIN_ROT
-					|| newRot[1] > MAX_ROT
-					|| newRot[2] < MIN_ROT
-					|| newRot[2] > MAX_ROT
-					|| newRot[3] < MIN_ROT
-					|| newRot[3] > MAX_ROT)
+				raw = target;
+			}
+			else if (directOut != nullptr) memcpy(directOut + rawOffset, stored, chunkRawSize);
+			
+			if (directOut == nullptr)
+			{
+				onChunk(
+					raw,
+					rawOffset / elementSize,
+					chunkRawSize / elementSize);
+			}
+			
+			storedOffset += chunkStoredSize;
+			rawOffset += chunkRawSize;
+		}
+		
+		//trailing bytes mean the counts and the stream disagree
+		if (storedOffset != storedSize) return ImportResult::RESULT_DECOMPRESSION_FAILED;
+		
+		return ImportResult::RESULT_SUCCESS;
+	}
+	
+	//Decodes a version 2 vertex stream into vertexCount vertices,
+	//unquantized streams are decompressed straight into outVertices
+	inline ImportResult DecodeVertexStream(
+		const u8* src,
+		size_t storedSize,
+		u8 vertexEncoding,
+		u8 compression,
+		size_t vertexCount,
+		Vertex* outVertices,
+		vector<u8>& scratch)
+	{
+		const size_t stride = GetEncodedVertexSize(vertexEncoding);
+		
+		u8* directOut = vertexEncoding == 0
+			? rcast<u8*>(outVertices)
+			: nullptr;
+		
+		auto expand = [vertexEncoding, stride, outVertices](
+			const u8* raw,
+			size_t first,
+			size_t count)
+			{
+				for (size_t i = 0; i < count; ++i)
 				{
-					return ImportResult::RESULT_INVALID_MODEL_ROTATION;
+					const u8* in = raw + i * stride;
+					Vertex& v = outVertices[first + i];
+					
+					memcpy(v.position, in, sizeof(v.position));
+					in += sizeof(v.position);
+					
+					if (vertexEncoding & VERTEX_OCTAHEDRAL_NORMAL)
+					{
+						i16 q[2]{};
+						memcpy(q, in, sizeof(q));
+						in += sizeof(q);
+						
+						DecodeOctahedral(q[0], q[1], v.normal);
+					}
+					else
+					{
+						memcpy(v.normal, in, sizeof(v.normal));
+						in += sizeof(v.normal);
+					}
+					
+					if (vertexEncoding & VERTEX_HALF_TEXCOORD)
+					{
+						u16 q[2]{};
+						memcpy(q, in, sizeof(q));
+						in += sizeof(q);
+						
+						v.texCoord[0] = HalfToFloat(q[0]);
+						v.texCoord[1] = HalfToFloat(q[1]);
+					}
+					else if (vertexEncoding & VERTEX_UNORM_TEXCOORD)
+					{
+						u16 q[2]{};
+						memcpy(q, in, sizeof(q));
+						in += sizeof(q);
+						
+						v.texCoord[0] = scast<f32>(q[0]) / 65535.0f;
+						v.texCoord[1] = scast<f32>(q[1]) / 65535.0f;
+					}
+					else
+					{
+						memcpy(v.texCoord, in, sizeof(v.texCoord));
+						in += sizeof(v.texCoord);
+					}
+					
+					if (vertexEncoding & VERTEX_OCTAHEDRAL_TANGENT)
+					{
+						i16 q[2]{};
+						memcpy(q, in, sizeof(q));
+						
+						//the handedness sign lives in the lowest bit of the second value
+						v.tangent[3] = (q[1] & 1) ? -1.0f : 1.0f;
+						DecodeOctahedral(q[0], scast<i16>(q[1] & ~1), v.tangent);
+					}
+					else memcpy(v.tangent, in, sizeof(v.tangent));
 				}
-				
-				memcpy(b.rotation, newRot, sizeof(b.rotation));
-				
-				f32 newSize[3]{};
-				memcpy(&newSize[0], blockData.data() + relativeOffset + 120, sizeof(f32));
-				memcpy(&newSize[1], blockData.data() + relativeOffset + 124, sizeof(f32));
-				memcpy(&newSize[2], blockData.data() + relativeOffset + 128, sizeof(f32));
-				
-				if (newSize[0] < MIN_SIZE
-					|| newSize[0] > MAX_SIZE
-					|| newSize[1] < MIN_SIZE
-					|| newSize[1] > MAX_SIZE
-					|| newSize[2] < MIN_SIZE
-					|| newSize[2] > MAX_SIZE)
+			};
+		
+		return ReadStreamChunks(
+			src,
+			storedSize,
+			compression,
+			stride,
+			vertexCount,
+			directOut,
+			scratch,
+			expand);
+	}
+	
+	//Decodes a version 2 index stream into indexCount indices,
+	//u32 streams are decompressed straight into outIndices
+	inline ImportResult DecodeIndexStream(
+		const u8* src,
+		size_t storedSize,
+		u8 indexEncoding,
+		u8 compression,
+		size_t indexCount,
+		u32* outIndices,
+		vector<u8>& scratch)
+	{
+		const size_t stride = GetEncodedIndexSize(indexEncoding);
+		
+		u8* directOut = indexEncoding == INDEX_U32
+			? rcast<u8*>(outIndices)
+			: nullptr;
+		
+		auto expand = [outIndices](
+			const u8* raw,
+			size_t first,
+			size_t count)
+			{
+				for (size_t i = 0; i < count; ++i)
 				{
-					return ImportResult::RESULT_INVALID_MODEL_SIZE;
+					u16 index{};
+					memcpy(&index, raw + i * sizeof(u16), sizeof(u16));
+					
+					outIndices[first + i] = index;
 				}
+			};
+		
+		return ReadStreamChunks(
+			src,
+			storedSize,
+			compression,
+			stride,
+			indexCount,
+			directOut,
+			scratch,
+			expand);
+	}
+	
+	//Location of one LOD index stream inside a version 2 model block
+	struct LodStreamInfo
+	{
+		size_t offset{}; //relative to the start of the model block
+		u32 indexCount{};
+		u32 storedSize{};
+		f32 error{};
+	};
+	
+	//Reads and bounds-checks the LOD table of a version 2 model block,
+	//src points at the start of the model block and available is how many bytes can be read from it
+	template<typename T>
+	inline ImportResult ReadLodTable(
+		const u8* src,
+		size_t available,
+		const T& b,
+		vector<LodStreamInfo>& outLods)
+	{
+		outLods.clear();
+		if (b.lodCount == 0) return ImportResult::RESULT_SUCCESS;
+		
+		size_t tableStart = 
+			VERTICE_DATA_OFFSET_V2 
+			+ b.verticesSize 
+			+ b.indicesSize;
+		size_t streamStart = tableStart + scast<size_t>(b.lodCount) * LOD_TABLE_ENTRY_SIZE;
+		
+		//verify that the lod table is not OOB
+		if (streamStart > available) return ImportResult::RESULT_UNEXPECTED_EOF;
+		
+		for (u8 i = 0; i < b.lodCount; ++i)
+		{
+			const u8* entry = src + tableStart + scast<size_t>(i) * LOD_TABLE_ENTRY_SIZE;
+			
+			LodStreamInfo lod{};
+			lod.offset = streamStart;
+			memcpy(&lod.indexCount, entry + 0, sizeof(u32));
+			memcpy(&lod.storedSize, entry + 4, sizeof(u32));
+			memcpy(&lod.error,      entry + 8, sizeof(f32));
+			
+			if (scast<size_t>(lod.indexCount) * sizeof(u32) > MAX_MODEL_BLOCK_SIZE)
+			{
+				return ImportResult::RESULT_INVALID_MODEL_BLOCK_SIZE;
+			}
+			
+			//the count must fit the stored stream before anything is allocated for it
+			if (scast<size_t>(lod.indexCount) * GetEncodedIndexSize(b.indexEncoding)
+				> GetMaxStreamRawSize(lod.storedSize, b.compression))
+			{
+				return ImportResult::RESULT_DECOMPRESSION_FAILED;
+			}
+			
+			//verify that the lod indices are not OOB
+			if (streamStart + lod.storedSize > available) return ImportResult::RESULT_UNEXPECTED_EOF;
+			
+			streamStart += lod.storedSize;
+			outLods.push_back(lod);
+		}
+		
+		return ImportResult::RESULT_SUCCESS;
+	}
+	
+	//Returns true if a block stores plain f32 vertices and u32 indices without compression,
+	//so its data can be copied or borrowed as-is
+	template<typename T>
+	inline constexpr bool HasPlainLayout(const T& b)
+	{
+		return b.vertexEncoding == 0
+			&& b.indexEncoding == INDEX_U32
+			&& b.compression == COMPRESSION_NONE;
+	}
+	
+	//Decodes the vertices and indices that follow the fixed-layout block header,
+	//src points at the start of the model block and available is how many bytes can be read from it
+	inline ImportResult DecodeBlockStreams(
+		const u8* src,
+		size_t available,
+		u8 version,
+		ModelBlock& b)
+	{
+		KPROFILE_ZONE("DecodeBlockStreams");
+
+		const size_t dataOffset = GetVertexDataOffset(version);
+		
+		//verify that vertices are not OOB
+		if (dataOffset + b.verticesSize > available)
+		{
+			return ImportResult::RESULT_UNEXPECTED_EOF;
+		}
+		
+		//verify that indices are not OOB
+		if (dataOffset + b.verticesSize + b.indicesSize > available)
+		{
+			return ImportResult::RESULT_UNEXPECTED_EOF;
+		}
+		
+		const u8* vertexData = src + dataOffset;
+		const u8* indexData = vertexData + b.verticesSize;
+		
+		b.vertices.resize(b.vertexCount);
+		b.indices.resize(b.indexCount);
+		
+		if (version < 2)
+		{
+			if (!b.vertices.empty()) memcpy(b.vertices.data(), vertexData, b.vertices.size() * sizeof(Vertex));
+			if (!b.indices.empty()) memcpy(b.indices.data(), indexData, b.indices.size() * sizeof(u32));
+		}
+		else
+		{
+			vector<u8> scratch{};
+			
+			ImportResult vertexResult = DecodeVertexStream(
+				vertexData,
+				b.verticesSize,
+				b.vertexEncoding,
+				b.compression,
+				b.vertexCount,
+				b.vertices.data(),
+				scratch);
+				
+			if (vertexResult != ImportResult::RESULT_SUCCESS) return vertexResult;
+			
+			ImportResult indexResult = DecodeIndexStream(
+				indexData,
+				b.indicesSize,
+				b.indexEncoding,
+				b.compression,
+				b.indexCount,
+				b.indices.data(),
+				scratch);
 				
-				memcpy(b.size, newSize, sizeof(b.size));
+			if (indexResult != ImportResult::RESULT_SUCCESS) return indexResult;
+			
+			//lod index buffers
+			
+			vector<LodStreamInfo> lodStreams{};
+			
+			ImportResult lodResult = ReadLodTable(
+				src,
+				available,
+				b,
+				lodStreams);
 				
-				memcpy(&b.verticesOffset, blockData.data() + relativeOffset + 132, sizeof(u32));
-				memcpy(&b.verticesSize,   blockData.data() + relativeOffset + 136, sizeof(u32));
-				memcpy(&b.indicesOffset,  blockData.data() + relativeOffset + 140, sizeof(u32));
-				memcpy(&b.indicesSize,    blockData.data() + relativeOffset + 144, sizeof(u32));
+			if (lodResult != ImportResult::RESULT_SUCCESS) return lodResult;
+			
+			b.lods.resize(lodStreams.size());
+			for (size_t i = 0; i < lodStreams.size(); ++i)
+			{
+				ModelLod& lod = b.lods[i];
+				lod.error = lodStreams[i].error;
+				lod.indices.resize(lodStreams[i].indexCount);
 				
-				//verify that vertices are not OOB
-				if (relativeOffset + scast<u32>(VERTICE_DATA_OFFSET) + b.verticesSize > blockData.size())
+				lodResult = DecodeIndexStream(
+					src + lodStreams[i].offset,
+					lodStreams[i].storedSize,
+					b.indexEncoding,
+					b.compression,
+					lodStreams[i].indexCount,
+					lod.indices.data(),
+					scratch);
+					
+				if (lodResult != ImportResult::RESULT_SUCCESS) return lodResult;
+			}
+		}
+		
+		b.bounds = ComputeModelBounds(b);
+		
+		return ImportResult::RESULT_SUCCESS;
+	}
+	
+	//Returns model blocks for the inserted tables, set skipChecks to true if the file has already been checked.
+	//Tables are read in file order and nearby blocks are merged into a single read,
+	//outBlocks is returned in the same order as inTables
+	inline ImportResult StreamModels(
+		const path& inFile,
+		const vector<ModelTable>& inTables,
+		vector<ModelBlock>& outBlocks,
+		bool skipChecks = false)
+	{
+		KPROFILE_ZONE("StreamModels");
+
+		if (!skipChecks)
+		{
+			ImportResult preReadResult = PreReadCheck(inFile);
+			if (preReadResult != ImportResult::RESULT_SUCCESS) return preReadResult;
+			
+			ImportResult tryOpenResult = TryOpenCheck(inFile);
+			if (tryOpenResult != ImportResult::RESULT_SUCCESS) return tryOpenResult;
+		}
+		
+		try
+		{
+			ifstream in(inFile, ios::in | ios::binary);
+			
+			in.seekg(0, ios::end);
+			size_t fileSize = scast<size_t>(in.tellg());
+			
+			//block layout depends on the version in the top header
+			
+			u8 version{};
+			in.seekg(4);
+			in.read(rcast<char*>(&version), sizeof(u8));
+			
+			if (version < KMD_MIN_VERSION
+				|| version > KMD_VERSION)
+			{
+				return ImportResult::RESULT_INVALID_VERSION;
+			}
+			
+			const size_t dataOffset = GetVertexDataOffset(version);
+			
+			//verify that no block is OOB before reading anything
+			
+			for (const auto& t : inTables)
+			{
+				if (scast<size_t>(t.blockOffset) + t.blockSize > fileSize)
 				{
 					return ImportResult::RESULT_UNEXPECTED_EOF;
 				}
+			}
+			
+			//sort requested tables by their position in the file
+			
+			vector<size_t> order(inTables.size());
+			iota(order.begin(), order.end(), 0);
+			sort(order.begin(), order.end(),
+				[&inTables](size_t a, size_t b)
+				{
+					return inTables[a].blockOffset < inTables[b].blockOffset;
+				});
+			
+			//model block data
+			
+			vector<ModelBlock> blocks(inTables.size());
+			vector<u8> rangeData{};
+			
+			size_t first = 0;
+			while (first < order.size())
+			{
+				//merge all following blocks that are close enough into one range
 				
-				//vertices
+				size_t rangeStart = inTables[order[first]].blockOffset;
+				size_t rangeEnd = rangeStart + inTables[order[first]].blockSize;
+				
+				size_t last = first + 1;
+				while (last < order.size())
+				{
+					const ModelTable& next = inTables[order[last]];
+					size_t nextEnd = scast<size_t>(next.blockOffset) + next.blockSize;
+					
+					if (next.blockOffset > rangeEnd + STREAM_MERGE_GAP
+						|| max(rangeEnd, nextEnd) - rangeStart > MAX_STREAM_RANGE_SIZE)
+					{
+						break;
+					}
+					
+					rangeEnd = max(rangeEnd, nextEnd);
+					++last;
+				}
 				
-				size_t vertexCount = b.verticesSize / sizeof(Vertex);
+				//read the whole range with one call
 				
-				b.vertices.resize(vertexCount);
-				memcpy(b.vertices.data(), blockData.data() + relativeOffset + VERTICE_DATA_OFFSET, b.verticesSize);
+				size_t rangeSize = rangeEnd - rangeStart;
+				rangeData.resize(rangeSize);
 				
-				//verify that indices are not OOB
-				if (relativeOffset + scast<u32>(VERTICE_DATA_OFFSET) + b.verticesSize + b.indicesSize > blockData.size())
+				in.seekg(scast<streamoff>(rangeStart));
+				in.read(
+					rcast<char*>(rangeData.data()),
+					scast<streamsize>(rangeSize));
+					
+				if (scast<size_t>(in.gcount()) != rangeSize)
 				{
 					return ImportResult::RESULT_UNEXPECTED_EOF;
 				}
 				
-				//indices
+				KPROFILE_COUNTER("kmd bytes read", rangeSize);
 				
-				size_t indexCount = b.indicesSize / sizeof(u32);
+				//decode each block in the range
 				
-				b.indices.resize(indexCount);
-				memcpy(b.indices.data(), blockData.data() + relativeOffset + VERTICE_DATA_OFFSET + b.verticesSize, b.indicesSize);
+				for (size_t i = first; i < last; ++i)
+				{
+					const ModelTable& t = inTables[order[i]];
+					ModelBlock& b = blocks[order[i]];
+					
+					size_t relativeOffset = t.blockOffset - rangeStart;
+					size_t blockEnd = relativeOffset + t.blockSize;
+					
+					//verify that the fixed-layout block header is not OOB
+					if (relativeOffset + dataOffset > blockEnd)
+					{
+						return ImportResult::RESULT_UNEXPECTED_EOF;
+					}
+					
+					ImportResult blockResult = DecodeBlockHeader(
+						rangeData.data() + relativeOffset,
+						b,
+						version);
+						
+					if (blockResult != ImportResult::RESULT_SUCCESS) return blockResult;
+					
+					//vertices and indices, version 2 streams are decompressed chunk by chunk into b
+					
+					ImportResult streamResult = DecodeBlockStreams(
+						rangeData.data() + relativeOffset,
+						t.blockSize,
+						version,
+						b);
+						
+					if (streamResult != ImportResult::RESULT_SUCCESS) return streamResult;
+				}
 				
-				blocks.push_back(std::move(b));
+				first = last;
 			}
 			
+			in.close();
+			
+			outBlocks = std::move(blocks);
+			
+			return ImportResult::RESULT_SUCCESS;
+		}
+		catch(...)
+		{
+			return ImportResult::RESULT_UNEXPECTED_EOF;
+		}
+	}
+	
+	//Decodes and validates one model block from the block region of a kmd file,
+	//blockData must start at blockRegionStart in the file and version is the kmd version of the file
+	inline ImportResult DecodeModelBlock(
+		const vector<u8>& blockData,
+		size_t blockRegionStart,
+		const ModelTable& t,
+		ModelBlock& b,
+		u8 version = KMD_MIN_VERSION)
+	{
+		//verify that the block doesn't start before the block region
+		if (t.blockOffset < blockRegionStart) return ImportResult::RESULT_UNEXPECTED_EOF;
+		
+		size_t relativeOffset = t.blockOffset - blockRegionStart;
+		
+		//verify that block size is not OOB
+		if (relativeOffset > blockData.size()
+			|| t.blockSize > blockData.size() - relativeOffset)
+		{
+			return ImportResult::RESULT_UNEXPECTED_EOF;
+		}
+		
+		//verify that the fixed-layout block header is not OOB
+		if (GetVertexDataOffset(version) > blockData.size() - relativeOffset)
+		{
+			return ImportResult::RESULT_UNEXPECTED_EOF;
+		}
+		
+		ImportResult blockResult = DecodeBlockHeader(
+			blockData.data() + relativeOffset,
+			b,
+			version);
+			
+		if (blockResult != ImportResult::RESULT_SUCCESS) return blockResult;
+		
+		//vertices and indices, version 2 streams are decompressed chunk by chunk into b
+		
+		return DecodeBlockStreams(
+			blockData.data() + relativeOffset,
+			blockData.size() - relativeOffset,
+			version,
+			b);
+	}
+	
+	//Reads and validates the header and tables of the kmd file
+	//and the whole block region into outBlockData
+	inline ImportResult ReadBlockRegion(
+		const path& inFile,
+		ModelHeader& outHeader,
+		vector<ModelTable>& outTables,
+		vector<u8>& outBlockData)
+	{
+		ImportResult preReadResult = PreReadCheck(inFile);
+		if (preReadResult != ImportResult::RESULT_SUCCESS) return preReadResult;
+		
+		ImportResult tryOpenResult = TryOpenCheck(inFile);
+		if (tryOpenResult != ImportResult::RESULT_SUCCESS) return tryOpenResult;
+		
+		//header data
+			
+		ModelHeader header{};
+			
+		ImportResult headerResult = GetHeaderData(
+			inFile,
+			header,
+			true);
+			
+		if (headerResult != ImportResult::RESULT_SUCCESS) return headerResult;
+			
+		//model table data
+			
+		vector<ModelTable> tables{};
+		tables.reserve(header.modelCount);
+			
+		ImportResult tableResult = GetTableData(
+			inFile,
+			tables,
+			true);
+			
+		if (tableResult != ImportResult::RESULT_SUCCESS) return tableResult;
+		
+		try
+		{
+			ifstream in(inFile, ios::in | ios::binary);
+			
+			vector<u8> blockData(header.modelBlocksSize);
+			
+			//start at the end of the tables
+			
+			size_t blockRegionStart = CORRECT_MODEL_HEADER_SIZE + header.modelTablesSize;
+			in.seekg(blockRegionStart);
+			
+			//read in the size of all models
+			in.read(
+				rcast<char*>(blockData.data()),
+				scast<streamsize>(header.modelBlocksSize));
+				
+			in.close();
+			
+			KPROFILE_COUNTER("kmd bytes read", header.modelBlocksSize);
+			
 			outHeader = header;
 			outTables = std::move(tables);
-			outBlocks = std::move(blocks);
+			outBlockData = std::move(blockData);
 			
 			return ImportResult::RESULT_SUCCESS;
 		}
@@ -838,4 +1784,1689 @@ namespace KalaHeaders::KalaModelData
 			return ImportResult::RESULT_UNKNOWN_READ_ERROR;
 		}
 	}
+	
+	//Returns the entire kmd file binary content in structs
+	inline ImportResult ImportKMD(
+		const path& inFile,
+		ModelHeader& outHeader,
+		vector<ModelTable>& outTables,
+		vector<ModelBlock>& outBlocks)
+	{
+		KPROFILE_ZONE("ImportKMD");
+
+		ModelHeader header{};
+		vector<ModelTable> tables{};
+		vector<u8> blockData{};
+		
+		ImportResult regionResult = ReadBlockRegion(
+			inFile,
+			header,
+			tables,
+			blockData);
+			
+		if (regionResult != ImportResult::RESULT_SUCCESS) return regionResult;
+		
+		try
+		{
+			size_t blockRegionStart = CORRECT_MODEL_HEADER_SIZE + header.modelTablesSize;
+			
+			//model block data
+			
+			vector<ModelBlock> blocks{};
+			blocks.reserve(header.modelCount);
+			
+			for (const auto& t : tables)
+			{
+				ModelBlock b{};
+				
+				ImportResult blockResult = DecodeModelBlock(
+					blockData,
+					blockRegionStart,
+					t,
+					b,
+					header.version);
+					
+				if (blockResult != ImportResult::RESULT_SUCCESS) return blockResult;
+				
+				blocks.push_back(std::move(b));
+			}
+			
+			outHeader = header;
+			outTables = std::move(tables);
+			outBlocks = std::move(blocks);
+			
+			return ImportResult::RESULT_SUCCESS;
+		}
+		catch (...)
+		{
+			return ImportResult::RESULT_UNKNOWN_READ_ERROR;
+		}
+	}
+	
+	//Called from an import worker as soon as a model block has been decoded,
+	//index is the position of the block in the model tables.
+	//Runs concurrently on all workers so it must be thread-safe
+	using ModelReadyCallback = function<void(size_t index, const ModelBlock& block)>;
+	
+	//Shared state between an AsyncModelImport handle and its workers
+	struct AsyncModelImportState
+	{
+		ModelHeader header{};
+		vector<ModelTable> tables{};
+		vector<ModelBlock> blocks{};
+		vector<u8> blockData{};
+		
+		ModelReadyCallback onReady{};
+		
+		atomic<ImportResult> result{ ImportResult::RESULT_SUCCESS };
+		atomic<size_t> nextBlock{};
+		atomic<size_t> readyCount{};
+		atomic<bool> isReady{};
+	};
+	
+	//Future-like handle returned by ImportKMDAsync, waits for the import to finish when destroyed
+	class AsyncModelImport
+	{
+	public:
+		AsyncModelImport() = default;
+		AsyncModelImport(
+			shared_ptr<AsyncModelImportState> inState,
+			thread&& inCoordinator)
+			: state(std::move(inState)),
+			coordinator(std::move(inCoordinator)) {}
+		
+		~AsyncModelImport() { Wait(); }
+		
+		AsyncModelImport(const AsyncModelImport&) = delete;
+		AsyncModelImport& operator=(const AsyncModelImport&) = delete;
+		
+		AsyncModelImport(AsyncModelImport&&) noexcept = default;
+		AsyncModelImport& operator=(AsyncModelImport&& other) noexcept
+		{
+			if (this == &other) return *this;
+			
+			Wait();
+			
+			state = std::move(other.state);
+			coordinator = std::move(other.coordinator);
+			
+			return *this;
+		}
+		
+		//Returns true once every block has been decoded or the import has failed
+		inline bool IsReady() const
+		{
+			return state
+				&& state->isReady.load(memory_order_acquire);
+		}
+		
+		//Returns how many blocks have been decoded so far
+		inline size_t GetReadyCount() const
+		{
+			return state
+				? state->readyCount.load(memory_order_acquire)
+				: 0;
+		}
+		
+		//Blocks until the import has finished and returns its result
+		inline ImportResult Wait()
+		{
+			if (coordinator.joinable()) coordinator.join();
+			
+			return state
+				? state->result.load(memory_order_acquire)
+				: ImportResult::RESULT_UNKNOWN_READ_ERROR;
+		}
+		
+		//Header, tables and blocks are only valid after Wait has returned RESULT_SUCCESS
+		inline ModelHeader& GetHeader() { return state->header; }
+		inline vector<ModelTable>& GetTables() { return state->tables; }
+		inline vector<ModelBlock>& GetBlocks() { return state->blocks; }
+	private:
+		shared_ptr<AsyncModelImportState> state{};
+		thread coordinator{};
+	};
+	
+	//Imports the entire kmd file in the background and decodes its model blocks in parallel.
+	//onReady is called for each block as soon as it is decoded, before the rest of the blocks are done.
+	//threadCount of 0 uses all hardware threads, never more threads than there are models
+	inline AsyncModelImport ImportKMDAsync(
+		const path& inFile,
+		ModelReadyCallback onReady = {},
+		u32 threadCount = 0)
+	{
+		auto state = make_shared<AsyncModelImportState>();
+		state->onReady = std::move(onReady);
+		
+		auto fail = [](AsyncModelImportState& s, ImportResult r)
+			{
+				ImportResult expected = ImportResult::RESULT_SUCCESS;
+				s.result.compare_exchange_strong(
+					expected,
+					r,
+					memory_order_acq_rel);
+			};
+		
+		auto work = [fail](AsyncModelImportState& s)
+			{
+				size_t blockRegionStart = CORRECT_MODEL_HEADER_SIZE + s.header.modelTablesSize;
+				
+				while (s.result.load(memory_order_relaxed) == ImportResult::RESULT_SUCCESS)
+				{
+					size_t i = s.nextBlock.fetch_add(1, memory_order_relaxed);
+					if (i >= s.tables.size()) break;
+					
+					try
+					{
+						ImportResult blockResult = DecodeModelBlock(
+							s.blockData,
+							blockRegionStart,
+							s.tables[i],
+							s.blocks[i],
+							s.header.version);
+							
+						if (blockResult != ImportResult::RESULT_SUCCESS)
+						{
+							fail(s, blockResult);
+							break;
+						}
+						
+						if (s.onReady) s.onReady(i, s.blocks[i]);
+					}
+					catch (...)
+					{
+						fail(s, ImportResult::RESULT_UNKNOWN_READ_ERROR);
+						break;
+					}
+					
+					s.readyCount.fetch_add(1, memory_order_release);
+				}
+			};
+		
+		auto run = [state, inFile, threadCount, fail, work]()
+			{
+				AsyncModelImportState& s = *state;
+				
+				ImportResult regionResult = ReadBlockRegion(
+					inFile,
+					s.header,
+					s.tables,
+					s.blockData);
+					
+				if (regionResult != ImportResult::RESULT_SUCCESS)
+				{
+					fail(s, regionResult);
+				}
+				else
+				{
+					try
+					{
+						s.blocks.resize(s.tables.size());
+						
+						size_t workerCount = threadCount == 0
+							? thread::hardware_concurrency()
+							: threadCount;
+						workerCount = clamp(workerCount, size_t{ 1 }, max(s.tables.size(), size_t{ 1 }));
+						
+						//the coordinator decodes too, so one less worker is spawned
+						vector<thread> workers{};
+						workers.reserve(workerCount - 1);
+						
+						for (size_t i = 1; i < workerCount; ++i)
+						{
+							//if a thread can't be spawned the already started workers
+							//and the coordinator still claim and decode every block,
+							//unwinding here would destroy joinable threads
+							try { workers.emplace_back(work, std::ref(s)); }
+							catch (...) { break; }
+						}
+						
+						work(s);
+						
+						for (auto& w : workers) w.join();
+					}
+					catch (...)
+					{
+						fail(s, ImportResult::RESULT_UNKNOWN_READ_ERROR);
+					}
+				}
+				
+				//the raw block region is no longer needed once everything is decoded
+				vector<u8>().swap(s.blockData);
+				
+				s.isReady.store(true, memory_order_release);
+			};
+			
+		//a coordinator that can't be spawned is reported like any other failed import
+		thread coordinator{};
+		try { coordinator = thread(std::move(run)); }
+		catch (...)
+		{
+			fail(*state, ImportResult::RESULT_UNKNOWN_READ_ERROR);
+			state->isReady.store(true, memory_order_release);
+		}
+			
+		return AsyncModelImport(
+			std::move(state),
+			std::move(coordinator));
+	}
+	
+	//Read-only memory mapping of a kmd file, owns the mapping that
+	//ModelBlockView vertices and indices borrow from so it must outlive them
+	class MappedModelFile
+	{
+	public:
+		MappedModelFile() = default;
+		~MappedModelFile() { Unmap(); }
+		
+		MappedModelFile(const MappedModelFile&) = delete;
+		MappedModelFile& operator=(const MappedModelFile&) = delete;
+		
+		MappedModelFile(MappedModelFile&& other) noexcept { *this = std::move(other); }
+		MappedModelFile& operator=(MappedModelFile&& other) noexcept
+		{
+			if (this == &other) return *this;
+			
+			Unmap();
+			
+			data = other.data;
+			size = other.size;
+#ifdef _WIN32
+			mappingHandle = other.mappingHandle;
+			other.mappingHandle = nullptr;
+#endif
+			alignedVertices = std::move(other.alignedVertices);
+			alignedIndices = std::move(other.alignedIndices);
+			
+			other.data = nullptr;
+			other.size = 0;
+			
+			return *this;
+		}
+		
+		//Maps the whole file as read-only, unmaps any previous mapping first
+		inline ImportResult Map(const path& inFile)
+		{
+			Unmap();
+			
+#ifdef _WIN32
+			HANDLE file = CreateFileW(
+				inFile.c_str(),
+				GENERIC_READ,
+				FILE_SHARE_READ,
+				nullptr,
+				OPEN_EXISTING,
+				FILE_ATTRIBUTE_NORMAL
+				| FILE_FLAG_SEQUENTIAL_SCAN,
+				nullptr);
+				
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				return GetLastError() == ERROR_SHARING_VIOLATION
+					? ImportResult::RESULT_FILE_LOCKED
+					: ImportResult::RESULT_UNKNOWN_READ_ERROR;
+			}
+			
+			LARGE_INTEGER fileSize{};
+			if (!GetFileSizeEx(file, &fileSize)
+				|| fileSize.QuadPart == 0)
+			{
+				CloseHandle(file);
+				return ImportResult::RESULT_MAP_FAILED;
+			}
+			
+			HANDLE mapping = CreateFileMappingW(
+				file,
+				nullptr,
+				PAGE_READONLY,
+				0,
+				0,
+				nullptr);
+				
+			//the mapping keeps its own reference to the file
+			CloseHandle(file);
+			
+			if (mapping == nullptr) return ImportResult::RESULT_MAP_FAILED;
+			
+			void* view = MapViewOfFile(
+				mapping,
+				FILE_MAP_READ,
+				0,
+				0,
+				0);
+				
+			if (view == nullptr)
+			{
+				CloseHandle(mapping);
+				return ImportResult::RESULT_MAP_FAILED;
+			}
+			
+			mappingHandle = mapping;
+			data = scast<const u8*>(view);
+			size = scast<size_t>(fileSize.QuadPart);
+#else
+			int fd = open(inFile.c_str(), O_RDONLY);
+			if (fd < 0)
+			{
+				return (errno == EBUSY || errno == ETXTBSY)
+					? ImportResult::RESULT_FILE_LOCKED
+					: ImportResult::RESULT_UNKNOWN_READ_ERROR;
+			}
+			
+			struct stat fileStat{};
+			if (fstat(fd, &fileStat) != 0
+				|| fileStat.st_size == 0)
+			{
+				close(fd);
+				return ImportResult::RESULT_MAP_FAILED;
+			}
+			
+			void* view = mmap(
+				nullptr,
+				scast<size_t>(fileStat.st_size),
+				PROT_READ,
+				MAP_PRIVATE,
+				fd,
+				0);
+				
+			//the mapping keeps its own reference to the file
+			close(fd);
+			
+			if (view == MAP_FAILED) return ImportResult::RESULT_MAP_FAILED;
+			
+			//the whole block region is about to be read or uploaded
+			madvise(view, scast<size_t>(fileStat.st_size), MADV_WILLNEED);
+			
+			data = scast<const u8*>(view);
+			size = scast<size_t>(fileStat.st_size);
+#endif
+			return ImportResult::RESULT_SUCCESS;
+		}
+		
+		//Releases the mapping, all views borrowed from it become invalid
+		inline void Unmap()
+		{
+			if (data != nullptr)
+			{
+#ifdef _WIN32
+				UnmapViewOfFile(data);
+				if (mappingHandle != nullptr) CloseHandle(mappingHandle);
+				mappingHandle = nullptr;
+#else
+				munmap(const_cast<u8*>(data), size);
+#endif
+			}
+			
+			data = nullptr;
+			size = 0;
+			
+			alignedVertices.clear();
+			alignedIndices.clear();
+		}
+		
+		inline const u8* GetData() const { return data; }
+		inline size_t GetSize() const { return size; }
+		inline bool IsMapped() const { return data != nullptr; }
+		
+		//Returns vertices at offset as a span, borrowed straight from the mapping
+		//if it is aligned for Vertex, otherwise copied once into owned storage
+		//or returned empty if copyUnaligned is false
+		inline span<const Vertex> GetVertices(
+			size_t offset,
+			size_t count,
+			bool copyUnaligned,
+			bool& outIsBorrowed)
+		{
+			const u8* src = data + offset;
+			
+			outIsBorrowed = rcast<uintptr_t>(src) % alignof(Vertex) == 0;
+			if (outIsBorrowed) return { rcast<const Vertex*>(src), count };
+			if (!copyUnaligned) return {};
+			
+			vector<Vertex>& owned = alignedVertices.emplace_back(count);
+			memcpy(owned.data(), src, count * sizeof(Vertex));
+			
+			return owned;
+		}
+		
+		//Returns indices at offset as a span, borrowed straight from the mapping
+		//if it is aligned for u32, otherwise copied once into owned storage
+		//or returned empty if copyUnaligned is false
+		inline span<const u32> GetIndices(
+			size_t offset,
+			size_t count,
+			bool copyUnaligned,
+			bool& outIsBorrowed)
+		{
+			const u8* src = data + offset;
+			
+			outIsBorrowed = rcast<uintptr_t>(src) % alignof(u32) == 0;
+			if (outIsBorrowed) return { rcast<const u32*>(src), count };
+			if (!copyUnaligned) return {};
+			
+			vector<u32>& owned = alignedIndices.emplace_back(count);
+			memcpy(owned.data(), src, count * sizeof(u32));
+			
+			return owned;
+		}
+		
+		//Moves vertices decoded from a quantized or compressed block into owned storage
+		inline span<const Vertex> AdoptVertices(vector<Vertex>&& decoded)
+		{
+			return alignedVertices.emplace_back(std::move(decoded));
+		}
+		
+		//Moves indices decoded from a 16-bit or compressed block into owned storage
+		inline span<const u32> AdoptIndices(vector<u32>&& decoded)
+		{
+			return alignedIndices.emplace_back(std::move(decoded));
+		}
+	private:
+		const u8* data{};
+		size_t size{};
+#ifdef _WIN32
+		HANDLE mappingHandle{};
+#endif
+		//fallback storage for blocks whose data was not aligned inside the file or had to be decoded,
+		//inner vectors keep their addresses when the outer vector grows or is moved
+		vector<vector<Vertex>> alignedVertices{};
+		vector<vector<u32>> alignedIndices{};
+	};
+	
+	//Memory-maps the kmd file and returns its content in structs without copying the block region.
+	//Each ModelBlockView borrows its vertices and indices from outMapping,
+	//so outMapping must stay alive for as long as the views are used.
+	//Set copyUnaligned to false to leave vertices and indices empty for blocks that are not
+	//aligned inside the file and only use vertexBytes and indexBytes for them.
+	//Quantized or compressed version 2 blocks can't be borrowed, they are always decoded into outMapping
+	inline ImportResult ImportKMDMapped(
+		const path& inFile,
+		MappedModelFile& outMapping,
+		ModelHeader& outHeader,
+		vector<ModelTable>& outTables,
+		vector<ModelBlockView>& outViews,
+		bool copyUnaligned = true)
+	{
+		KPROFILE_ZONE("ImportKMDMapped");
+
+		ImportResult preReadResult = PreReadCheck(inFile);
+		if (preReadResult != ImportResult::RESULT_SUCCESS) return preReadResult;
+		
+		ImportResult tryOpenResult = TryOpenCheck(inFile);
+		if (tryOpenResult != ImportResult::RESULT_SUCCESS) return tryOpenResult;
+		
+		//header data
+			
+		ModelHeader header{};
+			
+		ImportResult headerResult = GetHeaderData(
+			inFile,
+			header,
+			true);
+			
+		if (headerResult != ImportResult::RESULT_SUCCESS) return headerResult;
+			
+		//model table data
+			
+		vector<ModelTable> tables{};
+		tables.reserve(header.modelCount);
+			
+		ImportResult tableResult = GetTableData(
+			inFile,
+			tables,
+			true);
+			
+		if (tableResult != ImportResult::RESULT_SUCCESS) return tableResult;
+		
+		try
+		{
+			MappedModelFile mapping{};
+			
+			ImportResult mapResult = mapping.Map(inFile);
+			if (mapResult != ImportResult::RESULT_SUCCESS) return mapResult;
+			
+			size_t blockRegionStart = CORRECT_MODEL_HEADER_SIZE + header.modelTablesSize;
+			size_t blockRegionEnd = blockRegionStart + header.modelBlocksSize;
+			
+			//verify that the block region is not OOB
+			if (blockRegionEnd > mapping.GetSize())
+			{
+				return ImportResult::RESULT_UNEXPECTED_EOF;
+			}
+			
+			const size_t dataOffset = GetVertexDataOffset(header.version);
+			
+			//model block data
+			
+			vector<ModelBlockView> views{};
+			views.reserve(header.modelCount);
+			
+			vector<u8> scratch{};
+			
+			for (const auto& t : tables)
+			{
+				ModelBlockView b{};
+				size_t offset = t.blockOffset;
+				
+				//verify that block size is not OOB
+				if (offset < blockRegionStart
+					|| offset + t.blockSize > blockRegionEnd)
+				{
+					return ImportResult::RESULT_UNEXPECTED_EOF;
+				}
+				
+				//verify that the fixed-layout block header is not OOB
+				if (offset + dataOffset > blockRegionEnd)
+				{
+					return ImportResult::RESULT_UNEXPECTED_EOF;
+				}
+				
+				ImportResult blockResult = DecodeBlockHeader(
+					mapping.GetData() + offset,
+					b,
+					header.version);
+					
+				if (blockResult != ImportResult::RESULT_SUCCESS) return blockResult;
+				
+				//verify that vertices are not OOB
+				if (offset + dataOffset + b.verticesSize > blockRegionEnd)
+				{
+					return ImportResult::RESULT_UNEXPECTED_EOF;
+				}
+				
+				//verify that indices are not OOB
+				if (offset + dataOffset + b.verticesSize + b.indicesSize > blockRegionEnd)
+				{
+					return ImportResult::RESULT_UNEXPECTED_EOF;
+				}
+				
+				size_t verticesStart = offset + dataOffset;
+				size_t indicesStart = verticesStart + b.verticesSize;
+				
+				if (HasPlainLayout(b))
+				{
+					//plain version 2 streams must hold exactly their counts
+					if (header.version >= 2
+						&& (b.verticesSize != scast<size_t>(b.vertexCount) * sizeof(Vertex)
+						|| b.indicesSize != scast<size_t>(b.indexCount) * sizeof(u32)))
+					{
+						return ImportResult::RESULT_DECOMPRESSION_FAILED;
+					}
+					
+					bool verticesBorrowed{};
+					bool indicesBorrowed{};
+					
+					//vertices
+					
+					b.vertexBytes = { mapping.GetData() + verticesStart, b.verticesSize };
+					b.vertices = mapping.GetVertices(
+						verticesStart,
+						b.vertexCount,
+						copyUnaligned,
+						verticesBorrowed);
+					
+					//indices
+					
+					b.indexBytes = { mapping.GetData() + indicesStart, b.indicesSize };
+					b.indices = mapping.GetIndices(
+						indicesStart,
+						b.indexCount,
+						copyUnaligned,
+						indicesBorrowed);
+						
+					b.isBorrowed = 
+						verticesBorrowed 
+						&& indicesBorrowed;
+				}
+				else
+				{
+					//encoded streams are decompressed chunk by chunk straight into the owned storage
+					
+					vector<Vertex> vertices(b.vertexCount);
+					vector<u32> indices(b.indexCount);
+					
+					ImportResult vertexResult = DecodeVertexStream(
+						mapping.GetData() + verticesStart,
+						b.verticesSize,
+						b.vertexEncoding,
+						b.compression,
+						b.vertexCount,
+						vertices.data(),
+						scratch);
+						
+					if (vertexResult != ImportResult::RESULT_SUCCESS) return vertexResult;
+					
+					ImportResult indexResult = DecodeIndexStream(
+						mapping.GetData() + indicesStart,
+						b.indicesSize,
+						b.indexEncoding,
+						b.compression,
+						b.indexCount,
+						indices.data(),
+						scratch);
+						
+					if (indexResult != ImportResult::RESULT_SUCCESS) return indexResult;
+					
+					b.vertices = mapping.AdoptVertices(std::move(vertices));
+					b.indices = mapping.AdoptIndices(std::move(indices));
+					
+					b.vertexBytes = { rcast<const u8*>(b.vertices.data()), b.vertices.size_bytes() };
+					b.indexBytes = { rcast<const u8*>(b.indices.data()), b.indices.size_bytes() };
+					
+					b.isBorrowed = false;
+				}
+				
+				//lod index buffers, borrowed like the indices if they are stored as plain u32
+				
+				vector<LodStreamInfo> lodStreams{};
+				
+				ImportResult lodResult = ReadLodTable(
+					mapping.GetData() + offset,
+					blockRegionEnd - offset,
+					b,
+					lodStreams);
+					
+				if (lodResult != ImportResult::RESULT_SUCCESS) return lodResult;
+				
+				for (const auto& l : lodStreams)
+				{
+					ModelLodView lod{};
+					lod.error = l.error;
+					
+					size_t lodStart = offset + l.offset;
+					
+					if (HasPlainLayout(b))
+					{
+						if (l.storedSize != scast<size_t>(l.indexCount) * sizeof(u32))
+						{
+							return ImportResult::RESULT_DECOMPRESSION_FAILED;
+						}
+						
+						bool lodBorrowed{};
+						lod.indices = mapping.GetIndices(
+							lodStart,
+							l.indexCount,
+							copyUnaligned,
+							lodBorrowed);
+							
+						b.isBorrowed = 
+							b.isBorrowed 
+							&& lodBorrowed;
+					}
+					else
+					{
+						vector<u32> indices(l.indexCount);
+						
+						lodResult = DecodeIndexStream(
+							mapping.GetData() + lodStart,
+							l.storedSize,
+							b.indexEncoding,
+							b.compression,
+							l.indexCount,
+							indices.data(),
+							scratch);
+							
+						if (lodResult != ImportResult::RESULT_SUCCESS) return lodResult;
+						
+						lod.indices = mapping.AdoptIndices(std::move(indices));
+					}
+					
+					b.lods.push_back(lod);
+				}
+					
+				b.bounds = ComputeModelBounds(b);
+				
+				views.push_back(std::move(b));
+			}
+			
+			outMapping = std::move(mapping);
+			outHeader = header;
+			outTables = std::move(tables);
+			outViews = std::move(views);
+			
+			return ImportResult::RESULT_SUCCESS;
+		}
+		catch (...)
+		{
+			return ImportResult::RESULT_UNKNOWN_READ_ERROR;
+		}
+	}	
+	//FIFO post-transform vertex cache size most GPUs behave like
+	inline constexpr u32 VERTEX_CACHE_SIZE = 16u;
+	
+	//Returns true if every index is below vertexCount,
+	//triangle lists must also have a multiple of 3 indices
+	inline bool IsValidIndexBuffer(
+		span<const u32> indices,
+		size_t vertexCount,
+		bool isTriangleList = true)
+	{
+		if (isTriangleList
+			&& indices.size() % 3 != 0)
+		{
+			return false;
+		}
+		
+		for (u32 index : indices)
+		{
+			if (index >= vertexCount) return false;
+		}
+		
+		return true;
+	}
+	
+	//Returns the average vertex shader invocations per triangle with a FIFO cache of cacheSize,
+	//0.5 is the best possible for large closed meshes and 3.0 means no reuse at all.
+	//Returns 0 if indices is not a valid triangle list for vertexCount vertices
+	inline f32 GetCacheMissRatio(
+		span<const u32> indices,
+		size_t vertexCount,
+		u32 cacheSize = VERTEX_CACHE_SIZE)
+	{
+		if (indices.size() < 3
+			|| !IsValidIndexBuffer(indices, vertexCount))
+		{
+			return 0.0f;
+		}
+		
+		//a vertex is cached if it was inserted less than cacheSize insertions ago
+		vector<u32> insertedAt(vertexCount);
+		u32 time = cacheSize + 1;
+		size_t misses{};
+		
+		for (u32 index : indices)
+		{
+			if (time - insertedAt[index] > cacheSize)
+			{
+				insertedAt[index] = time++;
+				++misses;
+			}
+		}
+		
+		return scast<f32>(misses) / scast<f32>(indices.size() / 3);
+	}
+	
+	//Reorders triangles for post-transform vertex cache locality with Tipsify (Sander et al. 2007),
+	//triangles stay the same and keep their winding, only their order changes.
+	//Returns false and leaves indices untouched if it is not a valid triangle list for vertexCount vertices
+	inline bool OptimizeVertexCache(
+		span<u32> indices,
+		size_t vertexCount,
+		u32 cacheSize = VERTEX_CACHE_SIZE)
+	{
+		KPROFILE_ZONE("OptimizeVertexCache");
+
+		if (!IsValidIndexBuffer(indices, vertexCount)) return false;
+		
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0) return true;
+		
+		//triangles using each vertex
+		
+		vector<u32> liveCount(vertexCount);
+		for (size_t i = 0; i < triangleCount * 3; ++i) ++liveCount[indices[i]];
+		
+		vector<u32> adjacencyStart(vertexCount + 1);
+		for (size_t v = 0; v < vertexCount; ++v) adjacencyStart[v + 1] = adjacencyStart[v] + liveCount[v];
+		
+		vector<u32> adjacency(triangleCount * 3);
+		{
+			vector<u32> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+			for (size_t i = 0; i < triangleCount * 3; ++i) adjacency[fill[indices[i]]++] = scast<u32>(i / 3);
+		}
+		
+		vector<u32> insertedAt(vertexCount);
+		vector<u8> isEmitted(triangleCount);
+		vector<u32> deadEnd{};
+		vector<u32> candidates{};
+		vector<u32> result{};
+		result.reserve(triangleCount * 3);
+		
+		u32 time = cacheSize + 1;
+		size_t cursor{};
+		int64_t fanning = indices[0];
+		
+		while (fanning >= 0)
+		{
+			const u32 f = scast<u32>(fanning);
+			candidates.clear();
+			
+			//emit every remaining triangle around the fanning vertex
+			for (u32 a = adjacencyStart[f]; a < adjacencyStart[f + 1]; ++a)
+			{
+				const u32 t = adjacency[a];
+				if (isEmitted[t]) continue;
+				
+				isEmitted[t] = 1;
+				for (size_t c = 0; c < 3; ++c)
+				{
+					const u32 v = indices[t * 3 + c];
+					
+					result.push_back(v);
+					deadEnd.push_back(v);
+					candidates.push_back(v);
+					--liveCount[v];
+					
+					if (time - insertedAt[v] > cacheSize) insertedAt[v] = time++;
+				}
+			}
+			
+			//prefer the oldest candidate that still stays in the cache while it is fanned
+			fanning = -1;
+			int64_t bestPriority = -1;
+			
+			for (u32 v : candidates)
+			{
+				if (liveCount[v] == 0) continue;
+				
+				int64_t priority{};
+				if (time - insertedAt[v] + 2 * liveCount[v] <= cacheSize) priority = time - insertedAt[v];
+				
+				if (priority > bestPriority)
+				{
+					bestPriority = priority;
+					fanning = v;
+				}
+			}
+			
+			//dead end, back up to a recently used vertex or the next unfinished one in input order
+			while (fanning < 0
+				&& !deadEnd.empty())
+			{
+				const u32 v = deadEnd.back();
+				deadEnd.pop_back();
+				
+				if (liveCount[v] > 0) fanning = v;
+			}
+			while (fanning < 0
+				&& cursor < vertexCount)
+			{
+				if (liveCount[cursor] > 0) fanning = scast<int64_t>(cursor);
+				else ++cursor;
+			}
+		}
+		
+		memcpy(indices.data(), result.data(), result.size() * sizeof(u32));
+		
+		return true;
+	}
+	
+	//Reorders clusters of an already cache-optimized index buffer so outward-facing clusters
+	//far from the mesh center are drawn first and occlude the rest (Sander et al. 2007).
+	//A cluster ends once its own cache miss ratio reaches threshold times the whole mesh,
+	//so higher thresholds give more clusters and less overdraw at some vertex cache cost.
+	//Returns false and leaves indices untouched if it is not a valid triangle list for vertices
+	inline bool OptimizeOverdraw(
+		span<u32> indices,
+		span<const Vertex> vertices,
+		f32 threshold = 1.05f,
+		u32 cacheSize = VERTEX_CACHE_SIZE)
+	{
+		if (!IsValidIndexBuffer(indices, vertices.size())) return false;
+		
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount < 2) return true;
+		
+		const f32 meshRatio = GetCacheMissRatio(
+			indices,
+			vertices.size(),
+			cacheSize);
+		
+		//split into clusters, each cluster starts with a cold cache
+		
+		vector<size_t> clusterStarts{ 0 };
+		{
+			vector<u32> insertedAt(vertices.size());
+			u32 time = cacheSize + 1;
+			size_t clusterMisses{};
+			size_t clusterTriangles{};
+			
+			for (size_t t = 0; t < triangleCount; ++t)
+			{
+				for (size_t c = 0; c < 3; ++c)
+				{
+					const u32 v = indices[t * 3 + c];
+					if (time - insertedAt[v] > cacheSize)
+					{
+						insertedAt[v] = time++;
+						++clusterMisses;
+					}
+				}
+				++clusterTriangles;
+				
+				if (t + 1 < triangleCount
+					&& scast<f32>(clusterMisses) <= meshRatio * threshold * scast<f32>(clusterTriangles))
+				{
+					clusterStarts.push_back(t + 1);
+					
+					//invalidate the whole cache for the next cluster
+					time += cacheSize + 1;
+					clusterMisses = 0;
+					clusterTriangles = 0;
+				}
+			}
+		}
+		
+		auto getPosition = [&vertices](u32 index, f32 (&outPos)[3])
+			{
+				memcpy(outPos, vertices[index].position, sizeof(outPos));
+			};
+		
+		//area-weighted centroid and normal per cluster
+		
+		const size_t clusterCount = clusterStarts.size();
+		vector<array<f32, 6>> clusterData(clusterCount);
+		f32 meshCentroid[3]{};
+		f32 meshArea{};
+		
+		for (size_t c = 0; c < clusterCount; ++c)
+		{
+			const size_t first = clusterStarts[c];
+			const size_t last = c + 1 < clusterCount ? clusterStarts[c + 1] : triangleCount;
+			
+			f32 centroid[3]{};
+			f32 normal[3]{};
+			f32 area{};
+			
+			for (size_t t = first; t < last; ++t)
+			{
+				f32 p0[3]{};
+				f32 p1[3]{};
+				f32 p2[3]{};
+				getPosition(indices[t * 3 + 0], p0);
+				getPosition(indices[t * 3 + 1], p1);
+				getPosition(indices[t * 3 + 2], p2);
+				
+				const f32 e1[3]{ p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+				const f32 e2[3]{ p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+				const f32 n[3]
+				{
+					e1[1] * e2[2] - e1[2] * e2[1],
+					e1[2] * e2[0] - e1[0] * e2[2],
+					e1[0] * e2[1] - e1[1] * e2[0]
+				};
+				const f32 a = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+				
+				for (int k = 0; k < 3; ++k)
+				{
+					centroid[k] += (p0[k] + p1[k] + p2[k]) * a / 3.0f;
+					normal[k] += n[k];
+				}
+				area += a;
+			}
+			
+			for (int k = 0; k < 3; ++k) meshCentroid[k] += centroid[k];
+			meshArea += area;
+			
+			const f32 inverseArea = area > 0.0f ? 1.0f / area : 0.0f;
+			const f32 normalLength = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			const f32 inverseNormal = normalLength > 0.0f ? 1.0f / normalLength : 0.0f;
+			
+			clusterData[c] =
+			{
+				centroid[0] * inverseArea, centroid[1] * inverseArea, centroid[2] * inverseArea,
+				normal[0] * inverseNormal, normal[1] * inverseNormal, normal[2] * inverseNormal
+			};
+		}
+		
+		if (meshArea > 0.0f)
+		{
+			for (int k = 0; k < 3; ++k) meshCentroid[k] /= meshArea;
+		}
+		
+		vector<f32> sortKey(clusterCount);
+		for (size_t c = 0; c < clusterCount; ++c)
+		{
+			const auto& d = clusterData[c];
+			sortKey[c] =
+				(d[0] - meshCentroid[0]) * d[3]
+				+ (d[1] - meshCentroid[1]) * d[4]
+				+ (d[2] - meshCentroid[2]) * d[5];
+		}
+		
+		vector<size_t> order(clusterCount);
+		iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(),
+			[&sortKey](size_t a, size_t b)
+			{
+				return sortKey[a] > sortKey[b];
+			});
+		
+		vector<u32> result{};
+		result.reserve(triangleCount * 3);
+		
+		for (size_t c : order)
+		{
+			const size_t first = clusterStarts[c];
+			const size_t last = c + 1 < clusterCount ? clusterStarts[c + 1] : triangleCount;
+			
+			result.insert(
+				result.end(),
+				indices.begin() + first * 3,
+				indices.begin() + last * 3);
+		}
+		
+		memcpy(indices.data(), result.data(), result.size() * sizeof(u32));
+		
+		return true;
+	}
+	
+	//Reorders vertices by their first use across indexBuffers and drops vertices no index references,
+	//every index buffer is remapped to the new order. Returns the new vertex count,
+	//or 0 and leaves everything untouched if an index is out of range
+	inline size_t OptimizeVertexFetch(
+		vector<Vertex>& vertices,
+		const vector<span<u32>>& indexBuffers)
+	{
+		for (const auto& buffer : indexBuffers)
+		{
+			if (!IsValidIndexBuffer(buffer, vertices.size(), false)) return 0;
+		}
+		
+		constexpr u32 UNUSED = 0xFFFFFFFFu;
+		
+		vector<u32> remap(vertices.size(), UNUSED);
+		u32 nextVertex{};
+		
+		for (const auto& buffer : indexBuffers)
+		{
+			for (u32 index : buffer)
+			{
+				if (remap[index] == UNUSED) remap[index] = nextVertex++;
+			}
+		}
+		
+		vector<Vertex> reordered(nextVertex);
+		for (size_t v = 0; v < vertices.size(); ++v)
+		{
+			if (remap[v] != UNUSED) reordered[remap[v]] = vertices[v];
+		}
+		
+		for (const auto& buffer : indexBuffers)
+		{
+			for (u32& index : buffer) index = remap[index];
+		}
+		
+		vertices = std::move(reordered);
+		
+		return vertices.size();
+	}
+	
+	//Symmetric plane quadric used by SimplifyMesh, error is the
+	//area-weighted sum of squared distances to the accumulated planes
+	struct Quadric
+	{
+		double a00{}, a11{}, a22{}, a01{}, a02{}, a12{};
+		double b0{}, b1{}, b2{};
+		double c{};
+		double weight{};
+		
+		inline void AddPlane(
+			const double (&n)[3],
+			double d,
+			double w)
+		{
+			a00 += w * n[0] * n[0];
+			a11 += w * n[1] * n[1];
+			a22 += w * n[2] * n[2];
+			a01 += w * n[0] * n[1];
+			a02 += w * n[0] * n[2];
+			a12 += w * n[1] * n[2];
+			b0 += w * n[0] * d;
+			b1 += w * n[1] * d;
+			b2 += w * n[2] * d;
+			c += w * d * d;
+			weight += w;
+		}
+		
+		inline void Add(const Quadric& q)
+		{
+			a00 += q.a00; a11 += q.a11; a22 += q.a22;
+			a01 += q.a01; a02 += q.a02; a12 += q.a12;
+			b0 += q.b0; b1 += q.b1; b2 += q.b2;
+			c += q.c;
+			weight += q.weight;
+		}
+		
+		inline double Evaluate(const f32 (&p)[3]) const
+		{
+			const double x = p[0];
+			const double y = p[1];
+			const double z = p[2];
+			
+			const double result =
+				a00 * x * x + a11 * y * y + a22 * z * z
+				+ 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+				+ 2.0 * (b0 * x + b1 * y + b2 * z)
+				+ c;
+				
+			return max(result, 0.0);
+		}
+	};
+	
+	//Simplifies a triangle list by collapsing edges onto existing vertices (Garland-Heckbert quadrics)
+	//until it has at most targetIndexCount indices or the next collapse would move the surface
+	//further than targetError, relative to the largest extent of the mesh aabb.
+	//outIndices still indexes into vertices, vertices on open borders and on attribute seams
+	//(same position, different attributes) are never moved so the result has no new holes or cracks.
+	//Returns the largest relative error of all the collapses that were made,
+	//outIndices is left empty if indices is not a valid triangle list for vertices
+	inline f32 SimplifyMesh(
+		span<const Vertex> vertices,
+		span<const u32> indices,
+		size_t targetIndexCount,
+		f32 targetError,
+		vector<u32>& outIndices)
+	{
+		KPROFILE_ZONE("SimplifyMesh");
+
+		outIndices.clear();
+		if (!IsValidIndexBuffer(indices, vertices.size())) return 0.0f;
+		
+		const size_t vertexCount = vertices.size();
+		outIndices.assign(indices.begin(), indices.end());
+		
+		if (outIndices.size() <= targetIndexCount
+			|| vertexCount == 0)
+		{
+			return 0.0f;
+		}
+		
+		auto samePosition = [&vertices](u32 a, u32 b)
+			{
+				return memcmp(vertices[a].position, vertices[b].position, sizeof(Vertex::position)) == 0;
+			};
+		
+		//vertices sharing a position, the first of each group stands in for the whole group
+		
+		vector<u32> byPosition(vertexCount);
+		iota(byPosition.begin(), byPosition.end(), 0u);
+		sort(byPosition.begin(), byPosition.end(),
+			[&vertices](u32 a, u32 b)
+			{
+				return memcmp(vertices[a].position, vertices[b].position, sizeof(Vertex::position)) < 0;
+			});
+		
+		vector<u32> positionId(vertexCount);
+		vector<u8> isLocked(vertexCount);
+		
+		for (size_t i = 0; i < vertexCount;)
+		{
+			size_t j = i + 1;
+			while (j < vertexCount
+				&& samePosition(byPosition[i], byPosition[j]))
+			{
+				++j;
+			}
+			
+			for (size_t k = i; k < j; ++k)
+			{
+				positionId[byPosition[k]] = byPosition[i];
+				
+				//moving one side of a seam would tear it open
+				if (j - i > 1) isLocked[byPosition[k]] = 1;
+			}
+			
+			i = j;
+		}
+		
+		//edges that only one triangle uses are on an open border,
+		//edges more than two triangles use are non-manifold, both keep their vertices in place
+		{
+			vector<uint64_t> edges{};
+			edges.reserve(outIndices.size());
+			
+			for (size_t t = 0; t < outIndices.size(); t += 3)
+			{
+				for (size_t c = 0; c < 3; ++c)
+				{
+					u32 a = positionId[outIndices[t + c]];
+					u32 b = positionId[outIndices[t + (c + 1) % 3]];
+					if (a == b) continue;
+					if (a > b) std::swap(a, b);
+					
+					edges.push_back((scast<uint64_t>(a) << 32) | b);
+				}
+			}
+			
+			sort(edges.begin(), edges.end());
+			
+			vector<u8> isBorderPosition(vertexCount);
+			for (size_t i = 0; i < edges.size();)
+			{
+				size_t j = i + 1;
+				while (j < edges.size() && edges[j] == edges[i]) ++j;
+				
+				if (j - i != 2)
+				{
+					isBorderPosition[scast<u32>(edges[i] >> 32)] = 1;
+					isBorderPosition[scast<u32>(edges[i] & 0xFFFFFFFFu)] = 1;
+				}
+				
+				i = j;
+			}
+			
+			for (size_t v = 0; v < vertexCount; ++v)
+			{
+				if (isBorderPosition[positionId[v]]) isLocked[v] = 1;
+			}
+		}
+		
+		//error is measured relative to the mesh size
+		
+		f32 aabbMin[3]{};
+		f32 aabbMax[3]{};
+		memcpy(aabbMin, vertices[outIndices[0]].position, sizeof(aabbMin));
+		memcpy(aabbMax, vertices[outIndices[0]].position, sizeof(aabbMax));
+		
+		for (u32 index : outIndices)
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				aabbMin[k] = min(aabbMin[k], vertices[index].position[k]);
+				aabbMax[k] = max(aabbMax[k], vertices[index].position[k]);
+			}
+		}
+		
+		const f32 extent = max(max(
+			aabbMax[0] - aabbMin[0], 
+			aabbMax[1] - aabbMin[1]), 
+			aabbMax[2] - aabbMin[2]);
+		if (extent <= 0.0f) return 0.0f;
+		
+		auto getNormal = [&vertices](u32 i0, u32 i1, u32 i2, double (&outNormal)[3])
+			{
+				const f32* p0 = vertices[i0].position;
+				const f32* p1 = vertices[i1].position;
+				const f32* p2 = vertices[i2].position;
+				
+				const double e1[3]{ double(p1[0]) - p0[0], double(p1[1]) - p0[1], double(p1[2]) - p0[2] };
+				const double e2[3]{ double(p2[0]) - p0[0], double(p2[1]) - p0[1], double(p2[2]) - p0[2] };
+				
+				outNormal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+				outNormal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+				outNormal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+			};
+		
+		//plane quadrics weighted by triangle area
+		
+		vector<Quadric> quadrics(vertexCount);
+		for (size_t t = 0; t < outIndices.size(); t += 3)
+		{
+			double n[3]{};
+			getNormal(outIndices[t], outIndices[t + 1], outIndices[t + 2], n);
+			
+			const double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			if (length <= 0.0) continue;
+			
+			n[0] /= length;
+			n[1] /= length;
+			n[2] /= length;
+			
+			const f32* p0 = vertices[outIndices[t]].position;
+			const double d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+			
+			for (size_t c = 0; c < 3; ++c) quadrics[outIndices[t + c]].AddPlane(n, d, length * 0.5);
+		}
+		
+		auto getError = [&](u32 from, u32 to)
+			{
+				Quadric q = quadrics[from];
+				q.Add(quadrics[to]);
+				
+				const double meanSquared = q.weight > 0.0
+					? q.Evaluate(vertices[to].position) / q.weight
+					: 0.0;
+					
+				return scast<f32>(sqrt(meanSquared)) / extent;
+			};
+		
+		struct Collapse
+		{
+			u32 from{};
+			u32 to{};
+			f32 error{};
+		};
+		
+		vector<Collapse> collapses{};
+		vector<u32> adjacencyStart(vertexCount + 1);
+		vector<u32> adjacency{};
+		vector<u8> isTouched(vertexCount);
+		f32 reachedError{};
+		
+		constexpr u32 REMOVED = 0xFFFFFFFFu;
+		
+		//each pass collapses the cheapest edges whose neighborhoods don't overlap
+		while (outIndices.size() > targetIndexCount)
+		{
+			const size_t triangleCount = outIndices.size() / 3;
+			
+			fill(adjacencyStart.begin(), adjacencyStart.end(), 0u);
+			for (u32 index : outIndices) ++adjacencyStart[index + 1];
+			for (size_t v = 0; v < vertexCount; ++v) adjacencyStart[v + 1] += adjacencyStart[v];
+			
+			adjacency.resize(outIndices.size());
+			{
+				vector<u32> fillPos(adjacencyStart.begin(), adjacencyStart.end() - 1);
+				for (size_t i = 0; i < outIndices.size(); ++i) adjacency[fillPos[outIndices[i]]++] = scast<u32>(i / 3);
+			}
+			
+			collapses.clear();
+			for (size_t t = 0; t < outIndices.size(); t += 3)
+			{
+				for (size_t c = 0; c < 3; ++c)
+				{
+					const u32 a = outIndices[t + c];
+					const u32 b = outIndices[t + (c + 1) % 3];
+					
+					if (!isLocked[a]) collapses.push_back({ a, b, getError(a, b) });
+					if (!isLocked[b]) collapses.push_back({ b, a, getError(b, a) });
+				}
+			}
+			
+			sort(collapses.begin(), collapses.end(),
+				[](const Collapse& x, const Collapse& y)
+				{
+					return x.error < y.error;
+				});
+			
+			fill(isTouched.begin(), isTouched.end(), u8{ 0 });
+			
+			size_t remainingTriangles = triangleCount;
+			size_t collapseCount{};
+			
+			for (const auto& cl : collapses)
+			{
+				if (cl.error > targetError
+					|| remainingTriangles * 3 <= targetIndexCount)
+				{
+					break;
+				}
+				if (isTouched[cl.from]
+					|| isTouched[cl.to])
+				{
+					continue;
+				}
+				
+				//reject collapses that would flip or flatten a surviving triangle
+				
+				bool isValid = true;
+				size_t removedTriangles{};
+				
+				for (u32 a = adjacencyStart[cl.from]; a < adjacencyStart[cl.from + 1] && isValid; ++a)
+				{
+					const u32 t = adjacency[a] * 3;
+					u32 tri[3]{ outIndices[t], outIndices[t + 1], outIndices[t + 2] };
+					
+					if (tri[0] == cl.to
+						|| tri[1] == cl.to
+						|| tri[2] == cl.to)
+					{
+						++removedTriangles;
+						continue;
+					}
+					
+					double before[3]{};
+					getNormal(tri[0], tri[1], tri[2], before);
+					
+					for (u32& v : tri)
+					{
+						if (v == cl.from) v = cl.to;
+					}
+					
+					double after[3]{};
+					getNormal(tri[0], tri[1], tri[2], after);
+					
+					const double dot = 
+						before[0] * after[0] 
+						+ before[1] * after[1] 
+						+ before[2] * after[2];
+					const double lengths = 
+						sqrt(before[0] * before[0] + before[1] * before[1] + before[2] * before[2])
+						* sqrt(after[0] * after[0] + after[1] * after[1] + after[2] * after[2]);
+						
+					if (dot <= 0.25 * lengths) isValid = false;
+				}
+				
+				if (!isValid) continue;
+				
+				//apply the collapse and keep the rest of this neighborhood still for this pass
+				
+				for (u32 a = adjacencyStart[cl.from]; a < adjacencyStart[cl.from + 1]; ++a)
+				{
+					const u32 t = adjacency[a] * 3;
+					
+					for (size_t c = 0; c < 3; ++c)
+					{
+						if (outIndices[t + c] == cl.from) outIndices[t + c] = cl.to;
+						isTouched[outIndices[t + c]] = 1;
+					}
+					
+					if (outIndices[t] == outIndices[t + 1]
+						|| outIndices[t + 1] == outIndices[t + 2]
+						|| outIndices[t] == outIndices[t + 2])
+					{
+						outIndices[t] = REMOVED;
+					}
+				}
+				
+				isTouched[cl.from] = 1;
+				quadrics[cl.to].Add(quadrics[cl.from]);
+				
+				reachedError = max(reachedError, cl.error);
+				remainingTriangles -= removedTriangles;
+				++collapseCount;
+			}
+			
+			//drop the triangles that became degenerate
+			
+			size_t write{};
+			for (size_t t = 0; t < outIndices.size(); t += 3)
+			{
+				if (outIndices[t] == REMOVED) continue;
+				
+				outIndices[write++] = outIndices[t];
+				outIndices[write++] = outIndices[t + 1];
+				outIndices[write++] = outIndices[t + 2];
+			}
+			outIndices.resize(write);
+			
+			if (collapseCount == 0) break;
+		}
+		
+		return reachedError;
+	}
+	
+	//Settings for OptimizeModelBlock
+	struct MeshOptimizeSettings
+	{
+		u32 cacheSize = VERTEX_CACHE_SIZE;
+		
+		//cluster threshold for OptimizeOverdraw, 0 skips overdraw ordering
+		f32 overdrawThreshold = 1.05f;
+		
+		//how many LOD index buffers to generate, up to MAX_LOD_COUNT
+		u8 lodCount{};
+		
+		//each LOD aims for this fraction of the indices of the previous one
+		f32 lodReduction = 0.5f;
+		
+		//no LOD may deviate from the full-detail mesh by more than this, relative to the mesh size
+		f32 lodMaxError = 0.02f;
+	};
+	
+	//Runs the whole post-processing pipeline on a model block, meant to be paid once at export time:
+	//vertex cache order, overdraw order, a chain of LOD index buffers and finally vertex fetch order
+	//across all index buffers. Counts and bounds are refreshed, store the result with EncodeModelBlock.
+	//Returns false and leaves b untouched if an index is out of range
+	inline bool OptimizeModelBlock(
+		ModelBlock& b,
+		const MeshOptimizeSettings& settings = {})
+	{
+		KPROFILE_ZONE("OptimizeModelBlock");
+
+		if (!IsValidIndexBuffer(b.indices, b.vertices.size(), false)) return false;
+		
+		b.indices.resize(b.indices.size() / 3 * 3);
+		
+		OptimizeVertexCache(
+			b.indices,
+			b.vertices.size(),
+			settings.cacheSize);
+		
+		if (settings.overdrawThreshold > 0.0f)
+		{
+			OptimizeOverdraw(
+				b.indices,
+				b.vertices,
+				settings.overdrawThreshold,
+				settings.cacheSize);
+		}
+		
+		//each LOD is simplified from the one before it, the full-detail
+		//mesh is the reference so the errors add up along the chain
+		
+		b.lods.clear();
+		span<const u32> previous = b.indices;
+		f32 previousError{};
+		
+		const u8 lodCount = min(settings.lodCount, MAX_LOD_COUNT);
+		for (u8 l = 0; l < lodCount; ++l)
+		{
+			const size_t target = scast<size_t>(scast<f32>(previous.size() / 3) * settings.lodReduction) * 3;
+			
+			ModelLod lod{};
+			const f32 error = SimplifyMesh(
+				b.vertices,
+				previous,
+				target,
+				settings.lodMaxError - previousError,
+				lod.indices);
+			
+			//stop once simplification no longer makes progress
+			if (lod.indices.empty()
+				|| lod.indices.size() >= previous.size())
+			{
+				break;
+			}
+			
+			OptimizeVertexCache(
+				lod.indices,
+				b.vertices.size(),
+				settings.cacheSize);
+			
+			lod.error = previousError + error;
+			previousError = lod.error;
+			
+			b.lods.push_back(std::move(lod));
+			previous = b.lods.back().indices;
+		}
+		
+		vector<span<u32>> indexBuffers{ b.indices };
+		for (auto& lod : b.lods) indexBuffers.push_back(lod.indices);
+		
+		OptimizeVertexFetch(
+			b.vertices,
+			indexBuffers);
+		
+		b.vertexCount = scast<u32>(b.vertices.size());
+		b.indexCount = scast<u32>(b.indices.size());
+		b.lodCount = scast<u8>(b.lods.size());
+		b.bounds = ComputeModelBounds(b);
+		
+		return true;
+	}
+	
+	//Encodes a model block in the version 2 block layout with plain f32 vertices and uncompressed streams,
+	//indices and LOD index buffers are stored as u16 when the vertex count allows it.
+	//The result can be written behind a ModelTable of a version 2 kmd file as-is,
+	//compressing the streams is left to the exporter
+	inline void EncodeModelBlock(
+		const ModelBlock& b,
+		vector<u8>& outBlock)
+	{
+		KPROFILE_ZONE("EncodeModelBlock");
+
+		const bool useU16 = b.vertices.size() <= 65536u;
+		const size_t indexSize = useU16 ? sizeof(u16) : sizeof(u32);
+		const u8 lodCount = scast<u8>(min(b.lods.size(), scast<size_t>(MAX_LOD_COUNT)));
+		
+		size_t lodIndexCount{};
+		for (u8 l = 0; l < lodCount; ++l) lodIndexCount += b.lods[l].indices.size();
+		
+		const u32 verticesSize = scast<u32>(b.vertices.size() * sizeof(Vertex));
+		const u32 indicesSize = scast<u32>(b.indices.size() * indexSize);
+		
+		outBlock.assign(
+			VERTICE_DATA_OFFSET_V2
+			+ verticesSize
+			+ indicesSize
+			+ scast<size_t>(lodCount) * LOD_TABLE_ENTRY_SIZE
+			+ lodIndexCount * indexSize,
+			0);
+			
+		u8* dst = outBlock.data();
+		
+		auto writeU32 = [&dst](u32 value)
+			{
+				memcpy(dst, &value, sizeof(u32));
+				dst += sizeof(u32);
+			};
+		auto writeIndices = [&dst, useU16](span<const u32> indices)
+			{
+				for (u32 index : indices)
+				{
+					if (useU16)
+					{
+						const u16 narrow = scast<u16>(index);
+						memcpy(dst, &narrow, sizeof(u16));
+						dst += sizeof(u16);
+					}
+					else
+					{
+						memcpy(dst, &index, sizeof(u32));
+						dst += sizeof(u32);
+					}
+				}
+			};
+		
+		memcpy(dst + 0,  b.nodeName, 20);
+		memcpy(dst + 20, b.meshName, 20);
+		memcpy(dst + 40, b.nodePath, 50);
+		
+		dst[90] = b.dataTypeFlags;
+		dst[91] = b.renderType;
+		
+		memcpy(dst + 92,  b.position, sizeof(b.position));
+		memcpy(dst + 104, b.rotation, sizeof(b.rotation));
+		memcpy(dst + 120, b.size,     sizeof(b.size));
+		
+		dst += 132;
+		writeU32(scast<u32>(b.vertices.size()));
+		writeU32(verticesSize);
+		writeU32(scast<u32>(b.indices.size()));
+		writeU32(indicesSize);
+		
+		dst[0] = 0; //plain f32 vertices
+		dst[1] = useU16 ? INDEX_U16 : INDEX_U32;
+		dst[2] = COMPRESSION_NONE;
+		dst[3] = lodCount;
+		dst += 4;
+		
+		if (verticesSize > 0) memcpy(dst, b.vertices.data(), verticesSize);
+		dst += verticesSize;
+		
+		writeIndices(b.indices);
+		
+		for (u8 l = 0; l < lodCount; ++l)
+		{
+			writeU32(scast<u32>(b.lods[l].indices.size()));
+			writeU32(scast<u32>(b.lods[l].indices.size() * indexSize));
+			
+			memcpy(dst, &b.lods[l].error, sizeof(f32));
+			dst += sizeof(f32);
+		}
+		
+		for (u8 l = 0; l < lodCount; ++l) writeIndices(b.lods[l].indices);
+	}
 }
\ No newline at end of file
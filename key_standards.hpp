@@ -11,13 +11,18 @@
 //   - standard layout for typography, math and currency symbols
 //   - standard layout for latin and cyrillic alphabet letters
 //   - standard layout for emojis
+//   - compile-time hash lookups between keys, utf code points and values
+//   - InputState with bitset input masks and lock-free per-frame snapshots
 //---------------------------------------------------------------------------
 
 #pragma once
 
 #include <cstddef>
 #include <array>
-#include <vector>
+#include <cstdint>
+#include <bit>
+#include <atomic>
+#include <type_traits>
 #include <string>
 #include <algorithm>
 
@@ -32,13 +37,18 @@ namespace KalaHeaders::KalaKeyStandards
 #endif
 
 	using std::array;
-	using std::vector;
 	using std::string;
 	using std::string_view;
-	using std::lower_bound;
-	using std::find_if;
+	using std::bit_ceil;
+	using std::max;
+	using std::atomic;
+	using std::memory_order_acquire;
+	using std::memory_order_release;
+	using std::memory_order_acq_rel;
 	
+	using u16 = uint16_t;
 	using u32 = uint32_t;
+	using u64 = uint64_t;
 	
 	struct KeyValue
 	{
@@ -990,149 +1000,453 @@ namespace KalaHeaders::KalaKeyStandards
 	// GET KEY, UTF OR VALUE
 	//
 	
-	inline vector<KeyValue> keyValues{};
+	//Count of entries in all tables combined, including unused trailing entries
+	inline constexpr size_t KEY_VALUE_COUNT =
+		mouseButtons.size()
+		+ gamepadButtons.size()
+		+ keyboardButtons.size()
+		
+		+ typography_symbols.size()
+		+ math_symbols.size()
+		+ currency_symbols.size()
+		
+		+ latin_standard.size()
+		+ latin_extra.size()
+		
+		+ cyrillic_standard.size()
+		+ cyrillic_extra.size()
+		
+		+ emojis.size();
+	
+	//Slot count of each lookup table, atleast twice the entry count so probes stay short
+	inline constexpr size_t KEY_LOOKUP_SIZE = bit_ceil(KEY_VALUE_COUNT * 2);
+	
+	//Marks an unused lookup table slot
+	inline constexpr u16 KEY_LOOKUP_EMPTY = 0xFFFF;
+	
+	//Lookups are never allowed to probe more slots than this
+	inline constexpr size_t MAX_KEY_LOOKUP_PROBE = 16;
+	
+	static_assert(KEY_VALUE_COUNT < KEY_LOOKUP_EMPTY, "Too many key values for 16-bit lookup slots.");
+	
+	//All tables merged at compile time, the merge order decides
+	//which entry wins when a utf or value exists in more than one table
+	inline constexpr array<KeyValue, KEY_VALUE_COUNT> keyValues = []()
+		{
+			array<KeyValue, KEY_VALUE_COUNT> merged{};
+			size_t offset{};
+			
+			auto append = [&merged, &offset](const auto& table)
+				{
+					for (const auto& kv : table) merged[offset++] = kv;
+				};
+				
+			append(mouseButtons);
+			append(gamepadButtons);
+			append(keyboardButtons);
+			
+			append(typography_symbols);
+			append(math_symbols);
+			append(currency_symbols);
+			
+			append(latin_standard);
+			append(latin_extra);
+			
+			append(cyrillic_standard);
+			append(cyrillic_extra);
+			
+			append(emojis);
+			
+			return merged;
+		}();
+	
+	//Open-addressed table of indexes into keyValues
+	struct KeyLookupTable
+	{
+		array<u16, KEY_LOOKUP_SIZE> slots{};
+		size_t maxProbe{}; //longest probe sequence of any inserted entry
+	};
+	
+	inline constexpr u32 HashKeyNumber(u32 v)
+	{
+		v ^= v >> 16;
+		v *= 0x7FEB352Du;
+		v ^= v >> 15;
+		v *= 0x846CA68Bu;
+		v ^= v >> 16;
+		
+		return v;
+	}
+	inline constexpr u32 HashKeyString(string_view s)
+	{
+		u32 hash = 2166136261u;
+		for (char c : s)
+		{
+			hash ^= scast<unsigned char>(c);
+			hash *= 16777619u;
+		}
+		
+		return hash;
+	}
 	
-	inline constexpr void FillKeyValues()
+	//Builds a lookup table over every keyValues entry that has a field,
+	//the first entry in merge order wins if the field exists more than once
+	template<typename GetField, typename Hash>
+	inline constexpr KeyLookupTable BuildKeyLookup(
+		GetField getField,
+		Hash hash)
 	{
-		if (!keyValues.empty()) return;
+		KeyLookupTable table{};
+		for (auto& slot : table.slots) slot = KEY_LOOKUP_EMPTY;
 		
-		keyValues.reserve(
-			mouseButtons.size()
-			+ gamepadButtons.size()
-			+ keyboardButtons.size()
+		for (size_t i = 0; i < keyValues.size(); ++i)
+		{
+			const auto field = getField(keyValues[i]);
 			
-			+ typography_symbols.size()
-			+ math_symbols.size()
-			+ currency_symbols.size()
-				
-			+ latin_standard.size()
-			+ latin_extra.size()
-				
-			+ cyrillic_standard.size()
-			+ cyrillic_extra.size()
+			//trailing entries of the tables are empty
+			if (field == decltype(field){}) continue;
 			
-			+ emojis.size());
-				
-		keyValues.insert(keyValues.end(), mouseButtons.begin(), mouseButtons.end());
-		keyValues.insert(keyValues.end(), gamepadButtons.begin(), gamepadButtons.end());
-		keyValues.insert(keyValues.end(), keyboardButtons.begin(), keyboardButtons.end());
+			size_t slot = hash(field) & (KEY_LOOKUP_SIZE - 1);
+			size_t probe = 0;
+			
+			while (table.slots[slot] != KEY_LOOKUP_EMPTY
+				&& getField(keyValues[table.slots[slot]]) != field)
+			{
+				slot = (slot + 1) & (KEY_LOOKUP_SIZE - 1);
+				++probe;
+			}
+			
+			if (table.slots[slot] != KEY_LOOKUP_EMPTY) continue;
+			
+			table.slots[slot] = scast<u16>(i);
+			table.maxProbe = max(table.maxProbe, probe);
+		}
+		
+		return table;
+	}
+	
+	//Returns the keyValues index of the entry whose field matches, invalid value is always returned as MAXSIZE_T
+	template<typename GetField, typename Hash, typename Field>
+	inline constexpr size_t FindKeyValueIndex(
+		const KeyLookupTable& table,
+		GetField getField,
+		Hash hash,
+		const Field& field)
+	{
+		size_t slot = hash(field) & (KEY_LOOKUP_SIZE - 1);
 		
-		keyValues.insert(keyValues.end(), typography_symbols.begin(), typography_symbols.end());
-		keyValues.insert(keyValues.end(), math_symbols.begin(), math_symbols.end());
-		keyValues.insert(keyValues.end(), currency_symbols.begin(), currency_symbols.end());
+		for (size_t probe = 0; probe <= table.maxProbe; ++probe)
+		{
+			const u16 index = table.slots[slot];
+			if (index == KEY_LOOKUP_EMPTY) break;
 			
-		keyValues.insert(keyValues.end(), latin_standard.begin(), latin_standard.end());
-		keyValues.insert(keyValues.end(), latin_extra.begin(), latin_extra.end());
+			if (getField(keyValues[index]) == field) return index;
 			
-		keyValues.insert(keyValues.end(), cyrillic_standard.begin(), cyrillic_standard.end());
-		keyValues.insert(keyValues.end(), cyrillic_extra.begin(), cyrillic_extra.end());
+			slot = (slot + 1) & (KEY_LOOKUP_SIZE - 1);
+		}
 		
-		keyValues.insert(keyValues.end(), emojis.begin(), emojis.end());
+		return MAXSIZE_T;
 	}
 	
+	inline constexpr auto GetKeyField = [](const KeyValue& kv) { return kv.key; };
+	inline constexpr auto GetUTFField = [](const KeyValue& kv) { return kv.utf; };
+	inline constexpr auto GetValueField = [](const KeyValue& kv) { return kv.value; };
+	
+	inline constexpr KeyLookupTable keyLookup = BuildKeyLookup(GetKeyField, HashKeyNumber);
+	inline constexpr KeyLookupTable utfLookup = BuildKeyLookup(GetUTFField, HashKeyNumber);
+	inline constexpr KeyLookupTable valueLookup = BuildKeyLookup(GetValueField, HashKeyString);
+	
+	static_assert(
+		keyLookup.maxProbe <= MAX_KEY_LOOKUP_PROBE
+		&& utfLookup.maxProbe <= MAX_KEY_LOOKUP_PROBE
+		&& valueLookup.maxProbe <= MAX_KEY_LOOKUP_PROBE,
+		"Key lookup tables have too long probe sequences, increase KEY_LOOKUP_SIZE.");
+	
+	//Kept for compatibility, keyValues and its lookup tables are built at compile time
+	inline constexpr void FillKeyValues() {}
+	
 	inline constexpr u32 GetKeyByUTF(const u32 utf)
 	{
-		FillKeyValues();
-		
 		//prevent empty searches
 		if (utf == 0) return 0;
 		
-		const auto it = find_if(
-			keyValues.begin(), keyValues.end(),
-			[&](const KeyValue& kv) { return kv.utf == utf; });
+		const size_t i = FindKeyValueIndex(utfLookup, GetUTFField, HashKeyNumber, utf);
 			
-		return (
-			it != keyValues.end()
-			&& it->utf != 0)
-			? it->utf
+		return i != MAXSIZE_T
+			? keyValues[i].key
 			: u32{};
 	}
 	inline constexpr u32 GetKeyByValue(const string_view& value)
 	{
-		FillKeyValues();
-		
 		//prevent empty searches
 		if (value.empty()) return 0;
 		
-		const auto it = find_if(
-			keyValues.begin(), keyValues.end(),
-			[&](const KeyValue& kv) { return kv.value == value; });
+		const size_t i = FindKeyValueIndex(valueLookup, GetValueField, HashKeyString, value);
 			
-		return (
-			it != keyValues.end()
-			&& it->key != 0)
-			? it->key
+		return i != MAXSIZE_T
+			? keyValues[i].key
 			: u32{};
 	}
 	
 	inline constexpr u32 GetUTFByKey(u32 key)
 	{
-		FillKeyValues();
-		
 		//prevent empty searches
 		if (key == 0) return 0x003F;
 		
-		const auto it = lower_bound(
-			keyValues.begin(), keyValues.end(), key,
-			[](const KeyValue& kv, u32 k) { return kv.key < k; });
+		const size_t i = FindKeyValueIndex(keyLookup, GetKeyField, HashKeyNumber, key);
 			
 		return (
-			it != keyValues.end()
-			&& it->key == key
-			&& it->utf != 0)
-			? it->utf
+			i != MAXSIZE_T
+			&& keyValues[i].utf != 0)
+			? keyValues[i].utf
 			: 0x003F; //returns ? as fallback
 	}
 	inline constexpr u32 GetUTFByValue(const string_view& value)
 	{
-		FillKeyValues();
-		
 		//prevent empty searches
 		if (value.empty()) return 0x003F;
 		
-		const auto it = find_if(
-			keyValues.begin(), keyValues.end(),
-			[&](const KeyValue& kv) { return kv.value == value; });
+		const size_t i = FindKeyValueIndex(valueLookup, GetValueField, HashKeyString, value);
 			
 		return (
-			it != keyValues.end()
-			&& it->utf != 0)
-			? it->utf
+			i != MAXSIZE_T
+			&& keyValues[i].utf != 0)
+			? keyValues[i].utf
 			: 0x003F; //returns ? as fallback
 	}
 	
 	inline constexpr string_view GetValueByKey(u32 key)
 	{
-		FillKeyValues();
-	
 		//prevent empty searches
 		if (key == 0) return "?";
 	
-		const auto it = lower_bound(
-			keyValues.begin(), keyValues.end(), key,
-			[](const KeyValue& kv, u32 k) { return kv.key < k; });
+		const size_t i = FindKeyValueIndex(keyLookup, GetKeyField, HashKeyNumber, key);
 			
-		return (
-			it != keyValues.end()
-			&& it->key == key)
-			? it->value
+		return i != MAXSIZE_T
+			? keyValues[i].value
 			: "?";
 	}
 	inline constexpr string_view GetValueByUTF(u32 utf)
 	{
-		FillKeyValues();
-		
 		//prevent empty searches
 		if (utf == 0) return "?";
 		
-		const auto it = find_if(
-			keyValues.begin(), keyValues.end(),
-			[&](const KeyValue& kv) { return kv.utf == utf; });
+		const size_t i = FindKeyValueIndex(utfLookup, GetUTFField, HashKeyNumber, utf);
 			
-		return (
-			it != keyValues.end()
-			&& it->utf == utf)
-			? it->value
+		return i != MAXSIZE_T
+			? keyValues[i].value
 			: "?";
 	}
+	
+	//
+	// INPUT STATE
+	//
+	
+	//Bit offsets of each device inside an InputMask
+	inline constexpr size_t INPUT_MOUSE_OFFSET = 0;
+	inline constexpr size_t INPUT_GAMEPAD_OFFSET = 64;
+	inline constexpr size_t INPUT_KEYBOARD_OFFSET = 128;
+	
+	//Count of 64-bit words in an InputMask
+	inline constexpr size_t INPUT_MASK_WORDS = 4;
+	
+	static_assert(
+		mouseButtons.size() <= INPUT_GAMEPAD_OFFSET - INPUT_MOUSE_OFFSET
+		&& gamepadButtons.size() <= INPUT_KEYBOARD_OFFSET - INPUT_GAMEPAD_OFFSET
+		&& keyboardButtons.size() <= INPUT_MASK_WORDS * 64 - INPUT_KEYBOARD_OFFSET,
+		"Input buttons do not fit into InputMask.");
+	
+	//Invalid value is always returned as MAXSIZE_T, never 0
+	inline constexpr size_t ButtonToBit(MouseButton m)
+	{
+		const size_t i = MouseToIndex(m);
+		return i == MAXSIZE_T ? MAXSIZE_T : INPUT_MOUSE_OFFSET + i;
+	}
+	//Invalid value is always returned as MAXSIZE_T, never 0
+	inline constexpr size_t ButtonToBit(GamepadButton g)
+	{
+		const size_t i = GamepadToIndex(g);
+		return i == MAXSIZE_T ? MAXSIZE_T : INPUT_GAMEPAD_OFFSET + i;
+	}
+	//Invalid value is always returned as MAXSIZE_T, never 0
+	inline constexpr size_t ButtonToBit(KeyboardButton k)
+	{
+		const size_t i = KeyToIndex(k);
+		return i == MAXSIZE_T ? MAXSIZE_T : INPUT_KEYBOARD_OFFSET + i;
+	}
+	
+	template<typename T>
+	concept InputButton = 
+		std::is_same_v<T, MouseButton>
+		|| std::is_same_v<T, GamepadButton>
+		|| std::is_same_v<T, KeyboardButton>;
+	
+	//One bit per mouse, gamepad and keyboard button so any number of buttons
+	//can be checked at once with a few AND instructions
+	struct InputMask
+	{
+		array<u64, INPUT_MASK_WORDS> words{};
+		
+		//Invalid buttons are ignored
+		template<InputButton T>
+		constexpr void Set(T b, bool isSet = true)
+		{
+			const size_t bit = ButtonToBit(b);
+			if (bit == MAXSIZE_T) return;
+			
+			const u64 mask = u64{ 1 } << (bit % 64);
+			
+			if (isSet) words[bit / 64] |= mask;
+			else       words[bit / 64] &= ~mask;
+		}
+		//Invalid buttons are never set
+		template<InputButton T>
+		constexpr bool Test(T b) const
+		{
+			const size_t bit = ButtonToBit(b);
+			if (bit == MAXSIZE_T) return false;
+			
+			return (words[bit / 64] >> (bit % 64)) & 1;
+		}
+		
+		//Returns true if any bit is set
+		constexpr bool Any() const
+		{
+			u64 bits{};
+			for (u64 w : words) bits |= w;
+			
+			return bits != 0;
+		}
+		//Returns true if atleast one of the buttons in m is set
+		constexpr bool AnyOf(const InputMask& m) const
+		{
+			u64 bits{};
+			for (size_t i = 0; i < INPUT_MASK_WORDS; ++i) bits |= words[i] & m.words[i];
+			
+			return bits != 0;
+		}
+		//Returns true if all of the buttons in m are set
+		constexpr bool AllOf(const InputMask& m) const
+		{
+			u64 missing{};
+			for (size_t i = 0; i < INPUT_MASK_WORDS; ++i) missing |= m.words[i] & ~words[i];
+			
+			return missing == 0;
+		}
+		
+		constexpr InputMask operator|(const InputMask& m) const
+		{
+			InputMask r{};
+			for (size_t i = 0; i < INPUT_MASK_WORDS; ++i) r.words[i] = words[i] | m.words[i];
+			
+			return r;
+		}
+		constexpr InputMask operator&(const InputMask& m) const
+		{
+			InputMask r{};
+			for (size_t i = 0; i < INPUT_MASK_WORDS; ++i) r.words[i] = words[i] & m.words[i];
+			
+			return r;
+		}
+		constexpr InputMask operator~() const
+		{
+			InputMask r{};
+			for (size_t i = 0; i < INPUT_MASK_WORDS; ++i) r.words[i] = ~words[i];
+			
+			return r;
+		}
+		
+		constexpr bool operator==(const InputMask& m) const = default;
+	};
+	
+	//Returns a mask with all of the buttons set, can be mixed from all three devices
+	template<InputButton... T>
+	inline constexpr InputMask MakeInputMask(T... buttons)
+	{
+		InputMask m{};
+		(m.Set(buttons), ...);
+		
+		return m;
+	}
+	
+	//Input of a single frame
+	struct InputSnapshot
+	{
+		InputMask down{};     //buttons held down at the end of the frame
+		InputMask pressed{};  //buttons that went down during the frame
+		InputMask released{}; //buttons that went up during the frame
+		
+		template<InputButton T>
+		constexpr bool IsDown(T b) const { return down.Test(b); }
+		template<InputButton T>
+		constexpr bool IsPressed(T b) const { return pressed.Test(b); }
+		template<InputButton T>
+		constexpr bool IsReleased(T b) const { return released.Test(b); }
+	};
+	
+	//Collects button events from the OS event thread and hands them to the game thread once per frame.
+	//SetButton and ReleaseAll can be called from any thread, Update and the getters only from the game thread.
+	//Nothing locks, and a press and release between two updates still show up as pressed and released
+	class InputState
+	{
+	public:
+		//Records a button going down or up, repeated downs from key repeat are not new presses
+		template<InputButton T>
+		inline void SetButton(T b, bool isDown)
+		{
+			const size_t bit = ButtonToBit(b);
+			if (bit == MAXSIZE_T) return;
+			
+			const size_t w = bit / 64;
+			const u64 mask = u64{ 1 } << (bit % 64);
+			
+			if (isDown)
+			{
+				const u64 prev = liveDown[w].fetch_or(mask, memory_order_acq_rel);
+				if (!(prev & mask)) livePressed[w].fetch_or(mask, memory_order_release);
+			}
+			else
+			{
+				const u64 prev = liveDown[w].fetch_and(~mask, memory_order_acq_rel);
+				if (prev & mask) liveReleased[w].fetch_or(mask, memory_order_release);
+			}
+		}
+		
+		//Releases every button that is down, use when the window loses focus
+		inline void ReleaseAll()
+		{
+			for (size_t w = 0; w < INPUT_MASK_WORDS; ++w)
+			{
+				const u64 prev = liveDown[w].exchange(0, memory_order_acq_rel);
+				if (prev != 0) liveReleased[w].fetch_or(prev, memory_order_release);
+			}
+		}
+		
+		//Swaps the snapshots and takes everything recorded since the last update into the current one.
+		//Edges that race with the update are never lost but may land in the next frame
+		inline void Update()
+		{
+			currentFrame ^= 1;
+			InputSnapshot& frame = frames[currentFrame];
+			
+			for (size_t w = 0; w < INPUT_MASK_WORDS; ++w)
+			{
+				frame.pressed.words[w] = livePressed[w].exchange(0, memory_order_acq_rel);
+				frame.released.words[w] = liveReleased[w].exchange(0, memory_order_acq_rel);
+				frame.down.words[w] = liveDown[w].load(memory_order_acquire);
+			}
+		}
+		
+		//Snapshot taken by the latest Update
+		inline const InputSnapshot& GetCurrent() const { return frames[currentFrame]; }
+		//Snapshot taken by the Update before the latest one
+		inline const InputSnapshot& GetPrevious() const { return frames[currentFrame ^ 1]; }
+	private:
+		array<atomic<u64>, INPUT_MASK_WORDS> liveDown{};
+		array<atomic<u64>, INPUT_MASK_WORDS> livePressed{};
+		array<atomic<u64>, INPUT_MASK_WORDS> liveReleased{};
+		
+		array<InputSnapshot, 2> frames{};
+		u32 currentFrame{};
+	};
 }
\ No newline at end of file
@@ -12,23 +12,50 @@
 //   - log types - info (no log type stamp), debug (skipped in release), success, warning, error
 //   - time stamp, date stamp accurate to system clock
 //   - logHook - user-defined function that allows emitting logs to another target like the crash log storage in kalawindow
+//   - async mode - lock-free MPSC ring of preformatted messages drained in batches by a background writer thread
+//   - file sink - buffered log file output with size or daily rotation and interval flushing
+//   - compile-time log level threshold - KLOG_MIN_LEVEL, KLOG_PRINT removes filtered calls and their arguments
+//   - binary log - format id, timestamp and raw arguments per record, formatted later by DecodeBinaryLog
 //---------------------------------------------------------------------------
 
 #pragma once
 
 #include <cstring>
+#include <cstdint>
 #include <ctime>
 #include <cstdio>
 #include <string>
 #include <chrono>
 #include <array>
 #include <algorithm>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <filesystem>
+#include <type_traits>
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define KLOG_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+	#include <arm_neon.h>
+	#define KLOG_NEON
+#endif
 
 //static_cast
 #ifndef scast
 	#define scast static_cast
 #endif
 
+//reinterpret_cast
+#ifndef rcast
+	#define rcast reinterpret_cast
+#endif
+
 //
 // CROSS-PLATFORM DEBUG FLAG
 //
@@ -41,6 +68,46 @@
 	#endif
 #endif
 
+//
+// COMPILE-TIME LOG LEVEL
+//
+
+//Lowest LogType value that is still compiled in, 0 keeps everything,
+//5 keeps only LOG_ERROR. Filtered KLOG_PRINT and KLOG_BINARY calls are removed
+//together with their arguments, direct Print calls return before formatting
+#ifndef KLOG_MIN_LEVEL
+	#define KLOG_MIN_LEVEL 0
+#endif
+
+//
+// LOG MACROS
+//
+
+//Calls Log::Print only if type passes KLOG_MIN_LEVEL, otherwise the call
+//and the evaluation of its arguments are removed at compile time.
+//Same parameters as the detailed Print, type must be a constant LogType
+#define KLOG_PRINT(message, target, type, ...) \
+	do \
+	{ \
+		if constexpr (KalaHeaders::KalaLog::IsLogEnabled(type)) \
+		{ \
+			KalaHeaders::KalaLog::Log::Print(message, target, type __VA_OPT__(,) __VA_ARGS__); \
+		} \
+	} while (0)
+
+//Stores a binary log record with deferred formatting, format is registered once per call site.
+//format must be a string literal where each {} is replaced by the next argument when decoding
+#define KLOG_BINARY(type, target, format, ...) \
+	do \
+	{ \
+		if constexpr (KalaHeaders::KalaLog::IsLogEnabled(type)) \
+		{ \
+			static const KalaHeaders::KalaLog::u32 klogFormatId = \
+				KalaHeaders::KalaLog::Log::RegisterBinaryFormat(format, target); \
+			KalaHeaders::KalaLog::Log::PrintBinary(klogFormatId, type __VA_OPT__(,) __VA_ARGS__); \
+		} \
+	} while (0)
+
 namespace KalaHeaders::KalaLog
 {
 	using std::string;
@@ -56,19 +123,79 @@ namespace KalaHeaders::KalaLog
 	using std::memcpy;
 	using std::strftime;
 	using std::snprintf;
+	using std::atomic;
+	using std::thread;
+	using std::unique_ptr;
+	using std::make_unique;
+	using std::vector;
+	using std::memory_order_relaxed;
+	using std::memory_order_acquire;
+	using std::memory_order_release;
+	using std::memory_order_acq_rel;
+	using std::this_thread::yield;
+	using std::mutex;
+	using std::scoped_lock;
+	using std::unique_lock;
+	using std::condition_variable;
+	using std::chrono::steady_clock;
+	using std::chrono::milliseconds;
+	using std::filesystem::path;
+	using std::filesystem::exists;
+	using std::filesystem::create_directories;
 	
 	using u8 = uint8_t;
 	using u16 = uint16_t;
 	using u32 = uint32_t;
+	using u64 = uint64_t;
+	using i64 = int64_t;
+	using f64 = double;
 
 	//Max allowed print message length
 	constexpr u16 MAX_MESSAGE_LENGTH = 5000;
+	//Max bytes of a trimmed print message, every UTF-8 character is up to 4 bytes
+	constexpr u32 MAX_MESSAGE_BYTES = MAX_MESSAGE_LENGTH * 4;
 	//Max allowed full print tag length
 	constexpr u8 MAX_TAG_LENGTH = 50;
 	//Max allowed indentation length per message
 	constexpr u8 MAX_INDENT_LENGTH = 20;
-	//How many type + tag combinations are cached
-	constexpr u8 CACHED_TAGS_LENGTH = 50;
+	//How many type + tag combinations are cached per thread, must be a power of two
+	constexpr u8 CACHED_TAGS_LENGTH = 64;
+	//How many prefix cache slots a lookup probes before evicting one of them
+	constexpr u8 CACHED_TAGS_PROBE_LENGTH = 8;
+	//Max built prefix length - "[ " + longest type tag + target + " ] "
+	constexpr u8 MAX_PREFIX_LENGTH = 2 + 10 + MAX_TAG_LENGTH + 3;
+	//Bytes each prefix cache slot owns in the arena - target followed by the built prefix
+	constexpr u8 CACHED_PREFIX_SLOT_SIZE = 128;
+
+	static_assert((CACHED_TAGS_LENGTH & (CACHED_TAGS_LENGTH - 1)) == 0, "CACHED_TAGS_LENGTH must be a power of two");
+	static_assert(MAX_TAG_LENGTH + MAX_PREFIX_LENGTH <= CACHED_PREFIX_SLOT_SIZE, "prefix cache slot is too small");
+	
+	//Max bytes of one formatted message in an async ring slot, longer messages are written synchronously
+	constexpr u16 LOG_SLOT_SIZE = MAX_MESSAGE_LENGTH + 256;
+	//Default async ring slot count, always rounded up to a power of two
+	constexpr u32 DEFAULT_LOG_SLOT_COUNT = 256;
+	//Max async ring slot count
+	constexpr u32 MAX_LOG_SLOT_COUNT = 65536;
+	//Max bytes the async writer gathers before a single fwrite
+	constexpr u32 LOG_BATCH_SIZE = 65536;
+	
+	//Max bytes of one string argument in a binary log record
+	constexpr u16 MAX_BINARY_STRING_LENGTH = 256;
+	//Max arguments of one binary log record
+	constexpr u8 MAX_BINARY_ARG_COUNT = 16;
+	//Max bytes of one binary log record - 15 byte header + every arg as a full length string
+	constexpr u16 MAX_BINARY_RECORD_SIZE = 15 + MAX_BINARY_ARG_COUNT * (3 + MAX_BINARY_STRING_LENGTH);
+	//Binary log userspace buffer size
+	constexpr u32 BINARY_LOG_BUFFER_SIZE = 262144;
+	//The magic that must exist in all klb (kalalogbinary) files at the first four bytes
+	constexpr u32 KLB_MAGIC = 0x00424C4B;
+	//The version that must exist in all klb files as the fifth byte
+	constexpr u8 KLB_VERSION = 1;
+
+	//Smallest allowed file sink userspace buffer
+	constexpr u32 MIN_LOG_FILE_BUFFER_SIZE = 4096;
+	//Max same-second rotations before the file sink gives up on finding a free file name
+	constexpr u16 MAX_LOG_FILE_NAME_ATTEMPTS = 1000;
 
 	enum class LogType
 	{
@@ -79,6 +206,15 @@ namespace KalaHeaders::KalaLog
 		LOG_WARNING, //Non-critical issue that should be looked into, sent to stdout
 		LOG_ERROR    //Serious issue or failure, sent to stderr, always flushes
 	};
+	//Returns true if this log type passes the compile-time threshold and debug filter
+	constexpr bool IsLogEnabled(LogType type)
+	{
+#ifndef KDEBUG
+		if (type == LogType::LOG_DEBUG) return false;
+#endif
+		return scast<int>(type) >= KLOG_MIN_LEVEL;
+	}
+
 	enum class TimeFormat : u8
 	{
 		TIME_NONE           = 0, //No time stamp
@@ -105,11 +241,150 @@ namespace KalaHeaders::KalaLog
 		DATE_FILENAME_MDY = 8  //12-31-2026
 	};
 
+	enum class LogOverflowPolicy : u8
+	{
+		OVERFLOW_DROP           = 0, //Silently discard the message when the async ring is full
+		OVERFLOW_BLOCK          = 1, //Wait until the writer frees a slot, never loses messages
+		OVERFLOW_COUNT_AND_DROP = 2  //Discard the message and let the writer report how many were lost
+	};
+
+	struct LogSlot
+	{
+		atomic<size_t> sequence{};         //ring turn this slot is ready for
+		u16 length{};                      //bytes used in data
+		bool isError{};                    //true if this message goes to stderr
+		array<char, LOG_SLOT_SIZE> data{}; //preformatted message with its newline
+	};
+
+	struct AsyncLogState
+	{
+		unique_ptr<LogSlot[]> slots{};
+		size_t mask{};
+
+		alignas(64) atomic<size_t> enqueuePos{}; //next slot a producer claims
+		alignas(64) atomic<size_t> writtenPos{}; //every message before this has been passed to fwrite
+		alignas(64) atomic<u32> wakeSignal{};    //bumped by producers to wake the writer
+
+		atomic<u64> droppedCount{}; //dropped since the last writer report
+		atomic<u64> droppedTotal{}; //dropped since StartAsync
+		atomic<bool> isRunning{};
+
+		LogOverflowPolicy policy{};
+		thread writer{};
+
+		~AsyncLogState()
+		{
+			if (writer.joinable())
+			{
+				isRunning.store(false, memory_order_release);
+				wakeSignal.fetch_add(1, memory_order_release);
+				wakeSignal.notify_one();
+				writer.join();
+			}
+		}
+	};
+
+	struct LogFileConfig
+	{
+		path directory{};                                      //where log files are created, created if missing
+		string baseName = "log";                               //file names are baseName_date_time.log
+		DateFormat dateFormat = DateFormat::DATE_FILENAME_DMY; //must be DATE_FILENAME_DMY or DATE_FILENAME_MDY
+		TimeFormat timeFormat = TimeFormat::TIME_FILENAME;     //must be one of the TIME_FILENAME formats
+		u64 maxFileSize = 16777216;                            //rotate once the file would grow past this, 0 disables size rotation
+		bool rotateDaily = true;                               //rotate at local midnight
+		u32 bufferSize = 1048576;                              //userspace buffer size, written with one fwrite when full
+		u32 flushIntervalMs = 1000;                            //max age of buffered data, flushed by a background thread, 0 flushes every message
+	};
+
+	struct LogFileState
+	{
+		mutex lock{};
+		LogFileConfig config{};
+
+		FILE* file{};
+		vector<char> buffer{};
+		size_t bufferUsed{};
+		u64 fileSize{};
+
+		system_clock::time_point nextMidnight{};
+		steady_clock::time_point lastFlush{};
+
+		//flushes buffered data once it is flushIntervalMs old even if no new message arrives
+		thread flusher{};
+		mutex flusherControl{}; //held by OpenFileSink and CloseFileSink while they start or stop the flusher
+		condition_variable flusherWake{};
+		bool isFlusherStopping{};
+
+		~LogFileState()
+		{
+			if (flusher.joinable())
+			{
+				{
+					scoped_lock guard(lock);
+					isFlusherStopping = true;
+				}
+				flusherWake.notify_one();
+				flusher.join();
+			}
+
+			if (file)
+			{
+				if (bufferUsed > 0) fwrite(buffer.data(), 1, bufferUsed, file);
+				fclose(file);
+				file = nullptr;
+				bufferUsed = 0;
+			}
+		}
+	};
+
+	enum class BinaryArgType : u8
+	{
+		ARG_INT    = 0, //i64
+		ARG_UINT   = 1, //u64
+		ARG_FLOAT  = 2, //f64
+		ARG_STRING = 3  //u16 length + bytes, clamped up to MAX_BINARY_STRING_LENGTH
+	};
+
+	enum class BinaryRecordKind : u8
+	{
+		RECORD_FORMAT  = 0, //u32 format id, u16 format length, format, u8 target length, target
+		RECORD_MESSAGE = 1  //u32 format id, u8 log type, u64 microseconds since epoch, u8 arg count, args
+	};
+
+	struct BinaryLogState
+	{
+		mutex lock{};
+
+		FILE* file{};
+		vector<char> buffer{};
+		size_t bufferUsed{};
+
+		vector<string> formats{}; //indexed by format id
+		vector<string> targets{}; //indexed by format id
+
+		~BinaryLogState()
+		{
+			if (file)
+			{
+				if (bufferUsed > 0) fwrite(buffer.data(), 1, bufferUsed, file);
+				fclose(file);
+			}
+		}
+	};
+
 	struct CachedPrefix
 	{
+		u64 hash{};         //hash of type + target, 0 means the slot is empty
 		LogType type{};
-		string target{};
-		string prefix{};
+		u8 targetLength{};
+		u8 prefixLength{};
+	};
+
+	struct PrefixCacheStats
+	{
+		u64 hits{};
+		u64 misses{};
+		u64 evictions{};
 	};
 
 	class Log
@@ -316,9 +591,7 @@ namespace KalaHeaders::KalaLog
 			TimeFormat timeFormat = TimeFormat::TIME_DEFAULT,
 			DateFormat dateFormat = DateFormat::DATE_DEFAULT)
 		{
-#ifndef KDEBUG
-			if (type == LogType::LOG_DEBUG) return;
-#endif
+			if (!IsLogEnabled(type)) return;
 
 			thread_local const string empty{};
 
@@ -328,7 +601,8 @@ namespace KalaHeaders::KalaLog
 				return;
 			}
 
-			string trimmed = TrimUTF8(message);
+			bool isTrimmed{};
+			string_view trimmed = TrimUTF8(message, isTrimmed);
 
 			target = target.substr(0, MAX_TAG_LENGTH);
 
@@ -381,25 +655,22 @@ namespace KalaHeaders::KalaLog
 			memcpy(p, trimmed.data(), trimmed.size());
 			p += trimmed.size();
 
+			if (isTrimmed)
+			{
+				memcpy(p, TRIMMED_NOTICE.data(), TRIMMED_NOTICE.size());
+				p += TRIMMED_NOTICE.size();
+			}
+
 			//newline
 			*p++ = '\n';
 
-			FILE* out = (type == LogType::LOG_ERROR)
-				? stderr
-				: stdout;
-
 			const size_t length = scast<size_t>(p - logBuffer().data());
 
-			//TODO: figure out how to make it work
-			//EmitLog(string_view(logBuffer().data(), length));
-
-			fwrite(logBuffer().data(), 1, length, out);
-
-			if (flush
-				|| type == LogType::LOG_ERROR)
-			{
-				fflush(out);
-			}
+			Write(
+				logBuffer().data(),
+				length,
+				type == LogType::LOG_ERROR,
+				flush);
 		}
 
 		//Prints a log message to the console using fwrite.
@@ -412,50 +683,1077 @@ namespace KalaHeaders::KalaLog
 		{
 			if (message.empty()) return;
 
-			string trimmed = TrimUTF8(message);
+			bool isTrimmed{};
+			string_view trimmed = TrimUTF8(message, isTrimmed);
+
+			char* p = logBuffer().data();
+
+			memcpy(p, trimmed.data(), trimmed.size());
+			p += trimmed.size();
+
+			if (isTrimmed)
+			{
+				memcpy(p, TRIMMED_NOTICE.data(), TRIMMED_NOTICE.size());
+				p += TRIMMED_NOTICE.size();
+			}
+
+			*p++ = '\n';
+
+			const size_t totalLength = scast<size_t>(p - logBuffer().data());
+
+			Write(
+				logBuffer().data(),
+				totalLength,
+				false,
+				flush);
+		}
+
+		//Moves all Print calls to async mode, messages are still formatted on the calling thread
+		//but copied into a lock-free ring that a background writer drains with one fwrite per batch.
+		//Errors and flush requests drain the ring and then write synchronously so crash logs are never lost.
+		//Call StopAsync after every logging thread is done, returns false if async mode was already running
+		//  - policy: what producers do when every slot is taken
+		//  - slotCount: ring size, rounded up to a power of two, clamped up to 65536
+		static inline bool StartAsync(
+			LogOverflowPolicy policy = LogOverflowPolicy::OVERFLOW_COUNT_AND_DROP,
+			u32 slotCount = DEFAULT_LOG_SLOT_COUNT)
+		{
+			AsyncLogState& s = asyncState();
+
+			if (s.writer.joinable()) return false;
+
+			size_t count = 2;
+			while (count < clamp(slotCount, 2u, MAX_LOG_SLOT_COUNT)) count <<= 1;
+
+			if (!s.slots
+				|| s.mask + 1 != count)
+			{
+				s.slots = make_unique<LogSlot[]>(count);
+				s.mask = count - 1;
+			}
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				s.slots[i].sequence.store(i, memory_order_relaxed);
+			}
+
+			s.enqueuePos.store(0, memory_order_relaxed);
+			s.writtenPos.store(0, memory_order_relaxed);
+			s.droppedCount.store(0, memory_order_relaxed);
+			s.droppedTotal.store(0, memory_order_relaxed);
+			s.policy = policy;
+			s.isRunning.store(true, memory_order_release);
+
+			s.writer = thread(WriterLoop);
+
+			return true;
+		}
+
+		//Drains every queued message, stops the writer thread and returns to synchronous writes
+		static inline void StopAsync()
+		{
+			AsyncLogState& s = asyncState();
+
+			if (!s.writer.joinable()) return;
+
+			s.isRunning.store(false, memory_order_release);
+			s.wakeSignal.fetch_add(1, memory_order_release);
+			s.wakeSignal.notify_one();
+
+			s.writer.join();
+
+			fflush(stdout);
+			fflush(stderr);
+		}
+
+		//Returns true if Print calls currently go through the async ring
+		static inline bool IsAsync()
+		{
+			return asyncState().isRunning.load(memory_order_acquire);
+		}
+
+		//Blocks until every message queued before this call has been written and flushed
+		static inline void Flush()
+		{
+			AsyncLogState& s = asyncState();
+
+			if (s.isRunning.load(memory_order_acquire))
+			{
+				const size_t target = s.enqueuePos.load(memory_order_acquire);
+
+				s.wakeSignal.fetch_add(1, memory_order_release);
+				s.wakeSignal.notify_one();
+
+				size_t written = s.writtenPos.load(memory_order_acquire);
+				while (written < target
+					&& s.isRunning.load(memory_order_acquire))
+				{
+					s.writtenPos.wait(written, memory_order_acquire);
+					written = s.writtenPos.load(memory_order_acquire);
+				}
+			}
+
+			fflush(stdout);
+			fflush(stderr);
+
+			LogFileState& f = fileState();
+			scoped_lock guard(f.lock);
+			FlushFile(f);
+		}
+
+		//Starts copying every printed message into a log file in config.directory,
+		//closes any previously open file sink first, returns false if the file could not be created
+		static inline bool OpenFileSink(const LogFileConfig& config)
+		{
+			LogFileState& f = fileState();
+			scoped_lock control(f.flusherControl);
+			StopFlusher(f);
+
+			scoped_lock guard(f.lock);
+
+			CloseFile(f);
+
+			f.config = config;
+			if (f.config.dateFormat != DateFormat::DATE_FILENAME_MDY)
+			{
+				f.config.dateFormat = DateFormat::DATE_FILENAME_DMY;
+			}
+			if (f.config.timeFormat != TimeFormat::TIME_FILENAME_MS
+				&& f.config.timeFormat != TimeFormat::TIME_FILENAME_MS_US)
+			{
+				f.config.timeFormat = TimeFormat::TIME_FILENAME;
+			}
+			if (f.config.baseName.empty()) f.config.baseName = "log";
+
+			f.buffer.assign(std::max(f.config.bufferSize, MIN_LOG_FILE_BUFFER_SIZE), '\0');
+			f.bufferUsed = 0;
+
+			if (!OpenFile(f)) return false;
+
+			//without the flusher thread buffered data is still flushed by the next message past the interval
+			if (f.config.flushIntervalMs > 0)
+			{
+				f.isFlusherStopping = false;
+				try { f.flusher = thread(FlusherLoop); }
+				catch (...) {}
+			}
+
+			return true;
+		}
+
+		//Writes out buffered file sink data and closes the log file
+		static inline void CloseFileSink()
+		{
+			LogFileState& f = fileState();
+			scoped_lock control(f.flusherControl);
+			StopFlusher(f);
+
+			scoped_lock guard(f.lock);
+
+			CloseFile(f);
+			f.buffer.clear();
+			f.buffer.shrink_to_fit();
+		}
+
+		//Returns true if printed messages are also copied into a log file
+		static inline bool HasFileSink()
+		{
+			LogFileState& f = fileState();
+			scoped_lock guard(f.lock);
+
+			return f.file != nullptr;
+		}
+
+		//Starts writing binary log records to a klb file, closes any previously open binary log first.
+		//Every already registered format is written first so the file decodes on its own
+		static inline bool OpenBinaryLog(const path& file)
+		{
+			BinaryLogState& b = binaryState();
+			scoped_lock guard(b.lock);
+
+			CloseBinary(b);
+
+#ifdef _WIN32
+			if (_wfopen_s(&b.file, file.c_str(), L"wb") != 0) b.file = nullptr;
+#else
+			b.file = fopen(file.c_str(), "wb");
+#endif
+			if (!b.file) return false;
+
+			setvbuf(b.file, nullptr, _IONBF, 0);
+
+			b.buffer.assign(BINARY_LOG_BUFFER_SIZE, '\0');
+			b.bufferUsed = 0;
+
+			char header[5]{};
+			memcpy(header, &KLB_MAGIC, sizeof(u32));
+			header[4] = scast<char>(KLB_VERSION);
+			AppendBinary(b, header, sizeof(header));
+
+			for (size_t i = 0; i < b.formats.size(); ++i)
+			{
+				AppendFormat(b, scast<u32>(i));
+			}
+
+			return true;
+		}
+
+		//Writes out buffered binary records and closes the klb file
+		static inline void CloseBinaryLog()
+		{
+			BinaryLogState& b = binaryState();
+			scoped_lock guard(b.lock);
+
+			CloseBinary(b);
+		}
+
+		//Registers a binary log format and returns its id, {} marks where each argument goes.
+		//KLOG_BINARY calls this once per call site, target is clamped up to 50 characters
+		static inline u32 RegisterBinaryFormat(
+			string_view format,
+			string_view target)
+		{
+			BinaryLogState& b = binaryState();
+			scoped_lock guard(b.lock);
+
+			const u32 id = scast<u32>(b.formats.size());
+
+			b.formats.emplace_back(format.substr(0, MAX_MESSAGE_LENGTH));
+			b.targets.emplace_back(target.substr(0, MAX_TAG_LENGTH));
+
+			if (b.file) AppendFormat(b, id);
+
+			return id;
+		}
+
+		//Stores one binary log record without formatting anything,
+		//arguments must be arithmetic or convertible to string_view
+		template<typename... Args>
+		static inline void PrintBinary(
+			u32 formatId,
+			LogType type,
+			const Args&... args)
+		{
+			static_assert(sizeof...(Args) <= MAX_BINARY_ARG_COUNT, "too many binary log arguments");
+
+			if (!IsLogEnabled(type)) return;
+
+			thread_local array<char, MAX_BINARY_RECORD_SIZE> record{};
+
+			const u64 timestamp = scast<u64>(duration_cast<microseconds>(
+				system_clock::now().time_since_epoch()).count());
+
+			char* p = record.data();
+			*p++ = scast<char>(BinaryRecordKind::RECORD_MESSAGE);
+			memcpy(p, &formatId, sizeof(u32));  p += sizeof(u32);
+			*p++ = scast<char>(type);
+			memcpy(p, &timestamp, sizeof(u64)); p += sizeof(u64);
+			*p++ = scast<char>(sizeof...(Args));
+
+			(WriteBinaryArg(p, args), ...);
+
+			BinaryLogState& b = binaryState();
+			scoped_lock guard(b.lock);
+
+			if (!b.file) return;
+
+			AppendBinary(b, record.data(), scast<size_t>(p - record.data()));
+
+			if (type == LogType::LOG_ERROR) FlushBinary(b);
+		}
+
+		//Decodes a klb file into the same lines Print would have produced with TIME_HMS_MS_US,
+		//returns false if the file is missing, not a klb file or ends in the middle of a record
+		static inline bool DecodeBinaryLog(
+			const path& file,
+			vector<string>& outLines)
+		{
+			vector<char> data{};
+
+			try
+			{
+#ifdef _WIN32
+				FILE* in{};
+				if (_wfopen_s(&in, file.c_str(), L"rb") != 0) in = nullptr;
+#else
+				FILE* in = fopen(file.c_str(), "rb");
+#endif
+				if (!in) return false;
+
+				char chunk[65536];
+				size_t read{};
+				while ((read = fread(chunk, 1, sizeof(chunk), in)) > 0)
+				{
+					data.insert(data.end(), chunk, chunk + read);
+				}
+				fclose(in);
+			}
+			catch (...)
+			{
+				return false;
+			}
+
+			u32 magic{};
+			if (data.size() < 5) return false;
+			memcpy(&magic, data.data(), sizeof(u32));
+			if (magic != KLB_MAGIC
+				|| scast<u8>(data[4]) != KLB_VERSION)
+			{
+				return false;
+			}
+
+			vector<string> formats{};
+			vector<string> targets{};
+
+			size_t pos = 5;
+			auto has = [&](size_t n) { return pos + n <= data.size(); };
+
+			while (pos < data.size())
+			{
+				const BinaryRecordKind kind = scast<BinaryRecordKind>(data[pos++]);
+
+				u32 id{};
+				if (!has(sizeof(u32))) return false;
+				memcpy(&id, data.data() + pos, sizeof(u32));
+				pos += sizeof(u32);
+
+				if (kind == BinaryRecordKind::RECORD_FORMAT)
+				{
+					u16 formatLength{};
+					if (!has(sizeof(u16))) return false;
+					memcpy(&formatLength, data.data() + pos, sizeof(u16));
+					pos += sizeof(u16);
+
+					if (!has(formatLength + 1u)) return false;
+					string format(data.data() + pos, formatLength);
+					pos += formatLength;
+
+					const u8 targetLength = scast<u8>(data[pos++]);
+					if (!has(targetLength)) return false;
+					string target(data.data() + pos, targetLength);
+					pos += targetLength;
+
+					if (id >= formats.size())
+					{
+						formats.resize(id + 1);
+						targets.resize(id + 1);
+					}
+					formats[id] = std::move(format);
+					targets[id] = std::move(target);
+
+					continue;
+				}
+
+				if (kind != BinaryRecordKind::RECORD_MESSAGE) return false;
+
+				if (!has(1 + sizeof(u64) + 1)) return false;
+
+				const u8 type = scast<u8>(data[pos++]);
+				u64 timestamp{};
+				memcpy(&timestamp, data.data() + pos, sizeof(u64));
+				pos += sizeof(u64);
+				const u8 argCount = scast<u8>(data[pos++]);
+
+				if (type > scast<u8>(LogType::LOG_ERROR)
+					|| id >= formats.size())
+				{
+					return false;
+				}
+
+				//decode the arguments
+
+				vector<string> args{};
+				args.reserve(argCount);
+
+				for (u8 i = 0; i < argCount; ++i)
+				{
+					if (!has(1)) return false;
+					const BinaryArgType argType = scast<BinaryArgType>(data[pos++]);
+
+					char number[32]{};
+
+					switch (argType)
+					{
+					case BinaryArgType::ARG_INT:
+					{
+						i64 v{};
+						if (!has(sizeof(i64))) return false;
+						memcpy(&v, data.data() + pos, sizeof(i64));
+						pos += sizeof(i64);
+						snprintf(number, sizeof(number), "%lld", scast<long long>(v));
+						args.emplace_back(number);
+						break;
+					}
+					case BinaryArgType::ARG_UINT:
+					{
+						u64 v{};
+						if (!has(sizeof(u64))) return false;
+						memcpy(&v, data.data() + pos, sizeof(u64));
+						pos += sizeof(u64);
+						snprintf(number, sizeof(number), "%llu", scast<unsigned long long>(v));
+						args.emplace_back(number);
+						break;
+					}
+					case BinaryArgType::ARG_FLOAT:
+					{
+						f64 v{};
+						if (!has(sizeof(f64))) return false;
+						memcpy(&v, data.data() + pos, sizeof(f64));
+						pos += sizeof(f64);
+						snprintf(number, sizeof(number), "%g", v);
+						args.emplace_back(number);
+						break;
+					}
+					case BinaryArgType::ARG_STRING:
+					{
+						u16 length{};
+						if (!has(sizeof(u16))) return false;
+						memcpy(&length, data.data() + pos, sizeof(u16));
+						pos += sizeof(u16);
+						if (!has(length)) return false;
+						args.emplace_back(data.data() + pos, length);
+						pos += length;
+						break;
+					}
+					default: return false;
+					}
+				}
+
+				//[ time ] [ tag target ] message
+
+				const time_t seconds = scast<time_t>(timestamp / 1000000);
+				const u32 us = scast<u32>(timestamp % 1000000);
+				tm local{};
+#ifdef _WIN32
+				localtime_s(&local, &seconds);
+#else
+				localtime_r(&seconds, &local);
+#endif
+				char timeStamp[32]{};
+				const size_t timeLength = strftime(timeStamp, sizeof(timeStamp), "%H:%M:%S", &local);
+				snprintf(
+					timeStamp + timeLength,
+					sizeof(timeStamp) - timeLength,
+					":%03u:%03u",
+					us / 1000,
+					us % 1000);
+
+				string line = "[ ";
+				line += timeStamp;
+				line += " ] [ ";
+				line += LogTypeTag[type];
+				line += targets[id];
+				line += " ] ";
+
+				const string& format = formats[id];
+				size_t argIndex{};
+				for (size_t i = 0; i < format.size(); ++i)
+				{
+					if (format[i] == '{'
+						&& i + 1 < format.size()
+						&& format[i + 1] == '}')
+					{
+						if (argIndex < args.size()) line += args[argIndex++];
+						++i;
+						continue;
+					}
+					line += format[i];
+				}
+
+				outLines.push_back(std::move(line));
+			}
+
+			return true;
+		}
+
+		//Returns the calling thread's prefix cache hits, misses and evictions,
+		//always zero unless KLOG_PREFIX_STATS is defined
+		static inline PrefixCacheStats GetPrefixCacheStats()
+		{
+			return prefixStats();
+		}
+
+		//Returns how many messages were discarded because the async ring was full since StartAsync
+		static inline u64 GetDroppedCount()
+		{
+			return asyncState().droppedTotal.load(memory_order_relaxed);
+		}
+	private:
+		//Sends one formatted message to the async ring or straight to the console
+		static inline void Write(
+			const char* data,
+			size_t length,
+			bool isError,
+			bool flush)
+		{
+			AsyncLogState& s = asyncState();
+
+			if (s.isRunning.load(memory_order_acquire))
+			{
+				if (!isError
+					&& !flush
+					&& length <= LOG_SLOT_SIZE)
+				{
+					Enqueue(s, data, length, isError);
+					return;
+				}
+
+				//keep ordering with everything queued before this message
+				Flush();
+			}
+
+			FILE* out = isError
+				? stderr
+				: stdout;
+
+			EmitLog(
+				string_view(data, length),
+				flush || isError);
+
+			fwrite(data, 1, length, out);
+
+			if (flush
+				|| isError)
+			{
+				fflush(out);
+			}
+		}
+
+		//Claims a ring slot and publishes the message, returns false if it was dropped
+		static inline bool Enqueue(
+			AsyncLogState& s,
+			const char* data,
+			size_t length,
+			bool isError)
+		{
+			size_t pos = s.enqueuePos.load(memory_order_relaxed);
+			LogSlot* slot{};
+
+			for (;;)
+			{
+				slot = &s.slots[pos & s.mask];
+				const size_t seq = slot->sequence.load(memory_order_acquire);
+				const intptr_t diff = scast<intptr_t>(seq) - scast<intptr_t>(pos);
+
+				if (diff == 0)
+				{
+					if (s.enqueuePos.compare_exchange_weak(
+						pos,
+						pos + 1,
+						memory_order_relaxed))
+					{
+						break;
+					}
+				}
+				else if (diff < 0)
+				{
+					//ring is full
+					if (s.policy == LogOverflowPolicy::OVERFLOW_BLOCK)
+					{
+						s.wakeSignal.fetch_add(1, memory_order_release);
+						s.wakeSignal.notify_one();
+						yield();
+
+						pos = s.enqueuePos.load(memory_order_relaxed);
+						continue;
+					}
+
+					if (s.policy == LogOverflowPolicy::OVERFLOW_COUNT_AND_DROP)
+					{
+						s.droppedCount.fetch_add(1, memory_order_relaxed);
+					}
+					s.droppedTotal.fetch_add(1, memory_order_relaxed);
+
+					return false;
+				}
+				else pos = s.enqueuePos.load(memory_order_relaxed);
+			}
+
+			memcpy(slot->data.data(), data, length);
+			slot->length = scast<u16>(length);
+			slot->isError = isError;
+			slot->sequence.store(pos + 1, memory_order_release);
+
+			s.wakeSignal.fetch_add(1, memory_order_release);
+			s.wakeSignal.notify_one();
+
+			return true;
+		}
+
+		//Background writer, gathers ready slots into one buffer per stream and writes it with a single fwrite
+		static inline void WriterLoop()
+		{
+			AsyncLogState& s = asyncState();
+
+			vector<char> batch(LOG_BATCH_SIZE);
+			size_t batchSize{};
+			bool batchIsError{};
+			size_t readPos = s.writtenPos.load(memory_order_relaxed);
+
+			auto writeBatch = [&]()
+				{
+					if (batchSize == 0) return;
+
+					EmitLog(string_view(batch.data(), batchSize), false);
+					fwrite(batch.data(), 1, batchSize, batchIsError ? stderr : stdout);
+					batchSize = 0;
+				};
+
+			for (;;)
+			{
+				const u32 signal = s.wakeSignal.load(memory_order_acquire);
+				const bool isRunning = s.isRunning.load(memory_order_acquire);
+				bool didWork = false;
+
+				for (;;)
+				{
+					LogSlot& slot = s.slots[readPos & s.mask];
+					if (slot.sequence.load(memory_order_acquire) != readPos + 1) break;
+
+					if (batchSize > 0
+						&& (slot.isError != batchIsError
+						|| batchSize + slot.length > batch.size()))
+					{
+						writeBatch();
+					}
+
+					memcpy(batch.data() + batchSize, slot.data.data(), slot.length);
+					batchSize += slot.length;
+					batchIsError = slot.isError;
+
+					slot.sequence.store(readPos + s.mask + 1, memory_order_release);
+					++readPos;
+					didWork = true;
+				}
+
+				const u64 dropped = s.droppedCount.exchange(0, memory_order_relaxed);
+				if (dropped > 0)
+				{
+					writeBatch();
+
+					char notice[96]{};
+					const int noticeLength = snprintf(
+						notice,
+						sizeof(notice),
+						"[ WARNING | LOG ] dropped %llu messages, async log ring was full\n",
+						scast<unsigned long long>(dropped));
+
+					if (noticeLength > 0) fwrite(notice, 1, scast<size_t>(noticeLength), stderr);
+				}
+
+				if (didWork)
+				{
+					writeBatch();
+					s.writtenPos.store(readPos, memory_order_release);
+					s.writtenPos.notify_all();
+
+					continue;
+				}
+
+				if (!isRunning) break;
+
+				fflush(stdout);
+				s.wakeSignal.wait(signal, memory_order_acquire);
+			}
+
+			writeBatch();
+			s.writtenPos.store(readPos, memory_order_release);
+			s.writtenPos.notify_all();
+		}
+
+		//Copies formatted messages into the file sink if one is open
+		static inline void EmitLog(
+			string_view data,
+			bool flush)
+		{
+			LogFileState& f = fileState();
+			scoped_lock guard(f.lock);
+
+			if (!f.file) return;
+
+			const system_clock::time_point now = system_clock::now();
+
+			if ((f.config.rotateDaily
+				&& now >= f.nextMidnight)
+				|| (f.config.maxFileSize > 0
+				&& f.fileSize + f.bufferUsed > 0
+				&& f.fileSize + f.bufferUsed + data.size() > f.config.maxFileSize))
+			{
+				CloseFile(f);
+				if (!OpenFile(f)) return;
+			}
+
+			if (f.bufferUsed + data.size() > f.buffer.size()) FlushFile(f);
+
+			if (data.size() > f.buffer.size())
+			{
+				fwrite(data.data(), 1, data.size(), f.file);
+				f.fileSize += data.size();
+			}
+			else
+			{
+				memcpy(f.buffer.data() + f.bufferUsed, data.data(), data.size());
+				f.bufferUsed += data.size();
+			}
+
+			if (flush
+				|| steady_clock::now() - f.lastFlush >= milliseconds(f.config.flushIntervalMs))
+			{
+				FlushFile(f);
+			}
+		}
+
+		//Writes the file sink buffer with one fwrite, caller holds the file sink lock
+		static inline void FlushFile(LogFileState& f)
+		{
+			f.lastFlush = steady_clock::now();
+
+			if (!f.file) return;
+
+			if (f.bufferUsed > 0)
+			{
+				fwrite(f.buffer.data(), 1, f.bufferUsed, f.file);
+				f.fileSize += f.bufferUsed;
+				f.bufferUsed = 0;
+			}
+
+			fflush(f.file);
+		}
+
+		//Creates the next log file, caller holds the file sink lock
+		static inline bool OpenFile(LogFileState& f)
+		{
+			try
+			{
+				if (!f.config.directory.empty()
+					&& !exists(f.config.directory))
+				{
+					create_directories(f.config.directory);
+				}
+
+				//baseName_date_time.log, baseName_date_time_1.log if rotated again within the same second
+
+				string stem = f.config.baseName;
+				stem += '_';
+				stem += GetDate(f.config.dateFormat);
+				stem += '_';
+				stem += GetTime(f.config.timeFormat);
+
+				path target = f.config.directory / (stem + ".log");
+				for (u16 i = 1; exists(target); ++i)
+				{
+					if (i == MAX_LOG_FILE_NAME_ATTEMPTS) return false;
+
+					target = f.config.directory / (stem + "_" + std::to_string(i) + ".log");
+				}
+
+#ifdef _WIN32
+				if (_wfopen_s(&f.file, target.c_str(), L"wb") != 0) f.file = nullptr;
+#else
+				f.file = fopen(target.c_str(), "wb");
+#endif
+				if (!f.file) return false;
+
+				//the userspace buffer already batches writes
+				setvbuf(f.file, nullptr, _IONBF, 0);
+			}
+			catch (...)
+			{
+				f.file = nullptr;
+				return false;
+			}
+
+			f.fileSize = 0;
+			f.lastFlush = steady_clock::now();
+
+			//next local midnight for daily rotation
+
+			const time_t nowTime = system_clock::to_time_t(system_clock::now());
+			tm local{};
+#ifdef _WIN32
+			localtime_s(&local, &nowTime);
+#else
+			localtime_r(&nowTime, &local);
+#endif
+			local.tm_hour = 0;
+			local.tm_min = 0;
+			local.tm_sec = 0;
+			local.tm_mday += 1;
+			local.tm_isdst = -1;
+
+			f.nextMidnight = system_clock::from_time_t(mktime(&local));
+
+			return true;
+		}
+
+		//Flushes the file sink buffer once its oldest data is flushIntervalMs old
+		static inline void FlusherLoop()
+		{
+			LogFileState& f = fileState();
+			unique_lock guard(f.lock);
+
+			const milliseconds interval(f.config.flushIntervalMs);
+
+			while (!f.isFlusherStopping)
+			{
+				const steady_clock::time_point due = f.lastFlush + interval;
+
+				if (f.bufferUsed > 0
+					&& steady_clock::now() >= due)
+				{
+					FlushFile(f);
+					continue;
+				}
+
+				//an empty buffer has nothing to age, so wait a full interval from now
+				if (f.bufferUsed > 0) f.flusherWake.wait_until(guard, due);
+				else f.flusherWake.wait_for(guard, interval);
+			}
+		}
+
+		//Stops the flusher thread of the file sink, caller must not hold the file sink lock
+		static inline void StopFlusher(LogFileState& f)
+		{
+			if (!f.flusher.joinable()) return;
+
+			{
+				scoped_lock guard(f.lock);
+				f.isFlusherStopping = true;
+			}
+			f.flusherWake.notify_one();
+			f.flusher.join();
+		}
+
+		//Writes out the buffer and closes the current log file, caller holds the file sink lock
+		static inline void CloseFile(LogFileState& f)
+		{
+			if (!f.file) return;
+
+			FlushFile(f);
+			fclose(f.file);
+			f.file = nullptr;
+		}
+
+		//Appends one typed binary log argument, strings are clamped to fit the record
+		template<typename T>
+		static inline void WriteBinaryArg(
+			char*& p,
+			const T& value)
+		{
+			using V = std::decay_t<T>;
+
+			if constexpr (std::is_floating_point_v<V>)
+			{
+				const f64 v = scast<f64>(value);
+				*p++ = scast<char>(BinaryArgType::ARG_FLOAT);
+				memcpy(p, &v, sizeof(f64));
+				p += sizeof(f64);
+			}
+			else if constexpr (std::is_enum_v<V>)
+			{
+				WriteBinaryArg(p, scast<std::underlying_type_t<V>>(value));
+			}
+			else if constexpr (std::is_integral_v<V>
+				&& std::is_signed_v<V>)
+			{
+				const i64 v = scast<i64>(value);
+				*p++ = scast<char>(BinaryArgType::ARG_INT);
+				memcpy(p, &v, sizeof(i64));
+				p += sizeof(i64);
+			}
+			else if constexpr (std::is_integral_v<V>)
+			{
+				const u64 v = scast<u64>(value);
+				*p++ = scast<char>(BinaryArgType::ARG_UINT);
+				memcpy(p, &v, sizeof(u64));
+				p += sizeof(u64);
+			}
+			else
+			{
+				static_assert(std::is_convertible_v<const T&, string_view>,
+					"binary log arguments must be arithmetic, enums or convertible to string_view");
+
+				const string_view v = value;
+				const u16 length = scast<u16>(std::min(v.size(), scast<size_t>(MAX_BINARY_STRING_LENGTH)));
+
+				*p++ = scast<char>(BinaryArgType::ARG_STRING);
+				memcpy(p, &length, sizeof(u16));
+				p += sizeof(u16);
+				memcpy(p, v.data(), length);
+				p += length;
+			}
+		}
+
+		//Appends raw bytes to the binary log buffer, caller holds the binary log lock
+		static inline void AppendBinary(
+			BinaryLogState& b,
+			const char* data,
+			size_t length)
+		{
+			if (b.bufferUsed + length > b.buffer.size()) FlushBinary(b);
+
+			memcpy(b.buffer.data() + b.bufferUsed, data, length);
+			b.bufferUsed += length;
+		}
+
+		//Appends a format definition record, caller holds the binary log lock
+		static inline void AppendFormat(
+			BinaryLogState& b,
+			u32 id)
+		{
+			const string& format = b.formats[id];
+			const string& target = b.targets[id];
+
+			const u16 formatLength = scast<u16>(format.size());
+			const u8 targetLength = scast<u8>(target.size());
+
+			char header[7]{};
+			header[0] = scast<char>(BinaryRecordKind::RECORD_FORMAT);
+			memcpy(header + 1, &id, sizeof(u32));
+			memcpy(header + 5, &formatLength, sizeof(u16));
+
+			AppendBinary(b, header, sizeof(header));
+			AppendBinary(b, format.data(), formatLength);
+			AppendBinary(b, rcast<const char*>(&targetLength), sizeof(u8));
+			AppendBinary(b, target.data(), targetLength);
+		}
+
+		//Writes the binary log buffer with one fwrite, caller holds the binary log lock
+		static inline void FlushBinary(BinaryLogState& b)
+		{
+			if (!b.file) return;
+
+			if (b.bufferUsed > 0)
+			{
+				fwrite(b.buffer.data(), 1, b.bufferUsed, b.file);
+				b.bufferUsed = 0;
+			}
+
+			fflush(b.file);
+		}
+
+		//Writes out the buffer and closes the klb file, caller holds the binary log lock
+		static inline void CloseBinary(BinaryLogState& b)
+		{
+			if (!b.file) return;
 
-			const size_t length = trimmed.size();
-			const size_t totalLength = length + 1; //+1 for '\n'
+			FlushBinary(b);
+			fclose(b.file);
+			b.file = nullptr;
+			b.buffer.clear();
+			b.buffer.shrink_to_fit();
+		}
 
-			memcpy(logBuffer().data(), trimmed.data(), length);
-			logBuffer()[length] = '\n';
+		static inline BinaryLogState& binaryState()
+		{
+			static BinaryLogState state{};
+			return state;
+		}
 
-			//TODO: figure out how to make it work
-			//EmitLog(string_view(logBuffer().data(), totalLength));
+		static inline LogFileState& fileState()
+		{
+			static LogFileState state{};
+			return state;
+		}
 
-			fwrite(logBuffer().data(), 1, totalLength, stdout);
+		static inline AsyncLogState& asyncState()
+		{
+			//the async writer drains into the file sink when it is stopped at exit,
+			//constructing the file state first makes it outlive the async state
+			fileState();
 
-			if (flush) fflush(stdout);
+			static AsyncLogState state{};
+			return state;
 		}
-	private:		
-		static inline string TrimUTF8(string_view s)
+
+		static constexpr string_view TRIMMED_NOTICE = "\n[TRIMMED LONG MESSAGE]";
+
+		//Returns the part of s that fits in MAX_MESSAGE_LENGTH characters without copying,
+		//isTrimmed is set if anything was cut off. Messages that are shorter in bytes than the
+		//character limit skip the scan entirely, longer ones are counted 16 bytes at a time
+		static inline string_view TrimUTF8(
+			string_view s,
+			bool& isTrimmed)
 		{
-			size_t bytes = 0;
-			size_t chars = 0;
-			
-			while (bytes < s.size() 
-				&& chars < MAX_MESSAGE_LENGTH)
+			size_t bytes = s.size();
+
+			if (bytes > MAX_MESSAGE_LENGTH)
+			{
+				bytes = FindUTF8Offset(s, MAX_MESSAGE_LENGTH);
+			}
+
+			//drop an incomplete trailing character
+			size_t lead = bytes;
+			while (lead > 0
+				&& bytes - lead < 4)
 			{
-				unsigned char c = scast<unsigned char>(s[bytes]);
-				
-				size_t charLen = 
-					(c < 0x80) ? 1 
-					: (c < 0xE0) ? 2 
-					: (c < 0xF0) ? 3 
+				--lead;
+				if ((scast<unsigned char>(s[lead]) & 0xC0) != 0x80) break;
+			}
+			if (lead < bytes)
+			{
+				const unsigned char c = scast<unsigned char>(s[lead]);
+				const size_t charLen =
+					(c < 0x80) ? 1
+					: (c < 0xE0) ? 2
+					: (c < 0xF0) ? 3
 					: 4;
-					
-				if (bytes + charLen > s.size()) break; //incomplete char
-				
-				bytes += charLen;
+
+				if (lead + charLen > bytes) bytes = lead;
+			}
+
+			isTrimmed = bytes < s.size();
+			return s.substr(0, bytes);
+		}
+
+		//Returns the byte offset where character number maxChars starts,
+		//or the clamped end of s if it holds fewer characters than that
+		static inline size_t FindUTF8Offset(
+			string_view s,
+			size_t maxChars)
+		{
+			const unsigned char* data = rcast<const unsigned char*>(s.data());
+			const size_t size = std::min(s.size(), scast<size_t>(MAX_MESSAGE_BYTES));
+
+			size_t pos{};
+			size_t chars{};
+
+			//every byte that is not 10xxxxxx starts a character,
+			//whole blocks are counted while they can not overshoot maxChars
+
+#if defined(KLOG_SSE2)
+			const __m128i continuation = _mm_set1_epi8(scast<char>(0xBF));
+			while (pos + 16 <= size
+				&& chars + 16 <= maxChars)
+			{
+				const __m128i v = _mm_loadu_si128(rcast<const __m128i*>(data + pos));
+				const u32 leads = scast<u32>(_mm_movemask_epi8(_mm_cmpgt_epi8(v, continuation)));
+
+				chars += std::popcount(leads);
+				pos += 16;
+			}
+#elif defined(KLOG_NEON)
+			const int8x16_t continuation = vdupq_n_s8(scast<int8_t>(0xBF));
+			while (pos + 16 <= size
+				&& chars + 16 <= maxChars)
+			{
+				const int8x16_t v = vreinterpretq_s8_u8(vld1q_u8(data + pos));
+				const uint8x16_t leads = vshrq_n_u8(vcgtq_s8(v, continuation), 7);
+
+				chars += vaddvq_u8(leads);
+				pos += 16;
+			}
+#endif
+			for (; pos < size; ++pos)
+			{
+				if ((data[pos] & 0xC0) == 0x80) continue;
+				if (chars == maxChars) return pos;
+
 				++chars;
 			}
-			
-			string result(s.data(), bytes);
-			
-			if (bytes < s.size()) result.append("\n[TRIMMED LONG MESSAGE]");
-			
-			return result;
-		};
+
+			return size;
+		}
 
 		static constexpr const char* LogTypeTag[] =
 		{
@@ -480,50 +1778,97 @@ namespace KalaHeaders::KalaLog
 			LogType type,
 			string_view target)
 		{
-			//search existing entries
+			//FNV-1a of type + target, never 0 so 0 can mark empty slots
 
-			for (size_t i = 0; i < prefixSize; ++i)
+			u64 hash = 14695981039346656037ull;
+			hash ^= scast<u64>(type);
+			hash *= 1099511628211ull;
+			for (char c : target)
 			{
-				const auto& e = prefixCache()[i];
-				if (e.type == type
-					&& e.target == target)
+				hash ^= scast<unsigned char>(c);
+				hash *= 1099511628211ull;
+			}
+			if (hash == 0) hash = 1;
+
+			auto& entries = prefixCache();
+			char* arena = prefixArena().data();
+
+			//linear probe, slots never become empty again so a miss
+			//can stop at the first empty slot or the end of the probe window
+
+			const size_t mask = CACHED_TAGS_LENGTH - 1;
+			const size_t home = scast<size_t>(hash) & mask;
+			size_t index = SIZE_MAX;
+
+			for (size_t i = 0; i < CACHED_TAGS_PROBE_LENGTH; ++i)
+			{
+				const size_t slot = (home + i) & mask;
+				const CachedPrefix& e = entries[slot];
+
+				if (e.hash == 0)
+				{
+					index = slot;
+					break;
+				}
+
+				if (e.hash == hash
+					&& e.type == type
+					&& e.targetLength == target.size()
+					&& memcmp(arena + slot * CACHED_PREFIX_SLOT_SIZE, target.data(), target.size()) == 0)
 				{
-					return e.prefix;
+#ifdef KLOG_PREFIX_STATS
+					++prefixStats().hits;
+#endif
+					return string_view(
+						arena + slot * CACHED_PREFIX_SLOT_SIZE + MAX_TAG_LENGTH,
+						e.prefixLength);
 				}
 			}
 
-			//not found, make new
+#ifdef KLOG_PREFIX_STATS
+			++prefixStats().misses;
+#endif
+
+			//probe window is full, overwrite one of its slots in turn
+			if (index == SIZE_MAX)
+			{
+				index = (home + (prefixClock++ % CACHED_TAGS_PROBE_LENGTH)) & mask;
+#ifdef KLOG_PREFIX_STATS
+				++prefixStats().evictions;
+#endif
+			}
+
+			//not found, build "[ " + tag + target + " ] " into the slot
 
 			const char* tag = LogTypeTag[scast<size_t>(type)];
 			const size_t tagLength = LogTypeTagLength[scast<size_t>(type)];
 			const size_t targetLength = target.size();
 
-			//"[ " + tag + " | " + target + "] " 
+			char* slotData = arena + index * CACHED_PREFIX_SLOT_SIZE;
+			memcpy(slotData, target.data(), targetLength);
 
-			string built{};
-			built.resize(2 + tagLength + targetLength + 3);
-
-			char* p = built.data();
+			char* p = slotData + MAX_TAG_LENGTH;
 			p[0] = '[';
 			p[1] = ' ';
 			memcpy(p + 2, tag, tagLength);
 			memcpy(p + 2 + tagLength, target.data(), targetLength);
-			p[2 + tagLength + targetLength] = ' '; 
+			p[2 + tagLength + targetLength] = ' ';
 			p[3 + tagLength + targetLength] = ']';
 			p[4 + tagLength + targetLength] = ' ';
 
-			size_t index{};
-			if (prefixSize < prefixCache().size()) index = prefixSize++;
-			else index = (prefixClock++ % prefixCache().size());
+			CachedPrefix& e = entries[index];
+			e.hash = hash;
+			e.type = type;
+			e.targetLength = scast<u8>(targetLength);
+			e.prefixLength = scast<u8>(5 + tagLength + targetLength);
 
-			prefixCache()[index] = { type, string(target), std::move(built) };
-			return prefixCache()[index].prefix;
+			return string_view(p, e.prefixLength);
 		}
 
-		//Message length + headroom for tag, date stamp, time stamp and indent
-		static inline array<char, MAX_MESSAGE_LENGTH + 256>& logBuffer()
+		//Message bytes + headroom for tag, date stamp, time stamp, indent and trim notice
+		static inline array<char, MAX_MESSAGE_BYTES + 256>& logBuffer()
 		{
-			thread_local array<char, MAX_MESSAGE_LENGTH + 256> buffer{};
+			thread_local array<char, MAX_MESSAGE_BYTES + 256> buffer{};
 			return buffer;
 		}
 
@@ -533,7 +1878,19 @@ namespace KalaHeaders::KalaLog
 			return cache;
 		}
 
-		static inline thread_local size_t prefixSize{};  //total filled cached prefixes
-		static inline thread_local size_t prefixClock{}; //where to overwrite next once the cache is full
+		//Fixed per-thread storage for cached targets and built prefixes, one slot per cache entry
+		static inline array<char, CACHED_TAGS_LENGTH * CACHED_PREFIX_SLOT_SIZE>& prefixArena()
+		{
+			thread_local array<char, CACHED_TAGS_LENGTH * CACHED_PREFIX_SLOT_SIZE> arena{};
+			return arena;
+		}
+
+		static inline PrefixCacheStats& prefixStats()
+		{
+			thread_local PrefixCacheStats stats{};
+			return stats;
+		}
+
+		static inline thread_local size_t prefixClock{}; //which probe window slot to overwrite next once it is full
 	};
-}
+}
\ No newline at end of file
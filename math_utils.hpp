@@ -11,6 +11,11 @@
 //   - GLM-like containers as vec2, vec3, vec4, mat2, mat3, mat4, quat
 //   - operators and helpers for vec, mat and quat types
 //   - mat containers as column-major and scalar form
+//   - opt-in SSE/AVX/NEON backend for vec4, mat4 and quat (define KMATH_SIMD)
+//   - transpose, determinant and inverse for mat2, mat3 and mat4
+//   - span-based batch transform, rotate, normalize, lerp and slerp with SoA SIMD kernels
+//   - AABB, bounding sphere and frustum types with scalar and batch SIMD frustum culling
+//   - TransformHierarchy - SoA depth-sorted 3D transforms with dirty subtree propagation
 //---------------------------------------------------------------------------
 
 #pragma once
@@ -18,11 +23,54 @@
 #include <cmath>
 #include <cstdint>
 #include <algorithm>
+#include <type_traits>
+#include <vector>
+#include <thread>
+#include <barrier>
+#include <span>
 
 #ifdef _WIN32
 #include <basetsd.h>
 #endif
 
+//Opt-in SIMD backend for vec4, mat4 and quat, define KMATH_SIMD before including this header.
+//The best available instruction set is picked at compile time, the scalar code is used otherwise
+//and always in constant evaluation
+#ifdef KMATH_SIMD
+	#if defined(__AVX__)
+		#include <immintrin.h>
+		#define KMATH_SIMD_SSE
+		#define KMATH_SIMD_AVX
+	#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#include <emmintrin.h>
+		#define KMATH_SIMD_SSE
+	#elif defined(__ARM_NEON) && defined(__aarch64__)
+		#include <arm_neon.h>
+		#define KMATH_SIMD_NEON
+	#endif
+#endif
+
+//vec4, mat4 and quat are 16-byte aligned when a SIMD backend is active
+#if defined(KMATH_SIMD_SSE) || defined(KMATH_SIMD_NEON)
+	#define KMATH_ALIGN alignas(16)
+#else
+	#define KMATH_ALIGN
+#endif
+
+//================================================================================
+//
+// PROFILER HOOKS
+//
+//================================================================================
+
+//Recorded by profile_utils.hpp if it is included first with KPROFILE_ENABLED defined,
+//otherwise every zone and counter below compiles to nothing
+#ifndef KPROFILE_ZONE
+	#define KPROFILE_HOOKS_FALLBACK
+	#define KPROFILE_ZONE(name)
+	#define KPROFILE_COUNTER(name, value) do {} while (0)
+#endif
+
 //================================================================================
 //
 // DEFINE SHORTHANDS FOR SAFE MATH VARIABLES
@@ -98,18 +146,27 @@ namespace KalaHeaders::KalaMath
 	#define scast static_cast
 #endif
 
-	using std::sinf;
-	using std::cosf;
-	using std::tanf;
-	using std::sqrtf;
-	using std::fabsf;
-	using std::atan2f;
+	using std::sin;
+	using std::cos;
+	using std::tan;
+	using std::sqrt;
+	using std::fabs;
+	using std::atan2;
 	using std::clamp;
 	using std::min;
 	using std::max;
-	using std::fmodf;
-	using std::powf;
-	using std::floorf;
+	using std::fmod;
+	using std::pow;
+	using std::floor;
+	using std::ceil;
+	using std::round;
+	using std::asin;
+	using std::acos;
+	using std::copysign;
+	using std::vector;
+	using std::thread;
+	using std::barrier;
+	using std::span;
 
 	//6-digit precision PI
 	inline constexpr f32 PI = 3.131593f;
@@ -128,7 +185,7 @@ namespace KalaHeaders::KalaMath
 		f32 origin,
 		f32 divisor)
 	{
-		const f32 safeDivisor = (fabsf(divisor) > epsilon) ? divisor : 1.0f;
+		const f32 safeDivisor = (fabs(divisor) > epsilon) ? divisor : 1.0f;
 		return origin / safeDivisor;
 	}
 	//Used for compound division and prevents division by 0, mutates origin instead of returning result
@@ -136,10 +193,347 @@ namespace KalaHeaders::KalaMath
 		f32& origin,
 		f32 divisor)
 	{
-		const f32 safeDivisor = (fabsf(divisor) > epsilon) ? divisor : 1.0f;
+		const f32 safeDivisor = (fabs(divisor) > epsilon) ? divisor : 1.0f;
 		origin /= safeDivisor;
 	}
 
+	//================================================================================
+	//
+	// SIMD BACKEND
+	//
+	//================================================================================
+
+	//All kernels work on raw column-major f32 arrays so the vec, mat and quat types
+	//can call them before they are fully defined. out may alias any input
+
+#if defined(KMATH_SIMD_SSE)
+
+	//out = a * b for two column-major mat4
+	inline void simd_mat4_mul(
+		const f32* a,
+		const f32* b,
+		f32* out)
+	{
+#if defined(KMATH_SIMD_AVX)
+		const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a));
+		const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+		const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+		const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+
+		//two result columns per pass
+		const __m256 b01 = _mm256_loadu_ps(b);
+		const __m256 b23 = _mm256_loadu_ps(b + 8);
+
+		__m256 r01 = _mm256_mul_ps(a0, _mm256_permute_ps(b01, 0x00));
+		r01 = _mm256_add_ps(r01, _mm256_mul_ps(a1, _mm256_permute_ps(b01, 0x55)));
+		r01 = _mm256_add_ps(r01, _mm256_mul_ps(a2, _mm256_permute_ps(b01, 0xAA)));
+		r01 = _mm256_add_ps(r01, _mm256_mul_ps(a3, _mm256_permute_ps(b01, 0xFF)));
+
+		__m256 r23 = _mm256_mul_ps(a0, _mm256_permute_ps(b23, 0x00));
+		r23 = _mm256_add_ps(r23, _mm256_mul_ps(a1, _mm256_permute_ps(b23, 0x55)));
+		r23 = _mm256_add_ps(r23, _mm256_mul_ps(a2, _mm256_permute_ps(b23, 0xAA)));
+		r23 = _mm256_add_ps(r23, _mm256_mul_ps(a3, _mm256_permute_ps(b23, 0xFF)));
+
+		_mm256_storeu_ps(out, r01);
+		_mm256_storeu_ps(out + 8, r23);
+#else
+		const __m128 a0 = _mm_loadu_ps(a);
+		const __m128 a1 = _mm_loadu_ps(a + 4);
+		const __m128 a2 = _mm_loadu_ps(a + 8);
+		const __m128 a3 = _mm_loadu_ps(a + 12);
+
+		__m128 r[4];
+		for (int j = 0; j < 4; ++j)
+		{
+			const __m128 bj = _mm_loadu_ps(b + j * 4);
+
+			r[j] = _mm_mul_ps(a0, _mm_shuffle_ps(bj, bj, _MM_SHUFFLE(0, 0, 0, 0)));
+			r[j] = _mm_add_ps(r[j], _mm_mul_ps(a1, _mm_shuffle_ps(bj, bj, _MM_SHUFFLE(1, 1, 1, 1))));
+			r[j] = _mm_add_ps(r[j], _mm_mul_ps(a2, _mm_shuffle_ps(bj, bj, _MM_SHUFFLE(2, 2, 2, 2))));
+			r[j] = _mm_add_ps(r[j], _mm_mul_ps(a3, _mm_shuffle_ps(bj, bj, _MM_SHUFFLE(3, 3, 3, 3))));
+		}
+
+		_mm_storeu_ps(out,      r[0]);
+		_mm_storeu_ps(out + 4,  r[1]);
+		_mm_storeu_ps(out + 8,  r[2]);
+		_mm_storeu_ps(out + 12, r[3]);
+#endif
+	}
+
+	//out[i] = dot(column i, v), same as the scalar mat4 * vec4
+	inline void simd_mat4_mul_vec4(
+		const f32* m,
+		const f32* v,
+		f32* out)
+	{
+		__m128 c0 = _mm_loadu_ps(m);
+		__m128 c1 = _mm_loadu_ps(m + 4);
+		__m128 c2 = _mm_loadu_ps(m + 8);
+		__m128 c3 = _mm_loadu_ps(m + 12);
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+		const __m128 vv = _mm_loadu_ps(v);
+
+		__m128 r = _mm_mul_ps(c0, _mm_shuffle_ps(vv, vv, _MM_SHUFFLE(0, 0, 0, 0)));
+		r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_shuffle_ps(vv, vv, _MM_SHUFFLE(1, 1, 1, 1))));
+		r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(vv, vv, _MM_SHUFFLE(2, 2, 2, 2))));
+		r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_shuffle_ps(vv, vv, _MM_SHUFFLE(3, 3, 3, 3))));
+
+		_mm_storeu_ps(out, r);
+	}
+
+	inline void simd_mat4_transpose(
+		const f32* m,
+		f32* out)
+	{
+		__m128 c0 = _mm_loadu_ps(m);
+		__m128 c1 = _mm_loadu_ps(m + 4);
+		__m128 c2 = _mm_loadu_ps(m + 8);
+		__m128 c3 = _mm_loadu_ps(m + 12);
+		_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+		_mm_storeu_ps(out,      c0);
+		_mm_storeu_ps(out + 4,  c1);
+		_mm_storeu_ps(out + 8,  c2);
+		_mm_storeu_ps(out + 12, c3);
+	}
+
+	//2x2 helpers for the block inverse, a 2x2 is packed as (m00, m01, m10, m11)
+
+	//a * b
+	inline __m128 simd_mat2_mul(__m128 a, __m128 b)
+	{
+		return _mm_add_ps(
+			_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+			_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+	}
+	//adjugate(a) * b
+	inline __m128 simd_mat2_adj_mul(__m128 a, __m128 b)
+	{
+		return _mm_sub_ps(
+			_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+			_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+	}
+	//a * adjugate(b)
+	inline __m128 simd_mat2_mul_adj(__m128 a, __m128 b)
+	{
+		return _mm_sub_ps(
+			_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+			_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+	}
+
+	//Block-wise 2x2 inverse of a mat4, returns false and leaves out untouched if m is singular
+	inline bool simd_mat4_inverse(
+		const f32* m,
+		f32* out)
+	{
+		const __m128 c0 = _mm_loadu_ps(m);
+		const __m128 c1 = _mm_loadu_ps(m + 4);
+		const __m128 c2 = _mm_loadu_ps(m + 8);
+		const __m128 c3 = _mm_loadu_ps(m + 12);
+
+		//sub matrices, the columns are treated as rows which yields the same inverse layout
+		const __m128 A = _mm_movelh_ps(c0, c1);
+		const __m128 B = _mm_movehl_ps(c1, c0);
+		const __m128 C = _mm_movelh_ps(c2, c3);
+		const __m128 D = _mm_movehl_ps(c3, c2);
+
+		//(|A|, |B|, |C|, |D|)
+		const __m128 detSub = _mm_sub_ps(
+			_mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(3, 1, 3, 1))),
+			_mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(2, 0, 2, 0))));
+
+		const __m128 detA = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(0, 0, 0, 0));
+		const __m128 detB = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(1, 1, 1, 1));
+		const __m128 detC = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(2, 2, 2, 2));
+		const __m128 detD = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(3, 3, 3, 3));
+
+		const __m128 D_C = simd_mat2_adj_mul(D, C);
+		const __m128 A_B = simd_mat2_adj_mul(A, B);
+
+		__m128 X_ = _mm_sub_ps(_mm_mul_ps(detD, A), simd_mat2_mul(B, D_C));
+		__m128 W_ = _mm_sub_ps(_mm_mul_ps(detA, D), simd_mat2_mul(C, A_B));
+		__m128 Y_ = _mm_sub_ps(_mm_mul_ps(detB, C), simd_mat2_mul_adj(D, A_B));
+		__m128 Z_ = _mm_sub_ps(_mm_mul_ps(detC, B), simd_mat2_mul_adj(A, D_C));
+
+		//|M| = |A||D| + |B||C| - tr((A#B)(D#C))
+		__m128 tr = _mm_mul_ps(A_B, _mm_shuffle_ps(D_C, D_C, _MM_SHUFFLE(3, 1, 2, 0)));
+		tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(2, 3, 0, 1)));
+		tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(1, 0, 3, 2)));
+
+		const __m128 detM = _mm_sub_ps(
+			_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)),
+			tr);
+
+		if (_mm_cvtss_f32(detM) == 0.0f) return false;
+
+		const __m128 rDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+
+		X_ = _mm_mul_ps(X_, rDetM);
+		Y_ = _mm_mul_ps(Y_, rDetM);
+		Z_ = _mm_mul_ps(Z_, rDetM);
+		W_ = _mm_mul_ps(W_, rDetM);
+
+		_mm_storeu_ps(out,      _mm_shuffle_ps(X_, Y_, _MM_SHUFFLE(1, 3, 1, 3)));
+		_mm_storeu_ps(out + 4,  _mm_shuffle_ps(X_, Y_, _MM_SHUFFLE(0, 2, 0, 2)));
+		_mm_storeu_ps(out + 8,  _mm_shuffle_ps(Z_, W_, _MM_SHUFFLE(1, 3, 1, 3)));
+		_mm_storeu_ps(out + 12, _mm_shuffle_ps(Z_, W_, _MM_SHUFFLE(0, 2, 0, 2)));
+
+		return true;
+	}
+
+	//hamilton product of two (w, x, y, z) quats
+	inline void simd_quat_mul(
+		const f32* a,
+		const f32* b,
+		f32* out)
+	{
+		const __m128 qa = _mm_loadu_ps(a);
+		const __m128 qb = _mm_loadu_ps(b);
+
+		const __m128 aw = _mm_shuffle_ps(qa, qa, _MM_SHUFFLE(0, 0, 0, 0));
+		const __m128 ax = _mm_shuffle_ps(qa, qa, _MM_SHUFFLE(1, 1, 1, 1));
+		const __m128 ay = _mm_shuffle_ps(qa, qa, _MM_SHUFFLE(2, 2, 2, 2));
+		const __m128 az = _mm_shuffle_ps(qa, qa, _MM_SHUFFLE(3, 3, 3, 3));
+
+		//w * (w, x, y, z) + x * (-x, w, -z, y) + y * (-y, z, w, -x) + z * (-z, -y, x, w)
+		__m128 r = _mm_mul_ps(aw, qb);
+		r = _mm_add_ps(r, _mm_mul_ps(
+			_mm_mul_ps(ax, _mm_shuffle_ps(qb, qb, _MM_SHUFFLE(2, 3, 0, 1))),
+			_mm_setr_ps(-1.0f, 1.0f, -1.0f, 1.0f)));
+		r = _mm_add_ps(r, _mm_mul_ps(
+			_mm_mul_ps(ay, _mm_shuffle_ps(qb, qb, _MM_SHUFFLE(1, 0, 3, 2))),
+			_mm_setr_ps(-1.0f, 1.0f, 1.0f, -1.0f)));
+		r = _mm_add_ps(r, _mm_mul_ps(
+			_mm_mul_ps(az, _mm_shuffle_ps(qb, qb, _MM_SHUFFLE(0, 1, 2, 3))),
+			_mm_setr_ps(-1.0f, -1.0f, 1.0f, 1.0f)));
+
+		_mm_storeu_ps(out, r);
+	}
+
+	inline __m128 simd_cross3(__m128 a, __m128 b)
+	{
+		//a.yzx * b.zxy - a.zxy * b.yzx
+		const __m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+		const __m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+		const __m128 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+
+		return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+	}
+
+	//rotates v (x, y, z) by the (w, x, y, z) quat q
+	inline void simd_quat_rotate(
+		const f32* q,
+		const f32* v,
+		f32* out)
+	{
+		const __m128 qq = _mm_loadu_ps(q);
+		const __m128 qv = _mm_shuffle_ps(qq, qq, _MM_SHUFFLE(0, 3, 2, 1));
+		const __m128 qw = _mm_shuffle_ps(qq, qq, _MM_SHUFFLE(0, 0, 0, 0));
+		const __m128 vv = _mm_setr_ps(v[0], v[1], v[2], 0.0f);
+
+		const __m128 cv = simd_cross3(qv, vv);
+		const __m128 t = _mm_add_ps(cv, cv);
+		const __m128 r = _mm_add_ps(
+			_mm_add_ps(vv, _mm_mul_ps(qw, t)),
+			simd_cross3(qv, t));
+
+		alignas(16) f32 result[4];
+		_mm_store_ps(result, r);
+
+		out[0] = result[0];
+		out[1] = result[1];
+		out[2] = result[2];
+	}
+
+#elif defined(KMATH_SIMD_NEON)
+
+	//out = a * b for two column-major mat4
+	inline void simd_mat4_mul(
+		const f32* a,
+		const f32* b,
+		f32* out)
+	{
+		const float32x4_t a0 = vld1q_f32(a);
+		const float32x4_t a1 = vld1q_f32(a + 4);
+		const float32x4_t a2 = vld1q_f32(a + 8);
+		const float32x4_t a3 = vld1q_f32(a + 12);
+
+		float32x4_t r[4];
+		for (int j = 0; j < 4; ++j)
+		{
+			const float32x4_t bj = vld1q_f32(b + j * 4);
+
+			r[j] = vmulq_laneq_f32(a0, bj, 0);
+			r[j] = vfmaq_laneq_f32(r[j], a1, bj, 1);
+			r[j] = vfmaq_laneq_f32(r[j], a2, bj, 2);
+			r[j] = vfmaq_laneq_f32(r[j], a3, bj, 3);
+		}
+
+		vst1q_f32(out,      r[0]);
+		vst1q_f32(out + 4,  r[1]);
+		vst1q_f32(out + 8,  r[2]);
+		vst1q_f32(out + 12, r[3]);
+	}
+
+	//out[i] = dot(column i, v), same as the scalar mat4 * vec4
+	inline void simd_mat4_mul_vec4(
+		const f32* m,
+		const f32* v,
+		f32* out)
+	{
+		//de-interleaving load gives the rows
+		const float32x4x4_t rows = vld4q_f32(m);
+		const float32x4_t vv = vld1q_f32(v);
+
+		float32x4_t r = vmulq_laneq_f32(rows.val[0], vv, 0);
+		r = vfmaq_laneq_f32(r, rows.val[1], vv, 1);
+		r = vfmaq_laneq_f32(r, rows.val[2], vv, 2);
+		r = vfmaq_laneq_f32(r, rows.val[3], vv, 3);
+
+		vst1q_f32(out, r);
+	}
+
+	inline void simd_mat4_transpose(
+		const f32* m,
+		f32* out)
+	{
+		const float32x4x4_t rows = vld4q_f32(m);
+
+		vst1q_f32(out,      rows.val[0]);
+		vst1q_f32(out + 4,  rows.val[1]);
+		vst1q_f32(out + 8,  rows.val[2]);
+		vst1q_f32(out + 12, rows.val[3]);
+	}
+
+	//hamilton product of two (w, x, y, z) quats
+	inline void simd_quat_mul(
+		const f32* a,
+		const f32* b,
+		f32* out)
+	{
+		static const f32 signX[4] = { -1.0f,  1.0f, -1.0f,  1.0f };
+		static const f32 signY[4] = { -1.0f,  1.0f,  1.0f, -1.0f };
+		static const f32 signZ[4] = { -1.0f, -1.0f,  1.0f,  1.0f };
+
+		const float32x4_t qa = vld1q_f32(a);
+		const float32x4_t qb = vld1q_f32(b);
+
+		//(x, w, z, y), (y, z, w, x), (z, y, x, w)
+		const float32x4_t bX = vrev64q_f32(qb);
+		const float32x4_t bY = vextq_f32(qb, qb, 2);
+		const float32x4_t bZ = vrev64q_f32(bY);
+
+		float32x4_t r = vmulq_laneq_f32(qb, qa, 0);
+		r = vfmaq_f32(r, vmulq_laneq_f32(bX, qa, 1), vld1q_f32(signX));
+		r = vfmaq_f32(r, vmulq_laneq_f32(bY, qa, 2), vld1q_f32(signY));
+		r = vfmaq_f32(r, vmulq_laneq_f32(bZ, qa, 3), vld1q_f32(signZ));
+
+		vst1q_f32(out, r);
+	}
+
+#endif
+
 	//================================================================================
 	//
 	// VEC
@@ -154,7 +548,7 @@ namespace KalaHeaders::KalaMath
 	template<>
 	struct vec_storage<3> { f32 x{}, y{}, z{}; };
 	template<>
-	struct vec_storage<4> { f32 x{}, y{}, z{}, w{}; };
+	struct KMATH_ALIGN vec_storage<4> { f32 x{}, y{}, z{}, w{}; };
 
 	template <size_t N>
 	struct vec : public vec_storage<N>
@@ -162,6 +556,10 @@ namespace KalaHeaders::KalaMath
 		static_assert(N >= 2 && N <= 4, "vec can only have 2, 3, or 4 components.");
 
 		constexpr vec() = default;
+		
+		//the same-size constructors below are user-provided copy constructors,
+		//so copy assignment has to be declared explicitly
+		constexpr vec& operator=(const vec&) = default;
 
 		//vec2
 
@@ -360,17 +758,17 @@ namespace KalaHeaders::KalaMath
 		constexpr bool operator==(const vec& v) const
 		{
 			if constexpr (N == 2) return 
-				fabsf(this->x - v.x) < epsilon
-				&& fabsf(this->y - v.y) < epsilon;
+				fabs(this->x - v.x) < epsilon
+				&& fabs(this->y - v.y) < epsilon;
 			if constexpr (N == 3) return
-				fabsf(this->x - v.x) < epsilon
-				&& fabsf(this->y - v.y) < epsilon
-				&& fabsf(this->z - v.z) < epsilon;
+				fabs(this->x - v.x) < epsilon
+				&& fabs(this->y - v.y) < epsilon
+				&& fabs(this->z - v.z) < epsilon;
 			if constexpr (N == 4) return
-				fabsf(this->x - v.x) < epsilon
-				&& fabsf(this->y - v.y) < epsilon
-				&& fabsf(this->z - v.z) < epsilon
-				&& fabsf(this->w - v.w) < epsilon;
+				fabs(this->x - v.x) < epsilon
+				&& fabs(this->y - v.y) < epsilon
+				&& fabs(this->z - v.z) < epsilon
+				&& fabs(this->w - v.w) < epsilon;
 		}
 		constexpr bool operator!=(const vec& v) const { return !(*this == v); }
 
@@ -663,7 +1061,7 @@ namespace KalaHeaders::KalaMath
 		f32 m02{},      m12{},      m22 = 1.0f;
 	};
 	template<>
-	struct mat_storage<4>
+	struct KMATH_ALIGN mat_storage<4>
 	{
 		f32 m00 = 1.0f, m10{},      m20{},      m30{};
 		f32 m01{},      m11 = 1.0f, m21{},      m31{};
@@ -891,41 +1289,41 @@ namespace KalaHeaders::KalaMath
 		{
 			if constexpr (N == 2)
 				return
-				(fabsf(this->m00 - m.m00) < epsilon)
-				&& (fabsf(this->m01 - m.m01) < epsilon)
-				&& (fabsf(this->m10 - m.m10) < epsilon)
-				&& (fabsf(this->m11 - m.m11) < epsilon);
+				(fabs(this->m00 - m.m00) < epsilon)
+				&& (fabs(this->m01 - m.m01) < epsilon)
+				&& (fabs(this->m10 - m.m10) < epsilon)
+				&& (fabs(this->m11 - m.m11) < epsilon);
 
 			if constexpr (N == 3)
 				return
-				(fabsf(this->m00 - m.m00) < epsilon)
-				&& (fabsf(this->m01 - m.m01) < epsilon)
-				&& (fabsf(this->m02 - m.m02) < epsilon)
-				&& (fabsf(this->m10 - m.m10) < epsilon)
-				&& (fabsf(this->m11 - m.m11) < epsilon)
-				&& (fabsf(this->m12 - m.m12) < epsilon)
-				&& (fabsf(this->m20 - m.m20) < epsilon)
-				&& (fabsf(this->m21 - m.m21) < epsilon)
-				&& (fabsf(this->m22 - m.m22) < epsilon);
+				(fabs(this->m00 - m.m00) < epsilon)
+				&& (fabs(this->m01 - m.m01) < epsilon)
+				&& (fabs(this->m02 - m.m02) < epsilon)
+				&& (fabs(this->m10 - m.m10) < epsilon)
+				&& (fabs(this->m11 - m.m11) < epsilon)
+				&& (fabs(this->m12 - m.m12) < epsilon)
+				&& (fabs(this->m20 - m.m20) < epsilon)
+				&& (fabs(this->m21 - m.m21) < epsilon)
+				&& (fabs(this->m22 - m.m22) < epsilon);
 
 			if constexpr (N == 4)
 				return
-				(fabsf(this->m00 - m.m00) < epsilon)
-				&& (fabsf(this->m01 - m.m01) < epsilon)
-				&& (fabsf(this->m02 - m.m02) < epsilon)
-				&& (fabsf(this->m03 - m.m03) < epsilon)
-				&& (fabsf(this->m10 - m.m10) < epsilon)
-				&& (fabsf(this->m11 - m.m11) < epsilon)
-				&& (fabsf(this->m12 - m.m12) < epsilon)
-				&& (fabsf(this->m13 - m.m13) < epsilon)
-				&& (fabsf(this->m20 - m.m20) < epsilon)
-				&& (fabsf(this->m21 - m.m21) < epsilon)
-				&& (fabsf(this->m22 - m.m22) < epsilon)
-				&& (fabsf(this->m23 - m.m23) < epsilon)
-				&& (fabsf(this->m30 - m.m30) < epsilon)
-				&& (fabsf(this->m31 - m.m31) < epsilon)
-				&& (fabsf(this->m32 - m.m32) < epsilon)
-				&& (fabsf(this->m33 - m.m33) < epsilon);
+				(fabs(this->m00 - m.m00) < epsilon)
+				&& (fabs(this->m01 - m.m01) < epsilon)
+				&& (fabs(this->m02 - m.m02) < epsilon)
+				&& (fabs(this->m03 - m.m03) < epsilon)
+				&& (fabs(this->m10 - m.m10) < epsilon)
+				&& (fabs(this->m11 - m.m11) < epsilon)
+				&& (fabs(this->m12 - m.m12) < epsilon)
+				&& (fabs(this->m13 - m.m13) < epsilon)
+				&& (fabs(this->m20 - m.m20) < epsilon)
+				&& (fabs(this->m21 - m.m21) < epsilon)
+				&& (fabs(this->m22 - m.m22) < epsilon)
+				&& (fabs(this->m23 - m.m23) < epsilon)
+				&& (fabs(this->m30 - m.m30) < epsilon)
+				&& (fabs(this->m31 - m.m31) < epsilon)
+				&& (fabs(this->m32 - m.m32) < epsilon)
+				&& (fabs(this->m33 - m.m33) < epsilon);
 		}
 		constexpr bool operator!=(const mat& m) const { return !(*this == m); }
 
@@ -1062,6 +1460,13 @@ namespace KalaHeaders::KalaMath
 			}
 			if constexpr (N == 4)
 			{
+#if defined(KMATH_SIMD_SSE) || defined(KMATH_SIMD_NEON)
+				if (!std::is_constant_evaluated())
+				{
+					simd_mat4_mul(&this->m00, &m.m00, &this->m00);
+					return *this;
+				}
+#endif
 				const f32 a00 = this->m00, a10 = this->m10, a20 = this->m20, a30 = this->m30;
 				const f32 a01 = this->m01, a11 = this->m11, a21 = this->m21, a31 = this->m31;
 				const f32 a02 = this->m02, a12 = this->m12, a22 = this->m22, a32 = this->m32;
@@ -1249,13 +1654,23 @@ namespace KalaHeaders::KalaMath
 			m.m02 * v.x + m.m12 * v.y + m.m22 * v.z
 		};
 		if constexpr (N == 4)
-			return 
 		{
-			m.m00 * v.x + m.m10 * v.y + m.m20 * v.z + m.m30 * v.w,
-			m.m01 * v.x + m.m11 * v.y + m.m21 * v.z + m.m31 * v.w,
-			m.m02 * v.x + m.m12 * v.y + m.m22 * v.z + m.m32 * v.w,
-			m.m03 * v.x + m.m13 * v.y + m.m23 * v.z + m.m33 * v.w
-		};
+#if defined(KMATH_SIMD_SSE) || defined(KMATH_SIMD_NEON)
+			if (!std::is_constant_evaluated())
+			{
+				vec<4> r{};
+				simd_mat4_mul_vec4(&m.m00, &v.x, &r.x);
+				return r;
+			}
+#endif
+			return 
+			{
+				m.m00 * v.x + m.m10 * v.y + m.m20 * v.z + m.m30 * v.w,
+				m.m01 * v.x + m.m11 * v.y + m.m21 * v.z + m.m31 * v.w,
+				m.m02 * v.x + m.m12 * v.y + m.m22 * v.z + m.m32 * v.w,
+				m.m03 * v.x + m.m13 * v.y + m.m23 * v.z + m.m33 * v.w
+			};
+		}
 	}
 	
 	//define mat2, mat3 and mat4
@@ -1270,7 +1685,7 @@ namespace KalaHeaders::KalaMath
 	//
 	//================================================================================
 
-	struct quat
+	struct KMATH_ALIGN quat
 	{
 		f32 w = 1.0f, x{}, y{}, z{};
 		
@@ -1297,6 +1712,14 @@ namespace KalaHeaders::KalaMath
 		//hamilton multiplication
 		constexpr quat operator*(const quat& q) const
 		{ 
+#if defined(KMATH_SIMD_SSE) || defined(KMATH_SIMD_NEON)
+			if (!std::is_constant_evaluated())
+			{
+				quat r{};
+				simd_quat_mul(&w, &q.w, &r.w);
+				return r;
+			}
+#endif
 			return 
 			{
 				w * q.w - x * q.x - y * q.y - z * q.z,
@@ -1349,6 +1772,14 @@ namespace KalaHeaders::KalaMath
 	//rotate vector by quaternion
 	inline constexpr vec3 operator*(const quat& q, const vec3& v)
 	{
+#if defined(KMATH_SIMD_SSE)
+		if (!std::is_constant_evaluated())
+		{
+			vec3 r{};
+			simd_quat_rotate(&q.w, &v.x, &r.x);
+			return r;
+		}
+#endif
 		auto cross = [](
 			const vec3& a,
 			const vec3& b) -> vec3
@@ -1485,6 +1916,177 @@ namespace KalaHeaders::KalaMath
 		};
 	}
 	
+	//Returns the transpose of a mat, rows become columns
+	template<size_t N>
+		requires(N >= 2 && N <= 4)
+	inline constexpr mat<N> transpose(const mat<N>& m)
+	{
+		if constexpr (N == 2)
+		{
+			return
+			{
+				m.m00, m.m01,
+				m.m10, m.m11
+			};
+		}
+		if constexpr (N == 3)
+		{
+			return
+			{
+				m.m00, m.m01, m.m02,
+				m.m10, m.m11, m.m12,
+				m.m20, m.m21, m.m22
+			};
+		}
+		if constexpr (N == 4)
+		{
+#if defined(KMATH_SIMD_SSE) || defined(KMATH_SIMD_NEON)
+			if (!std::is_constant_evaluated())
+			{
+				mat<4> r{};
+				simd_mat4_transpose(&m.m00, &r.m00);
+				return r;
+			}
+#endif
+			return
+			{
+				m.m00, m.m01, m.m02, m.m03,
+				m.m10, m.m11, m.m12, m.m13,
+				m.m20, m.m21, m.m22, m.m23,
+				m.m30, m.m31, m.m32, m.m33
+			};
+		}
+	}
+
+	//Returns the determinant of a mat
+	template<size_t N>
+		requires(N >= 2 && N <= 4)
+	inline constexpr f32 determinant(const mat<N>& m)
+	{
+		if constexpr (N == 2)
+		{
+			return m.m00 * m.m11 - m.m01 * m.m10;
+		}
+		if constexpr (N == 3)
+		{
+			return
+				m.m00 * (m.m11 * m.m22 - m.m12 * m.m21)
+				- m.m01 * (m.m10 * m.m22 - m.m12 * m.m20)
+				+ m.m02 * (m.m10 * m.m21 - m.m11 * m.m20);
+		}
+		if constexpr (N == 4)
+		{
+			const f32 s0 = m.m00 * m.m11 - m.m10 * m.m01;
+			const f32 s1 = m.m00 * m.m12 - m.m10 * m.m02;
+			const f32 s2 = m.m00 * m.m13 - m.m10 * m.m03;
+			const f32 s3 = m.m01 * m.m12 - m.m11 * m.m02;
+			const f32 s4 = m.m01 * m.m13 - m.m11 * m.m03;
+			const f32 s5 = m.m02 * m.m13 - m.m12 * m.m03;
+
+			const f32 c5 = m.m22 * m.m33 - m.m32 * m.m23;
+			const f32 c4 = m.m21 * m.m33 - m.m31 * m.m23;
+			const f32 c3 = m.m21 * m.m32 - m.m31 * m.m22;
+			const f32 c2 = m.m20 * m.m33 - m.m30 * m.m23;
+			const f32 c1 = m.m20 * m.m32 - m.m30 * m.m22;
+			const f32 c0 = m.m20 * m.m31 - m.m30 * m.m21;
+
+			return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+		}
+	}
+
+	//Returns the inverse of a mat, returns identity if the mat is singular
+	template<size_t N>
+		requires(N >= 2 && N <= 4)
+	inline constexpr mat<N> inverse(const mat<N>& m)
+	{
+		if constexpr (N == 2)
+		{
+			const f32 det = determinant(m);
+			if (det == 0.0f) return {};
+
+			const f32 id = 1.0f / det;
+			return
+			{
+				 m.m11 * id, -m.m10 * id,
+				-m.m01 * id,  m.m00 * id
+			};
+		}
+		if constexpr (N == 3)
+		{
+			const f32 det = determinant(m);
+			if (det == 0.0f) return {};
+
+			const f32 id = 1.0f / det;
+			mat<3> r{};
+
+			r.m00 =  (m.m11 * m.m22 - m.m12 * m.m21) * id;
+			r.m01 = -(m.m01 * m.m22 - m.m02 * m.m21) * id;
+			r.m02 =  (m.m01 * m.m12 - m.m02 * m.m11) * id;
+
+			r.m10 = -(m.m10 * m.m22 - m.m12 * m.m20) * id;
+			r.m11 =  (m.m00 * m.m22 - m.m02 * m.m20) * id;
+			r.m12 = -(m.m00 * m.m12 - m.m02 * m.m10) * id;
+
+			r.m20 =  (m.m10 * m.m21 - m.m11 * m.m20) * id;
+			r.m21 = -(m.m00 * m.m21 - m.m01 * m.m20) * id;
+			r.m22 =  (m.m00 * m.m11 - m.m01 * m.m10) * id;
+
+			return r;
+		}
+		if constexpr (N == 4)
+		{
+#if defined(KMATH_SIMD_SSE)
+			if (!std::is_constant_evaluated())
+			{
+				mat<4> r{};
+				if (!simd_mat4_inverse(&m.m00, &r.m00)) return {};
+				return r;
+			}
+#endif
+			const f32 s0 = m.m00 * m.m11 - m.m10 * m.m01;
+			const f32 s1 = m.m00 * m.m12 - m.m10 * m.m02;
+			const f32 s2 = m.m00 * m.m13 - m.m10 * m.m03;
+			const f32 s3 = m.m01 * m.m12 - m.m11 * m.m02;
+			const f32 s4 = m.m01 * m.m13 - m.m11 * m.m03;
+			const f32 s5 = m.m02 * m.m13 - m.m12 * m.m03;
+
+			const f32 c5 = m.m22 * m.m33 - m.m32 * m.m23;
+			const f32 c4 = m.m21 * m.m33 - m.m31 * m.m23;
+			const f32 c3 = m.m21 * m.m32 - m.m31 * m.m22;
+			const f32 c2 = m.m20 * m.m33 - m.m30 * m.m23;
+			const f32 c1 = m.m20 * m.m32 - m.m30 * m.m22;
+			const f32 c0 = m.m20 * m.m31 - m.m30 * m.m21;
+
+			const f32 det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+			if (det == 0.0f) return {};
+
+			const f32 id = 1.0f / det;
+			mat<4> r{};
+
+			r.m00 = ( m.m11 * c5 - m.m12 * c4 + m.m13 * c3) * id;
+			r.m01 = (-m.m01 * c5 + m.m02 * c4 - m.m03 * c3) * id;
+			r.m02 = ( m.m31 * s5 - m.m32 * s4 + m.m33 * s3) * id;
+			r.m03 = (-m.m21 * s5 + m.m22 * s4 - m.m23 * s3) * id;
+
+			r.m10 = (-m.m10 * c5 + m.m12 * c2 - m.m13 * c1) * id;
+			r.m11 = ( m.m00 * c5 - m.m02 * c2 + m.m03 * c1) * id;
+			r.m12 = (-m.m30 * s5 + m.m32 * s2 - m.m33 * s1) * id;
+			r.m13 = ( m.m20 * s5 - m.m22 * s2 + m.m23 * s1) * id;
+
+			r.m20 = ( m.m10 * c4 - m.m11 * c2 + m.m13 * c0) * id;
+			r.m21 = (-m.m00 * c4 + m.m01 * c2 - m.m03 * c0) * id;
+			r.m22 = ( m.m30 * s4 - m.m31 * s2 + m.m33 * s0) * id;
+			r.m23 = (-m.m20 * s4 + m.m21 * s2 - m.m23 * s0) * id;
+
+			r.m30 = (-m.m10 * c3 + m.m11 * c1 - m.m12 * c0) * id;
+			r.m31 = ( m.m00 * c3 - m.m01 * c1 + m.m02 * c0) * id;
+			r.m32 = (-m.m30 * s3 + m.m31 * s1 - m.m32 * s0) * id;
+			r.m33 = ( m.m20 * s3 - m.m21 * s1 + m.m22 * s0) * id;
+
+			return r;
+		}
+	}
+
 	//Returns the inverse (congjugated) rotation of a quaternion,
 	//assuming the quat input is already normalized
 	inline constexpr quat inverse(const quat& q)
@@ -1495,14 +2097,14 @@ namespace KalaHeaders::KalaMath
 	//Computes vec2 magnitude (distance from a)
 	inline f32 length(const vec2 v)
 	{
-		return sqrtf(
+		return sqrt(
 			v.x * v.x
 			+ v.y * v.y);
 	}
 	//Computes vec3 magnitude (distance from a)
 	inline f32 length(const vec3& v)
 	{
-		return sqrtf(
+		return sqrt(
 			v.x * v.x
 			+ v.y * v.y
 			+ v.z * v.z);
@@ -1510,7 +2112,7 @@ namespace KalaHeaders::KalaMath
 	//Computes vec4 magnitude (distance from a)
 	inline f32 length(const vec4& v)
 	{
-		return sqrtf(
+		return sqrt(
 			v.x * v.x
 			+ v.y * v.y
 			+ v.z * v.z
@@ -1520,7 +2122,7 @@ namespace KalaHeaders::KalaMath
 	//Computes quat magnitude (distance from a)
 	inline f32 length(const quat& q)
 	{
-		return sqrtf(
+		return sqrt(
 			q.w * q.w
 			+ q.x * q.x
 			+ q.y * q.y
@@ -1529,13 +2131,13 @@ namespace KalaHeaders::KalaMath
 	
 	//
 	// it is recommended to use isnear *only for equality checks*,
-	// this means == and != only, use fabsf/linear + epsilon for <, >, <= and >=
+	// this means == and != only, use fabs/linear + epsilon for <, >, <= and >=
 	//
 	
 	//Returns true if f32 a is close to f32 b within epsilon range
 	inline bool isnear(const f32 a, const f32 b = {})
 	{
-		return fabsf(a - b) <= epsilon;
+		return fabs(a - b) <= epsilon;
 	}
 	
 	//Returns true if vec2 a is close to vec2 b within epsilon range
@@ -1725,26 +2327,26 @@ namespace KalaHeaders::KalaMath
 	inline bool isnormalized(vec2 v)
 	{
 		f32 len2 = dot(v, v);
-		return fabsf(len2 - 1.0f) <= epsilon;
+		return fabs(len2 - 1.0f) <= epsilon;
 	}
 	//Returns true if vec3 is unit-length normalized
 	inline bool isnormalized(const vec3& v)
 	{
 		f32 len2 = dot(v, v);
-		return fabsf(len2 - 1.0f) <= epsilon;
+		return fabs(len2 - 1.0f) <= epsilon;
 	}
 	//Returns true if vec4 is unit-length normalized
 	inline bool isnormalized(const vec4& v)
 	{
 		f32 len2 = dot(v, v);
-		return fabsf(len2 - 1.0f) <= epsilon;
+		return fabs(len2 - 1.0f) <= epsilon;
 	}
 	
 	//Returns true if quat is unit-length normalized
 	inline bool isnormalized(const quat& q)
 	{
 		f32 len2 = dot(q, q);
-		return fabsf(len2 - 1.0f) <= epsilon;
+		return fabs(len2 - 1.0f) <= epsilon;
 	}
 
 	//Returns unit-length normalized vec2
@@ -1796,7 +2398,7 @@ namespace KalaHeaders::KalaMath
 	//Wraps a rotation axis between 0 to 360 degrees
 	inline f32 wrap(f32 deg)
 	{
-		deg = fmodf(deg, 360.0f);
+		deg = fmod(deg, 360.0f);
 		if (deg < 0.0f) deg += 360.0f;
 
 		return deg;
@@ -1857,18 +2459,18 @@ namespace KalaHeaders::KalaMath
 	
 		//get yaw
 		
-		//TODO: figure out a better solution so atan2f doesn't return -180 to 180
+		//TODO: figure out a better solution so atan2 doesn't return -180 to 180
 		
 		f32 siny = 2.0f * (nq.w * nq.y + nq.x * nq.z);
 		f32 cosy = 1.0f - 2.0f * (nq.y * nq.y + nq.x * nq.x);
 		
-		f32 yaw = atan2f(siny, cosy);
+		f32 yaw = atan2(siny, cosy);
 		
 		//get pitch
 		
 		f32 sinp = 2.0f * (nq.w * nq.x - nq.y * nq.z);
 		
-		f32 pitch = (fabsf(sinp) >= 1.0f - epsilon)
+		f32 pitch = (fabs(sinp) >= 1.0f - epsilon)
 			? copysign(PI / 2.0f, sinp)
 			: asin(sinp);
 		
@@ -1877,7 +2479,7 @@ namespace KalaHeaders::KalaMath
 		f32 sinr = 2.0f * (nq.w * nq.z + nq.x * nq.y);
 		f32 cosr = 1.0f - 2.0f * (nq.z * nq.z + nq.x * nq.x);
 		
-		f32 roll = atan2f(sinr, cosr);
+		f32 roll = atan2(sinr, cosr);
 		
 		//combine all together
 		
@@ -1921,9 +2523,9 @@ namespace KalaHeaders::KalaMath
 		
 		vec3 r = radians(e) * 0.5f;
 
-		f32 cx = cosf(r.x), sx = sinf(r.x); //pitch
-		f32 cy = cosf(r.y), sy = sinf(r.y); //yaw
-		f32 cz = cosf(r.z), sz = sinf(r.z); //roll
+		f32 cx = cos(r.x), sx = sin(r.x); //pitch
+		f32 cy = cos(r.y), sy = sin(r.y); //yaw
+		f32 cz = cos(r.z), sz = sin(r.z); //roll
 
 		return
 		{
@@ -1942,7 +2544,7 @@ namespace KalaHeaders::KalaMath
 
 		if (trace > 0.0f)
 		{
-			const f32 s = 0.5f / sqrtf(trace + 1.0f);
+			const f32 s = 0.5f / sqrt(trace + 1.0f);
 			q.w = 0.25f / s;
 			q.x = (m.m21 - m.m12) * s;
 			q.y = (m.m02 - m.m20) * s;
@@ -1950,7 +2552,7 @@ namespace KalaHeaders::KalaMath
 		}
 		else if (m.m00 > m.m11 && m.m00 > m.m22)
 		{
-			const f32 s = 2.0f * sqrtf(1.0f + m.m00 - m.m11 - m.m22);
+			const f32 s = 2.0f * sqrt(1.0f + m.m00 - m.m11 - m.m22);
 			q.w = (m.m21 - m.m12) / s;
 			q.x = 0.25f * s;
 			q.y = (m.m10 + m.m01) / s;
@@ -1958,7 +2560,7 @@ namespace KalaHeaders::KalaMath
 		}
 		else if (m.m11 > m.m22)
 		{
-			const f32 s = 2.0f * sqrtf(1.0f + m.m11 - m.m00 - m.m22);
+			const f32 s = 2.0f * sqrt(1.0f + m.m11 - m.m00 - m.m22);
 			q.w = (m.m02 - m.m20) / s;
 			q.x = (m.m10 + m.m01) / s;
 			q.y = 0.25f * s;
@@ -1966,7 +2568,7 @@ namespace KalaHeaders::KalaMath
 		}
 		else
 		{
-			const f32 s = 2.0f * sqrtf(1.0f + m.m22 - m.m00 - m.m11);
+			const f32 s = 2.0f * sqrt(1.0f + m.m22 - m.m00 - m.m11);
 			q.w = (m.m10 - m.m01) / s;
 			q.x = (m.m20 + m.m02) / s;
 			q.y = (m.m21 + m.m12) / s;
@@ -1983,7 +2585,7 @@ namespace KalaHeaders::KalaMath
 
 		if (trace > 0.0f)
 		{
-			const f32 s = 0.5f / sqrtf(trace + 1.0f);
+			const f32 s = 0.5f / sqrt(trace + 1.0f);
 			q.w = 0.25f / s;
 			q.x = (m.m21 - m.m12) * s;
 			q.y = (m.m02 - m.m20) * s;
@@ -1991,7 +2593,7 @@ namespace KalaHeaders::KalaMath
 		}
 		else if (m.m00 > m.m11 && m.m00 > m.m22)
 		{
-			const f32 s = 2.0f * sqrtf(1.0f + m.m00 - m.m11 - m.m22);
+			const f32 s = 2.0f * sqrt(1.0f + m.m00 - m.m11 - m.m22);
 			q.w = (m.m21 - m.m12) / s;
 			q.x = 0.25f * s;
 			q.y = (m.m10 + m.m01) / s;
@@ -1999,7 +2601,7 @@ namespace KalaHeaders::KalaMath
 		}
 		else if (m.m11 > m.m22)
 		{
-			const f32 s = 2.0f * sqrtf(1.0f + m.m11 - m.m00 - m.m22);
+			const f32 s = 2.0f * sqrt(1.0f + m.m11 - m.m00 - m.m22);
 			q.w = (m.m02 - m.m20) / s;
 			q.x = (m.m10 + m.m01) / s;
 			q.y = 0.25f * s;
@@ -2007,7 +2609,7 @@ namespace KalaHeaders::KalaMath
 		}
 		else
 		{
-			const f32 s = 2.0f * sqrtf(1.0f + m.m22 - m.m00 - m.m11);
+			const f32 s = 2.0f * sqrt(1.0f + m.m22 - m.m00 - m.m11);
 			q.w = (m.m10 - m.m01) / s;
 			q.x = (m.m20 + m.m02) / s;
 			q.y = (m.m21 + m.m12) / s;
@@ -2235,7 +2837,7 @@ namespace KalaHeaders::KalaMath
 		if (zNear >= zFar) zFar = zNear + 1;
 		
 		const f32 aspect = correctVP.x / correctVP.y;
-		const f32 f = 1.0f / tanf(radians(fovDeg) * 0.5f);
+		const f32 f = 1.0f / tan(radians(fovDeg) * 0.5f);
 		const f32 fn = zFar - zNear;
 
 		mat4 m{};
@@ -2255,8 +2857,8 @@ namespace KalaHeaders::KalaMath
 		const vec2 size)
 	{
 		f32 r = radians(rotDeg);
-		f32 c = cosf(r);
-		f32 s = sinf(r);
+		f32 c = cos(r);
+		f32 s = sin(r);
 
 		mat4 m{};
 
@@ -2399,10 +3001,10 @@ namespace KalaHeaders::KalaMath
 		}
 		
 		f32 theta = acos(dotAB);
-		f32 sinTheta = sinf(theta);
+		f32 sinTheta = sin(theta);
 		
-		f32 w1 = sinf((1.0f - t) * theta) / sinTheta;
-		f32 w2 = sinf(t * theta) / sinTheta;
+		f32 w1 = sin((1.0f - t) * theta) / sinTheta;
+		f32 w2 = sin(t * theta) / sinTheta;
 
 		return normalize_q(
 		{
@@ -2460,7 +3062,7 @@ namespace KalaHeaders::KalaMath
 		};
 	}
 
-	//Uses std::sqrtf and returns unit-accurate distance between two vec2s
+	//Uses std::sqrt and returns unit-accurate distance between two vec2s
 	inline f32 distancesqrt(
 		const vec2 a, 
 		const vec2 b)
@@ -2468,9 +3070,9 @@ namespace KalaHeaders::KalaMath
 		f32 dx = a.x - b.x;
 		f32 dy = a.y - b.y;
 
-		return sqrtf(dx * dx + dy * dy);
+		return sqrt(dx * dx + dy * dy);
 	}
-	//Uses std::sqrtf and returns unit-accurate distance between two vec3s
+	//Uses std::sqrt and returns unit-accurate distance between two vec3s
 	inline f32 distancesqrt(
 		const vec3& a, 
 		const vec3& b)
@@ -2479,10 +3081,10 @@ namespace KalaHeaders::KalaMath
 		f32 dy = a.y - b.y;
 		f32 dz = a.z - b.z;
 
-		return sqrtf(dx * dx + dy * dy + dz * dz);
+		return sqrt(dx * dx + dy * dy + dz * dz);
 	}
 
-	//Does not use std::sqrtf and returns squared distance between two vec2s
+	//Does not use std::sqrt and returns squared distance between two vec2s
 	inline constexpr f32 distancefast(
 		const vec2 a, 
 		const vec2 b)
@@ -2492,7 +3094,7 @@ namespace KalaHeaders::KalaMath
 
 		return dx * dx + dy * dy;
 	}
-	//Does not use std::sqrtf and returns squared distance between two vec3s
+	//Does not use std::sqrt and returns squared distance between two vec3s
 	inline constexpr f32 distancefast(
 		const vec3& a, 
 		const vec3& b)
@@ -2622,11 +3224,11 @@ namespace KalaHeaders::KalaMath
 	{
 		vec3 na = normalize(axis);
 		f32 half = angle * 0.5f;
-		f32 s = sinf(half);
+		f32 s = sin(half);
 
 		return normalize_q(
 			{
-				cosf(half),
+				cos(half),
 				na.x * s,
 				na.y * s,
 				na.z * s
@@ -2732,70 +3334,806 @@ namespace KalaHeaders::KalaMath
 	
 	//================================================================================
 	//
-	// TRANSFORM
+	// BATCH KERNELS
 	//
 	//================================================================================
-	
-	enum class PosTarget
-	{
-		POS_WORLD,    //position in world space
-		POS_LOCAL,    //position relative to parent
 
-		POS_COMBINED, //final position after combining world and local position
-	};
-	enum class RotTarget
-	{
-		ROT_WORLD,   //rotation in world space
-		ROT_LOCAL,   //rotation relative to parent
+	//Span versions of the per-value helpers for large arrays. Each call processes
+	//min(in.size(), out.size()) elements, out may be the same span as an input.
+	//Elements are de-interleaved four at a time into x, y, z (and w) lanes so the
+	//SIMD backend works on SoA streams, the remainder and the scalar build go through
+	//the regular functions. Results match the scalar functions within isnear
+
+	static_assert(sizeof(vec3) == sizeof(f32) * 3, "vec3 must be tightly packed for batch kernels.");
+	static_assert(sizeof(quat) == sizeof(f32) * 4, "quat must be tightly packed for batch kernels.");
+
+#if defined(KMATH_SIMD_SSE)
+
+	using simd_f4 = __m128;
+	using simd_m4 = __m128;
+
+	inline simd_f4 simd_set1(f32 s) { return _mm_set1_ps(s); }
+	inline simd_f4 simd_add(simd_f4 a, simd_f4 b) { return _mm_add_ps(a, b); }
+	inline simd_f4 simd_sub(simd_f4 a, simd_f4 b) { return _mm_sub_ps(a, b); }
+	inline simd_f4 simd_mul(simd_f4 a, simd_f4 b) { return _mm_mul_ps(a, b); }
+	inline simd_f4 simd_div(simd_f4 a, simd_f4 b) { return _mm_div_ps(a, b); }
+	inline simd_f4 simd_sqrt(simd_f4 a) { return _mm_sqrt_ps(a); }
+	inline simd_f4 simd_abs(simd_f4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+	inline simd_m4 simd_le(simd_f4 a, simd_f4 b) { return _mm_cmple_ps(a, b); }
+	inline simd_m4 simd_lt(simd_f4 a, simd_f4 b) { return _mm_cmplt_ps(a, b); }
+	//picks a where mask is set, b otherwise
+	inline simd_f4 simd_select(simd_m4 mask, simd_f4 a, simd_f4 b)
+	{
+		return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+	}
+
+	//de-interleaves four packed vec3s into x, y and z lanes
+	inline void simd_load_vec3x4(
+		const f32* p,
+		simd_f4& x,
+		simd_f4& y,
+		simd_f4& z)
+	{
+		const __m128 a = _mm_loadu_ps(p);     //x0 y0 z0 x1
+		const __m128 b = _mm_loadu_ps(p + 4); //y1 z1 x2 y2
+		const __m128 c = _mm_loadu_ps(p + 8); //z2 x3 y3 z3
+
+		x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+		y = _mm_shuffle_ps(
+			_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+			_mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)),
+			_MM_SHUFFLE(2, 0, 2, 0));
+		z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), c, _MM_SHUFFLE(3, 0, 2, 0));
+	}
+	//interleaves x, y and z lanes back into four packed vec3s
+	inline void simd_store_vec3x4(
+		f32* p,
+		simd_f4 x,
+		simd_f4 y,
+		simd_f4 z)
+	{
+		const __m128 a = _mm_shuffle_ps(
+			_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)),
+			_mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)),
+			_MM_SHUFFLE(2, 0, 2, 0));
+		const __m128 b = _mm_shuffle_ps(
+			_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)),
+			_mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)),
+			_MM_SHUFFLE(2, 0, 2, 0));
+		const __m128 c = _mm_shuffle_ps(
+			_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)),
+			_mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)),
+			_MM_SHUFFLE(2, 0, 2, 0));
+
+		_mm_storeu_ps(p,     a);
+		_mm_storeu_ps(p + 4, b);
+		_mm_storeu_ps(p + 8, c);
+	}
+
+	//de-interleaves four packed (w, x, y, z) quats into w, x, y and z lanes
+	inline void simd_load_quatx4(
+		const f32* p,
+		simd_f4& w,
+		simd_f4& x,
+		simd_f4& y,
+		simd_f4& z)
+	{
+		w = _mm_loadu_ps(p);
+		x = _mm_loadu_ps(p + 4);
+		y = _mm_loadu_ps(p + 8);
+		z = _mm_loadu_ps(p + 12);
+		_MM_TRANSPOSE4_PS(w, x, y, z);
+	}
+	//interleaves w, x, y and z lanes back into four packed quats
+	inline void simd_store_quatx4(
+		f32* p,
+		simd_f4 w,
+		simd_f4 x,
+		simd_f4 y,
+		simd_f4 z)
+	{
+		_MM_TRANSPOSE4_PS(w, x, y, z);
+		_mm_storeu_ps(p,      w);
+		_mm_storeu_ps(p + 4,  x);
+		_mm_storeu_ps(p + 8,  y);
+		_mm_storeu_ps(p + 12, z);
+	}
+
+	inline void simd_store(f32* p, simd_f4 a) { _mm_store_ps(p, a); }
+	inline simd_f4 simd_load(const f32* p) { return _mm_load_ps(p); }
+	inline simd_f4 simd_loadu(const f32* p) { return _mm_loadu_ps(p); }
+	inline void simd_storeu(f32* p, simd_f4 a) { _mm_storeu_ps(p, a); }
+
+#elif defined(KMATH_SIMD_NEON)
+
+	using simd_f4 = float32x4_t;
+	using simd_m4 = uint32x4_t;
+
+	inline simd_f4 simd_set1(f32 s) { return vdupq_n_f32(s); }
+	inline simd_f4 simd_add(simd_f4 a, simd_f4 b) { return vaddq_f32(a, b); }
+	inline simd_f4 simd_sub(simd_f4 a, simd_f4 b) { return vsubq_f32(a, b); }
+	inline simd_f4 simd_mul(simd_f4 a, simd_f4 b) { return vmulq_f32(a, b); }
+	inline simd_f4 simd_div(simd_f4 a, simd_f4 b) { return vdivq_f32(a, b); }
+	inline simd_f4 simd_sqrt(simd_f4 a) { return vsqrtq_f32(a); }
+	inline simd_f4 simd_abs(simd_f4 a) { return vabsq_f32(a); }
+	inline simd_m4 simd_le(simd_f4 a, simd_f4 b) { return vcleq_f32(a, b); }
+	inline simd_m4 simd_lt(simd_f4 a, simd_f4 b) { return vcltq_f32(a, b); }
+	//picks a where mask is set, b otherwise
+	inline simd_f4 simd_select(simd_m4 mask, simd_f4 a, simd_f4 b) { return vbslq_f32(mask, a, b); }
+
+	//de-interleaves four packed vec3s into x, y and z lanes
+	inline void simd_load_vec3x4(
+		const f32* p,
+		simd_f4& x,
+		simd_f4& y,
+		simd_f4& z)
+	{
+		const float32x4x3_t v = vld3q_f32(p);
+		x = v.val[0];
+		y = v.val[1];
+		z = v.val[2];
+	}
+	//interleaves x, y and z lanes back into four packed vec3s
+	inline void simd_store_vec3x4(
+		f32* p,
+		simd_f4 x,
+		simd_f4 y,
+		simd_f4 z)
+	{
+		vst3q_f32(p, float32x4x3_t{ { x, y, z } });
+	}
+
+	//de-interleaves four packed (w, x, y, z) quats into w, x, y and z lanes
+	inline void simd_load_quatx4(
+		const f32* p,
+		simd_f4& w,
+		simd_f4& x,
+		simd_f4& y,
+		simd_f4& z)
+	{
+		const float32x4x4_t q = vld4q_f32(p);
+		w = q.val[0];
+		x = q.val[1];
+		y = q.val[2];
+		z = q.val[3];
+	}
+	//interleaves w, x, y and z lanes back into four packed quats
+	inline void simd_store_quatx4(
+		f32* p,
+		simd_f4 w,
+		simd_f4 x,
+		simd_f4 y,
+		simd_f4 z)
+	{
+		vst4q_f32(p, float32x4x4_t{ { w, x, y, z } });
+	}
+
+	inline void simd_store(f32* p, simd_f4 a) { vst1q_f32(p, a); }
+	inline simd_f4 simd_load(const f32* p) { return vld1q_f32(p); }
+	inline simd_f4 simd_loadu(const f32* p) { return vld1q_f32(p); }
+	inline void simd_storeu(f32* p, simd_f4 a) { vst1q_f32(p, a); }
 
-		ROT_COMBINED //final rotation after combining world and local rotation
-	};
-	enum class SizeTarget
-	{
-		SIZE_WORLD,   //size in world space
-		SIZE_LOCAL,   //size relative to parent
+#endif
 
-		SIZE_COMBINED //final position after combining world and local position
-	};
-	
-	inline constexpr vec2 MIN_POS2 = vec2(-10000.0f);
-	inline constexpr vec2 MAX_POS2 = vec2(10000.0f);
-	
-	inline constexpr vec2 MIN_SIZE2 = vec2(epsilon);
-	inline constexpr vec2 MAX_SIZE2 = vec2(10000.0f);
-	
-	struct Transform2D
+#if defined(KMATH_SIMD_SSE) || defined(KMATH_SIMD_NEON)
+
+	//normalizes count lanes of a SoA vector in place with the same rules
+	//as normalize: near unit-length lanes are kept, near zero-length lanes become 0,
+	//returns the near zero-length mask
+	inline simd_m4 simd_normalize_soa(
+		simd_f4* c,
+		int count)
 	{
-		vec2 pos_world{};
-		vec2 pos_local{};
-		vec2 pos_combined{};
+		simd_f4 len2 = simd_mul(c[0], c[0]);
+		for (int i = 1; i < count; ++i) len2 = simd_add(len2, simd_mul(c[i], c[i]));
 
-		f32 rot_world{};
-		f32 rot_local{};
-		f32 rot_combined{};
+		const simd_f4 eps = simd_set1(epsilon);
+		const simd_f4 zero = simd_set1(0.0f);
+		const simd_f4 len = simd_sqrt(len2);
 
-		vec2 size_world    = vec2(1.0f);
-		vec2 size_local    = vec2(1.0f);
-		vec2 size_combined = vec2(1.0f);
-	};
-	
-	inline constexpr vec3 MIN_POS3 = vec3(-10000.0f);
-	inline constexpr vec3 MAX_POS3 = vec3(10000.0f);
-	
-	inline constexpr vec3 MIN_SIZE3 = vec3(epsilon);
-	inline constexpr vec3 MAX_SIZE3 = vec3(10000.0f);
-	
-	struct Transform3D
-	{
-		vec3 pos_world{};
-		vec3 pos_local{};
-		vec3 pos_combined{};
+		const simd_m4 keep = simd_le(simd_abs(simd_sub(len2, simd_set1(1.0f))), eps);
+		const simd_m4 degenerate = simd_le(len, eps);
 
-		quat rot_world{};
-		quat rot_local{};
-		quat rot_combined{};
+		for (int i = 0; i < count; ++i)
+		{
+			const simd_f4 scaled = simd_select(degenerate, zero, simd_div(c[i], len));
+			c[i] = simd_select(keep, c[i], scaled);
+		}
 
-		vec3 size_world    = vec3(1.0f);
+#if defined(KMATH_SIMD_SSE)
+		return _mm_andnot_ps(keep, degenerate);
+#else
+		return vbicq_u32(degenerate, keep);
+#endif
+	}
+
+#endif
+
+	//Transforms each point by m as m * vec4(p, 1) and writes the xyz result
+	inline void transform_batch(
+		const mat4& m,
+		span<const vec3> in,
+		span<vec3> out)
+	{
+		const size_t count = min(in.size(), out.size());
+		size_t i = 0;
+
+#if defined(KMATH_SIMD_SSE) || defined(KMATH_SIMD_NEON)
+		const simd_f4 m00 = simd_set1(m.m00), m10 = simd_set1(m.m10), m20 = simd_set1(m.m20), m30 = simd_set1(m.m30);
+		const simd_f4 m01 = simd_set1(m.m01), m11 = simd_set1(m.m11), m21 = simd_set1(m.m21), m31 = simd_set1(m.m31);
+		const simd_f4 m02 = simd_set1(m.m02), m12 = simd_set1(m.m12), m22 = simd_set1(m.m22), m32 = simd_set1(m.m32);
+
+		for (; i + 4 <= count; i += 4)
+		{
+			simd_f4 x, y, z;
+			simd_load_vec3x4(&in[i].x, x, y, z);
+
+			const simd_f4 rx = simd_add(simd_add(simd_mul(m00, x), simd_mul(m10, y)), simd_add(simd_mul(m20, z), m30));
+			const simd_f4 ry = simd_add(simd_add(simd_mul(m01, x), simd_mul(m11, y)), simd_add(simd_mul(m21, z), m31));
+			const simd_f4 rz = simd_add(simd_add(simd_mul(m02, x), simd_mul(m12, y)), simd_add(simd_mul(m22, z), m32));
+
+			simd_store_vec3x4(&out[i].x, rx, ry, rz);
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			const vec3 p = in[i];
+			const vec4 r = m * vec4(p.x, p.y, p.z, 1.0f);
+			out[i] = vec3(r.x, r.y, r.z);
+		}
+	}
+
+	//Rotates each vec3 by q, same as q * v
+	inline void rotate_batch(
+		const quat& q,
+		span<const vec3> in,
+		span<vec3> out)
+	{
+		const size_t count = min(in.size(), out.size());
+		size_t i = 0;
+
+#if defined(KMATH_SIMD_SSE) || defined(KMATH_SIMD_NEON)
+		const simd_f4 qw = simd_set1(q.w);
+		const simd_f4 qx = simd_set1(q.x);
+		const simd_f4 qy = simd_set1(q.y);
+		const simd_f4 qz = simd_set1(q.z);
+		const simd_f4 two = simd_set1(2.0f);
+
+		for (; i + 4 <= count; i += 4)
+		{
+			simd_f4 x, y, z;
+			simd_load_vec3x4(&in[i].x, x, y, z);
+
+			//t = 2 * cross(q.xyz, v)
+			const simd_f4 tx = simd_mul(two, simd_sub(simd_mul(qy, z), simd_mul(qz, y)));
+			const simd_f4 ty = simd_mul(two, simd_sub(simd_mul(qz, x), simd_mul(qx, z)));
+			const simd_f4 tz = simd_mul(two, simd_sub(simd_mul(qx, y), simd_mul(qy, x)));
+
+			//v + w * t + cross(q.xyz, t)
+			const simd_f4 rx = simd_add(simd_add(x, simd_mul(qw, tx)), simd_sub(simd_mul(qy, tz), simd_mul(qz, ty)));
+			const simd_f4 ry = simd_add(simd_add(y, simd_mul(qw, ty)), simd_sub(simd_mul(qz, tx), simd_mul(qx, tz)));
+			const simd_f4 rz = simd_add(simd_add(z, simd_mul(qw, tz)), simd_sub(simd_mul(qx, ty), simd_mul(qy, tx)));
+
+			simd_store_vec3x4(&out[i].x, rx, ry, rz);
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			out[i] = q * in[i];
+		}
+	}
+
+	//Normalizes each vec3, same as normalize
+	inline void normalize_batch(
+		span<const vec3> in,
+		span<vec3> out)
+	{
+		const size_t count = min(in.size(), out.size());
+		size_t i = 0;
+
+#if defined(KMATH_SIMD_SSE) || defined(KMATH_SIMD_NEON)
+		for (; i + 4 <= count; i += 4)
+		{
+			simd_f4 c[3];
+			simd_load_vec3x4(&in[i].x, c[0], c[1], c[2]);
+			simd_normalize_soa(c, 3);
+			simd_store_vec3x4(&out[i].x, c[0], c[1], c[2]);
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			out[i] = normalize(in[i]);
+		}
+	}
+
+	//Linear interpolation between each pair of vec3s by t, same as lerp
+	inline void lerp_batch(
+		span<const vec3> a,
+		span<const vec3> b,
+		f32 t,
+		span<vec3> out)
+	{
+		const size_t count = min(min(a.size(), b.size()), out.size());
+		if (count == 0) return;
+
+		//componentwise, so the packed vec3s are treated as one flat f32 stream
+		const f32* pa = &a.data()->x;
+		const f32* pb = &b.data()->x;
+		f32* po = &out.data()->x;
+
+		const size_t floatCount = count * 3;
+		size_t i = 0;
+
+#if defined(KMATH_SIMD_SSE) || defined(KMATH_SIMD_NEON)
+		const simd_f4 tt = simd_set1(t);
+
+		for (; i + 4 <= floatCount; i += 4)
+		{
+			const simd_f4 va = simd_loadu(pa + i);
+			const simd_f4 vb = simd_loadu(pb + i);
+			simd_storeu(po + i, simd_add(va, simd_mul(simd_sub(vb, va), tt)));
+		}
+#endif
+		for (; i < floatCount; ++i)
+		{
+			po[i] = lerp(pa[i], pb[i], t);
+		}
+	}
+
+	//Spherical linear interpolation between each pair of quats by t, same as slerp
+	inline void slerp_batch(
+		span<const quat> a,
+		span<const quat> b,
+		f32 t,
+		span<quat> out)
+	{
+		const size_t count = min(min(a.size(), b.size()), out.size());
+		size_t i = 0;
+
+#if defined(KMATH_SIMD_SSE) || defined(KMATH_SIMD_NEON)
+		const simd_f4 zero = simd_set1(0.0f);
+		const simd_f4 one = simd_set1(1.0f);
+
+		for (; i + 4 <= count; i += 4)
+		{
+			simd_f4 q1[4];
+			simd_f4 q2[4];
+			simd_load_quatx4(&a[i].w, q1[0], q1[1], q1[2], q1[3]);
+			simd_load_quatx4(&b[i].w, q2[0], q2[1], q2[2], q2[3]);
+
+			//normalize_q returns identity for near zero-length quats
+			const simd_m4 zero1 = simd_normalize_soa(q1, 4);
+			const simd_m4 zero2 = simd_normalize_soa(q2, 4);
+			q1[0] = simd_select(zero1, one, q1[0]);
+			q2[0] = simd_select(zero2, one, q2[0]);
+
+			simd_f4 dotAB = simd_mul(q1[0], q2[0]);
+			for (int c = 1; c < 4; ++c) dotAB = simd_add(dotAB, simd_mul(q1[c], q2[c]));
+
+			//flip q2 where dot < 0 to take the shortest rotation path
+			const simd_m4 flip = simd_lt(dotAB, zero);
+			dotAB = simd_select(flip, simd_sub(zero, dotAB), dotAB);
+			for (int c = 0; c < 4; ++c) q2[c] = simd_select(flip, simd_sub(zero, q2[c]), q2[c]);
+
+			//there is no vector acos and sin, the weights are solved per lane,
+			//near identical quats fall back to lerp weights like slerp does
+			alignas(16) f32 dots[4];
+			alignas(16) f32 w1[4];
+			alignas(16) f32 w2[4];
+			simd_store(dots, dotAB);
+			for (int l = 0; l < 4; ++l)
+			{
+				if (dots[l] >= 1.0f - epsilon)
+				{
+					w1[l] = 1.0f - t;
+					w2[l] = t;
+					continue;
+				}
+
+				const f32 theta = acos(dots[l]);
+				const f32 sinTheta = sin(theta);
+				w1[l] = sin((1.0f - t) * theta) / sinTheta;
+				w2[l] = sin(t * theta) / sinTheta;
+			}
+
+			const simd_f4 vw1 = simd_load(w1);
+			const simd_f4 vw2 = simd_load(w2);
+
+			simd_f4 r[4];
+			for (int c = 0; c < 4; ++c) r[c] = simd_add(simd_mul(q1[c], vw1), simd_mul(q2[c], vw2));
+
+			const simd_m4 zeroR = simd_normalize_soa(r, 4);
+			r[0] = simd_select(zeroR, one, r[0]);
+
+			simd_store_quatx4(&out[i].w, r[0], r[1], r[2], r[3]);
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			out[i] = slerp(a[i], b[i], t);
+		}
+	}
+
+	//================================================================================
+	//
+	// CULLING
+	//
+	//================================================================================
+
+	//Axis-aligned bounding box
+	struct AABB
+	{
+		vec3 min{};
+		vec3 max{};
+	};
+
+	//Bounding sphere
+	struct BoundingSphere
+	{
+		vec3 center{};
+		f32 radius{};
+	};
+
+	//Six normalized planes as (nx, ny, nz, d) in the order left, right, bottom, top, near, far,
+	//a point p is on the inner side of a plane if dot(n, p) + d >= 0
+	struct Frustum
+	{
+		vec4 planes[6]{};
+	};
+
+	static_assert(sizeof(AABB) == sizeof(f32) * 6, "AABB must be tightly packed for batch culling.");
+	static_assert(sizeof(BoundingSphere) == sizeof(f32) * 4, "BoundingSphere must be tightly packed for batch culling.");
+
+	//Returns the smallest AABB that contains all points, returns an empty AABB at origin if there are no points
+	inline AABB aabbfrompoints(span<const vec3> points)
+	{
+		if (points.empty()) return {};
+
+		AABB b{ points[0], points[0] };
+		for (const vec3& p : points)
+		{
+			b.min = vec3(min(b.min.x, p.x), min(b.min.y, p.y), min(b.min.z, p.z));
+			b.max = vec3(max(b.max.x, p.x), max(b.max.y, p.y), max(b.max.z, p.z));
+		}
+
+		return b;
+	}
+
+	//Returns the bounding sphere that encloses the AABB
+	inline BoundingSphere spherefromaabb(const AABB& b)
+	{
+		const vec3 center = (b.min + b.max) * 0.5f;
+
+		return { center, length(b.max - center) };
+	}
+
+	//Returns the AABB that encloses b after it is transformed by m,
+	//m uses the same layout as createumodel with the translation in m03, m13 and m23
+	inline AABB transformaabb(
+		const AABB& b,
+		const mat4& m)
+	{
+		const vec3 c = (b.min + b.max) * 0.5f;
+		const vec3 e = (b.max - b.min) * 0.5f;
+
+		const vec3 center
+		{
+			m.m00 * c.x + m.m01 * c.y + m.m02 * c.z + m.m03,
+			m.m10 * c.x + m.m11 * c.y + m.m12 * c.z + m.m13,
+			m.m20 * c.x + m.m21 * c.y + m.m22 * c.z + m.m23
+		};
+		const vec3 extent
+		{
+			fabs(m.m00) * e.x + fabs(m.m01) * e.y + fabs(m.m02) * e.z,
+			fabs(m.m10) * e.x + fabs(m.m11) * e.y + fabs(m.m12) * e.z,
+			fabs(m.m20) * e.x + fabs(m.m21) * e.y + fabs(m.m22) * e.z
+		};
+
+		return { center - extent, center + extent };
+	}
+
+	//Returns the frustum of a projection * view matrix built from perspective or ortho and view,
+	//planes are normalized so distances can be compared against sphere radii directly
+	inline Frustum extractfrustum(const mat4& viewProj)
+	{
+		const mat4& m = viewProj;
+
+		const vec4 row0(m.m00, m.m01, m.m02, m.m03);
+		const vec4 row1(m.m10, m.m11, m.m12, m.m13);
+		const vec4 row2(m.m20, m.m21, m.m22, m.m23);
+		const vec4 row3(m.m30, m.m31, m.m32, m.m33);
+
+		Frustum f{};
+
+		f.planes[0] = row3 + row0; //left
+		f.planes[1] = row3 - row0; //right
+		f.planes[2] = row3 + row1; //bottom
+		f.planes[3] = row3 - row1; //top
+		f.planes[4] = row3 + row2; //near
+		f.planes[5] = row3 - row2; //far
+
+		for (vec4& p : f.planes)
+		{
+			const f32 len = length(vec3(p.x, p.y, p.z));
+			if (!isnear(len)) p = p / len;
+		}
+
+		return f;
+	}
+
+	//Returns true if the AABB is at least partially inside the frustum,
+	//boxes near frustum corners may pass even if they are just outside
+	inline bool isvisible(
+		const Frustum& f,
+		const AABB& b)
+	{
+		const vec3 c = (b.min + b.max) * 0.5f;
+		const vec3 e = (b.max - b.min) * 0.5f;
+
+		for (const vec4& p : f.planes)
+		{
+			const f32 dist = p.x * c.x + p.y * c.y + p.z * c.z + p.w;
+			const f32 radius = fabs(p.x) * e.x + fabs(p.y) * e.y + fabs(p.z) * e.z;
+
+			if (dist + radius < 0.0f) return false;
+		}
+
+		return true;
+	}
+	//Returns true if the sphere is at least partially inside the frustum
+	inline bool isvisible(
+		const Frustum& f,
+		const BoundingSphere& s)
+	{
+		for (const vec4& p : f.planes)
+		{
+			const f32 dist = p.x * s.center.x + p.y * s.center.y + p.z * s.center.z + p.w;
+
+			if (dist + s.radius < 0.0f) return false;
+		}
+
+		return true;
+	}
+
+#if defined(KMATH_SIMD_SSE)
+
+	inline simd_m4 simd_and(simd_m4 a, simd_m4 b) { return _mm_and_ps(a, b); }
+	//one bit per lane, lane 0 in bit 0
+	inline int simd_movemask(simd_m4 m) { return _mm_movemask_ps(m); }
+	//lanes 0 and 2 of a followed by lanes 0 and 2 of b
+	inline simd_f4 simd_even(simd_f4 a, simd_f4 b) { return _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)); }
+	//lanes 1 and 3 of a followed by lanes 1 and 3 of b
+	inline simd_f4 simd_odd(simd_f4 a, simd_f4 b) { return _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)); }
+
+#elif defined(KMATH_SIMD_NEON)
+
+	inline simd_m4 simd_and(simd_m4 a, simd_m4 b) { return vandq_u32(a, b); }
+	//one bit per lane, lane 0 in bit 0
+	inline int simd_movemask(simd_m4 m)
+	{
+		const uint32x4_t bits = vshrq_n_u32(m, 31);
+
+		return scast<int>(
+			vgetq_lane_u32(bits, 0)
+			| (vgetq_lane_u32(bits, 1) << 1)
+			| (vgetq_lane_u32(bits, 2) << 2)
+			| (vgetq_lane_u32(bits, 3) << 3));
+	}
+	//lanes 0 and 2 of a followed by lanes 0 and 2 of b
+	inline simd_f4 simd_even(simd_f4 a, simd_f4 b) { return vuzp1q_f32(a, b); }
+	//lanes 1 and 3 of a followed by lanes 1 and 3 of b
+	inline simd_f4 simd_odd(simd_f4 a, simd_f4 b) { return vuzp2q_f32(a, b); }
+
+#endif
+
+	//Tests each AABB against the frustum, writes 1 to outVisible if it is at least
+	//partially inside and 0 otherwise, same as isvisible.
+	//Processes min(bounds.size(), outVisible.size()) elements and returns how many were visible
+	inline size_t cull_batch(
+		const Frustum& f,
+		span<const AABB> bounds,
+		span<u8> outVisible)
+	{
+		const size_t count = min(bounds.size(), outVisible.size());
+		size_t visibleCount = 0;
+		size_t i = 0;
+
+#if defined(KMATH_SIMD_SSE) || defined(KMATH_SIMD_NEON)
+		simd_f4 planes[6][4];
+		simd_f4 absPlanes[6][3];
+		for (int p = 0; p < 6; ++p)
+		{
+			const vec4& plane = f.planes[p];
+			planes[p][0] = simd_set1(plane.x);
+			planes[p][1] = simd_set1(plane.y);
+			planes[p][2] = simd_set1(plane.z);
+			planes[p][3] = simd_set1(plane.w);
+			absPlanes[p][0] = simd_set1(fabs(plane.x));
+			absPlanes[p][1] = simd_set1(fabs(plane.y));
+			absPlanes[p][2] = simd_set1(fabs(plane.z));
+		}
+
+		const simd_f4 half = simd_set1(0.5f);
+		const simd_f4 zero = simd_set1(0.0f);
+
+		for (; i + 4 <= count; i += 4)
+		{
+			//four boxes are eight packed vec3s alternating between min and max
+			simd_f4 x0, y0, z0, x1, y1, z1;
+			simd_load_vec3x4(&bounds[i].min.x, x0, y0, z0);
+			simd_load_vec3x4(&bounds[i + 2].min.x, x1, y1, z1);
+
+			const simd_f4 minX = simd_even(x0, x1), maxX = simd_odd(x0, x1);
+			const simd_f4 minY = simd_even(y0, y1), maxY = simd_odd(y0, y1);
+			const simd_f4 minZ = simd_even(z0, z1), maxZ = simd_odd(z0, z1);
+
+			const simd_f4 cx = simd_mul(simd_add(minX, maxX), half);
+			const simd_f4 cy = simd_mul(simd_add(minY, maxY), half);
+			const simd_f4 cz = simd_mul(simd_add(minZ, maxZ), half);
+			const simd_f4 ex = simd_mul(simd_sub(maxX, minX), half);
+			const simd_f4 ey = simd_mul(simd_sub(maxY, minY), half);
+			const simd_f4 ez = simd_mul(simd_sub(maxZ, minZ), half);
+
+			simd_m4 inside{};
+			for (int p = 0; p < 6; ++p)
+			{
+				const simd_f4 dist = simd_add(
+					simd_add(simd_mul(planes[p][0], cx), simd_mul(planes[p][1], cy)),
+					simd_add(simd_mul(planes[p][2], cz), planes[p][3]));
+				const simd_f4 radius = simd_add(
+					simd_add(simd_mul(absPlanes[p][0], ex), simd_mul(absPlanes[p][1], ey)),
+					simd_mul(absPlanes[p][2], ez));
+
+				const simd_m4 planeInside = simd_le(zero, simd_add(dist, radius));
+				inside = p == 0 ? planeInside : simd_and(inside, planeInside);
+			}
+
+			const int bits = simd_movemask(inside);
+			for (int l = 0; l < 4; ++l)
+			{
+				const u8 visible = scast<u8>((bits >> l) & 1);
+				outVisible[i + l] = visible;
+				visibleCount += visible;
+			}
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			const u8 visible = isvisible(f, bounds[i]) ? 1 : 0;
+			outVisible[i] = visible;
+			visibleCount += visible;
+		}
+
+		return visibleCount;
+	}
+
+	//Tests each sphere against the frustum, writes 1 to outVisible if it is at least
+	//partially inside and 0 otherwise, same as isvisible.
+	//Processes min(bounds.size(), outVisible.size()) elements and returns how many were visible
+	inline size_t cull_batch(
+		const Frustum& f,
+		span<const BoundingSphere> bounds,
+		span<u8> outVisible)
+	{
+		const size_t count = min(bounds.size(), outVisible.size());
+		size_t visibleCount = 0;
+		size_t i = 0;
+
+#if defined(KMATH_SIMD_SSE) || defined(KMATH_SIMD_NEON)
+		simd_f4 planes[6][4];
+		for (int p = 0; p < 6; ++p)
+		{
+			const vec4& plane = f.planes[p];
+			planes[p][0] = simd_set1(plane.x);
+			planes[p][1] = simd_set1(plane.y);
+			planes[p][2] = simd_set1(plane.z);
+			planes[p][3] = simd_set1(plane.w);
+		}
+
+		const simd_f4 zero = simd_set1(0.0f);
+
+		for (; i + 4 <= count; i += 4)
+		{
+			//four spheres have the same layout as four packed quats
+			simd_f4 cx, cy, cz, r;
+			simd_load_quatx4(&bounds[i].center.x, cx, cy, cz, r);
+
+			simd_m4 inside{};
+			for (int p = 0; p < 6; ++p)
+			{
+				const simd_f4 dist = simd_add(
+					simd_add(simd_mul(planes[p][0], cx), simd_mul(planes[p][1], cy)),
+					simd_add(simd_mul(planes[p][2], cz), planes[p][3]));
+
+				const simd_m4 planeInside = simd_le(zero, simd_add(dist, r));
+				inside = p == 0 ? planeInside : simd_and(inside, planeInside);
+			}
+
+			const int bits = simd_movemask(inside);
+			for (int l = 0; l < 4; ++l)
+			{
+				const u8 visible = scast<u8>((bits >> l) & 1);
+				outVisible[i + l] = visible;
+				visibleCount += visible;
+			}
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			const u8 visible = isvisible(f, bounds[i]) ? 1 : 0;
+			outVisible[i] = visible;
+			visibleCount += visible;
+		}
+
+		return visibleCount;
+	}
+
+	//================================================================================
+	//
+	// TRANSFORM
+	//
+	//================================================================================
+	
+	enum class PosTarget
+	{
+		POS_WORLD,    //position in world space
+		POS_LOCAL,    //position relative to parent
+
+		POS_COMBINED, //final position after combining world and local position
+	};
+	enum class RotTarget
+	{
+		ROT_WORLD,   //rotation in world space
+		ROT_LOCAL,   //rotation relative to parent
+
+		ROT_COMBINED //final rotation after combining world and local rotation
+	};
+	enum class SizeTarget
+	{
+		SIZE_WORLD,   //size in world space
+		SIZE_LOCAL,   //size relative to parent
+
+		SIZE_COMBINED //final position after combining world and local position
+	};
+	
+	inline constexpr vec2 MIN_POS2 = vec2(-10000.0f);
+	inline constexpr vec2 MAX_POS2 = vec2(10000.0f);
+	
+	inline constexpr vec2 MIN_SIZE2 = vec2(epsilon);
+	inline constexpr vec2 MAX_SIZE2 = vec2(10000.0f);
+	
+	struct Transform2D
+	{
+		vec2 pos_world{};
+		vec2 pos_local{};
+		vec2 pos_combined{};
+
+		f32 rot_world{};
+		f32 rot_local{};
+		f32 rot_combined{};
+
+		vec2 size_world    = vec2(1.0f);
+		vec2 size_local    = vec2(1.0f);
+		vec2 size_combined = vec2(1.0f);
+	};
+	
+	inline constexpr vec3 MIN_POS3 = vec3(-10000.0f);
+	inline constexpr vec3 MAX_POS3 = vec3(10000.0f);
+	
+	inline constexpr vec3 MIN_SIZE3 = vec3(epsilon);
+	inline constexpr vec3 MAX_SIZE3 = vec3(10000.0f);
+	
+	struct Transform3D
+	{
+		vec3 pos_world{};
+		vec3 pos_local{};
+		vec3 pos_combined{};
+
+		quat rot_world{};
+		quat rot_local{};
+		quat rot_combined{};
+
+		vec3 size_world    = vec3(1.0f);
 		vec3 size_local    = vec3(1.0f);
 		vec3 size_combined = vec3(1.0f);
 	};
@@ -2829,8 +4167,8 @@ namespace KalaHeaders::KalaMath
 			f32 rads = radians(parent.rot_combined);
 			mat3 rot_mat =
 			{
-				cosf(rads), -sinf(rads), 0.0f,
-				sinf(rads),  cosf(rads), 0.0f,
+				cos(rads), -sin(rads), 0.0f,
+				sin(rads),  cos(rads), 0.0f,
 				0.0f,        0.0f,       1.0f
 			};
 
@@ -2919,13 +4257,13 @@ namespace KalaHeaders::KalaMath
 	inline constexpr vec2 getdirright(Transform2D& target)
 	{
 		float r = radians(target.rot_combined);
-		return vec2(cosf(r), sinf(r));
+		return vec2(cos(r), sin(r));
 	}
 	//Returns true local up direction of this transform
 	inline constexpr vec2 getdirup(Transform2D& target)
 	{
 		float r = radians(target.rot_combined);
-		return vec2(-sinf(r), cosf(r));
+		return vec2(-sin(r), cos(r));
 	}
 	
 	//Takes in rotation in euler (degrees) and incrementally rotates over time,
@@ -3072,6 +4410,8 @@ namespace KalaHeaders::KalaMath
 		Transform3D& target,
 		const Transform3D& parent)
 	{
+		KPROFILE_ZONE("combine3d");
+
 		if (!isidentity(parent.pos_combined)
 			|| !isidentity_q(parent.rot_combined)
 			|| !isnear(parent.size_combined, vec3(1.0f)))
@@ -3517,4 +4857,560 @@ namespace KalaHeaders::KalaMath
 		case SizeTarget::SIZE_COMBINED: return target.size_combined;
 		}
 	};
-}
+	
+	//================================================================================
+	//
+	// TRANSFORM HIERARCHY
+	//
+	//================================================================================
+	
+	//Stable handle of a node in a TransformHierarchy
+	using TransformNode = u32;
+	
+	inline constexpr TransformNode INVALID_TRANSFORM_NODE = UINT32_MAX;
+	
+	//Min nodes in a depth level before update splits it across threads
+	inline constexpr u32 PARALLEL_TRANSFORM_LEVEL_SIZE = 4096;
+	
+	//Structure-of-arrays container for many 3D transforms with parent links.
+	//Nodes are kept sorted by depth so parents are always combined before their children,
+	//setters only mark nodes dirty and update combines the dirty nodes and everything below them.
+	//Roots combine to their world values, children combine as
+	//  rot_combined  = parent rot_combined * rot_world * rot_local
+	//  size_combined = parent size_combined * size_world * size_local
+	//  pos_combined  = parent pos_combined + pos_world + parent rot_combined * pos_local
+	class TransformHierarchy
+	{
+	public:
+		//Adds a node under parent, or a root if parent is INVALID_TRANSFORM_NODE,
+		//returns INVALID_TRANSFORM_NODE if parent does not exist
+		TransformNode add(
+			TransformNode parentNode = INVALID_TRANSFORM_NODE,
+			const Transform3D& t = {})
+		{
+			u32 parentIndex = INVALID_TRANSFORM_NODE;
+			if (parentNode != INVALID_TRANSFORM_NODE)
+			{
+				if (!contains(parentNode)) return INVALID_TRANSFORM_NODE;
+				parentIndex = handleToIndex[parentNode];
+			}
+
+			TransformNode handle{};
+			if (!freeHandles.empty())
+			{
+				handle = freeHandles.back();
+				freeHandles.pop_back();
+			}
+			else
+			{
+				handle = scast<TransformNode>(handleToIndex.size());
+				handleToIndex.push_back(INVALID_TRANSFORM_NODE);
+			}
+
+			const u32 index = scast<u32>(parent.size());
+			handleToIndex[handle] = index;
+			indexToHandle.push_back(handle);
+			parent.push_back(parentIndex);
+			dirty.push_back(1);
+
+			pos_world.push_back(t.pos_world);
+			pos_local.push_back(t.pos_local);
+			pos_combined.push_back(t.pos_combined);
+			rot_world.push_back(t.rot_world);
+			rot_local.push_back(t.rot_local);
+			rot_combined.push_back(t.rot_combined);
+			size_world.push_back(t.size_world);
+			size_local.push_back(t.size_local);
+			size_combined.push_back(t.size_combined);
+
+			//appending keeps the depth order unless the new node is shallower than the last one
+			const u32 depth = (parentIndex == INVALID_TRANSFORM_NODE)
+				? 0
+				: nodeDepth[parentIndex] + 1;
+
+			if (!isOrderDirty)
+			{
+				if (levelStart.empty()) levelStart = { 0, 1 };
+				else if (depth == nodeDepth.back()) levelStart.back() = index + 1;
+				else if (depth == nodeDepth.back() + 1) levelStart.push_back(index + 1);
+				else isOrderDirty = true;
+			}
+
+			nodeDepth.push_back(depth);
+
+			++dirtyCount;
+
+			return handle;
+		}
+
+		//Removes a node and every node below it
+		void remove(TransformNode node)
+		{
+			if (!contains(node)) return;
+
+			sortByDepth();
+
+			//depth order means every parent is visited before its children
+			const u32 count = scast<u32>(parent.size());
+			vector<u8> removed(count, 0);
+			removed[handleToIndex[node]] = 1;
+
+			for (u32 i = 0; i < count; ++i)
+			{
+				if (parent[i] != INVALID_TRANSFORM_NODE
+					&& removed[parent[i]])
+				{
+					removed[i] = 1;
+				}
+			}
+
+			vector<u32> order{};
+			order.reserve(count);
+			for (u32 i = 0; i < count; ++i)
+			{
+				if (removed[i])
+				{
+					freeHandles.push_back(indexToHandle[i]);
+					handleToIndex[indexToHandle[i]] = INVALID_TRANSFORM_NODE;
+				}
+				else order.push_back(i);
+			}
+
+			permute(order);
+			rebuildLevels();
+		}
+
+		//Moves node below a new parent, or makes it a root if parent is INVALID_TRANSFORM_NODE,
+		//returns false if either node does not exist or the new parent is inside node's subtree
+		bool setparent(
+			TransformNode node,
+			TransformNode parentNode)
+		{
+			if (!contains(node)) return false;
+
+			u32 parentIndex = INVALID_TRANSFORM_NODE;
+			if (parentNode != INVALID_TRANSFORM_NODE)
+			{
+				if (!contains(parentNode)) return false;
+				parentIndex = handleToIndex[parentNode];
+
+				//refuse cycles
+				for (u32 i = parentIndex; i != INVALID_TRANSFORM_NODE; i = parent[i])
+				{
+					if (i == handleToIndex[node]) return false;
+				}
+			}
+
+			const u32 index = handleToIndex[node];
+			parent[index] = parentIndex;
+			markdirty(index);
+			isOrderDirty = true;
+
+			return true;
+		}
+		TransformNode getparent(TransformNode node) const
+		{
+			if (!contains(node)) return INVALID_TRANSFORM_NODE;
+
+			const u32 p = parent[handleToIndex[node]];
+			return p == INVALID_TRANSFORM_NODE
+				? INVALID_TRANSFORM_NODE
+				: indexToHandle[p];
+		}
+
+		bool contains(TransformNode node) const
+		{
+			return node < handleToIndex.size()
+				&& handleToIndex[node] != INVALID_TRANSFORM_NODE;
+		}
+		size_t size() const { return parent.size(); }
+		bool isdirty() const { return dirtyCount > 0 || isOrderDirty; }
+
+		void clear()
+		{
+			*this = TransformHierarchy{};
+		}
+
+		//Snaps the world or local position, clamped between MIN_POS3 and MAX_POS3
+		void setpos(
+			TransformNode node,
+			PosTarget type,
+			const vec3& pos_new)
+		{
+			if (!contains(node)) return;
+
+			const u32 i = handleToIndex[node];
+			const vec3 pos_clamped = kclamp(pos_new, MIN_POS3, MAX_POS3);
+
+			switch (type)
+			{
+			default: return;
+			case PosTarget::POS_WORLD: pos_world[i] = pos_clamped; break;
+			case PosTarget::POS_LOCAL: pos_local[i] = pos_clamped; break;
+			}
+
+			markdirty(i);
+		}
+		//Snaps the world or local rotation, normalized
+		void setrot(
+			TransformNode node,
+			RotTarget type,
+			const quat& rot_new)
+		{
+			if (!contains(node)) return;
+
+			const u32 i = handleToIndex[node];
+			const quat rot_clamped = normalize_q(rot_new);
+
+			switch (type)
+			{
+			default: return;
+			case RotTarget::ROT_WORLD: rot_world[i] = rot_clamped; break;
+			case RotTarget::ROT_LOCAL: rot_local[i] = rot_clamped; break;
+			}
+
+			markdirty(i);
+		}
+		//Snaps the world or local size, clamped between MIN_SIZE3 and MAX_SIZE3
+		void setsize(
+			TransformNode node,
+			SizeTarget type,
+			const vec3& size_new)
+		{
+			if (!contains(node)) return;
+
+			const u32 i = handleToIndex[node];
+			const vec3 size_clamped = kclamp(size_new, MIN_SIZE3, MAX_SIZE3);
+
+			switch (type)
+			{
+			default: return;
+			case SizeTarget::SIZE_WORLD: size_world[i] = size_clamped; break;
+			case SizeTarget::SIZE_LOCAL: size_local[i] = size_clamped; break;
+			}
+
+			markdirty(i);
+		}
+
+		//Combined values are only current after update
+		vec3 getpos(
+			TransformNode node,
+			PosTarget type) const
+		{
+			if (!contains(node)) return {};
+
+			const u32 i = handleToIndex[node];
+			switch (type)
+			{
+			default: return {};
+			case PosTarget::POS_WORLD:    return pos_world[i];
+			case PosTarget::POS_LOCAL:    return pos_local[i];
+			case PosTarget::POS_COMBINED: return pos_combined[i];
+			}
+		}
+		quat getrot(
+			TransformNode node,
+			RotTarget type) const
+		{
+			if (!contains(node)) return {};
+
+			const u32 i = handleToIndex[node];
+			switch (type)
+			{
+			default: return {};
+			case RotTarget::ROT_WORLD:    return rot_world[i];
+			case RotTarget::ROT_LOCAL:    return rot_local[i];
+			case RotTarget::ROT_COMBINED: return rot_combined[i];
+			}
+		}
+		vec3 getsize(
+			TransformNode node,
+			SizeTarget type) const
+		{
+			if (!contains(node)) return {};
+
+			const u32 i = handleToIndex[node];
+			switch (type)
+			{
+			default: return {};
+			case SizeTarget::SIZE_WORLD:    return size_world[i];
+			case SizeTarget::SIZE_LOCAL:    return size_local[i];
+			case SizeTarget::SIZE_COMBINED: return size_combined[i];
+			}
+		}
+
+		//Returns every field of a node as a Transform3D
+		Transform3D get(TransformNode node) const
+		{
+			if (!contains(node)) return {};
+
+			const u32 i = handleToIndex[node];
+			Transform3D t{};
+			t.pos_world     = pos_world[i];
+			t.pos_local     = pos_local[i];
+			t.pos_combined  = pos_combined[i];
+			t.rot_world     = rot_world[i];
+			t.rot_local     = rot_local[i];
+			t.rot_combined  = rot_combined[i];
+			t.size_world    = size_world[i];
+			t.size_local    = size_local[i];
+			t.size_combined = size_combined[i];
+
+			return t;
+		}
+
+		//Combines every dirty node and its subtree in one pass per depth level.
+		//If parallel is set, levels with at least PARALLEL_TRANSFORM_LEVEL_SIZE nodes
+		//are split across threadCount threads, 0 uses hardware concurrency
+		void update(
+			bool parallel = false,
+			u32 threadCount = 0)
+		{
+			KPROFILE_ZONE("TransformHierarchy::update");
+
+			sortByDepth();
+
+			if (dirtyCount == 0) return;
+
+			const u32 levelCount = levelStart.empty()
+				? 0
+				: scast<u32>(levelStart.size() - 1);
+
+			u32 widestLevel{};
+			for (u32 l = 0; l < levelCount; ++l)
+			{
+				widestLevel = max(widestLevel, levelStart[l + 1] - levelStart[l]);
+			}
+
+			if (threadCount == 0) threadCount = max(1u, thread::hardware_concurrency());
+
+			if (!parallel
+				|| threadCount < 2
+				|| widestLevel < PARALLEL_TRANSFORM_LEVEL_SIZE)
+			{
+				for (u32 l = 0; l < levelCount; ++l)
+				{
+					combinerange(levelStart[l], levelStart[l + 1]);
+				}
+			}
+			else
+			{
+				//every thread takes its slice of each level, the barrier keeps levels in order
+				barrier sync(threadCount);
+
+				auto work = [&](u32 t)
+					{
+						for (u32 l = 0; l < levelCount; ++l)
+						{
+							const u32 first = levelStart[l];
+							const u32 count = levelStart[l + 1] - first;
+
+							if (count < PARALLEL_TRANSFORM_LEVEL_SIZE)
+							{
+								if (t == 0) combinerange(first, first + count);
+							}
+							else
+							{
+								const u32 chunk = (count + threadCount - 1) / threadCount;
+								const u32 begin = min(count, t * chunk);
+								const u32 end = min(count, begin + chunk);
+								combinerange(first + begin, first + end);
+							}
+
+							sync.arrive_and_wait();
+						}
+					};
+
+				vector<thread> workers{};
+				workers.reserve(threadCount - 1);
+				for (u32 t = 1; t < threadCount; ++t) workers.emplace_back(work, t);
+
+				work(0);
+
+				for (auto& w : workers) w.join();
+			}
+
+			std::fill(dirty.begin(), dirty.end(), 0);
+			dirtyCount = 0;
+		}
+
+		//SoA fields indexed by depth-sorted node index, use the handle getters and setters
+		//unless iterating every node, the order changes after add, remove and setparent
+
+		vector<vec3> pos_world{};
+		vector<vec3> pos_local{};
+		vector<vec3> pos_combined{};
+
+		vector<quat> rot_world{};
+		vector<quat> rot_local{};
+		vector<quat> rot_combined{};
+
+		vector<vec3> size_world{};
+		vector<vec3> size_local{};
+		vector<vec3> size_combined{};
+
+		vector<u32> parent{}; //parent index or INVALID_TRANSFORM_NODE for roots
+	private:
+		void markdirty(u32 index)
+		{
+			if (dirty[index]) return;
+
+			dirty[index] = 1;
+			++dirtyCount;
+		}
+
+		//Combines nodes [first, last) of one depth level, a node is recombined
+		//if it or its parent was dirty, and passes that on to its own children
+		void combinerange(
+			u32 first,
+			u32 last)
+		{
+			for (u32 i = first; i < last; ++i)
+			{
+				const u32 p = parent[i];
+
+				if (p == INVALID_TRANSFORM_NODE)
+				{
+					if (!dirty[i]) continue;
+
+					pos_combined[i] = pos_world[i];
+					rot_combined[i] = rot_world[i];
+					size_combined[i] = size_world[i];
+
+					continue;
+				}
+
+				if (!dirty[i]
+					&& !dirty[p])
+				{
+					continue;
+				}
+
+				//children of this node are in later levels and read this flag
+				dirty[i] = 1;
+
+				rot_combined[i] = rot_combined[p] * rot_world[i] * rot_local[i];
+				size_combined[i] = size_combined[p] * size_world[i] * size_local[i];
+				pos_combined[i] = pos_combined[p] + pos_world[i] + rot_combined[p] * pos_local[i];
+			}
+		}
+
+		//Stable counting sort of every node by depth, only runs after structural changes
+		void sortByDepth()
+		{
+			if (!isOrderDirty) return;
+
+			const u32 count = scast<u32>(parent.size());
+
+			//resolve depths with an explicit stack so deep chains do not recurse
+
+			vector<u32> depth(count, INVALID_TRANSFORM_NODE);
+			vector<u32> stack{};
+			u32 maxDepth{};
+
+			for (u32 i = 0; i < count; ++i)
+			{
+				u32 n = i;
+				while (n != INVALID_TRANSFORM_NODE
+					&& depth[n] == INVALID_TRANSFORM_NODE)
+				{
+					stack.push_back(n);
+					n = parent[n];
+				}
+
+				u32 d = (n == INVALID_TRANSFORM_NODE) ? 0 : depth[n] + 1;
+				while (!stack.empty())
+				{
+					depth[stack.back()] = d++;
+					stack.pop_back();
+				}
+			}
+			for (u32 i = 0; i < count; ++i) maxDepth = max(maxDepth, depth[i]);
+
+			vector<u32> offset(count > 0 ? maxDepth + 2 : 1, 0);
+			for (u32 i = 0; i < count; ++i) ++offset[depth[i] + 1];
+			for (size_t l = 1; l < offset.size(); ++l) offset[l] += offset[l - 1];
+
+			vector<u32> order(count);
+			vector<u32> cursor = offset;
+			for (u32 i = 0; i < count; ++i) order[cursor[depth[i]]++] = i;
+
+			//structural changes move subtrees so everything below them must recombine
+			for (u32 i = 0; i < count; ++i) markdirty(i);
+
+			permute(order);
+
+			nodeDepth.resize(count);
+			for (u32 i = 0; i < count; ++i) nodeDepth[i] = depth[order[i]];
+
+			levelStart = count > 0 ? std::move(offset) : vector<u32>{};
+			isOrderDirty = false;
+		}
+
+		//Keeps only the nodes in order, in that order, and remaps parents and handles
+		void permute(const vector<u32>& order)
+		{
+			const u32 oldCount = scast<u32>(parent.size());
+
+			vector<u32> remap(oldCount, INVALID_TRANSFORM_NODE);
+			for (u32 i = 0; i < order.size(); ++i) remap[order[i]] = i;
+
+			auto apply = [&order](auto& field)
+				{
+					std::remove_reference_t<decltype(field)> sorted{};
+					sorted.reserve(order.size());
+					for (u32 i : order) sorted.push_back(field[i]);
+					field = std::move(sorted);
+				};
+
+			apply(pos_world);
+			apply(pos_local);
+			apply(pos_combined);
+			apply(rot_world);
+			apply(rot_local);
+			apply(rot_combined);
+			apply(size_world);
+			apply(size_local);
+			apply(size_combined);
+			apply(dirty);
+			apply(indexToHandle);
+			if (nodeDepth.size() == oldCount) apply(nodeDepth);
+
+			apply(parent);
+			for (u32& p : parent)
+			{
+				if (p != INVALID_TRANSFORM_NODE) p = remap[p];
+			}
+
+			for (u32 i = 0; i < indexToHandle.size(); ++i) handleToIndex[indexToHandle[i]] = i;
+
+			dirtyCount = 0;
+			for (u8 d : dirty) dirtyCount += d;
+		}
+
+		//Rebuilds level offsets from nodeDepth after a removal kept the depth order
+		void rebuildLevels()
+		{
+			levelStart.clear();
+			if (parent.empty()) return;
+
+			levelStart.push_back(0);
+			for (u32 i = 1; i < nodeDepth.size(); ++i)
+			{
+				if (nodeDepth[i] != nodeDepth[i - 1]) levelStart.push_back(i);
+			}
+			levelStart.push_back(scast<u32>(nodeDepth.size()));
+		}
+
+		vector<u8> dirty{};
+		vector<u32> nodeDepth{};
+		vector<u32> levelStart{}; //first index of each depth level, last entry is the node count
+
+		vector<u32> handleToIndex{};
+		vector<TransformNode> indexToHandle{};
+		vector<TransformNode> freeHandles{};
+
+		u32 dirtyCount{};
+		bool isOrderDirty{};
+	};
+}
\ No newline at end of file
@@ -0,0 +1,1174 @@
+//---------------------------------------------------------------------------
+// profile_utils.hpp
+//
+// Copyright (C) 2026 Lost Empire Entertainment
+//
+// This is free source code, and you are welcome to redistribute it under certain conditions.
+// Read LICENSE.md for more information.
+//
+// Provides:
+//   - scoped zones - KPROFILE_ZONE records a named static zone descriptor with its start and end time
+//   - counters - KPROFILE_COUNTER adds to a named static counter and samples its total for the trace
+//   - per-thread lock-free event rings drained by Collect, with dropped event counts
+//   - steady_clock timestamps, or calibrated rdtsc timestamps on x86 (define KPROFILE_USE_RDTSC)
+//   - compiled out entirely unless KPROFILE_ENABLED is defined, every macro is removed with its arguments
+//   - zone statistics - call count, total, min and max time per zone
+//   - Chrome trace exporter - json for chrome://tracing, Perfetto and the Tracy import-chrome tool
+//   - BenchmarkSuite - calibrated single-threaded and contended benchmarks with json results and baseline comparison
+//---------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <barrier>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <mutex>
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+
+#if defined(KPROFILE_USE_RDTSC) \
+	&& (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86))
+	#ifdef _MSC_VER
+		#include <intrin.h>
+	#else
+		#include <x86intrin.h>
+	#endif
+	#define KPROFILE_RDTSC
+#endif
+
+//static_cast
+#ifndef scast
+	#define scast static_cast
+#endif
+
+//reinterpret_cast
+#ifndef rcast
+	#define rcast reinterpret_cast
+#endif
+
+//
+// PROFILER MACROS
+//
+
+//The other headers define empty fallbacks of these macros and mark them with KPROFILE_HOOKS_FALLBACK,
+//so this header must be included before them for their zones and counters to be recorded.
+//KPROFILE_ENABLED must have the same value in every translation unit of a program
+//because it changes the bodies of inline functions
+#if defined(KPROFILE_ENABLED) && defined(KPROFILE_HOOKS_FALLBACK)
+	#error "profile_utils.hpp must be included before the headers it profiles"
+#endif
+
+#define KPROFILE_CONCAT_INNER(a, b) a##b
+#define KPROFILE_CONCAT(a, b) KPROFILE_CONCAT_INNER(a, b)
+
+#ifdef KPROFILE_ENABLED
+	//Records the rest of the enclosing scope as one zone, name must be a string literal
+	#define KPROFILE_ZONE(name) \
+		static constexpr KalaHeaders::KalaProfile::ZoneDescriptor KPROFILE_CONCAT(kprofileZone, __LINE__){ name, __FILE__, __LINE__ }; \
+		const KalaHeaders::KalaProfile::ScopedZone KPROFILE_CONCAT(kprofileScope, __LINE__)(&KPROFILE_CONCAT(kprofileZone, __LINE__))
+
+	//Adds value to a named counter and samples its new total, name must be a string literal
+	#define KPROFILE_COUNTER(name, value) \
+		do \
+		{ \
+			static KalaHeaders::KalaProfile::CounterDescriptor kprofileCounter{ name }; \
+			KalaHeaders::KalaProfile::Profile::AddCounter(kprofileCounter, static_cast<KalaHeaders::KalaProfile::i64>(value)); \
+		} while (0)
+
+	//Names the calling thread in exported traces
+	#define KPROFILE_THREAD_NAME(name) KalaHeaders::KalaProfile::Profile::SetThreadName(name)
+#else
+	#define KPROFILE_ZONE(name)
+	#define KPROFILE_COUNTER(name, value) do {} while (0)
+	#define KPROFILE_THREAD_NAME(name) do {} while (0)
+#endif
+
+namespace KalaHeaders::KalaProfile
+{
+	using std::string;
+	using std::string_view;
+	using std::to_string;
+	using std::snprintf;
+	using std::strtod;
+	using std::strtoul;
+	using std::sqrt;
+	using std::atomic;
+	using std::memory_order_relaxed;
+	using std::memory_order_acquire;
+	using std::memory_order_release;
+	using std::mutex;
+	using std::scoped_lock;
+	using std::unique_ptr;
+	using std::make_unique;
+	using std::shared_ptr;
+	using std::make_shared;
+	using std::vector;
+	using std::sort;
+	using std::find_if;
+	using std::pair;
+	using std::min;
+	using std::max;
+	using std::ofstream;
+	using std::ifstream;
+	using std::getline;
+	using std::thread;
+	using std::barrier;
+	using std::ios;
+	using std::chrono::steady_clock;
+	using std::chrono::duration_cast;
+	using std::chrono::nanoseconds;
+	using std::chrono::milliseconds;
+	using std::this_thread::sleep_for;
+	using std::filesystem::path;
+	using std::filesystem::exists;
+	using std::filesystem::create_directories;
+
+	using u8 = uint8_t;
+	using u32 = uint32_t;
+	using u64 = uint64_t;
+	using i64 = int64_t;
+	using f64 = double;
+
+	//Default events each thread ring can hold before Collect has to drain it, must be a power of two
+	constexpr u32 DEFAULT_PROFILE_RING_SIZE = 65536;
+	//Shortest rdtsc calibration window, longer windows give a more accurate tick rate
+	constexpr u32 RDTSC_CALIBRATION_MS = 10;
+
+	static_assert((DEFAULT_PROFILE_RING_SIZE & (DEFAULT_PROFILE_RING_SIZE - 1)) == 0, "DEFAULT_PROFILE_RING_SIZE must be a power of two");
+
+	//One per KPROFILE_ZONE call site, lives in static storage so events only store its address
+	struct ZoneDescriptor
+	{
+		const char* name{};
+		const char* file{};
+		u32 line{};
+	};
+
+	//One per KPROFILE_COUNTER call site, registered with the profiler on first use
+	struct CounterDescriptor
+	{
+		const char* name{};
+		atomic<i64> value{};
+		atomic<bool> isRegistered{};
+	};
+
+	enum class ProfileEventKind : u8
+	{
+		EVENT_ZONE    = 0, //start and end ticks of a zone
+		EVENT_COUNTER = 1  //counter total at start ticks
+	};
+
+	struct ProfileEvent
+	{
+		const void* descriptor{}; //ZoneDescriptor or CounterDescriptor depending on kind
+		u64 start{};              //ticks when the zone started or the counter changed
+		i64 value{};              //end ticks of a zone or the counter total
+		ProfileEventKind kind{};
+	};
+
+	//Single producer ring, only the owning thread pushes and only Collect pops
+	struct ThreadProfileBuffer
+	{
+		unique_ptr<ProfileEvent[]> events{};
+		size_t mask{};
+
+		alignas(64) atomic<size_t> writePos{}; //next slot the owning thread fills
+		alignas(64) atomic<size_t> readPos{};  //every event before this has been collected
+		atomic<u64> droppedCount{};            //events lost because the ring was full
+		atomic<bool> isExited{};               //set once the owning thread can't push anymore
+
+		u32 threadId{};    //sequential id in registration order, used as the trace tid
+		string threadName; //guarded by the registry lock
+	};
+
+	//Owned by each recording thread, marks its buffer as exited when the thread ends
+	struct ThreadProfileHandle
+	{
+		shared_ptr<ThreadProfileBuffer> buffer{};
+
+		~ThreadProfileHandle()
+		{
+			if (buffer) buffer->isExited.store(true, memory_order_release);
+		}
+	};
+
+	//Event copied out of a thread ring by Collect
+	struct CapturedEvent
+	{
+		ProfileEvent event{};
+		u32 threadId{};
+	};
+
+	struct ProfileRegistry
+	{
+		mutex lock{};
+		vector<shared_ptr<ThreadProfileBuffer>> buffers{}; //kept after their thread exits until collected
+		vector<CounterDescriptor*> counters{};
+		vector<CapturedEvent> captured{};
+		vector<pair<u32, string>> threadNames{}; //names of collected threads that have exited
+
+		u32 nextThreadId = 1;
+		u32 ringSize = DEFAULT_PROFILE_RING_SIZE;
+		u64 droppedTotal{}; //dropped events of buffers that were already released
+	};
+
+	//Timestamp origin and rate, ticks are nanoseconds unless rdtsc is used
+	struct ProfileClock
+	{
+		u64 originTicks{};
+		u64 originNs{};
+	};
+
+	struct ZoneStats
+	{
+		const ZoneDescriptor* zone{};
+		u64 count{};
+		f64 totalMs{};
+		f64 minMs{};
+		f64 maxMs{};
+	};
+
+	struct CounterValue
+	{
+		const char* name{};
+		i64 value{};
+	};
+
+	//Appends text as the inside of a json string
+	inline void AppendJsonEscaped(
+		string& out,
+		string_view text)
+	{
+		for (char ch : text)
+		{
+			switch (ch)
+			{
+			case '"':  out += "\\\""; break;
+			case '\\': out += "\\\\"; break;
+			case '\n': out += "\\n"; break;
+			case '\r': out += "\\r"; break;
+			case '\t': out += "\\t"; break;
+			default:
+				if (scast<u8>(ch) < 0x20)
+				{
+					char escaped[8]{};
+					snprintf(escaped, sizeof(escaped), "\\u%04x", scast<u32>(scast<u8>(ch)));
+					out += escaped;
+				}
+				else out += ch;
+				break;
+			}
+		}
+	}
+
+	class Profile
+	{
+	public:
+		//Current raw timestamp in ticks
+		static inline u64 Now()
+		{
+#ifdef KPROFILE_RDTSC
+			return scast<u64>(__rdtsc());
+#else
+			return SteadyNs();
+#endif
+		}
+
+		//Zones and counter samples are only stored while recording, counters always keep adding up
+		static inline void SetRecording(bool state) { recording().store(state, memory_order_relaxed); }
+		static inline bool IsRecording() { return recording().load(memory_order_relaxed); }
+
+		//Ring size of threads that record their first event after this call,
+		//rounded up to a power of two
+		static inline void SetRingSize(u32 size)
+		{
+			u32 rounded = 1;
+			while (rounded < size
+				&& rounded < (1u << 30))
+			{
+				rounded <<= 1;
+			}
+
+			ProfileRegistry& r = registry();
+			scoped_lock lock(r.lock);
+			r.ringSize = rounded;
+		}
+
+		//Names the calling thread in exported traces
+		static inline void SetThreadName(string_view name)
+		{
+			ThreadProfileBuffer& b = threadBuffer();
+
+			ProfileRegistry& r = registry();
+			scoped_lock lock(r.lock);
+			b.threadName = string(name);
+		}
+
+		//Stores one finished zone in the calling thread ring
+		static inline void RecordZone(
+			const ZoneDescriptor* zone,
+			u64 start,
+			u64 end)
+		{
+			Push(
+			{
+				zone,
+				start,
+				scast<i64>(end),
+				ProfileEventKind::EVENT_ZONE
+			});
+		}
+
+		static inline void AddCounter(
+			CounterDescriptor& counter,
+			i64 value)
+		{
+			if (!counter.isRegistered.load(memory_order_acquire)) RegisterCounter(counter);
+
+			const i64 total = counter.value.fetch_add(value, memory_order_relaxed) + value;
+
+			if (IsRecording())
+			{
+				Push(
+				{
+					&counter,
+					Now(),
+					total,
+					ProfileEventKind::EVENT_COUNTER
+				});
+			}
+		}
+
+		//Moves every recorded event out of the thread rings into the capture
+		//and releases the rings of exited threads, returns how many events were moved.
+		//Call it regularly in long sessions so the rings don't fill up and drop events
+		static inline size_t Collect()
+		{
+			ProfileRegistry& r = registry();
+			scoped_lock lock(r.lock);
+
+			return CollectLocked(r);
+		}
+
+		//Drops every captured event, resetCounters also sets every counter back to zero
+		static inline void Clear(bool resetCounters = false)
+		{
+			ProfileRegistry& r = registry();
+			scoped_lock lock(r.lock);
+
+			CollectLocked(r);
+			r.captured.clear();
+			r.threadNames.clear();
+
+			if (resetCounters)
+			{
+				for (CounterDescriptor* c : r.counters)
+				{
+					c->value.store(0, memory_order_relaxed);
+				}
+			}
+		}
+
+		//Events lost because a thread ring was full before Collect drained it
+		static inline u64 GetDroppedCount()
+		{
+			ProfileRegistry& r = registry();
+			scoped_lock lock(r.lock);
+
+			u64 total = r.droppedTotal;
+			for (const auto& b : r.buffers)
+			{
+				total += b->droppedCount.load(memory_order_relaxed);
+			}
+			return total;
+		}
+
+		//Current total of every counter that has been used at least once, sorted by name
+		static inline vector<CounterValue> GetCounters()
+		{
+			ProfileRegistry& r = registry();
+			scoped_lock lock(r.lock);
+
+			vector<CounterValue> result{};
+			result.reserve(r.counters.size());
+
+			for (const CounterDescriptor* c : r.counters)
+			{
+				result.push_back({ c->name, c->value.load(memory_order_relaxed) });
+			}
+
+			sort(result.begin(), result.end(),
+				[](const CounterValue& a, const CounterValue& b)
+				{
+					return string_view(a.name) < string_view(b.name);
+				});
+
+			return result;
+		}
+
+		//Collects and returns per zone call site statistics of the capture, sorted by total time
+		static inline vector<ZoneStats> GetZoneStats()
+		{
+			ProfileRegistry& r = registry();
+			scoped_lock lock(r.lock);
+
+			CollectLocked(r);
+
+			const f64 msPerTick = GetNsPerTick() / 1000000.0;
+
+			vector<ZoneStats> result{};
+			for (const CapturedEvent& c : r.captured)
+			{
+				if (c.event.kind != ProfileEventKind::EVENT_ZONE) continue;
+
+				const auto* zone = scast<const ZoneDescriptor*>(c.event.descriptor);
+				const f64 ms = scast<f64>(scast<u64>(c.event.value) - c.event.start) * msPerTick;
+
+				auto it = find_if(result.begin(), result.end(),
+					[zone](const ZoneStats& s) { return s.zone == zone; });
+
+				if (it == result.end())
+				{
+					result.push_back({ zone, 1, ms, ms, ms });
+					continue;
+				}
+
+				it->count++;
+				it->totalMs += ms;
+				it->minMs = min(it->minMs, ms);
+				it->maxMs = max(it->maxMs, ms);
+			}
+
+			sort(result.begin(), result.end(),
+				[](const ZoneStats& a, const ZoneStats& b)
+				{
+					return a.totalMs > b.totalMs;
+				});
+
+			return result;
+		}
+
+		//Collects and writes the capture as a Chrome trace event json file,
+		//zones become complete events and counter samples become counter events.
+		//Opens in chrome://tracing and Perfetto, and converts to a Tracy capture with import-chrome.
+		//Returns false if the file could not be written
+		static inline bool WriteChromeTrace(const path& file)
+		{
+			ProfileRegistry& r = registry();
+			scoped_lock lock(r.lock);
+
+			CollectLocked(r);
+
+			const f64 usPerTick = GetNsPerTick() / 1000.0;
+			const u64 origin = clock().originTicks;
+
+			string out{};
+			out.reserve(64 + r.captured.size() * 128);
+			out += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+			bool isFirst = true;
+			auto separate = [&]()
+				{
+					if (!isFirst) out += ",";
+					out += "\n";
+					isFirst = false;
+				};
+
+			auto writeThreadName = [&](u32 id, const string& name)
+				{
+					if (name.empty()) return;
+
+					separate();
+					out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+					out += to_string(id);
+					out += ",\"args\":{\"name\":\"";
+					AppendJsonEscaped(out, name);
+					out += "\"}}";
+				};
+
+			for (const auto& b : r.buffers) writeThreadName(b->threadId, b->threadName);
+			for (const auto& [id, name] : r.threadNames) writeThreadName(id, name);
+
+			char number[64]{};
+			for (const CapturedEvent& c : r.captured)
+			{
+				const ProfileEvent& e = c.event;
+				const f64 ts = e.start >= origin
+					? scast<f64>(e.start - origin) * usPerTick
+					: 0.0;
+
+				separate();
+				out += "{\"name\":\"";
+
+				if (e.kind == ProfileEventKind::EVENT_ZONE)
+				{
+					const auto* zone = scast<const ZoneDescriptor*>(e.descriptor);
+					const f64 dur = scast<f64>(scast<u64>(e.value) - e.start) * usPerTick;
+
+					AppendJsonEscaped(out, zone->name);
+					snprintf(number, sizeof(number), "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f", ts, dur);
+					out += number;
+					out += ",\"pid\":1,\"tid\":";
+					out += to_string(c.threadId);
+					out += ",\"args\":{\"source\":\"";
+					AppendJsonEscaped(out, zone->file);
+					out += ":";
+					out += to_string(zone->line);
+					out += "\"}}";
+				}
+				else
+				{
+					const auto* counter = scast<const CounterDescriptor*>(e.descriptor);
+
+					AppendJsonEscaped(out, counter->name);
+					snprintf(number, sizeof(number), "\",\"ph\":\"C\",\"ts\":%.3f", ts);
+					out += number;
+					out += ",\"pid\":1,\"tid\":";
+					out += to_string(c.threadId);
+					out += ",\"args\":{\"value\":";
+					out += to_string(e.value);
+					out += "}}";
+				}
+			}
+
+			out += "\n]}\n";
+
+			if (file.has_parent_path()
+				&& !exists(file.parent_path()))
+			{
+				std::error_code ec{};
+				create_directories(file.parent_path(), ec);
+				if (ec) return false;
+			}
+
+			ofstream stream(file, ios::binary | ios::trunc);
+			if (!stream.is_open()) return false;
+
+			stream.write(out.data(), scast<std::streamsize>(out.size()));
+			return stream.good();
+		}
+
+		//Nanoseconds per tick of Now, measured over at least RDTSC_CALIBRATION_MS when rdtsc is used
+		static inline f64 GetNsPerTick()
+		{
+#ifdef KPROFILE_RDTSC
+			const ProfileClock& c = clock();
+
+			u64 ns = SteadyNs();
+			if (ns - c.originNs < scast<u64>(RDTSC_CALIBRATION_MS) * 1000000)
+			{
+				sleep_for(milliseconds(RDTSC_CALIBRATION_MS) - nanoseconds(ns - c.originNs));
+				ns = SteadyNs();
+			}
+			const u64 ticks = Now();
+
+			return ticks > c.originTicks
+				? scast<f64>(ns - c.originNs) / scast<f64>(ticks - c.originTicks)
+				: 1.0;
+#else
+			return 1.0;
+#endif
+		}
+	private:
+		static inline u64 SteadyNs()
+		{
+			return scast<u64>(duration_cast<nanoseconds>(
+				steady_clock::now().time_since_epoch()).count());
+		}
+
+		static inline void Push(const ProfileEvent& e)
+		{
+			ThreadProfileBuffer& b = threadBuffer();
+
+			const size_t pos = b.writePos.load(memory_order_relaxed);
+			if (pos - b.readPos.load(memory_order_acquire) > b.mask)
+			{
+				b.droppedCount.fetch_add(1, memory_order_relaxed);
+				return;
+			}
+
+			b.events[pos & b.mask] = e;
+			b.writePos.store(pos + 1, memory_order_release);
+		}
+
+		static inline void RegisterCounter(CounterDescriptor& counter)
+		{
+			ProfileRegistry& r = registry();
+			scoped_lock lock(r.lock);
+
+			if (counter.isRegistered.load(memory_order_relaxed)) return;
+
+			r.counters.push_back(&counter);
+			counter.isRegistered.store(true, memory_order_release);
+		}
+
+		static inline size_t CollectLocked(ProfileRegistry& r)
+		{
+			size_t moved{};
+
+			for (size_t i = 0; i < r.buffers.size();)
+			{
+				ThreadProfileBuffer& b = *r.buffers[i];
+
+				//read before draining so every event of an exited thread is drained below
+				const bool isExited = b.isExited.load(memory_order_acquire);
+
+				const size_t begin = b.readPos.load(memory_order_relaxed);
+				const size_t end = b.writePos.load(memory_order_acquire);
+
+				for (size_t pos = begin; pos != end; ++pos)
+				{
+					r.captured.push_back({ b.events[pos & b.mask], b.threadId });
+				}
+				moved += end - begin;
+				b.readPos.store(end, memory_order_release);
+
+				//the owning thread has exited, nothing can be pushed anymore
+				if (isExited)
+				{
+					r.droppedTotal += b.droppedCount.load(memory_order_relaxed);
+					if (!b.threadName.empty()) r.threadNames.emplace_back(b.threadId, b.threadName);
+
+					r.buffers[i] = std::move(r.buffers.back());
+					r.buffers.pop_back();
+					continue;
+				}
+
+				++i;
+			}
+
+			return moved;
+		}
+
+		static inline shared_ptr<ThreadProfileBuffer> RegisterThread()
+		{
+			//starts the clock before the first event of any thread
+			clock();
+
+			auto b = make_shared<ThreadProfileBuffer>();
+
+			ProfileRegistry& r = registry();
+			scoped_lock lock(r.lock);
+
+			b->events = make_unique<ProfileEvent[]>(r.ringSize);
+			b->mask = r.ringSize - 1;
+			b->threadId = r.nextThreadId++;
+
+			r.buffers.push_back(b);
+			return b;
+		}
+
+		static inline ThreadProfileBuffer& threadBuffer()
+		{
+			thread_local ThreadProfileHandle handle{ RegisterThread() };
+			return *handle.buffer;
+		}
+
+		static inline ProfileRegistry& registry()
+		{
+			static ProfileRegistry r{};
+			return r;
+		}
+
+		static inline const ProfileClock& clock()
+		{
+			static const ProfileClock c{ Now(), SteadyNs() };
+			return c;
+		}
+
+		static inline atomic<bool>& recording()
+		{
+			static atomic<bool> state{ true };
+			return state;
+		}
+	};
+
+	//Reads the start time on construction and records the zone on destruction.
+	//Skips both timestamps if recording was off when the zone started
+	class ScopedZone
+	{
+	public:
+		explicit ScopedZone(const ZoneDescriptor* zone)
+			: zone(zone),
+			isActive(Profile::IsRecording())
+		{
+			if (isActive) start = Profile::Now();
+		}
+		~ScopedZone()
+		{
+			if (isActive) Profile::RecordZone(zone, start, Profile::Now());
+		}
+
+		ScopedZone(const ScopedZone&) = delete;
+		ScopedZone& operator=(const ScopedZone&) = delete;
+	private:
+		const ZoneDescriptor* zone{};
+		u64 start{};
+		bool isActive{};
+	};
+
+	//
+	// BENCHMARK
+	//
+
+	struct BenchmarkSettings
+	{
+		u32 sampleCount = 15;     //timed samples per benchmark, the median is the tracked value
+		f64 minSampleMs = 5.0;    //iterations per sample grow until one sample takes at least this long
+		f64 warmupMs = 20.0;      //untimed runs before the first sample, includes the calibration runs
+		u64 bytesPerIteration{};  //bytes one iteration processes, enables mbPerSecond
+		u64 itemsPerIteration{};  //items one iteration processes, enables itemsPerSecond
+	};
+
+	struct BenchmarkResult
+	{
+		string name{};
+		u32 threadCount = 1;
+		u64 iterations{};  //iterations of one sample on each thread
+		u32 sampleCount{};
+		f64 minNs{};       //per iteration
+		f64 medianNs{};    //per iteration
+		f64 meanNs{};      //per iteration
+		f64 maxNs{};       //per iteration
+		f64 stddevNs{};    //per iteration
+		u64 bytesPerIteration{};
+		u64 itemsPerIteration{};
+		f64 mbPerSecond{};    //median throughput of all threads
+		f64 itemsPerSecond{}; //median throughput of all threads
+	};
+
+	struct BenchmarkComparison
+	{
+		string name{};
+		u32 threadCount = 1;
+		f64 baselineNs{}; //baseline median per iteration
+		f64 currentNs{};  //current median per iteration
+		f64 ratio{};      //currentNs / baselineNs, above 1 is slower
+		bool isRegression{};
+		bool isMissing{}; //the baseline has no result with this name and thread count
+	};
+
+	//Forces value to be computed so the optimizer can't drop a benchmarked expression
+	template <typename T>
+	inline void KeepValue(const T& value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const void* sink{};
+		sink = &value;
+		std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+	}
+
+	//Runs and times callables, keeps every result in run order
+	//and writes them as json so regressions can be tracked between versions
+	class BenchmarkSuite
+	{
+	public:
+		explicit BenchmarkSuite(string_view name) : name(name) {}
+
+		//Times func() with a growing iteration count per sample until each sample takes
+		//minSampleMs, then records sampleCount samples. Returns a copy of the recorded result,
+		//a reference into the results would dangle after the next run
+		template <typename F>
+		inline BenchmarkResult Run(
+			string_view benchmarkName,
+			F&& func,
+			const BenchmarkSettings& settings = {})
+		{
+			auto runSample = [&func](u64 iterations)
+				{
+					const u64 start = SteadyNs();
+					for (u64 i = 0; i < iterations; ++i) func();
+					return SteadyNs() - start;
+				};
+
+			return Measure(
+				benchmarkName,
+				1,
+				settings,
+				runSample);
+		}
+
+		//Times func(threadIndex) on threadCount threads that start each sample together,
+		//a sample lasts until the last thread finishes its iterations
+		template <typename F>
+		inline BenchmarkResult RunThreaded(
+			string_view benchmarkName,
+			u32 threadCount,
+			F&& func,
+			const BenchmarkSettings& settings = {})
+		{
+			if (threadCount == 0) threadCount = 1;
+
+			barrier<> startSync(threadCount + 1);
+			barrier<> endSync(threadCount + 1);
+			u64 sampleIterations{};
+			bool isDone{};
+
+			vector<thread> threads{};
+			threads.reserve(threadCount);
+
+			for (u32 t = 0; t < threadCount; ++t)
+			{
+				threads.emplace_back([&, t]()
+					{
+						for (;;)
+						{
+							startSync.arrive_and_wait();
+							if (isDone) return;
+
+							for (u64 i = 0; i < sampleIterations; ++i) func(t);
+
+							endSync.arrive_and_wait();
+						}
+					});
+			}
+
+			auto runSample = [&](u64 iterations)
+				{
+					sampleIterations = iterations;
+
+					const u64 start = SteadyNs();
+					startSync.arrive_and_wait();
+					endSync.arrive_and_wait();
+					return SteadyNs() - start;
+				};
+
+			BenchmarkResult result = Measure(
+				benchmarkName,
+				threadCount,
+				settings,
+				runSample);
+
+			isDone = true;
+			startSync.arrive_and_wait();
+			for (auto& t : threads) t.join();
+
+			return result;
+		}
+
+		inline const vector<BenchmarkResult>& GetResults() const { return results; }
+
+		//Writes the suite name, build info and every result as json, one result per line.
+		//Returns false if the file could not be written
+		inline bool WriteJson(const path& file) const
+		{
+			string out{};
+			out += "{\n\"suite\":\"";
+			AppendJsonEscaped(out, name);
+			out += "\",\n\"timestamp\":";
+			out += to_string(duration_cast<std::chrono::seconds>(
+				std::chrono::system_clock::now().time_since_epoch()).count());
+			out += ",\n\"compiler\":\"";
+#if defined(__clang__)
+			AppendJsonEscaped(out, "clang " __clang_version__);
+#elif defined(__GNUC__)
+			AppendJsonEscaped(out, "gcc " __VERSION__);
+#elif defined(_MSC_VER)
+			out += "msvc " + to_string(_MSC_VER);
+#endif
+#ifdef NDEBUG
+			out += "\",\n\"build\":\"release\",";
+#else
+			out += "\",\n\"build\":\"debug\",";
+#endif
+			out += "\n\"hardware_threads\":";
+			out += to_string(thread::hardware_concurrency());
+			out += ",\n\"results\":[";
+
+			char number[512]{};
+			for (size_t i = 0; i < results.size(); ++i)
+			{
+				const BenchmarkResult& r = results[i];
+
+				out += i == 0 ? "\n" : ",\n";
+				out += "{\"name\":\"";
+				AppendJsonEscaped(out, r.name);
+				snprintf(number, sizeof(number),
+					"\",\"threads\":%u,\"iterations\":%llu,\"samples\":%u"
+					",\"min_ns\":%.3f,\"median_ns\":%.3f,\"mean_ns\":%.3f,\"max_ns\":%.3f,\"stddev_ns\":%.3f"
+					",\"bytes_per_iteration\":%llu,\"items_per_iteration\":%llu"
+					",\"mb_per_second\":%.3f,\"items_per_second\":%.3f}",
+					r.threadCount,
+					scast<unsigned long long>(r.iterations),
+					r.sampleCount,
+					r.minNs,
+					r.medianNs,
+					r.meanNs,
+					r.maxNs,
+					r.stddevNs,
+					scast<unsigned long long>(r.bytesPerIteration),
+					scast<unsigned long long>(r.itemsPerIteration),
+					r.mbPerSecond,
+					r.itemsPerSecond);
+				out += number;
+			}
+
+			out += "\n]\n}\n";
+
+			if (file.has_parent_path()
+				&& !exists(file.parent_path()))
+			{
+				std::error_code ec{};
+				create_directories(file.parent_path(), ec);
+				if (ec) return false;
+			}
+
+			ofstream stream(file, ios::binary | ios::trunc);
+			if (!stream.is_open()) return false;
+
+			stream.write(out.data(), scast<std::streamsize>(out.size()));
+			return stream.good();
+		}
+
+		//Reads the results of a file written by WriteJson, returns false if it could not be read
+		static inline bool LoadJson(
+			const path& file,
+			vector<BenchmarkResult>& outResults)
+		{
+			ifstream stream(file, ios::binary);
+			if (!stream.is_open()) return false;
+
+			vector<BenchmarkResult> loaded{};
+			string line{};
+
+			while (getline(stream, line))
+			{
+				if (line.rfind("{\"name\":\"", 0) != 0) continue;
+
+				BenchmarkResult r{};
+				if (!ReadJsonString(line, "name", r.name)) return false;
+
+				f64 value{};
+				if (!ReadJsonNumber(line, "threads", value)) return false;
+				r.threadCount = scast<u32>(value);
+				if (!ReadJsonNumber(line, "iterations", value)) return false;
+				r.iterations = scast<u64>(value);
+				if (!ReadJsonNumber(line, "samples", value)) return false;
+				r.sampleCount = scast<u32>(value);
+
+				if (!ReadJsonNumber(line, "min_ns", r.minNs)
+					|| !ReadJsonNumber(line, "median_ns", r.medianNs)
+					|| !ReadJsonNumber(line, "mean_ns", r.meanNs)
+					|| !ReadJsonNumber(line, "max_ns", r.maxNs)
+					|| !ReadJsonNumber(line, "stddev_ns", r.stddevNs)
+					|| !ReadJsonNumber(line, "mb_per_second", r.mbPerSecond)
+					|| !ReadJsonNumber(line, "items_per_second", r.itemsPerSecond))
+				{
+					return false;
+				}
+
+				if (!ReadJsonNumber(line, "bytes_per_iteration", value)) return false;
+				r.bytesPerIteration = scast<u64>(value);
+				if (!ReadJsonNumber(line, "items_per_iteration", value)) return false;
+				r.itemsPerIteration = scast<u64>(value);
+
+				loaded.push_back(std::move(r));
+			}
+
+			outResults = std::move(loaded);
+			return true;
+		}
+
+		//Pairs current results with baseline results by name and thread count,
+		//a result is a regression if its median got slower by more than tolerance
+		static inline vector<BenchmarkComparison> Compare(
+			const vector<BenchmarkResult>& baseline,
+			const vector<BenchmarkResult>& current,
+			f64 tolerance = 0.05)
+		{
+			vector<BenchmarkComparison> comparisons{};
+			comparisons.reserve(current.size());
+
+			for (const BenchmarkResult& c : current)
+			{
+				BenchmarkComparison cmp{};
+				cmp.name = c.name;
+				cmp.threadCount = c.threadCount;
+				cmp.currentNs = c.medianNs;
+
+				auto it = find_if(baseline.begin(), baseline.end(),
+					[&c](const BenchmarkResult& b)
+					{
+						return b.name == c.name
+							&& b.threadCount == c.threadCount;
+					});
+
+				if (it == baseline.end())
+				{
+					cmp.isMissing = true;
+				}
+				else
+				{
+					cmp.baselineNs = it->medianNs;
+					cmp.ratio = it->medianNs > 0.0
+						? c.medianNs / it->medianNs
+						: 0.0;
+					cmp.isRegression = cmp.ratio > 1.0 + tolerance;
+				}
+
+				comparisons.push_back(std::move(cmp));
+			}
+
+			return comparisons;
+		}
+	private:
+		string name{};
+		vector<BenchmarkResult> results{};
+
+		static inline u64 SteadyNs()
+		{
+			return scast<u64>(duration_cast<nanoseconds>(
+				steady_clock::now().time_since_epoch()).count());
+		}
+
+		//runSample(iterations) runs one sample and returns its elapsed nanoseconds
+		template <typename S>
+		inline BenchmarkResult Measure(
+			string_view benchmarkName,
+			u32 threadCount,
+			const BenchmarkSettings& settings,
+			S& runSample)
+		{
+			const u64 minSampleNs = scast<u64>(max(settings.minSampleMs, 0.001) * 1000000.0);
+			const u64 warmupNs = scast<u64>(max(settings.warmupMs, 0.0) * 1000000.0);
+
+			//grow the iteration count until one sample is long enough,
+			//these runs also warm up caches, branch predictors and clocks
+			u64 iterations = 1;
+			u64 warmedNs{};
+			for (;;)
+			{
+				const u64 elapsed = runSample(iterations);
+				warmedNs += elapsed;
+
+				if (elapsed >= minSampleNs) break;
+
+				const f64 scale = elapsed > 0
+					? scast<f64>(minSampleNs) / scast<f64>(elapsed) * 1.2
+					: 10.0;
+				iterations = max(iterations + 1, scast<u64>(scast<f64>(iterations) * min(scale, 10.0)));
+			}
+			while (warmedNs < warmupNs)
+			{
+				warmedNs += runSample(iterations);
+			}
+
+			const u32 sampleCount = max(settings.sampleCount, 1u);
+
+			vector<f64> samples{};
+			samples.reserve(sampleCount);
+			for (u32 i = 0; i < sampleCount; ++i)
+			{
+				samples.push_back(scast<f64>(runSample(iterations)) / scast<f64>(iterations));
+			}
+			sort(samples.begin(), samples.end());
+
+			BenchmarkResult r{};
+			r.name = string(benchmarkName);
+			r.threadCount = threadCount;
+			r.iterations = iterations;
+			r.sampleCount = sampleCount;
+			r.minNs = samples.front();
+			r.maxNs = samples.back();
+			r.medianNs = sampleCount % 2 == 1
+				? samples[sampleCount / 2]
+				: (samples[sampleCount / 2 - 1] + samples[sampleCount / 2]) * 0.5;
+
+			for (f64 sample : samples) r.meanNs += sample;
+			r.meanNs /= sampleCount;
+
+			for (f64 sample : samples) r.stddevNs += (sample - r.meanNs) * (sample - r.meanNs);
+			r.stddevNs = sqrt(r.stddevNs / sampleCount);
+
+			r.bytesPerIteration = settings.bytesPerIteration;
+			r.itemsPerIteration = settings.itemsPerIteration;
+			if (r.medianNs > 0.0)
+			{
+				const f64 perSecond = 1000000000.0 / r.medianNs * threadCount;
+				r.mbPerSecond = scast<f64>(r.bytesPerIteration) * perSecond / 1048576.0;
+				r.itemsPerSecond = scast<f64>(r.itemsPerIteration) * perSecond;
+			}
+
+			results.push_back(r);
+			return r;
+		}
+
+		//Finds "key": in a line written by WriteJson and reads the string after it
+		static inline bool ReadJsonString(
+			const string& line,
+			string_view key,
+			string& outValue)
+		{
+			const string token = "\"" + string(key) + "\":\"";
+			size_t pos = line.find(token);
+			if (pos == string::npos) return false;
+			pos += token.size();
+
+			string value{};
+			for (; pos < line.size(); ++pos)
+			{
+				const char ch = line[pos];
+				if (ch == '"')
+				{
+					outValue = std::move(value);
+					return true;
+				}
+				if (ch != '\\'
+					|| pos + 1 >= line.size())
+				{
+					value += ch;
+					continue;
+				}
+
+				const char escaped = line[++pos];
+				switch (escaped)
+				{
+				case 'n': value += '\n'; break;
+				case 'r': value += '\r'; break;
+				case 't': value += '\t'; break;
+				case 'u':
+					if (pos + 4 >= line.size()) return false;
+					value += scast<char>(strtoul(line.substr(pos + 1, 4).c_str(), nullptr, 16));
+					pos += 4;
+					break;
+				default: value += escaped; break;
+				}
+			}
+
+			return false;
+		}
+
+		//Finds "key": in a line written by WriteJson and reads the number after it
+		static inline bool ReadJsonNumber(
+			const string& line,
+			string_view key,
+			f64& outValue)
+		{
+			const string token = "\"" + string(key) + "\":";
+			const size_t pos = line.find(token);
+			if (pos == string::npos) return false;
+
+			const char* begin = line.c_str() + pos + token.size();
+			char* end{};
+			const f64 value = strtod(begin, &end);
+			if (end == begin) return false;
+
+			outValue = value;
+			return true;
+		}
+	};
+}
\ No newline at end of file
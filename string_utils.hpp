@@ -8,6 +8,8 @@
 //
 // Provides:
 //   - various string conversions and functions to improve workflow with string operations
+//   - allocation-free string_view split and tokenize ranges with memchr-based splitter search
+//   - non-throwing from_chars number parsing and a one-pass delimited number parser
 //---------------------------------------------------------------------------
 
 #pragma once
@@ -16,6 +18,12 @@
 #include <string>
 #include <cstring>
 #include <algorithm>
+#include <iterator>
+#include <cstddef>
+#include <cstdint>
+#include <charconv>
+#include <system_error>
+#include <type_traits>
 
 namespace KalaHeaders::KalaString
 {	
@@ -43,6 +51,15 @@ namespace KalaHeaders::KalaString
 	using std::isspace;
 	using std::memcpy;
 	using std::memset;
+	using std::memchr;
+	using std::memcmp;
+	using std::default_sentinel_t;
+	using std::default_sentinel;
+	using std::from_chars;
+	using std::from_chars_result;
+	using std::errc;
+	using std::is_arithmetic_v;
+	using std::is_same_v;
 
 	//
 	// CONVERSION FUNCTIONS
@@ -69,6 +86,95 @@ namespace KalaHeaders::KalaString
 	template<> inline double             FromString<double>(string_view s) { return stod(string(s)); }               //Convert string to double
 	template<> inline long double        FromString<long double>(string_view s) { return stold(string(s)); }         //Convert string to long double
 
+	enum class ParseResult : uint8_t
+	{
+		RESULT_SUCCESS        = 0, //No errors, the whole input was parsed
+		RESULT_EMPTY          = 1, //Input was empty or only had white-space
+		RESULT_INVALID        = 2, //Input does not start with a valid number for this type
+		RESULT_OUT_OF_RANGE   = 3, //Number does not fit into this type
+		RESULT_TRAILING_CHARS = 4  //Input has more than white-space after the number
+	};
+	
+	inline constexpr string ResultToString(ParseResult result)
+	{
+		switch (result)
+		{
+		default: return "RESULT_UNKNOWN";
+		
+		case ParseResult::RESULT_SUCCESS:
+			return "RESULT_SUCCESS";
+		case ParseResult::RESULT_EMPTY:
+			return "RESULT_EMPTY";
+		case ParseResult::RESULT_INVALID:
+			return "RESULT_INVALID";
+		case ParseResult::RESULT_OUT_OF_RANGE:
+			return "RESULT_OUT_OF_RANGE";
+		case ParseResult::RESULT_TRAILING_CHARS:
+			return "RESULT_TRAILING_CHARS";
+		}
+	}
+	
+	//Non-throwing and non-allocating counterpart of FromString for numbers, built on from_chars.
+	//Leading and trailing white-space and a leading '+' are accepted like stoi and stof do,
+	//but anything else after the number is reported as RESULT_TRAILING_CHARS.
+	//outValue is only written on RESULT_SUCCESS
+	template<typename T>
+		requires (is_arithmetic_v<T> && !is_same_v<T, bool>)
+	inline ParseResult TryFromString(
+		string_view s,
+		T& outValue)
+	{
+		auto isSpace = [](char c)
+			{
+				return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+			};
+		
+		const char* first = s.data();
+		const char* last = s.data() + s.size();
+		
+		while (first < last && isSpace(*first)) ++first;
+		while (last > first && isSpace(*(last - 1))) --last;
+		
+		if (first == last) return ParseResult::RESULT_EMPTY;
+		
+		//from_chars does not accept a leading '+'
+		if (*first == '+'
+			&& last - first > 1
+			&& *(first + 1) != '-')
+		{
+			++first;
+		}
+		
+		T value{};
+		const from_chars_result r = from_chars(first, last, value);
+		
+		if (r.ec == errc::invalid_argument) return ParseResult::RESULT_INVALID;
+		if (r.ec == errc::result_out_of_range) return ParseResult::RESULT_OUT_OF_RANGE;
+		if (r.ptr != last) return ParseResult::RESULT_TRAILING_CHARS;
+		
+		outValue = value;
+		return ParseResult::RESULT_SUCCESS;
+	}
+	//Accepts only 'true' and 'false' with optional white-space around them
+	template<typename T>
+		requires (is_same_v<T, bool>)
+	inline ParseResult TryFromString(
+		string_view s,
+		T& outValue)
+	{
+		const size_t start = s.find_first_not_of(" \t\n\r\f\v");
+		if (start == string_view::npos) return ParseResult::RESULT_EMPTY;
+		
+		const size_t end = s.find_last_not_of(" \t\n\r\f\v");
+		const string_view word = s.substr(start, end - start + 1);
+		
+		if (word == "true")       outValue = true;
+		else if (word == "false") outValue = false;
+		else return ParseResult::RESULT_INVALID;
+		
+		return ParseResult::RESULT_SUCCESS;
+	}
+
 	//
 	// GENERAL FUNCTIONS
 	//
@@ -227,6 +333,271 @@ namespace KalaHeaders::KalaString
 		return result;
 	}
 
+	//Returns the position of the first target at or after start, or string_view::npos if there is none.
+	//Candidates are found with memchr on the first byte of target and only those are compared
+	inline size_t FindString(
+		string_view origin,
+		string_view target,
+		size_t start = 0)
+	{
+		if (target.empty()
+			|| origin.size() < target.size()
+			|| start > origin.size() - target.size())
+		{
+			return string_view::npos;
+		}
+		
+		const char* data = origin.data();
+		const size_t last = origin.size() - target.size();
+		const char first = target[0];
+		
+		size_t i = start;
+		while (i <= last)
+		{
+			const void* hit = memchr(data + i, first, last - i + 1);
+			if (hit == nullptr) return string_view::npos;
+			
+			i = scast<size_t>(scast<const char*>(hit) - data);
+			
+			if (memcmp(data + i + 1, target.data() + 1, target.size() - 1) == 0) return i;
+			
+			++i;
+		}
+		
+		return string_view::npos;
+	}
+	
+	//Lazy forward range over the chunks of origin between each splitter,
+	//views point into origin so it must outlive the range.
+	//Created by SplitView and TokenizeView, nothing is allocated while iterating
+	class StringViewRange
+	{
+	public:
+		class iterator
+		{
+		public:
+			using value_type = string_view;
+			using difference_type = ptrdiff_t;
+			
+			iterator() = default;
+			explicit iterator(const StringViewRange* inRange)
+				: range(inRange) { Advance(); }
+			
+			string_view operator*() const { return current; }
+			
+			iterator& operator++()
+			{
+				Advance();
+				return *this;
+			}
+			iterator operator++(int)
+			{
+				iterator prev = *this;
+				Advance();
+				return prev;
+			}
+			
+			bool operator==(default_sentinel_t) const { return isDone; }
+		private:
+			const StringViewRange* range{};
+			
+			size_t pos{};
+			size_t nextQuote{};
+			size_t nextSplit{};
+			bool hasNextQuote{};
+			bool hasNextSplit{};
+			
+			string_view current{};
+			bool isDone{};
+			
+			//first token at or after i, searched again only once i has passed the previous one
+			size_t QuoteAt(size_t i)
+			{
+				if (!hasNextQuote || nextQuote < i)
+				{
+					const string_view origin = range->origin;
+					const void* hit = i < origin.size()
+						? memchr(origin.data() + i, range->token, origin.size() - i)
+						: nullptr;
+					
+					nextQuote = hit
+						? scast<size_t>(scast<const char*>(hit) - origin.data())
+						: string_view::npos;
+					hasNextQuote = true;
+				}
+				
+				return nextQuote;
+			}
+			//first splitter at or after i, searched again only once i has passed the previous one
+			size_t SplitAt(size_t i)
+			{
+				if (!hasNextSplit || nextSplit < i)
+				{
+					nextSplit = FindString(range->origin, range->splitter, i);
+					hasNextSplit = true;
+				}
+				
+				return nextSplit;
+			}
+			
+			void Advance()
+			{
+				const string_view origin = range->origin;
+				const size_t splitterSize = range->splitter.size();
+				
+				if (!range->hasToken)
+				{
+					//split mode keeps empty chunks and always ends with the remainder
+					if (pos == string_view::npos
+						|| origin.empty())
+					{
+						isDone = true;
+						return;
+					}
+					
+					const size_t found = SplitAt(pos);
+					if (found == string_view::npos)
+					{
+						current = origin.substr(pos);
+						pos = string_view::npos;
+						return;
+					}
+					
+					current = origin.substr(pos, found - pos);
+					pos = found + splitterSize;
+					return;
+				}
+				
+				//tokenize mode skips empty chunks and ignores splitters between two tokens
+				while (pos < origin.size())
+				{
+					const size_t chunkStart = pos;
+					size_t i = pos;
+					size_t chunkEnd = origin.size();
+					size_t next = origin.size();
+					
+					while (i < origin.size())
+					{
+						const size_t quote = QuoteAt(i);
+						const size_t split = SplitAt(i);
+						
+						if (split != string_view::npos
+							&& split < quote)
+						{
+							chunkEnd = split;
+							next = split + splitterSize;
+							break;
+						}
+						
+						if (quote == string_view::npos) break;
+						
+						//skip to the closing token, the whole rest is one chunk if there is none
+						const size_t closing = QuoteAt(quote + 1);
+						if (closing == string_view::npos) break;
+						
+						i = closing + 1;
+					}
+					
+					pos = next;
+					
+					if (chunkEnd > chunkStart)
+					{
+						current = origin.substr(chunkStart, chunkEnd - chunkStart);
+						return;
+					}
+				}
+				
+				isDone = true;
+			}
+		};
+		
+		StringViewRange(
+			string_view inOrigin,
+			string_view inSplitter,
+			char inToken,
+			bool inHasToken)
+			: origin(inOrigin),
+			splitter(inSplitter),
+			token(inToken),
+			hasToken(inHasToken) {}
+		
+		iterator begin() const { return iterator(this); }
+		default_sentinel_t end() const { return default_sentinel; }
+	private:
+		string_view origin{};
+		string_view splitter{};
+		char token{};
+		bool hasToken{};
+	};
+	
+	//Same as SplitString but returns a lazy range of views into origin
+	inline StringViewRange SplitView(
+		string_view origin,
+		string_view splitter)
+	{
+		return StringViewRange(origin, splitter, '\0', false);
+	}
+	//Same as TokenizeString but returns a lazy range of views into origin
+	inline StringViewRange TokenizeView(
+		string_view origin,
+		char token,
+		string_view splitter)
+	{
+		return StringViewRange(origin, splitter, token, true);
+	}
+	
+	//Same as SplitString but fills outViews with views into origin,
+	//outViews is cleared first and keeps its capacity between calls, returns the chunk count
+	inline size_t SplitStringViews(
+		string_view origin,
+		string_view splitter,
+		vector<string_view>& outViews)
+	{
+		outViews.clear();
+		for (string_view v : SplitView(origin, splitter)) outViews.push_back(v);
+		
+		return outViews.size();
+	}
+	//Same as TokenizeString but fills outViews with views into origin,
+	//outViews is cleared first and keeps its capacity between calls, returns the chunk count
+	inline size_t TokenizeStringViews(
+		string_view origin,
+		char token,
+		string_view splitter,
+		vector<string_view>& outViews)
+	{
+		outViews.clear();
+		for (string_view v : TokenizeView(origin, token, splitter)) outViews.push_back(v);
+		
+		return outViews.size();
+	}
+
+	//Parses every chunk of origin between each splitter into outValues in one pass with TryFromString,
+	//empty and white-space only chunks are skipped. outValues is cleared first and keeps its capacity,
+	//on failure it holds every value parsed before the failing chunk. Skipped chunks are not counted,
+	//so its size is the index of the failing chunk only if no empty chunk came before it
+	template<typename T>
+	inline ParseResult ParseNumbers(
+		string_view origin,
+		string_view splitter,
+		vector<T>& outValues)
+	{
+		outValues.clear();
+		
+		for (string_view chunk : SplitView(origin, splitter))
+		{
+			T value{};
+			const ParseResult result = TryFromString(chunk, value);
+			
+			if (result == ParseResult::RESULT_EMPTY) continue;
+			if (result != ParseResult::RESULT_SUCCESS) return result;
+			
+			outValues.push_back(value);
+		}
+		
+		return ParseResult::RESULT_SUCCESS;
+	}
+
 	//Join all chunks in parts vector together into a single string
 	//and add delimiter after each chunk except the last one
 	inline constexpr string JoinString(
@@ -331,6 +702,34 @@ namespace KalaHeaders::KalaString
 		return result;
 	}
 
+	//Same as ReplaceFromString but writes the result into outResult,
+	//outResult keeps its capacity between calls so repeated use does not allocate
+	inline void ReplaceFromString(
+		string_view origin,
+		string_view target,
+		string_view replacement,
+		string& outResult,
+		bool replaceAll = false)
+	{
+		outResult.clear();
+		
+		size_t start{};
+		size_t pos = FindString(origin, target);
+		
+		while (pos != string_view::npos)
+		{
+			outResult.append(origin.substr(start, pos - start));
+			outResult.append(replacement);
+			start = pos + target.size();
+			
+			if (!replaceAll) break;
+			
+			pos = FindString(origin, target, start);
+		}
+		
+		outResult.append(origin.substr(start));
+	}
+
 	//Replaces everything after the start of target with replacer and returns the result
 	inline constexpr string ReplaceAfter(
 		string_view origin, 
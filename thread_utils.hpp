@@ -8,9 +8,12 @@
 //
 // Provides:
 //   - lock, lockwait and unlock overrides for handling safe access to variables
+//   - lockwait backoff - test-and-test-and-set spin with pause hints, yielding and OS parking, with contention counters
 //   - lock_m, lockwait_m (where applicable) and unlock_m for mutexes
 //   - jthread (joinable thread) which returns the created thread so it can be joined
 //   - dthread (self-exiting thread)
+//   - task_scheduler - persistent work-stealing thread pool with task groups, continuations and parallel_for
+//   - spsc_queue and mpmc_queue - lock-free bounded ring queues with batch push and pop
 //---------------------------------------------------------------------------
 
 #pragma once
@@ -20,6 +23,44 @@
 #include <thread>
 #include <chrono>
 #include <mutex>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <exception>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	#include <immintrin.h>
+#elif defined(_M_ARM64)
+	#include <intrin.h>
+#endif
+
+//rcast
+#ifndef rcast
+	#define rcast reinterpret_cast
+#endif
+
+//static_cast
+#ifndef scast
+	#define scast static_cast
+#endif
+
+//
+// PROFILER HOOKS
+//
+
+//Recorded by profile_utils.hpp if it is included first with KPROFILE_ENABLED defined,
+//otherwise every zone and counter below compiles to nothing
+#ifndef KPROFILE_ZONE
+	#define KPROFILE_HOOKS_FALLBACK
+	#define KPROFILE_ZONE(name)
+	#define KPROFILE_COUNTER(name, value) do {} while (0)
+#endif
 
 namespace KalaHeaders::KalaThread
 {	
@@ -40,9 +81,26 @@ namespace KalaHeaders::KalaThread
 	using std::chrono::duration;
 	using std::chrono::time_point;
 	using std::remove_cvref_t;
+	using std::memory_order_seq_cst;
+	using std::memory_order_acq_rel;
+	using std::vector;
+	using std::deque;
+	using std::unique_ptr;
+	using std::make_unique;
+	using std::function;
+	using std::exception_ptr;
+	using std::lock_guard;
+	using std::max;
+	using std::min;
+	using std::is_nothrow_move_constructible_v;
 	
 	using abool = atomic<bool>;
 	using auptr = atomic<uintptr_t>;
+	using asize = atomic<size_t>;
+	
+	//Fixed instead of hardware_destructive_interference_size, which
+	//differs between compilers and warns when used in a header
+	inline constexpr size_t CACHE_LINE_SIZE = 64;
 	
 	//
 	// CREATE THREAD
@@ -201,10 +259,12 @@ namespace KalaHeaders::KalaThread
 		return !flag.exchange(true, memory_order_acquire);
 	}
 	
-	//Lock an atomic arithmetic
+	//Lock an atomic arithmetic.
+	//bool is excluded from the arithmetic overloads because atomic<T>&
+	//is more specialized and would otherwise hijack the atomic boolean ones
 	template <typename T>
 	inline T lock(atomic<T>& value)
-		requires is_arithmetic_v<T>
+		requires (is_arithmetic_v<T> && !same_as<T, bool>)
 	{
 		return value.exchange(
 			value.load(memory_order_relaxed),
@@ -218,54 +278,194 @@ namespace KalaHeaders::KalaThread
 		return ptr.exchange(nullptr, memory_order_acquire) != nullptr;
 	}
 	
+	//
+	// BACKOFF
+	//
+	
+	//Pause rounds double from 1 up to this many pause hints
+	inline constexpr uint32_t LOCKWAIT_MAX_PAUSES = 64;
+	//Pause rounds before the waiter starts yielding
+	inline constexpr uint32_t LOCKWAIT_SPIN_ROUNDS = 10;
+	//Yields before the waiter parks in the OS
+	inline constexpr uint32_t LOCKWAIT_YIELD_ROUNDS = 4;
+	
+	//CPU hint that the thread is spin waiting, frees pipeline resources
+	//for the sibling hyperthread and avoids the memory order flush on exit
+	inline void cpu_pause()
+	{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+		_mm_pause();
+#elif defined(_M_ARM64)
+		__yield();
+#elif defined(__aarch64__) || defined(__arm__)
+		__asm__ __volatile__("yield");
+#endif
+	}
+	
+	//Totals of every contended lockwait since start or the last reset,
+	//spins counts pause hints, parks counts OS waits
+	struct lockwait_stats
+	{
+		uint64_t spins{};
+		uint64_t yields{};
+		uint64_t parks{};
+	};
+	
+	struct lockwait_counters
+	{
+		atomic<uint64_t> spins{};
+		atomic<uint64_t> yields{};
+		atomic<uint64_t> parks{};
+	};
+	
+	inline lockwait_counters& get_lockwait_counters()
+	{
+		static lockwait_counters counters{};
+		return counters;
+	}
+	
+	inline lockwait_stats get_lockwait_stats()
+	{
+		auto& c = get_lockwait_counters();
+		return
+		{
+			c.spins.load(memory_order_relaxed),
+			c.yields.load(memory_order_relaxed),
+			c.parks.load(memory_order_relaxed)
+		};
+	}
+	
+	inline void reset_lockwait_stats()
+	{
+		auto& c = get_lockwait_counters();
+		c.spins.store(0, memory_order_relaxed);
+		c.yields.store(0, memory_order_relaxed);
+		c.parks.store(0, memory_order_relaxed);
+	}
+	
+	//Exponential pause backoff, then yields, then parking.
+	//Counts locally and adds to the shared counters once when the wait ends,
+	//so an uncontended lockwait never touches them
+	class lockwait_backoff
+	{
+	public:
+		lockwait_backoff() = default;
+		~lockwait_backoff()
+		{
+			if (spins == 0
+				&& yields == 0
+				&& parks == 0)
+			{
+				return;
+			}
+			
+			auto& c = get_lockwait_counters();
+			c.spins.fetch_add(spins, memory_order_relaxed);
+			c.yields.fetch_add(yields, memory_order_relaxed);
+			c.parks.fetch_add(parks, memory_order_relaxed);
+			
+			KPROFILE_COUNTER("lockwait spins", spins);
+			KPROFILE_COUNTER("lockwait yields", yields);
+			KPROFILE_COUNTER("lockwait parks", parks);
+		}
+		
+		lockwait_backoff(const lockwait_backoff&) = delete;
+		lockwait_backoff& operator=(const lockwait_backoff&) = delete;
+		
+		//Spins or yields once and returns true, or returns false
+		//once the caller should park, which is counted as a park.
+		//If canPark is false it keeps yielding instead
+		inline bool wait(bool canPark = true)
+		{
+			if (rounds < LOCKWAIT_SPIN_ROUNDS)
+			{
+				for (uint32_t i = 0; i < pauses; ++i) cpu_pause();
+				
+				spins += pauses;
+				pauses = pauses < LOCKWAIT_MAX_PAUSES
+					? pauses * 2
+					: LOCKWAIT_MAX_PAUSES;
+				++rounds;
+				
+				return true;
+			}
+			
+			if (!canPark
+				|| rounds < LOCKWAIT_SPIN_ROUNDS + LOCKWAIT_YIELD_ROUNDS)
+			{
+				yield();
+				++yields;
+				++rounds;
+				
+				return true;
+			}
+			
+			++parks;
+			return false;
+		}
+	private:
+		uint32_t pauses = 1;
+		uint32_t rounds{};
+		uint64_t spins{};
+		uint64_t yields{};
+		uint64_t parks{};
+	};
+	
 	//
 	// LOCKWAIT
 	//
 	
-	//Wait until able to lock the atomic boolean
+	//Wait until able to lock the atomic boolean.
+	//Spins on plain loads so the cache line stays shared until it is released,
+	//then parks in the OS, so it must be released through unlock or followed by notify_one
 	template <is_atomic_bool T>
 	inline void lockwait(T& flag)
 	{
-		int spin_count = 0;
+		lockwait_backoff backoff{};
 		while (flag.exchange(true, memory_order_acquire))
 		{
-			if (++spin_count > 50)
+			KPROFILE_ZONE("lockwait");
+			
+			while (flag.load(memory_order_relaxed))
 			{
-				yield();
-				spin_count = 0;
+				if (!backoff.wait()) flag.wait(true, memory_order_relaxed);
 			}
 		}
 	}
 	
-	//Wait until able to lock the atomic arithmetic
+	//Wait until able to lock the atomic arithmetic.
+	//Never parks because the value is released by a plain store that can't notify
 	template <typename T>
 	inline void lockwait(atomic<T>& value)
-		requires is_arithmetic_v<T>
+		requires (is_arithmetic_v<T> && !same_as<T, bool>)
 	{
-		int spin_count = 0;	
+		lockwait_backoff backoff{};
 		while (value.exchange(
 			value.load(memory_order_relaxed),
 			memory_order_acquire))
 		{
-			if (++spin_count > 50)
+			KPROFILE_ZONE("lockwait");
+			
+			while (value.load(memory_order_relaxed) != T{})
 			{
-				yield();
-				spin_count = 0;
+				backoff.wait(false);
 			}
 		}
 	}
 	
-	//Wait until able to lock the atomic pointer
+	//Wait until able to lock the atomic pointer.
+	//Parks in the OS after spinning, so it must be released through unlock or followed by notify_one
 	template <is_atomic_pointer T>
 	inline void lockwait(T& ptr)
 	{
-		int spin_count = 0;
+		lockwait_backoff backoff{};
 		while (ptr.exchange(nullptr, memory_order_acquire) == nullptr)
 		{
-			if (++spin_count > 50)
+			KPROFILE_ZONE("lockwait");
+			
+			while (ptr.load(memory_order_relaxed) == nullptr)
 			{
-				yield();
-				spin_count = 0;
+				if (!backoff.wait()) ptr.wait(nullptr, memory_order_relaxed);
 			}
 		}
 	}
@@ -282,13 +482,16 @@ namespace KalaHeaders::KalaThread
 		if (!flag.load(memory_order_acquire)) return false;
 		
 		flag.store(false, memory_order_release);
+		
+		//wakes a lockwait that ran out of spins and parked
+		flag.notify_one();
 		return true;
 	}
 	
 	//Unlock a locked atomic arithmetic
 	template <typename T>
 	inline bool unlock(atomic<T>& value)
-		requires is_arithmetic_v<T>
+		requires (is_arithmetic_v<T> && !same_as<T, bool>)
 	{
 		//load current expected "locked" value
 		T current = value.load(memory_order_acquire);
@@ -311,6 +514,878 @@ namespace KalaHeaders::KalaThread
 		if (ptr.load(memory_order_acquire) != nullptr) return false;
 		
 		ptr.store(value, memory_order_release);
+		
+		//wakes a lockwait that ran out of spins and parked
+		ptr.notify_one();
 		return true;
 	}
+	
+	//
+	// WORK-STEALING DEQUE
+	//
+	
+	//Chase-Lev deque, the owner thread pushes and pops at the bottom
+	//while any other thread can steal from the top without locking.
+	//Outgrown rings are kept until destruction because a thief may still be reading one
+	template <typename T>
+	class ws_deque
+	{
+	public:
+		//Capacity is rounded up to a power of two
+		explicit ws_deque(size_t capacity = 256)
+		{
+			size_t size = 1;
+			while (size < capacity) size <<= 1;
+			
+			rings.push_back(make_unique<ring>(size));
+			buffer.store(rings.back().get(), memory_order_relaxed);
+		}
+		
+		ws_deque(const ws_deque&) = delete;
+		ws_deque& operator=(const ws_deque&) = delete;
+		
+		//Owner thread only
+		inline void push(T* item)
+		{
+			const int64_t b = bottom.load(memory_order_relaxed);
+			const int64_t t = top.load(memory_order_acquire);
+			ring* r = buffer.load(memory_order_relaxed);
+			
+			if (b - t > scast<int64_t>(r->mask)) r = grow(r, t, b);
+			
+			r->put(b, item);
+			bottom.store(b + 1, memory_order_release);
+		}
+		
+		//Owner thread only, returns nullptr if empty or the last item was stolen
+		inline T* pop()
+		{
+			const int64_t b = bottom.load(memory_order_relaxed) - 1;
+			ring* r = buffer.load(memory_order_relaxed);
+			
+			//seq_cst store and load order the bottom claim against concurrent thieves
+			bottom.store(b, memory_order_seq_cst);
+			int64_t t = top.load(memory_order_seq_cst);
+			
+			if (t > b)
+			{
+				bottom.store(b + 1, memory_order_relaxed);
+				return nullptr;
+			}
+			
+			T* item = r->get(b);
+			if (t == b)
+			{
+				//last item, race the thieves for it
+				if (!top.compare_exchange_strong(
+					t,
+					t + 1,
+					memory_order_seq_cst,
+					memory_order_relaxed))
+				{
+					item = nullptr;
+				}
+				bottom.store(b + 1, memory_order_relaxed);
+			}
+			
+			return item;
+		}
+		
+		//Any thread, returns nullptr if empty or another thread won the race
+		inline T* steal()
+		{
+			int64_t t = top.load(memory_order_seq_cst);
+			const int64_t b = bottom.load(memory_order_seq_cst);
+			
+			if (t >= b) return nullptr;
+			
+			T* item = buffer.load(memory_order_acquire)->get(t);
+			if (!top.compare_exchange_strong(
+				t,
+				t + 1,
+				memory_order_seq_cst,
+				memory_order_relaxed))
+			{
+				return nullptr;
+			}
+			
+			return item;
+		}
+		
+		//Approximate when called from a thread that is not the owner
+		inline bool empty() const
+		{
+			return bottom.load(memory_order_relaxed) <= top.load(memory_order_relaxed);
+		}
+	private:
+		struct ring
+		{
+			size_t mask{};
+			unique_ptr<atomic<T*>[]> slots{};
+			
+			explicit ring(size_t size)
+				: mask(size - 1),
+				  slots(make_unique<atomic<T*>[]>(size)) {}
+			
+			inline T* get(int64_t i) const
+			{
+				return slots[scast<size_t>(i) & mask].load(memory_order_relaxed);
+			}
+			inline void put(int64_t i, T* item)
+			{
+				slots[scast<size_t>(i) & mask].store(item, memory_order_relaxed);
+			}
+		};
+		
+		inline ring* grow(ring* old, int64_t t, int64_t b)
+		{
+			rings.push_back(make_unique<ring>((old->mask + 1) * 2));
+			ring* r = rings.back().get();
+			
+			for (int64_t i = t; i < b; ++i) r->put(i, old->get(i));
+			
+			buffer.store(r, memory_order_release);
+			return r;
+		}
+		
+		//top and bottom live on separate cache lines, thieves only write top
+		alignas(CACHE_LINE_SIZE) atomic<int64_t> top{};
+		alignas(CACHE_LINE_SIZE) atomic<int64_t> bottom{};
+		atomic<ring*> buffer{};
+		vector<unique_ptr<ring>> rings{};
+	};
+	
+	//
+	// TASK SCHEDULER
+	//
+	
+	class task_scheduler;
+	
+	//Counts the tasks started through it so they can be waited on together.
+	//Waiting runs other queued tasks instead of blocking, so groups can be nested inside tasks
+	class task_group
+	{
+	public:
+		explicit task_group(task_scheduler& inScheduler)
+			: scheduler(inScheduler) {}
+		
+		//Waits for remaining tasks, exceptions of unwaited tasks are dropped
+		~task_group()
+		{
+			try { wait(); }
+			catch (...) {}
+		}
+		
+		task_group(const task_group&) = delete;
+		task_group& operator=(const task_group&) = delete;
+		
+		//Queues a task that belongs to this group
+		template <invocable F>
+		inline void run(F&& func);
+		
+		//Runs queued tasks until every task of this group has finished,
+		//then rethrows the first exception thrown by any of them
+		inline void wait();
+		
+		//Queues func once the group next becomes idle, or right away if it already is.
+		//Only one continuation is kept, a later call replaces an earlier pending one
+		template <invocable F>
+		inline void then(F&& func);
+		
+		inline bool is_done() const { return pending.load(memory_order_acquire) == 0; }
+	private:
+		friend class task_scheduler;
+		
+		inline void finish_one();
+		
+		task_scheduler& scheduler;
+		atomic<size_t> pending{};
+		
+		mutex stateMutex{};
+		function<void()> continuation{};
+		exception_ptr firstException{};
+	};
+	
+	//Persistent pool of worker threads with one work-stealing deque each.
+	//Tasks queued from a worker go to its own deque, tasks queued from
+	//other threads go to a shared injection queue that workers drain before stealing
+	class task_scheduler
+	{
+	public:
+		//workerCount of 0 uses all hardware threads
+		explicit task_scheduler(size_t workerCount = 0)
+		{
+			if (workerCount == 0) workerCount = thread::hardware_concurrency();
+			if (workerCount == 0) workerCount = 1;
+			
+			queues.reserve(workerCount);
+			for (size_t i = 0; i < workerCount; ++i)
+			{
+				queues.push_back(make_unique<ws_deque<task>>());
+			}
+			
+			workers.reserve(workerCount);
+			for (size_t i = 0; i < workerCount; ++i)
+			{
+				workers.emplace_back([this, i] { worker_loop(i); });
+			}
+		}
+		
+		//Finishes every queued task before the workers are joined
+		~task_scheduler()
+		{
+			stopping.store(true, memory_order_seq_cst);
+			wake(true);
+			
+			for (auto& w : workers) w.join();
+		}
+		
+		task_scheduler(const task_scheduler&) = delete;
+		task_scheduler& operator=(const task_scheduler&) = delete;
+		
+		//Queues a task that nothing waits on, an exception thrown by it terminates like in a thread
+		template <invocable F>
+		inline void submit(F&& func)
+		{
+			enqueue(new task{ function<void()>(std::forward<F>(func)), nullptr });
+		}
+		
+		//Runs func(first, last) over [begin, end) split into chunks of at most grain indices,
+		//or func(i) for every index if func takes one argument.
+		//grain of 0 picks roughly eight chunks per worker. Returns after every chunk has run
+		template <typename F>
+			requires invocable<F&, size_t, size_t>
+			|| invocable<F&, size_t>
+		inline void parallel_for(
+			size_t begin,
+			size_t end,
+			F&& func,
+			size_t grain = 0)
+		{
+			if (begin >= end) return;
+			
+			KPROFILE_ZONE("parallel_for");
+			
+			const size_t count = end - begin;
+			if (grain == 0) grain = max<size_t>(count / (workers.size() * 8), 1);
+			
+			auto body = [&func](size_t first, size_t last)
+				{
+					if constexpr (invocable<F&, size_t, size_t>) func(first, last);
+					else for (size_t i = first; i < last; ++i) func(i);
+				};
+			
+			if (count <= grain)
+			{
+				body(begin, end);
+				return;
+			}
+			
+			//halves are split off lazily so idle workers steal large ranges first,
+			//split is declared before group so ~task_group can still run queued halves if func throws
+			function<void(size_t, size_t)> split{};
+			task_group group(*this);
+			split = [&](size_t first, size_t last)
+				{
+					while (last - first > grain)
+					{
+						const size_t mid = first + (last - first) / 2;
+						group.run([&split, mid, last] { split(mid, last); });
+						last = mid;
+					}
+					body(first, last);
+				};
+			
+			split(begin, end);
+			group.wait();
+		}
+		
+		//Runs one queued task on the calling thread, returns false if none was found
+		inline bool run_one()
+		{
+			task* t = find_task(current_index());
+			if (t == nullptr) return false;
+			
+			execute(t);
+			return true;
+		}
+		
+		inline size_t get_worker_count() const { return workers.size(); }
+		
+		//Index of the calling worker thread, or SIZE_MAX if it isn't a worker of this scheduler
+		inline size_t current_index() const
+		{
+			return currentScheduler == this
+				? currentIndex
+				: SIZE_MAX;
+		}
+	private:
+		friend class task_group;
+		
+		struct task
+		{
+			function<void()> func{};
+			task_group* group{};
+		};
+		
+		inline void enqueue(task* t)
+		{
+			const size_t index = current_index();
+			if (index != SIZE_MAX) queues[index]->push(t);
+			else
+			{
+				lock_guard<mutex> guard(injectionMutex);
+				injection.push_back(t);
+				hasInjected.store(true, memory_order_release);
+			}
+			
+			wake(false);
+		}
+		
+		inline void wake(bool all)
+		{
+			//bumping the epoch first makes a worker that is about to sleep see the change
+			epoch.fetch_add(1, memory_order_seq_cst);
+			
+			if (all) epoch.notify_all();
+			else if (sleepers.load(memory_order_seq_cst) > 0) epoch.notify_one();
+		}
+		
+		inline task* find_task(size_t index)
+		{
+			if (index != SIZE_MAX)
+			{
+				if (task* t = queues[index]->pop()) return t;
+			}
+			
+			if (hasInjected.load(memory_order_acquire))
+			{
+				lock_guard<mutex> guard(injectionMutex);
+				if (!injection.empty())
+				{
+					task* t = injection.front();
+					injection.pop_front();
+					hasInjected.store(!injection.empty(), memory_order_release);
+					return t;
+				}
+			}
+			
+			//random first victim keeps thieves from piling onto the same deque
+			const size_t count = queues.size();
+			const size_t first = next_random() % count;
+			for (size_t i = 0; i < count; ++i)
+			{
+				const size_t victim = (first + i) % count;
+				if (victim == index) continue;
+				
+				if (task* t = queues[victim]->steal()) return t;
+			}
+			
+			return nullptr;
+		}
+		
+		inline void execute(task* t)
+		{
+			KPROFILE_ZONE("task_scheduler task");
+			
+			unique_ptr<task> owned(t);
+			
+			if (owned->group == nullptr)
+			{
+				owned->func();
+				return;
+			}
+			
+			try { owned->func(); }
+			catch (...)
+			{
+				lock_guard<mutex> guard(owned->group->stateMutex);
+				if (!owned->group->firstException)
+				{
+					owned->group->firstException = std::current_exception();
+				}
+			}
+			
+			owned->group->finish_one();
+		}
+		
+		inline void worker_loop(size_t index)
+		{
+			currentScheduler = this;
+			currentIndex = index;
+			
+			while (true)
+			{
+				if (task* t = find_task(index))
+				{
+					execute(t);
+					continue;
+				}
+				
+				//a short spin catches tasks queued right behind the last one
+				bool found = false;
+				for (int i = 0; i < 64 && !found; ++i)
+				{
+					yield();
+					found = !queues[index]->empty()
+						|| hasInjected.load(memory_order_acquire);
+				}
+				if (found) continue;
+				
+				const uint32_t seen = epoch.load(memory_order_seq_cst);
+				sleepers.fetch_add(1, memory_order_seq_cst);
+				
+				if (task* t = find_task(index))
+				{
+					sleepers.fetch_sub(1, memory_order_seq_cst);
+					execute(t);
+					continue;
+				}
+				
+				if (stopping.load(memory_order_seq_cst))
+				{
+					sleepers.fetch_sub(1, memory_order_seq_cst);
+					break;
+				}
+				
+				epoch.wait(seen, memory_order_seq_cst);
+				sleepers.fetch_sub(1, memory_order_seq_cst);
+			}
+			
+			currentScheduler = nullptr;
+		}
+		
+		static inline size_t next_random()
+		{
+			//xorshift, seeded per thread from its own address
+			thread_local size_t state = rcast<uintptr_t>(&state) | 1;
+			
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			return state;
+		}
+		
+		static inline thread_local const task_scheduler* currentScheduler{};
+		static inline thread_local size_t currentIndex{};
+		
+		vector<unique_ptr<ws_deque<task>>> queues{};
+		vector<thread> workers{};
+		
+		mutex injectionMutex{};
+		deque<task*> injection{};
+		atomic<bool> hasInjected{};
+		
+		atomic<uint32_t> epoch{};
+		atomic<uint32_t> sleepers{};
+		atomic<bool> stopping{};
+	};
+	
+	template <invocable F>
+	inline void task_group::run(F&& func)
+	{
+		pending.fetch_add(1, memory_order_relaxed);
+		scheduler.enqueue(new task_scheduler::task{ function<void()>(std::forward<F>(func)), this });
+	}
+	
+	inline void task_group::wait()
+	{
+		while (pending.load(memory_order_acquire) != 0)
+		{
+			//the group's own tasks may be sitting in a deque, so help instead of blocking
+			if (!scheduler.run_one()) yield();
+		}
+		
+		//also waits for the task that made pending zero to release the group
+		exception_ptr e{};
+		{
+			lock_guard<mutex> guard(stateMutex);
+			e = std::exchange(firstException, nullptr);
+		}
+		if (e) std::rethrow_exception(e);
+	}
+	
+	template <invocable F>
+	inline void task_group::then(F&& func)
+	{
+		function<void()> next(std::forward<F>(func));
+		{
+			lock_guard<mutex> guard(stateMutex);
+			if (pending.load(memory_order_acquire) != 0)
+			{
+				continuation = std::move(next);
+				return;
+			}
+		}
+		
+		scheduler.submit(std::move(next));
+	}
+	
+	inline void task_group::finish_one()
+	{
+		//another task is still pending, so the group outlives this decrement
+		size_t count = pending.load(memory_order_acquire);
+		while (count > 1)
+		{
+			if (pending.compare_exchange_weak(
+				count,
+				count - 1,
+				memory_order_acq_rel,
+				memory_order_acquire))
+			{
+				return;
+			}
+		}
+		
+		//the last decrement happens under the lock and wait takes the lock after seeing zero,
+		//so the group can't be destroyed before the continuation is taken out of it
+		task_scheduler& owner = scheduler;
+		function<void()> next{};
+		{
+			lock_guard<mutex> guard(stateMutex);
+			if (pending.fetch_sub(1, memory_order_acq_rel) == 1)
+			{
+				next = std::move(continuation);
+				continuation = nullptr;
+			}
+		}
+		
+		if (next) owner.submit(std::move(next));
+	}
+	
+	//Process-wide scheduler shared by everything in this header,
+	//created with all hardware threads on first use
+	inline task_scheduler& default_scheduler()
+	{
+		static task_scheduler scheduler{};
+		return scheduler;
+	}	
+	//
+	// QUEUES
+	//
+	
+	//Single-producer single-consumer bounded ring queue.
+	//Each side keeps a cached copy of the other side's index so it only
+	//touches the shared cache line when the cached value says full or empty
+	template <typename T>
+		requires is_nothrow_move_constructible_v<T>
+	class spsc_queue
+	{
+	public:
+		//Capacity is rounded up to a power of two
+		explicit spsc_queue(size_t capacity)
+		{
+			size_t size = 1;
+			while (size < capacity) size <<= 1;
+			
+			mask = size - 1;
+			slots = make_unique<slot[]>(size);
+		}
+		
+		~spsc_queue()
+		{
+			const size_t tail = writeIndex.load(memory_order_relaxed);
+			for (size_t i = readIndex.load(memory_order_relaxed); i != tail; ++i)
+			{
+				slots[i & mask].get()->~T();
+			}
+		}
+		
+		spsc_queue(const spsc_queue&) = delete;
+		spsc_queue& operator=(const spsc_queue&) = delete;
+		
+		//Producer only, returns false if the queue is full
+		inline bool try_push(T&& item)
+		{
+			const size_t tail = writeIndex.load(memory_order_relaxed);
+			if (tail - cachedRead > mask)
+			{
+				cachedRead = readIndex.load(memory_order_acquire);
+				if (tail - cachedRead > mask) return false;
+			}
+			
+			new (slots[tail & mask].storage) T(std::move(item));
+			writeIndex.store(tail + 1, memory_order_release);
+			return true;
+		}
+		
+		//Producer only, returns false if the queue is full
+		inline bool try_push(const T& item)
+		{
+			T copy(item);
+			return try_push(std::move(copy));
+		}
+		
+		//Producer only, moves up to count items from items
+		//with a single publish and returns how many were pushed
+		inline size_t push_batch(T* items, size_t count)
+		{
+			const size_t tail = writeIndex.load(memory_order_relaxed);
+			if (tail - cachedRead + count > mask + 1)
+			{
+				cachedRead = readIndex.load(memory_order_acquire);
+			}
+			
+			const size_t pushed = min(count, mask + 1 - (tail - cachedRead));
+			for (size_t i = 0; i < pushed; ++i)
+			{
+				new (slots[(tail + i) & mask].storage) T(std::move(items[i]));
+			}
+			
+			if (pushed != 0) writeIndex.store(tail + pushed, memory_order_release);
+			return pushed;
+		}
+		
+		//Consumer only, returns false if the queue is empty
+		inline bool try_pop(T& outItem)
+		{
+			const size_t head = readIndex.load(memory_order_relaxed);
+			if (head == cachedWrite)
+			{
+				cachedWrite = writeIndex.load(memory_order_acquire);
+				if (head == cachedWrite) return false;
+			}
+			
+			T* item = slots[head & mask].get();
+			outItem = std::move(*item);
+			item->~T();
+			
+			readIndex.store(head + 1, memory_order_release);
+			return true;
+		}
+		
+		//Consumer only, moves up to maxCount items into outItems
+		//with a single release and returns how many were popped
+		inline size_t pop_batch(T* outItems, size_t maxCount)
+		{
+			const size_t head = readIndex.load(memory_order_relaxed);
+			if (cachedWrite - head < maxCount)
+			{
+				cachedWrite = writeIndex.load(memory_order_acquire);
+			}
+			
+			const size_t popped = min(maxCount, cachedWrite - head);
+			for (size_t i = 0; i < popped; ++i)
+			{
+				T* item = slots[(head + i) & mask].get();
+				outItems[i] = std::move(*item);
+				item->~T();
+			}
+			
+			if (popped != 0) readIndex.store(head + popped, memory_order_release);
+			return popped;
+		}
+		
+		//Exact from either side when the other side is idle, approximate otherwise
+		inline size_t size_approx() const
+		{
+			return writeIndex.load(memory_order_acquire) - readIndex.load(memory_order_acquire);
+		}
+		inline bool empty() const { return size_approx() == 0; }
+		inline size_t capacity() const { return mask + 1; }
+	private:
+		struct slot
+		{
+			alignas(T) unsigned char storage[sizeof(T)];
+			
+			inline T* get() { return std::launder(rcast<T*>(storage)); }
+		};
+		
+		size_t mask{};
+		unique_ptr<slot[]> slots{};
+		
+		//producer line
+		alignas(CACHE_LINE_SIZE) asize writeIndex{};
+		size_t cachedRead{};
+		
+		//consumer line
+		alignas(CACHE_LINE_SIZE) asize readIndex{};
+		size_t cachedWrite{};
+		
+		//keeps the consumer line from sharing with whatever follows the queue
+		char padding[CACHE_LINE_SIZE - sizeof(asize) - sizeof(size_t)]{};
+	};
+	
+	//Multi-producer multi-consumer bounded ring queue (Vyukov).
+	//Every cell carries a sequence number that tells producers and consumers
+	//whether it is free or filled for their lap, so each side only CASes its own index
+	template <typename T>
+		requires is_nothrow_move_constructible_v<T>
+	class mpmc_queue
+	{
+	public:
+		//Capacity is rounded up to a power of two, at least 2
+		explicit mpmc_queue(size_t capacity)
+		{
+			size_t size = 2;
+			while (size < capacity) size <<= 1;
+			
+			mask = size - 1;
+			cells = make_unique<cell[]>(size);
+			for (size_t i = 0; i < size; ++i)
+			{
+				cells[i].sequence.store(i, memory_order_relaxed);
+			}
+		}
+		
+		~mpmc_queue()
+		{
+			const size_t tail = enqueueIndex.load(memory_order_relaxed);
+			for (size_t i = dequeueIndex.load(memory_order_relaxed); i != tail; ++i)
+			{
+				cell& c = cells[i & mask];
+				if (c.sequence.load(memory_order_relaxed) == i + 1) c.get()->~T();
+			}
+		}
+		
+		mpmc_queue(const mpmc_queue&) = delete;
+		mpmc_queue& operator=(const mpmc_queue&) = delete;
+		
+		//Any thread, returns false if the queue is full
+		inline bool try_push(T&& item)
+		{
+			return push_batch(&item, 1) == 1;
+		}
+		
+		//Any thread, returns false if the queue is full
+		inline bool try_push(const T& item)
+		{
+			T copy(item);
+			return try_push(std::move(copy));
+		}
+		
+		//Any thread, claims up to count consecutive free cells with one CAS,
+		//moves that many items from items and returns how many were pushed
+		inline size_t push_batch(T* items, size_t count)
+		{
+			if (count == 0) return 0;
+			
+			size_t pos = enqueueIndex.load(memory_order_relaxed);
+			while (true)
+			{
+				//a cell is free for this lap once its sequence equals its position
+				size_t ready{};
+				while (ready < count
+					&& ready <= mask
+					&& cells[(pos + ready) & mask].sequence.load(memory_order_acquire) == pos + ready)
+				{
+					++ready;
+				}
+				
+				if (ready == 0)
+				{
+					const size_t sequence = cells[pos & mask].sequence.load(memory_order_acquire);
+					
+					//the consumer of the previous lap hasn't released it yet, so the queue is full
+					if (scast<ptrdiff_t>(sequence - pos) < 0) return 0;
+					
+					//another producer took it, retry from the current index
+					pos = enqueueIndex.load(memory_order_relaxed);
+					continue;
+				}
+				
+				if (enqueueIndex.compare_exchange_weak(
+					pos,
+					pos + ready,
+					memory_order_relaxed,
+					memory_order_relaxed))
+				{
+					for (size_t i = 0; i < ready; ++i)
+					{
+						cell& c = cells[(pos + i) & mask];
+						new (c.storage) T(std::move(items[i]));
+						c.sequence.store(pos + i + 1, memory_order_release);
+					}
+					
+					return ready;
+				}
+			}
+		}
+		
+		//Any thread, returns false if the queue is empty
+		inline bool try_pop(T& outItem)
+		{
+			return pop_batch(&outItem, 1) == 1;
+		}
+		
+		//Any thread, claims up to maxCount consecutive filled cells with one CAS,
+		//moves them into outItems and returns how many were popped
+		inline size_t pop_batch(T* outItems, size_t maxCount)
+		{
+			if (maxCount == 0) return 0;
+			
+			size_t pos = dequeueIndex.load(memory_order_relaxed);
+			while (true)
+			{
+				//a cell is filled for this lap once its sequence is one past its position
+				size_t ready{};
+				while (ready < maxCount
+					&& ready <= mask
+					&& cells[(pos + ready) & mask].sequence.load(memory_order_acquire) == pos + ready + 1)
+				{
+					++ready;
+				}
+				
+				if (ready == 0)
+				{
+					const size_t sequence = cells[pos & mask].sequence.load(memory_order_acquire);
+					
+					//the producer of this lap hasn't published it yet, so the queue is empty
+					if (scast<ptrdiff_t>(sequence - (pos + 1)) < 0) return 0;
+					
+					//another consumer took it, retry from the current index
+					pos = dequeueIndex.load(memory_order_relaxed);
+					continue;
+				}
+				
+				if (dequeueIndex.compare_exchange_weak(
+					pos,
+					pos + ready,
+					memory_order_relaxed,
+					memory_order_relaxed))
+				{
+					for (size_t i = 0; i < ready; ++i)
+					{
+						cell& c = cells[(pos + i) & mask];
+						T* item = c.get();
+						outItems[i] = std::move(*item);
+						item->~T();
+						
+						//free for the producer of the next lap
+						c.sequence.store(pos + i + mask + 1, memory_order_release);
+					}
+					
+					return ready;
+				}
+			}
+		}
+		
+		//Approximate while other threads push or pop
+		inline size_t size_approx() const
+		{
+			const size_t tail = enqueueIndex.load(memory_order_acquire);
+			const size_t head = dequeueIndex.load(memory_order_acquire);
+			
+			return tail > head ? tail - head : 0;
+		}
+		inline bool empty() const { return size_approx() == 0; }
+		inline size_t capacity() const { return mask + 1; }
+	private:
+		struct cell
+		{
+			asize sequence{};
+			alignas(T) unsigned char storage[sizeof(T)];
+			
+			inline T* get() { return std::launder(rcast<T*>(storage)); }
+		};
+		
+		size_t mask{};
+		unique_ptr<cell[]> cells{};
+		
+		alignas(CACHE_LINE_SIZE) asize enqueueIndex{};
+		alignas(CACHE_LINE_SIZE) asize dequeueIndex{};
+		
+		//keeps the consumer index from sharing with whatever follows the queue
+		char padding[CACHE_LINE_SIZE - sizeof(asize)]{};
+	};
 }
\ No newline at end of file